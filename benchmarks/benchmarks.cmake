@@ -0,0 +1,20 @@
+if(KPHP_BENCHMARKS)
+    function(vk_add_benchmark BENCHMARK_NAME SRC_LIBS)
+        set(BENCHMARK_NAME benchmark-${BENCHMARK_NAME})
+        add_executable(${BENCHMARK_NAME} ${ARGN})
+        target_link_libraries(${BENCHMARK_NAME} PRIVATE benchmark::benchmark ${SRC_LIBS} vk::popular_common)
+        target_link_options(${BENCHMARK_NAME} PRIVATE ${NO_PIE})
+        set_target_properties(${BENCHMARK_NAME} PROPERTIES FOLDER benchmarks)
+    endfunction()
+
+    set(CRYPTO_BENCHMARK_LIBS vk::common_src vk::net_src vk::binlog_src vk::unicode -l:libzstd.a rt crypto z)
+    vk_add_benchmark(crypto "${CRYPTO_BENCHMARK_LIBS}" ${COMMON_DIR}/crypto/aes256-benchmark.cpp)
+
+    # multi-process store/fetch/delete stress over the real shared memory machinery,
+    # see runtime/instance-cache-benchmark.cpp for details and usage
+    vk_add_benchmark(instance-cache "${RUNTIME_LIBS};${RUNTIME_LINK_TEST_LIBS}" ${BASE_DIR}/runtime/instance-cache-benchmark.cpp)
+
+    # array/string/string_buffer/script-allocator microbenchmarks inside a real
+    # script memory environment, see runtime/runtime-benchmark.cpp for the workloads
+    vk_add_benchmark(runtime "${RUNTIME_LIBS};${RUNTIME_LINK_TEST_LIBS}" ${BASE_DIR}/runtime/runtime-benchmark.cpp)
+endif()
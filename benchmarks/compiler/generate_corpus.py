@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""Generates the frozen synthetic PHP codebases for the kphp2cpp benchmark.
+
+The corpora are deterministic (fixed seed, sorted iteration), so two checkouts
+always produce byte-identical inputs and timing diffs can only come from the
+compiler itself. Three profiles stress different parts of the pipeline:
+
+  small  - many tiny files with literal-heavy functions: lexer and parser
+  medium - deep untyped call chains threading arrays and tuples: type inference
+  large  - many classes with typed fields and methods: codegen output volume
+"""
+import argparse
+import os
+import random
+
+SEED = 20260829
+
+
+def _write(corpus_dir, name, lines):
+    with open(os.path.join(corpus_dir, name), "w") as f:
+        f.write("<?php\n\n")
+        f.write("\n".join(lines))
+        f.write("\n")
+
+
+def gen_parse_corpus(corpus_dir, files=150, functions_per_file=40):
+    rnd = random.Random(SEED)
+    requires = []
+    calls = []
+    for file_i in range(files):
+        lines = []
+        for func_i in range(functions_per_file):
+            name = "parse_f_{}_{}".format(file_i, func_i)
+            literals = ", ".join(str(rnd.randint(0, 10 ** 9)) for _ in range(rnd.randint(8, 24)))
+            strings = ", ".join("'k{}' => {}".format(i, rnd.randint(0, 999)) for i in range(rnd.randint(4, 12)))
+            lines.append("function {}(int $x): int {{".format(name))
+            lines.append("  $a = [{}];".format(literals))
+            lines.append("  $m = [{}];".format(strings))
+            lines.append("  $s = 0;")
+            lines.append("  foreach ($a as $v) { $s += $v ^ $x; }")
+            lines.append("  foreach ($m as $v) { $s += $v; }")
+            lines.append("  return $s + {};".format(rnd.randint(1, 100)))
+            lines.append("}")
+            lines.append("")
+            calls.append("  $acc += {}($acc & 0xffff);".format(name))
+        file_name = "parse_{:03d}.php".format(file_i)
+        _write(corpus_dir, file_name, lines)
+        requires.append(file_name)
+    return requires, calls
+
+
+def gen_inference_corpus(corpus_dir, chains=40, depth=30):
+    rnd = random.Random(SEED)
+    requires = []
+    calls = []
+    for chain_i in range(chains):
+        lines = []
+        # the bottom of the chain fixes the types, everything above is untyped
+        # and must be inferred through array/tuple plumbing
+        lines.append("function infer_f_{}_0($x) {{".format(chain_i))
+        lines.append("  return [tuple($x + 1, (float)$x / 3, 'v' . $x)];")
+        lines.append("}")
+        for level in range(1, depth):
+            name = "infer_f_{}_{}".format(chain_i, level)
+            prev = "infer_f_{}_{}".format(chain_i, level - 1)
+            lines.append("function {}($x) {{".format(name))
+            lines.append("  $r = {}($x + {});".format(prev, rnd.randint(1, 9)))
+            lines.append("  foreach ($r as $t) {")
+            lines.append("    $r[] = tuple($t[0] + 1, $t[1] * 2, $t[2] . '!');")
+            lines.append("  }")
+            lines.append("  return $r;")
+            lines.append("}")
+        lines.append("")
+        lines.append("function infer_chain_{}($x) {{".format(chain_i))
+        lines.append("  $r = infer_f_{}_{}($x);".format(chain_i, depth - 1))
+        lines.append("  $s = 0;")
+        lines.append("  foreach ($r as $t) { $s += $t[0]; }")
+        lines.append("  return $s;")
+        lines.append("}")
+        file_name = "infer_{:03d}.php".format(chain_i)
+        _write(corpus_dir, file_name, lines)
+        requires.append(file_name)
+        calls.append("  $acc += infer_chain_{}($acc % 1000);".format(chain_i))
+    return requires, calls
+
+
+def gen_codegen_corpus(corpus_dir, files=60, classes_per_file=8, methods_per_class=10):
+    rnd = random.Random(SEED)
+    requires = []
+    calls = []
+    for file_i in range(files):
+        lines = []
+        for class_i in range(classes_per_file):
+            name = "Gen{}_{}".format(file_i, class_i)
+            lines.append("class {} {{".format(name))
+            lines.append("  /** @var int */")
+            lines.append("  public $count = 0;")
+            lines.append("  /** @var string */")
+            lines.append("  public $label = '';")
+            lines.append("  /** @var int[] */")
+            lines.append("  public $values = [];")
+            lines.append("")
+            lines.append("  public function __construct(int $count, string $label) {")
+            lines.append("    $this->count = $count;")
+            lines.append("    $this->label = $label;")
+            lines.append("    for ($i = 0; $i < $count; $i++) {{ $this->values[] = $i * {}; }}".format(rnd.randint(2, 17)))
+            lines.append("  }")
+            for method_i in range(methods_per_class):
+                lines.append("")
+                lines.append("  public function m{}(int $x): int {{".format(method_i))
+                lines.append("    $s = $x + {};".format(rnd.randint(1, 99)))
+                lines.append("    foreach ($this->values as $v) { $s += $v % (1 + $x); }")
+                lines.append("    return $s + strlen($this->label);")
+                lines.append("  }")
+            lines.append("}")
+            lines.append("")
+            lines.append("function use_{}(int $x): int {{".format(name))
+            lines.append("  $obj = new {}($x % 16 + 1, 'label_{}');".format(name, class_i))
+            lines.append("  $s = 0;")
+            for method_i in range(methods_per_class):
+                lines.append("  $s += $obj->m{}($x + {});".format(method_i, method_i))
+            lines.append("  return $s;")
+            lines.append("}")
+            lines.append("")
+            calls.append("  $acc += use_{}($acc & 0xff);".format(name))
+        file_name = "codegen_{:03d}.php".format(file_i)
+        _write(corpus_dir, file_name, lines)
+        requires.append(file_name)
+    return requires, calls
+
+
+GENERATORS = {
+    "small": gen_parse_corpus,
+    "medium": gen_inference_corpus,
+    "large": gen_codegen_corpus,
+}
+
+
+def generate_corpus(profile, corpus_dir):
+    os.makedirs(corpus_dir, exist_ok=True)
+    requires, calls = GENERATORS[profile](corpus_dir)
+    lines = ["require_once '{}';".format(name) for name in requires]
+    lines.append("")
+    lines.append("function main(): int {")
+    lines.append("  $acc = 1;")
+    lines.extend(calls)
+    lines.append("  return $acc;")
+    lines.append("}")
+    lines.append("")
+    lines.append("echo main(), \"\\n\";")
+    _write(corpus_dir, "index.php", lines)
+    return os.path.join(corpus_dir, "index.php")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="generate the kphp2cpp benchmark corpora")
+    parser.add_argument("--output-dir", required=True, help="directory to place the corpora in")
+    parser.add_argument("--profiles", default=",".join(GENERATORS), help="comma-separated subset of: " + ", ".join(GENERATORS))
+    args = parser.parse_args()
+    for profile in args.profiles.split(","):
+        entry = generate_corpus(profile, os.path.join(args.output_dir, profile))
+        print("{}: {}".format(profile, entry))
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""Builds the frozen benchmark corpora with the in-tree kphp2cpp and reports
+per-stage times.
+
+Timings come from the compiler's own pipeline profiler via
+KPHP_COMPILATION_METRICS_JSON_FILE (see compiler/threading/profiler.cpp and
+Stats::write_json_to), so the report breaks a regression down to the pipe that
+caused it. Several runs are taken and the best one kept - build machines are
+noisy, and the minimum is the most stable estimator of the true cost.
+
+Typical gating flow:
+  # on the base revision
+  ./run_benchmark.py --save-baseline base.json
+  # on the candidate revision
+  ./run_benchmark.py --baseline base.json --threshold 5
+The second invocation exits non-zero when any corpus got slower than the
+threshold, with a per-pipe breakdown of where the time went.
+"""
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+from generate_corpus import GENERATORS, generate_corpus
+
+DEFAULT_RUNS = 3
+TOP_PIPES = 10
+
+
+def search_kphp2cpp():
+    repo_root = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+    path = os.path.join(repo_root, "objs", "bin", "kphp2cpp")
+    if not os.access(path, os.X_OK):
+        sys.exit("kphp2cpp not found at {}; build it or pass --kphp2cpp".format(path))
+    return path
+
+
+def run_compiler(kphp2cpp, entry_php, work_dir, threads):
+    metrics_file = os.path.join(work_dir, "metrics.json")
+    dest_dir = os.path.join(work_dir, "kphp_out")
+    env = dict(
+        os.environ,
+        KPHP_NO_MAKE="1",  # we are measuring the transpiler, not g++
+        KPHP_DEST_DIR=dest_dir,
+        KPHP_THREADS_COUNT=str(threads),
+        KPHP_COMPILATION_METRICS_JSON_FILE=metrics_file,
+        KPHP_INCLUDE_DIR=os.path.dirname(entry_php),
+    )
+    proc = subprocess.run([kphp2cpp, entry_php], env=env, cwd=work_dir,
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    if proc.returncode != 0:
+        sys.stderr.write(proc.stderr.decode(errors="replace"))
+        sys.exit("kphp2cpp failed on {}".format(entry_php))
+    with open(metrics_file) as f:
+        metrics = json.load(f)
+    shutil.rmtree(dest_dir, ignore_errors=True)
+    return metrics
+
+
+def best_run(kphp2cpp, entry_php, work_dir, threads, runs):
+    best = None
+    for _ in range(runs):
+        metrics = run_compiler(kphp2cpp, entry_php, work_dir, threads)
+        if best is None or metrics["compilation"]["total_time"] < best["compilation"]["total_time"]:
+            best = metrics
+    return best
+
+
+def pipe_times(metrics):
+    return {name: pipe["working_time"] for name, pipe in metrics.get("pipes", {}).items()}
+
+
+def print_report(profile, metrics):
+    print("== {} ==".format(profile))
+    print("  total_time: {:.3f}s  transpilation_time: {:.3f}s  rss_peak: {:.0f}MB".format(
+        metrics["compilation"]["total_time"],
+        metrics["compilation"]["transpilation_time"],
+        metrics["memory"]["rss_peak"] / (1 << 20)))
+    top = sorted(pipe_times(metrics).items(), key=lambda kv: -kv[1])[:TOP_PIPES]
+    for name, seconds in top:
+        print("    {:<48} {:8.3f}s".format(name, seconds))
+
+
+def compare_with_baseline(profile, metrics, baseline_metrics, threshold_percent):
+    new_total = metrics["compilation"]["total_time"]
+    old_total = baseline_metrics["compilation"]["total_time"]
+    delta_percent = (new_total - old_total) / old_total * 100 if old_total else 0.0
+    print("== {} vs baseline: {:.3f}s -> {:.3f}s ({:+.1f}%)".format(profile, old_total, new_total, delta_percent))
+
+    old_pipes = pipe_times(baseline_metrics)
+    new_pipes = pipe_times(metrics)
+    moved = []
+    for name in sorted(set(old_pipes) | set(new_pipes)):
+        diff = new_pipes.get(name, 0.0) - old_pipes.get(name, 0.0)
+        if abs(diff) > 0.01:
+            moved.append((diff, name))
+    for diff, name in sorted(moved, reverse=True)[:TOP_PIPES]:
+        print("    {:<48} {:+8.3f}s".format(name, diff))
+    return delta_percent <= threshold_percent
+
+
+def main():
+    parser = argparse.ArgumentParser(description="kphp2cpp performance benchmark over the frozen corpora")
+    parser.add_argument("--kphp2cpp", help="compiler binary (default: objs/bin/kphp2cpp of this checkout)")
+    parser.add_argument("--profiles", default=",".join(GENERATORS), help="comma-separated subset of: " + ", ".join(GENERATORS))
+    parser.add_argument("--runs", type=int, default=DEFAULT_RUNS, help="runs per corpus, the best one is kept")
+    parser.add_argument("--threads", type=int, default=4, help="KPHP_THREADS_COUNT for the build")
+    parser.add_argument("--work-dir", help="keep corpora and build output here instead of a temp dir")
+    parser.add_argument("--baseline", help="compare against a report saved with --save-baseline")
+    parser.add_argument("--save-baseline", help="write the collected metrics to this file")
+    parser.add_argument("--threshold", type=float, default=5.0, help="max allowed total_time regression, percent")
+    args = parser.parse_args()
+
+    kphp2cpp = os.path.abspath(args.kphp2cpp) if args.kphp2cpp else search_kphp2cpp()
+    work_dir = os.path.abspath(args.work_dir) if args.work_dir else tempfile.mkdtemp(prefix="kphp2cpp_bench_")
+
+    baseline = None
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+
+    results = {}
+    ok = True
+    for profile in args.profiles.split(","):
+        corpus_dir = os.path.join(work_dir, "corpus", profile)
+        entry_php = generate_corpus(profile, corpus_dir)
+        metrics = best_run(kphp2cpp, entry_php, work_dir, args.threads, args.runs)
+        results[profile] = metrics
+        if baseline is not None and profile in baseline:
+            ok &= compare_with_baseline(profile, metrics, baseline[profile], args.threshold)
+        else:
+            print_report(profile, metrics)
+
+    if args.save_baseline:
+        with open(args.save_baseline, "w") as f:
+            json.dump(results, f, indent=1, sort_keys=True)
+        print("baseline saved to {}".format(args.save_baseline))
+
+    if not args.work_dir:
+        shutil.rmtree(work_dir, ignore_errors=True)
+    if not ok:
+        sys.exit("compiler performance regression above {:.1f}% threshold".format(args.threshold))
+
+
+if __name__ == "__main__":
+    main()
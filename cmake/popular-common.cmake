@@ -21,6 +21,7 @@ prepend(POPULAR_COMMON_SOURCES ${COMMON_DIR}/
         crc32c_${HOST}.cpp
         parallel/counter.cpp
         parallel/maximum.cpp
+        parallel/sharded-counter.cpp
         parallel/thread-id.cpp
         parallel/limit-counter.cpp
         version-string.cpp)
@@ -0,0 +1,69 @@
+#include "common/algorithms/simd-ascii-case.h"
+
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+char ascii_lower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+} // namespace
+
+TEST(simd_ascii_case, needs_case_mapping) {
+  const std::string lowered{"already lowered, with punctuation-123!"};
+  ASSERT_FALSE(vk::simd_ascii_needs_case_mapping(lowered.data(), lowered.size(), 'A', 'Z'));
+
+  const std::string with_capital{"almost lowered but one Capital near end"};
+  ASSERT_TRUE(vk::simd_ascii_needs_case_mapping(with_capital.data(), with_capital.size(), 'A', 'Z'));
+
+  const std::string with_non_ascii{"non-ascii \xEF depends on the locale"};
+  ASSERT_TRUE(vk::simd_ascii_needs_case_mapping(with_non_ascii.data(), with_non_ascii.size(), 'A', 'Z'));
+
+  ASSERT_FALSE(vk::simd_ascii_needs_case_mapping("", 0, 'A', 'Z'));
+}
+
+TEST(simd_ascii_case, flip_case_span_matches_scalar) {
+  std::mt19937 rng(42);
+  for (int iter = 0; iter < 2000; ++iter) {
+    const size_t n = rng() % 70;
+    std::string src(n, '\0');
+    for (auto &c : src) {
+      c = static_cast<char>(rng() % 256);
+    }
+    std::string dst(n, '#');
+    const size_t span = vk::simd_ascii_flip_case_span(src.data(), &dst[0], n, 'A', 'Z');
+
+    size_t expected_span = 0;
+    while (expected_span < n && static_cast<signed char>(src[expected_span]) >= 0) {
+      ++expected_span;
+    }
+    ASSERT_EQ(span, expected_span);
+    for (size_t i = 0; i < span; ++i) {
+      ASSERT_EQ(dst[i], ascii_lower(src[i]));
+    }
+  }
+}
+
+TEST(simd_ascii_case, case_equal_prefix_never_overshoots) {
+  std::mt19937 rng(7);
+  for (int iter = 0; iter < 2000; ++iter) {
+    const size_t n = rng() % 70;
+    std::string a(n, '\0');
+    std::string b(n, '\0');
+    for (size_t i = 0; i < n; ++i) {
+      a[i] = static_cast<char>(rng() % 256);
+      b[i] = (rng() % 3) ? a[i] : static_cast<char>(rng() % 256);
+    }
+    const size_t prefix = vk::simd_ascii_case_equal_prefix(a.data(), b.data(), n);
+    ASSERT_LE(prefix, n);
+    for (size_t i = 0; i < prefix; ++i) {
+      ASSERT_GE(static_cast<signed char>(a[i]), 0);
+      ASSERT_GE(static_cast<signed char>(b[i]), 0);
+      ASSERT_EQ(ascii_lower(a[i]), ascii_lower(b[i]));
+    }
+  }
+}
@@ -0,0 +1,94 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace vk {
+namespace impl_ {
+
+// signed byte compares are enough for ascii classes: both boundaries are below 0x80,
+// and non-ascii bytes read as negative and fail the range test
+inline __m128i ascii_in_range(__m128i chunk, char from, char to) {
+  return _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8(from - 1)),
+                       _mm_cmpgt_epi8(_mm_set1_epi8(to + 1), chunk));
+}
+
+inline __m128i ascii_to_lower(__m128i chunk) {
+  return _mm_or_si128(chunk, _mm_and_si128(ascii_in_range(chunk, 'A', 'Z'), _mm_set1_epi8(0x20)));
+}
+
+} // namespace impl_
+
+// whether case mapping can change any byte: one in [from, to] flips its case bit,
+// a non-ascii one maps through the locale table of the caller
+inline bool simd_ascii_needs_case_mapping(const char *s, size_t n, char from, char to) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+    // the sign bit of the chunk itself marks non-ascii bytes
+    if (_mm_movemask_epi8(_mm_or_si128(impl_::ascii_in_range(chunk, from, to), chunk)) != 0) {
+      return true;
+    }
+  }
+  for (; i < n; i++) {
+    const auto c = static_cast<signed char>(s[i]);
+    if (c < 0 || (c >= from && c <= to)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// copies the leading pure-ascii span into dst, flipping the 0x20 case bit of every byte
+// in [from, to]; stops before the first non-ascii byte and returns the span length
+inline size_t simd_ascii_flip_case_span(const char *src, char *dst, size_t n, char from, char to) {
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    const __m128i flipped = _mm_xor_si128(chunk, _mm_and_si128(impl_::ascii_in_range(chunk, from, to), case_bit));
+    const uint32_t non_ascii = static_cast<uint32_t>(_mm_movemask_epi8(chunk));
+    if (non_ascii == 0) {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), flipped);
+      continue;
+    }
+    alignas(16) char converted[16];
+    _mm_store_si128(reinterpret_cast<__m128i *>(converted), flipped);
+    const size_t valid = __builtin_ctz(non_ascii);
+    memcpy(dst + i, converted, valid);
+    return i + valid;
+  }
+  for (; i < n; i++) {
+    const auto c = static_cast<signed char>(src[i]);
+    if (c < 0) {
+      break;
+    }
+    dst[i] = (c >= from && c <= to) ? static_cast<char>(c ^ 0x20) : src[i];
+  }
+  return i;
+}
+
+// length of the prefix on which both buffers are pure ascii and equal ignoring case,
+// whole 16-byte blocks only: the caller finishes from the returned position
+inline size_t simd_ascii_case_equal_prefix(const char *a, const char *b, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    if (_mm_movemask_epi8(_mm_or_si128(va, vb)) != 0) {
+      break; // non-ascii bytes compare through the locale table of the caller
+    }
+    const uint32_t neq = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(impl_::ascii_to_lower(va), impl_::ascii_to_lower(vb)))) ^ 0xffffu;
+    if (neq != 0) {
+      return i + __builtin_ctz(neq);
+    }
+  }
+  return i;
+}
+
+} // namespace vk
@@ -0,0 +1,44 @@
+#include "common/algorithms/simd-escape-scan.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+template<class F, class Pred>
+void check_span_matches_scalar(F span_of, Pred is_clean) {
+  std::mt19937 rng(1234);
+  for (int iter = 0; iter < 2000; ++iter) {
+    std::string s(rng() % 70, '\0');
+    for (auto &c : s) {
+      c = static_cast<char>(rng() % 256);
+    }
+    size_t expected = 0;
+    while (expected < s.size() && is_clean(s[expected])) {
+      ++expected;
+    }
+    ASSERT_EQ(span_of(s.data(), s.size()), expected) << "iter " << iter;
+  }
+}
+
+} // namespace
+
+TEST(simd_escape_scan, html_span) {
+  check_span_matches_scalar(vk::simd_html_clean_span,
+                            [](char c) { return !strchr("&\"'<>", c) || c == '\0'; });
+}
+
+TEST(simd_escape_scan, slashes_span) {
+  check_span_matches_scalar(vk::simd_slashes_clean_span,
+                            [](char c) { return c != '\0' && c != '\'' && c != '"' && c != '\\'; });
+}
+
+TEST(simd_escape_scan, url_span) {
+  check_span_matches_scalar(vk::simd_url_clean_span, [](char c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+           c == '.' || c == '_' || c == '-';
+  });
+}
@@ -0,0 +1,78 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace vk {
+namespace impl_ {
+
+// length of the leading span whose bytes all classify as clean, 16 bytes per step;
+// dirty_mask_of returns an _mm_movemask_epi8 with a bit set per dirty byte
+template<class F>
+size_t simd_clean_span(const char *s, size_t n, F dirty_mask_of) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const uint32_t mask = dirty_mask_of(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i)));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  if (i < n) {
+    // the tail is padded with zero bytes: whatever they classify as is cut off by the clamp
+    alignas(16) char tail[16] = {};
+    memcpy(tail, s + i, n - i);
+    const uint32_t mask = dirty_mask_of(_mm_load_si128(reinterpret_cast<const __m128i *>(tail)));
+    i += mask != 0 ? __builtin_ctz(mask) : 16;
+  }
+  return i < n ? i : n;
+}
+
+} // namespace impl_
+
+// length of the leading span free of the htmlspecialchars escape set & " ' < >
+inline size_t simd_html_clean_span(const char *s, size_t n) {
+  return impl_::simd_clean_span(s, n, [](__m128i chunk) {
+    __m128i dirty = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('&'));
+    dirty = _mm_or_si128(dirty, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')));
+    dirty = _mm_or_si128(dirty, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\'')));
+    dirty = _mm_or_si128(dirty, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('<')));
+    dirty = _mm_or_si128(dirty, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('>')));
+    return static_cast<uint32_t>(_mm_movemask_epi8(dirty));
+  });
+}
+
+// length of the leading span free of the addslashes escape set \0 ' " backslash
+inline size_t simd_slashes_clean_span(const char *s, size_t n) {
+  return impl_::simd_clean_span(s, n, [](__m128i chunk) {
+    __m128i dirty = _mm_cmpeq_epi8(chunk, _mm_setzero_si128());
+    dirty = _mm_or_si128(dirty, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\'')));
+    dirty = _mm_or_si128(dirty, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')));
+    dirty = _mm_or_si128(dirty, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')));
+    return static_cast<uint32_t>(_mm_movemask_epi8(dirty));
+  });
+}
+
+// length of the leading span of url-safe bytes [0-9a-zA-Z._-]; signed byte compares are
+// enough: every boundary is below 0x80, and bytes >= 0x80 read as negative and fail them
+inline size_t simd_url_clean_span(const char *s, size_t n) {
+  return impl_::simd_clean_span(s, n, [](__m128i chunk) {
+    const auto in_range = [chunk](char from, char to) {
+      return _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8(from - 1)),
+                           _mm_cmpgt_epi8(_mm_set1_epi8(to + 1), chunk));
+    };
+    __m128i safe = in_range('0', '9');
+    safe = _mm_or_si128(safe, in_range('A', 'Z'));
+    safe = _mm_or_si128(safe, in_range('a', 'z'));
+    safe = _mm_or_si128(safe, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('.')));
+    safe = _mm_or_si128(safe, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_')));
+    safe = _mm_or_si128(safe, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('-')));
+    return static_cast<uint32_t>(_mm_movemask_epi8(safe)) ^ 0xffffu;
+  });
+}
+
+} // namespace vk
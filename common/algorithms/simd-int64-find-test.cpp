@@ -0,0 +1,39 @@
+#include "common/algorithms/simd-int64-find.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(simd_int64_find, matches_std_find) {
+  std::vector<int64_t> haystack(57);
+  for (size_t i = 0; i < haystack.size(); ++i) {
+    haystack[i] = static_cast<int64_t>(i * 2654435761) - 50;
+  }
+
+  for (int64_t needle : {haystack.front(), haystack.back(), haystack[31], int64_t{-1}, int64_t{1} << 40}) {
+    const int64_t *expected = std::find(haystack.data(), haystack.data() + haystack.size(), needle);
+    ASSERT_EQ(vk::simd_int64_find(haystack.data(), haystack.data() + haystack.size(), needle), expected);
+  }
+}
+
+TEST(simd_int64_find, half_lane_false_positives) {
+  // values sharing exactly one 32-bit half with the needle must not match
+  const int64_t needle = (int64_t{0x1234} << 32) | 0x5678;
+  std::vector<int64_t> haystack(16, 0x5678);
+  haystack.resize(24, int64_t{0x1234} << 32);
+
+  const int64_t *end = haystack.data() + haystack.size();
+  ASSERT_EQ(vk::simd_int64_find(haystack.data(), end, needle), end);
+
+  haystack[19] = needle;
+  ASSERT_EQ(vk::simd_int64_find(haystack.data(), end, needle), haystack.data() + 19);
+}
+
+TEST(simd_int64_find, short_and_empty_ranges) {
+  const int64_t small[3] = {1, -2, 3};
+  ASSERT_EQ(vk::simd_int64_find(small, small + 3, -2), small + 1);
+  ASSERT_EQ(vk::simd_int64_find(small, small + 3, 4), small + 3);
+  ASSERT_EQ(vk::simd_int64_find(small, small, 1), small);
+}
@@ -0,0 +1,38 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <emmintrin.h>
+
+namespace vk {
+
+// linear scan for an int64 value over a contiguous range, 4 elements per iteration;
+// returns a pointer to the first match or end: a membership test over flat arrays
+// that the generic element-wise comparison loops can't come close to
+inline const int64_t *simd_int64_find(const int64_t *begin, const int64_t *end, int64_t value) {
+  const __m128i needle = _mm_set1_epi64x(value);
+  const int64_t *p = begin;
+  for (; p + 4 <= end; p += 4) {
+    __m128i eq0 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), needle);
+    __m128i eq1 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 2)), needle);
+    // SSE2 has no 64-bit compare: a lane matches iff both its 32-bit halves do,
+    // so and each comparison with itself with the halves of every lane swapped
+    eq0 = _mm_and_si128(eq0, _mm_shuffle_epi32(eq0, 0xb1));
+    eq1 = _mm_and_si128(eq1, _mm_shuffle_epi32(eq1, 0xb1));
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(eq0)) | (static_cast<uint32_t>(_mm_movemask_epi8(eq1)) << 16);
+    if (mask != 0) {
+      return p + (__builtin_ctz(mask) >> 3);
+    }
+  }
+  for (; p != end; ++p) {
+    if (*p == value) {
+      return p;
+    }
+  }
+  return end;
+}
+
+} // namespace vk
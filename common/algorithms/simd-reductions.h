@@ -0,0 +1,71 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <emmintrin.h>
+
+namespace vk {
+
+// reduction kernels over contiguous ranges, two accumulators to hide the add
+// latency; SSE2 is the baseline here like in the rest of common/algorithms —
+// wider instruction sets would need per-file build flags the runtime doesn't use
+
+inline int64_t simd_int64_sum(const int64_t *begin, const int64_t *end) {
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  const int64_t *p = begin;
+  for (; p + 4 <= end; p += 4) {
+    acc0 = _mm_add_epi64(acc0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+    acc1 = _mm_add_epi64(acc1, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 2)));
+  }
+  acc0 = _mm_add_epi64(acc0, acc1);
+  int64_t result = _mm_cvtsi128_si64(acc0) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc0, acc0));
+  for (; p != end; ++p) {
+    result += *p;
+  }
+  return result;
+}
+
+// the accumulation order differs from a sequential loop, so the low bits of the
+// result can too; that's inherent to any vectorized float sum
+inline double simd_double_sum(const double *begin, const double *end) {
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  const double *p = begin;
+  for (; p + 4 <= end; p += 4) {
+    acc0 = _mm_add_pd(acc0, _mm_loadu_pd(p));
+    acc1 = _mm_add_pd(acc1, _mm_loadu_pd(p + 2));
+  }
+  acc0 = _mm_add_pd(acc0, acc1);
+  double result = _mm_cvtsd_f64(acc0) + _mm_cvtsd_f64(_mm_unpackhi_pd(acc0, acc0));
+  for (; p != end; ++p) {
+    result += *p;
+  }
+  return result;
+}
+
+// fused single-pass min+max; the range must be non-empty; with NaN entries the
+// result is unspecified, matching what the element-wise comparison loops give
+inline void simd_double_min_max(const double *begin, const double *end, double *min_out, double *max_out) {
+  __m128d min_acc = _mm_set1_pd(*begin);
+  __m128d max_acc = min_acc;
+  const double *p = begin;
+  for (; p + 2 <= end; p += 2) {
+    const __m128d v = _mm_loadu_pd(p);
+    min_acc = _mm_min_pd(min_acc, v);
+    max_acc = _mm_max_pd(max_acc, v);
+  }
+  double min_value = _mm_cvtsd_f64(_mm_min_sd(min_acc, _mm_unpackhi_pd(min_acc, min_acc)));
+  double max_value = _mm_cvtsd_f64(_mm_max_sd(max_acc, _mm_unpackhi_pd(max_acc, max_acc)));
+  for (; p != end; ++p) {
+    min_value = *p < min_value ? *p : min_value;
+    max_value = *p > max_value ? *p : max_value;
+  }
+  *min_out = min_value;
+  *max_out = max_value;
+}
+
+} // namespace vk
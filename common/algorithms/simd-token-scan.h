@@ -0,0 +1,46 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include "common/algorithms/simd-escape-scan.h"
+
+namespace vk {
+
+// token spans for the memcache text protocol scanner: the parse state machine
+// used to classify these bytes one at a time, the spans cover 16 per step
+
+// leading span of key bytes: everything above ' ', high bytes included
+inline size_t simd_mc_key_span(const char *s, size_t n) {
+  return impl_::simd_clean_span(s, n, [](__m128i chunk) {
+    // bytes >= 0x80 read negative and are key bytes; dirty ones sit in [0, 0x20]
+    const __m128i dirty = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8(-1)),
+                                        _mm_cmpgt_epi8(_mm_set1_epi8(0x21), chunk));
+    return static_cast<uint32_t>(_mm_movemask_epi8(dirty));
+  });
+}
+
+// leading span of a multi-get key token: stops at space, tab, cr or lf
+inline size_t simd_mc_token_span(const char *s, size_t n) {
+  return impl_::simd_clean_span(s, n, [](__m128i chunk) {
+    __m128i dirty = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '));
+    dirty = _mm_or_si128(dirty, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+    dirty = _mm_or_si128(dirty, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')));
+    dirty = _mm_or_si128(dirty, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+    return static_cast<uint32_t>(_mm_movemask_epi8(dirty));
+  });
+}
+
+// leading span of plain line bytes: stops at any control byte except tab,
+// which covers cr and lf as well
+inline size_t simd_mc_line_span(const char *s, size_t n) {
+  return impl_::simd_clean_span(s, n, [](__m128i chunk) {
+    const __m128i ctrl = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8(-1)),
+                                       _mm_cmpgt_epi8(_mm_set1_epi8(0x20), chunk));
+    const __m128i dirty = _mm_andnot_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')), ctrl);
+    return static_cast<uint32_t>(_mm_movemask_epi8(dirty));
+  });
+}
+
+} // namespace vk
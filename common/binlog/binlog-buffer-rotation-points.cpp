@@ -4,6 +4,7 @@
 
 #include "common/binlog/binlog-buffer-rotation-points.h"
 
+#include <pthread.h>
 #include <unistd.h>
 
 #include "common/kprintf.h"
@@ -13,13 +14,74 @@
 
 DECLARE_VERBOSITY(binlog_buffers);
 
+/******************** background binlog sync ********************/
+
+/* rotated-away slices are fsynced off the event loop: syncing a large slice on
+   a busy disk otherwise stalls event processing for the duration of the sync.
+   The flusher thread only ever sees its own duplicate of the descriptor, so
+   all kfs structures stay on the engine thread and are released immediately. */
+
+#define BB_SYNC_QUEUE_SIZE 64
+
+static int bb_sync_queue[BB_SYNC_QUEUE_SIZE];
+static unsigned bb_sync_queue_head, bb_sync_queue_tail;
+static pthread_mutex_t bb_sync_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bb_sync_cond = PTHREAD_COND_INITIALIZER;
+static int bb_sync_thread_running;
+
+static void *bb_sync_thread (void *arg __attribute__((unused))) {
+  pthread_mutex_lock (&bb_sync_mutex);
+  for (;;) {
+    while (bb_sync_queue_head == bb_sync_queue_tail) {
+      pthread_cond_wait (&bb_sync_cond, &bb_sync_mutex);
+    }
+    const int fd = bb_sync_queue[bb_sync_queue_head++ & (BB_SYNC_QUEUE_SIZE - 1)];
+    pthread_mutex_unlock (&bb_sync_mutex);
+    if (fsync (fd) < 0) {
+      kprintf ("error syncing binlog: %m\n");
+    }
+    close (fd);
+    pthread_mutex_lock (&bb_sync_mutex);
+  }
+  return NULL;
+}
+
+static int bb_sync_binlog_in_background (int fd) {
+  const int dupfd = dup (fd);
+  if (dupfd < 0) {
+    return -1;
+  }
+  pthread_mutex_lock (&bb_sync_mutex);
+  if (!bb_sync_thread_running) {
+    pthread_t t;
+    if (pthread_create (&t, NULL, bb_sync_thread, NULL)) {
+      pthread_mutex_unlock (&bb_sync_mutex);
+      close (dupfd);
+      return -1;
+    }
+    pthread_detach (t);
+    bb_sync_thread_running = 1;
+  }
+  if (bb_sync_queue_tail - bb_sync_queue_head == BB_SYNC_QUEUE_SIZE) {
+    pthread_mutex_unlock (&bb_sync_mutex);
+    close (dupfd);
+    return -1; /* queue full, sync in place */
+  }
+  bb_sync_queue[bb_sync_queue_tail++ & (BB_SYNC_QUEUE_SIZE - 1)] = dupfd;
+  pthread_cond_signal (&bb_sync_cond);
+  pthread_mutex_unlock (&bb_sync_mutex);
+  return 0;
+}
+
 /******************** rotation points ********************/
 
 void bb_rotation_point_close_binlog (bb_rotation_point_t *p) {
   if (p->Binlog) {
     tvkprintf (binlog_buffers, 2, "%s: close binlog '%s'(fd=%d) from rotation point %p\n", __func__, p->Binlog->info ? p->Binlog->info->filename : "", p->Binlog->fd, p);
-    if (fsync(p->Binlog->fd) < 0) {
-      kprintf ("error syncing binlog: %m\n");
+    if (bb_sync_binlog_in_background (p->Binlog->fd) < 0) {
+      if (fsync(p->Binlog->fd) < 0) {
+        kprintf ("error syncing binlog: %m\n");
+      }
     }
     close_binlog (p->Binlog, true);
     p->Binlog = NULL;
@@ -3,7 +3,10 @@ prepend(COMMON_TESTS_SOURCES ${COMMON_DIR}/
         algorithms/contains-test.cpp
         algorithms/hashes-test.cpp
         algorithms/projections-test.cpp
+        algorithms/simd-ascii-case-test.cpp
+        algorithms/simd-escape-scan-test.cpp
         algorithms/simd-int-to-string-test.cpp
+        algorithms/simd-int64-find-test.cpp
         algorithms/string-algorithms-test.cpp
         allocators/freelist-test.cpp
         allocators/lockfree-slab-test.cpp
@@ -12,6 +15,7 @@ prepend(COMMON_TESTS_SOURCES ${COMMON_DIR}/
         parallel/counter-test.cpp
         parallel/limit-counter-test.cpp
         parallel/maximum-test.cpp
+        parallel/sharded-counter-test.cpp
         smart_iterators/smart-iterators-test.cpp
         smart_ptrs/tagged-ptr-test.cpp
         type_traits/list_of_types_test.cpp
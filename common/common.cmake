@@ -14,6 +14,7 @@ prepend(COMMON_MAIN_SOURCES ${COMMON_DIR}/
         server/main-binlog.cpp
         crypto/aes256.cpp
         crypto/aes256-generic.cpp
+        crypto/aes256-gcm.cpp
         crypto/aes256-${HOST}.cpp
 
         fast-backtrace.cpp
@@ -10,6 +10,7 @@
 #include <random>
 #include <vector>
 
+#include "common/crypto/aes256-gcm.h"
 #include "common/crypto/aes256-generic.h"
 #include "common/crypto/aes256.h"
 
@@ -134,4 +135,26 @@ static void BM_crypto_aes256_encrypt_ctr(benchmark::State& state) {
 }
 BENCHMARK(BM_crypto_aes256_encrypt_ctr)->RangeMultiplier(2)->Range(16, 16 << 20);
 
+static void BM_crypto_aes256_encrypt_gcm(benchmark::State& state) {
+  std::array<std::uint8_t, AES256_GCM_IV_BYTES> iv;
+  std::array<std::uint8_t, AES256_GCM_KEY_BYTES> key;
+  std::independent_bits_engine<std::default_random_engine, 8, std::uint8_t> engine;
+  std::generate(key.begin(), key.end(), std::ref(engine));
+  std::generate(iv.begin(), iv.end(), std::ref(engine));
+
+  const std::size_t size = state.range(0);
+  std::vector<std::uint8_t> payload(size), ciphertext(size);
+  std::generate(payload.begin(), payload.end(), std::ref(engine));
+
+  std::array<std::uint8_t, AES256_GCM_TAG_BYTES> tag;
+  for(auto _ : state) {
+    vk_aes_gcm_ctx_t ctx;
+    vk_aes_gcm_encrypt_init(&ctx, key.data(), iv.data());
+    vk_aes_gcm_crypt(&ctx, payload.data(), ciphertext.data(), payload.size());
+    vk_aes_gcm_encrypt_final(&ctx, tag.data());
+    vk_aes_gcm_ctx_cleanup(&ctx);
+  }
+}
+BENCHMARK(BM_crypto_aes256_encrypt_gcm)->RangeMultiplier(2)->Range(16, 16 << 20);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,73 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/crypto/aes256-gcm.h"
+
+#include <assert.h>
+#include <string.h>
+
+static int vk_aes_gcm_init(vk_aes_gcm_ctx_t *ctx, const uint8_t key[AES256_GCM_KEY_BYTES], const uint8_t iv[AES256_GCM_IV_BYTES], int enc) {
+  ctx->evp = EVP_CIPHER_CTX_new();
+  if (!ctx->evp) {
+    return -1;
+  }
+  if (EVP_CipherInit_ex(ctx->evp, EVP_aes_256_gcm(), NULL, NULL, NULL, enc) != 1 ||
+      EVP_CIPHER_CTX_ctrl(ctx->evp, EVP_CTRL_GCM_SET_IVLEN, AES256_GCM_IV_BYTES, NULL) != 1 ||
+      EVP_CipherInit_ex(ctx->evp, NULL, NULL, key, iv, enc) != 1) {
+    vk_aes_gcm_ctx_cleanup(ctx);
+    return -1;
+  }
+  return 0;
+}
+
+int vk_aes_gcm_encrypt_init(vk_aes_gcm_ctx_t *ctx, const uint8_t key[AES256_GCM_KEY_BYTES], const uint8_t iv[AES256_GCM_IV_BYTES]) {
+  return vk_aes_gcm_init(ctx, key, iv, 1);
+}
+
+int vk_aes_gcm_decrypt_init(vk_aes_gcm_ctx_t *ctx, const uint8_t key[AES256_GCM_KEY_BYTES], const uint8_t iv[AES256_GCM_IV_BYTES]) {
+  return vk_aes_gcm_init(ctx, key, iv, 0);
+}
+
+int vk_aes_gcm_aad(vk_aes_gcm_ctx_t *ctx, const uint8_t *aad, int size) {
+  assert(size >= 0);
+  int written;
+  return EVP_CipherUpdate(ctx->evp, NULL, &written, aad, size) == 1 ? 0 : -1;
+}
+
+int vk_aes_gcm_crypt(vk_aes_gcm_ctx_t *ctx, const uint8_t *in, uint8_t *out, int size) {
+  assert(size >= 0);
+  int written;
+  if (EVP_CipherUpdate(ctx->evp, out, &written, in, size) != 1) {
+    return -1;
+  }
+  /* GCM is a stream mode: every update produces exactly its input size */
+  assert(written == size);
+  return 0;
+}
+
+int vk_aes_gcm_encrypt_final(vk_aes_gcm_ctx_t *ctx, uint8_t tag[AES256_GCM_TAG_BYTES]) {
+  int written;
+  if (EVP_EncryptFinal_ex(ctx->evp, NULL, &written) != 1 ||
+      EVP_CIPHER_CTX_ctrl(ctx->evp, EVP_CTRL_GCM_GET_TAG, AES256_GCM_TAG_BYTES, tag) != 1) {
+    return -1;
+  }
+  return 0;
+}
+
+int vk_aes_gcm_decrypt_final(vk_aes_gcm_ctx_t *ctx, const uint8_t tag[AES256_GCM_TAG_BYTES]) {
+  uint8_t tag_copy[AES256_GCM_TAG_BYTES];
+  memcpy(tag_copy, tag, sizeof(tag_copy));
+  int written;
+  if (EVP_CIPHER_CTX_ctrl(ctx->evp, EVP_CTRL_GCM_SET_TAG, AES256_GCM_TAG_BYTES, tag_copy) != 1) {
+    return -1;
+  }
+  return EVP_DecryptFinal_ex(ctx->evp, NULL, &written) == 1 ? 0 : -1;
+}
+
+void vk_aes_gcm_ctx_cleanup(vk_aes_gcm_ctx_t *ctx) {
+  if (ctx->evp) {
+    EVP_CIPHER_CTX_free(ctx->evp);
+    ctx->evp = NULL;
+  }
+}
@@ -0,0 +1,35 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#ifndef __NET_CRYPTO_AES256_GCM_H
+#define __NET_CRYPTO_AES256_GCM_H
+
+#include <sys/cdefs.h>
+#include <stdint.h>
+
+#include <openssl/evp.h>
+
+#define AES256_GCM_KEY_BYTES 32
+#define AES256_GCM_IV_BYTES 12
+#define AES256_GCM_TAG_BYTES 16
+
+/* AEAD wrapper around the OpenSSL AES-256-GCM implementation: EVP dispatches to
+   AESNI+PCLMUL or the ARMv8 crypto extensions at runtime. Data and AAD may be
+   fed in arbitrary pieces, so a whole msg_part chain is processed in one pass
+   without linearizing it first. */
+typedef struct vk_aes_gcm_ctx {
+  EVP_CIPHER_CTX *evp;
+} vk_aes_gcm_ctx_t;
+
+/* all functions return 0 on success, -1 on failure */
+int vk_aes_gcm_encrypt_init(vk_aes_gcm_ctx_t *ctx, const uint8_t key[AES256_GCM_KEY_BYTES], const uint8_t iv[AES256_GCM_IV_BYTES]);
+int vk_aes_gcm_decrypt_init(vk_aes_gcm_ctx_t *ctx, const uint8_t key[AES256_GCM_KEY_BYTES], const uint8_t iv[AES256_GCM_IV_BYTES]);
+int vk_aes_gcm_aad(vk_aes_gcm_ctx_t *ctx, const uint8_t *aad, int size);
+int vk_aes_gcm_crypt(vk_aes_gcm_ctx_t *ctx, const uint8_t *in, uint8_t *out, int size);
+int vk_aes_gcm_encrypt_final(vk_aes_gcm_ctx_t *ctx, uint8_t tag[AES256_GCM_TAG_BYTES]);
+/* verifies the tag: -1 means the ciphertext or AAD was tampered with */
+int vk_aes_gcm_decrypt_final(vk_aes_gcm_ctx_t *ctx, const uint8_t tag[AES256_GCM_TAG_BYTES]);
+void vk_aes_gcm_ctx_cleanup(vk_aes_gcm_ctx_t *ctx);
+
+#endif
@@ -17,6 +17,7 @@
 #include <gtest/gtest.h>
 
 #include "common/crypto/aes256-aarch64.h"
+#include "common/crypto/aes256-gcm.h"
 #include "common/crypto/aes256-generic.h"
 #include "common/crypto/aes256-x86_64.h"
 
@@ -357,3 +358,76 @@ TEST(crypto_aarch64_aes256_set_decrypt_key, basic) {
 }
 
 #endif // __aarch64__
+
+using AES256_gcm_random = AESCtx<1024, AES256_GCM_IV_BYTES, AES256_GCM_KEY_BYTES>;
+TEST_F(AES256_gcm_random, random_gcm) {
+  vk_aes_gcm_ctx_t ctx;
+  ASSERT_EQ(0, vk_aes_gcm_encrypt_init(&ctx, random_key_.data(), random_iv_.data()));
+
+  std::array<std::uint8_t, aes_ctx_plaintext_bytes> ciphertext;
+  std::array<std::uint8_t, AES256_GCM_TAG_BYTES> tag;
+  ASSERT_EQ(0, vk_aes_gcm_crypt(&ctx, random_payload_.data(), ciphertext.data(), aes_ctx_plaintext_bytes));
+  ASSERT_EQ(0, vk_aes_gcm_encrypt_final(&ctx, tag.data()));
+  vk_aes_gcm_ctx_cleanup(&ctx);
+
+  std::array<std::uint8_t, aes_ctx_plaintext_bytes> plaintext;
+  ASSERT_EQ(0, vk_aes_gcm_decrypt_init(&ctx, random_key_.data(), random_iv_.data()));
+  ASSERT_EQ(0, vk_aes_gcm_crypt(&ctx, ciphertext.data(), plaintext.data(), aes_ctx_plaintext_bytes));
+  EXPECT_EQ(0, vk_aes_gcm_decrypt_final(&ctx, tag.data()));
+  vk_aes_gcm_ctx_cleanup(&ctx);
+
+  EXPECT_EQ(plaintext, random_payload_);
+}
+
+TEST_F(AES256_gcm_random, chunked_matches_one_shot) {
+  vk_aes_gcm_ctx_t ctx;
+  std::array<std::uint8_t, aes_ctx_plaintext_bytes> one_shot;
+  std::array<std::uint8_t, AES256_GCM_TAG_BYTES> one_shot_tag;
+  ASSERT_EQ(0, vk_aes_gcm_encrypt_init(&ctx, random_key_.data(), random_iv_.data()));
+  ASSERT_EQ(0, vk_aes_gcm_crypt(&ctx, random_payload_.data(), one_shot.data(), aes_ctx_plaintext_bytes));
+  ASSERT_EQ(0, vk_aes_gcm_encrypt_final(&ctx, one_shot_tag.data()));
+  vk_aes_gcm_ctx_cleanup(&ctx);
+
+  // feed the same payload in uneven pieces, the way a msg_part chain would
+  std::array<std::uint8_t, aes_ctx_plaintext_bytes> chunked;
+  std::array<std::uint8_t, AES256_GCM_TAG_BYTES> chunked_tag;
+  ASSERT_EQ(0, vk_aes_gcm_encrypt_init(&ctx, random_key_.data(), random_iv_.data()));
+  std::size_t offset = 0;
+  for (std::size_t chunk = 1; offset < aes_ctx_plaintext_bytes; chunk = chunk * 2 + 3) {
+    const std::size_t size = std::min(chunk, aes_ctx_plaintext_bytes - offset);
+    ASSERT_EQ(0, vk_aes_gcm_crypt(&ctx, random_payload_.data() + offset, chunked.data() + offset, size));
+    offset += size;
+  }
+  ASSERT_EQ(0, vk_aes_gcm_encrypt_final(&ctx, chunked_tag.data()));
+  vk_aes_gcm_ctx_cleanup(&ctx);
+
+  EXPECT_EQ(one_shot, chunked);
+  EXPECT_EQ(one_shot_tag, chunked_tag);
+}
+
+TEST_F(AES256_gcm_random, tampering_is_detected) {
+  vk_aes_gcm_ctx_t ctx;
+  const std::array<std::uint8_t, 12> aad = {{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}};
+  std::array<std::uint8_t, aes_ctx_plaintext_bytes> ciphertext;
+  std::array<std::uint8_t, AES256_GCM_TAG_BYTES> tag;
+  ASSERT_EQ(0, vk_aes_gcm_encrypt_init(&ctx, random_key_.data(), random_iv_.data()));
+  ASSERT_EQ(0, vk_aes_gcm_aad(&ctx, aad.data(), aad.size()));
+  ASSERT_EQ(0, vk_aes_gcm_crypt(&ctx, random_payload_.data(), ciphertext.data(), aes_ctx_plaintext_bytes));
+  ASSERT_EQ(0, vk_aes_gcm_encrypt_final(&ctx, tag.data()));
+  vk_aes_gcm_ctx_cleanup(&ctx);
+
+  std::array<std::uint8_t, aes_ctx_plaintext_bytes> plaintext;
+  ciphertext[100] ^= 1;
+  ASSERT_EQ(0, vk_aes_gcm_decrypt_init(&ctx, random_key_.data(), random_iv_.data()));
+  ASSERT_EQ(0, vk_aes_gcm_aad(&ctx, aad.data(), aad.size()));
+  ASSERT_EQ(0, vk_aes_gcm_crypt(&ctx, ciphertext.data(), plaintext.data(), aes_ctx_plaintext_bytes));
+  EXPECT_EQ(-1, vk_aes_gcm_decrypt_final(&ctx, tag.data()));
+  vk_aes_gcm_ctx_cleanup(&ctx);
+
+  ciphertext[100] ^= 1;
+  ASSERT_EQ(0, vk_aes_gcm_decrypt_init(&ctx, random_key_.data(), random_iv_.data()));
+  // AAD mismatch must invalidate the tag even with intact ciphertext
+  ASSERT_EQ(0, vk_aes_gcm_crypt(&ctx, ciphertext.data(), plaintext.data(), aes_ctx_plaintext_bytes));
+  EXPECT_EQ(-1, vk_aes_gcm_decrypt_final(&ctx, tag.data()));
+  vk_aes_gcm_ctx_cleanup(&ctx);
+}
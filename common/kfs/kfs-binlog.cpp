@@ -92,6 +92,10 @@ kfs_file_handle_t open_binlog(const kfs_replica_t *R, long long log_pos) {
       //kprintf ("FI->file_size:%lld, FI->flags: %d, FI->kfs_headers:%d, file:%s, file_pos: %lld, log_pos: %lld\n", FI->file_size, FI->flags, FI->kfs_headers, FI->filename, file_pos, log_pos);
       assert (lseek(fd, file_pos, SEEK_SET) == file_pos);
 
+      /* the tail of the binlog is replayed sequentially right after this */
+      posix_fadvise(fd, file_pos, 0, POSIX_FADV_SEQUENTIAL);
+      posix_fadvise(fd, file_pos, 0, POSIX_FADV_WILLNEED);
+
       auto F = static_cast<kfs_file *>(calloc(1, sizeof(struct kfs_file)));
       assert (F);
       F->info = FI;
@@ -165,6 +169,8 @@ kfs_file_handle_t next_binlog(kfs_file_handle_t F) {
       return 0;
     }
   }
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
   F = static_cast<kfs_file_handle_t>(malloc(sizeof(struct kfs_file)));
   assert (F);
   memset(F, 0, sizeof(*F));
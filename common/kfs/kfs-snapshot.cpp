@@ -7,6 +7,7 @@
 #include <assert.h>
 #include <fcntl.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include "common/kprintf.h"
@@ -51,6 +52,10 @@ kfs_file_handle_t open_snapshot(kfs_replica_handle_t r, int snapshot_index) {
     return 0;
   }
 
+  /* the snapshot is consumed strictly sequentially at startup: let the kernel read ahead aggressively */
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+
   auto f = static_cast<kfs_file *>(malloc(sizeof(struct kfs_file)));
   assert (f);
   memset(f, 0, sizeof(*f));
@@ -112,6 +117,34 @@ int close_snapshot(kfs_file_handle_t f, bool close_handle) {
   return kfs_close_file(f, close_handle);
 }
 
+void *kfs_snapshot_mmap(kfs_file_handle_t F, long long *size) {
+  if (!F || !F->info || F->info->file_size < 0) {
+    return NULL;
+  }
+  if ((F->info->flags & KFS_FILE_ZIPPED) || F->info->iv) {
+    return NULL; /* the bytes on disk are not the plain data */
+  }
+  const long long data_size = F->info->file_size - F->offset;
+  if (data_size <= 0) {
+    return NULL;
+  }
+  /* kfs headers are 4KB each, so F->offset is page aligned */
+  void *data = mmap(NULL, data_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, F->fd, F->offset);
+  if (data == MAP_FAILED) {
+    vkprintf(1, "cannot mmap snapshot file %s: %m\n", F->info->filename);
+    return NULL;
+  }
+  madvise(data, data_size, MADV_SEQUENTIAL);
+  *size = data_size;
+  return data;
+}
+
+void kfs_snapshot_munmap(void *data, long long size) {
+  if (data) {
+    assert(!munmap(data, size));
+  }
+}
+
 void init_engine_snapshot_descr(struct engine_snapshot_descr *_descr, kfs_file_handle_t _snapshot) {
   if (_snapshot) {
     _descr->name = strdup(_snapshot->info->filename);
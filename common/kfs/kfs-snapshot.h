@@ -21,5 +21,15 @@ kfs_file_handle_t open_snapshot(kfs_replica_handle_t R, int snapshot_index);  //
 kfs_file_handle_t open_recent_snapshot(kfs_replica_handle_t Replica);  // file position is after kfs headers
 kfs_file_handle_t open_main_snapshot(kfs_file_handle_t snapshot_diff);
 int close_snapshot(kfs_file_handle_t F, bool close_handle);
+
+/* maps the snapshot payload (everything after the kfs headers) into memory, so
+   loaders can parse a multi-gigabyte image in place instead of copying it into
+   heap buffers. The mapping is private and writable: small regions (e.g. an
+   offset table) may be patched copy-on-write without touching the file.
+   Returns NULL for encrypted or zipped snapshots, where the bytes on disk are
+   not the plain data, and on any mmap failure; callers must keep a read path
+   as a fallback. Does not move the file position of F. */
+void *kfs_snapshot_mmap(kfs_file_handle_t F, long long *size);
+void kfs_snapshot_munmap(void *data, long long size);
 void init_engine_snapshot_descr(struct engine_snapshot_descr *_descr, kfs_file_handle_t _snapshot);
 #endif // ENGINE_KFS_SNAPSHOT_H
@@ -592,6 +592,16 @@ int kfs_bz_decode(const struct kfs_file *F, long long off, void *dst, int *dest_
     }
     vkprintf(2, "read %lld bytes from the file '%s', chunk: %d.\n", (long long)r, FI->filename, chunk_no);
 
+    if (chunk_no + 1 < chunks) {
+      /* ask the kernel to read the next compressed chunk while this one is being decoded */
+      const long long next_chunk_size = (chunk_no + 2 < chunks
+                                         ? H->chunk_offset[chunk_no + 2]
+                                         : FI->file_size - sizeof(struct kfs_file_header) * FI->kfs_headers) - H->chunk_offset[chunk_no + 1];
+      if (next_chunk_size > 0 && next_chunk_size <= KFS_BINLOG_ZIP_MAX_ENCODED_CHUNK_SIZE) {
+        posix_fadvise(fd, H->chunk_offset[chunk_no + 1] + F->offset, next_chunk_size, POSIX_FADV_WILLNEED);
+      }
+    }
+
     int m = expected_output_bytes;
     switch (H->format & 15) {
       case kfs_bzf_zlib: {
@@ -604,6 +614,21 @@ int kfs_bz_decode(const struct kfs_file *F, long long off, void *dst, int *dest_
         m = (int)destLen;
         break;
       }
+      case kfs_bzf_zstd: {
+        static __thread ZSTD_DCtx *dctx;
+        if (dctx == NULL) {
+          dctx = ZSTD_createDCtx();
+          assert (dctx);
+        }
+        size_t res = ZSTD_decompressDCtx(dctx, dst, m, src, chunk_size);
+        if (ZSTD_isError(res)) {
+          kprintf("ZSTD_decompress returns error '%s', chunk %d, offset %lld, file '%s'.\n",
+                  ZSTD_getErrorName(res), chunk_no, chunk_offset, FI->filename);
+          return -1;
+        }
+        m = (int)res;
+        break;
+      }
       default:
         kprintf("Unimplemented format '%d' in the file '%s'.\n", H->format & 15, FI->filename);
         return -1;
@@ -0,0 +1,65 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/parallel/sharded-counter.h"
+
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+
+TEST(parallel_sharded_counter, basic) {
+  PARALLEL_SHARDED_COUNTER(counter);
+  const int nr_threads = 8;
+  auto random_engine = std::default_random_engine();
+  std::uniform_int_distribution<int> distribution(0, 100000);
+
+  std::vector<std::thread> threads(nr_threads);
+
+  std::uint64_t expected_sum = 0;
+  for (auto &thread : threads) {
+    const int counter = distribution(random_engine);
+    expected_sum += counter;
+
+    // no per-thread registration: the counter must be usable from threads
+    // the parallel library has never heard of
+    thread = std::thread([=]() {
+      for (std::uint64_t i = 0; i < counter; ++i) {
+        PARALLEL_SHARDED_COUNTER_INC(counter);
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(expected_sum, PARALLEL_SHARDED_COUNTER_READ(counter));
+}
+
+TEST(parallel_sharded_counter, inc_and_dec) {
+  PARALLEL_SHARDED_COUNTER(counter);
+
+  EXPECT_EQ(0, PARALLEL_SHARDED_COUNTER_READ(counter));
+  PARALLEL_SHARDED_COUNTER_INC(counter);
+  EXPECT_EQ(1, PARALLEL_SHARDED_COUNTER_READ(counter));
+  PARALLEL_SHARDED_COUNTER_DEC(counter);
+  EXPECT_EQ(0, PARALLEL_SHARDED_COUNTER_READ(counter));
+}
+
+TEST(parallel_sharded_counter, add_and_sub) {
+  PARALLEL_SHARDED_COUNTER(counter);
+
+  PARALLEL_SHARDED_COUNTER_ADD(counter, 100500);
+  PARALLEL_SHARDED_COUNTER_SUB(counter, 100000);
+  EXPECT_EQ(500, PARALLEL_SHARDED_COUNTER_READ(counter));
+}
+
+TEST(parallel_sharded_counter, shards_are_cacheline_aligned) {
+  EXPECT_EQ(0, sizeof(parallel_sharded_counter_shard_t) % KDB_CACHELINE_SIZE);
+  EXPECT_EQ(KDB_CACHELINE_SIZE * NR_NUMA_SHARDS, sizeof(parallel_sharded_counter_t));
+}
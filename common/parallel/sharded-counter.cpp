@@ -0,0 +1,30 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/parallel/sharded-counter.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+__thread uint32_t parallel_sharded_counter_cached_shard = (uint32_t)-1;
+
+uint32_t parallel_sharded_counter_resolve_shard() {
+  unsigned cpu = 0;
+  unsigned node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) {
+    node = 0;
+  }
+  // threads rarely migrate between nodes and a stale shard only skews the
+  // balance, never the total, so the node is resolved once per thread
+  parallel_sharded_counter_cached_shard = node % NR_NUMA_SHARDS;
+  return parallel_sharded_counter_cached_shard;
+}
+
+uint64_t parallel_sharded_counter_read(const parallel_sharded_counter_t *counter) {
+  uint64_t sum = 0;
+  for (int i = 0; i < NR_NUMA_SHARDS; ++i) {
+    sum += __atomic_load_n(&counter->shards[i].counter, __ATOMIC_RELAXED);
+  }
+  return sum;
+}
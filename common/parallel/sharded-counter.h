@@ -0,0 +1,75 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#ifndef KDB_COMMON_PARALLEL_SHARDED_COUNTER_H
+#define KDB_COMMON_PARALLEL_SHARDED_COUNTER_H
+
+#include <sys/cdefs.h>
+
+#include <stdint.h>
+
+#include "common/cacheline.h"
+
+// A statistics counter sharded over NUMA nodes instead of threads.
+//
+// Unlike parallel_counter it needs no per-thread register/unregister, so it is
+// safe to bump from short-lived or external threads; the price is one relaxed
+// atomic add into the cache line owned by the caller's node. Reads gather all
+// shards, so a single shard may transiently wrap below zero while the total
+// stays exact — same as parallel_counter before a thread folds its tls in.
+
+#define NR_NUMA_SHARDS 8
+
+struct parallel_sharded_counter_shard {
+  uint64_t counter;
+} KDB_CACHELINE_ALIGNED;
+typedef struct parallel_sharded_counter_shard parallel_sharded_counter_shard_t;
+
+struct parallel_sharded_counter {
+  parallel_sharded_counter_shard_t shards[NR_NUMA_SHARDS];
+};
+typedef struct parallel_sharded_counter parallel_sharded_counter_t;
+
+extern __thread uint32_t parallel_sharded_counter_cached_shard;
+
+uint32_t parallel_sharded_counter_resolve_shard();
+
+static inline uint32_t parallel_sharded_counter_shard_id() {
+  if (__builtin_expect(parallel_sharded_counter_cached_shard == (uint32_t)-1, 0)) {
+    return parallel_sharded_counter_resolve_shard();
+  }
+  return parallel_sharded_counter_cached_shard;
+}
+
+static inline void parallel_sharded_counter_add(parallel_sharded_counter_t *counter, uint64_t value) {
+  __atomic_fetch_add(&counter->shards[parallel_sharded_counter_shard_id()].counter, value, __ATOMIC_RELAXED);
+}
+
+static inline void parallel_sharded_counter_sub(parallel_sharded_counter_t *counter, uint64_t value) {
+  __atomic_fetch_sub(&counter->shards[parallel_sharded_counter_shard_id()].counter, value, __ATOMIC_RELAXED);
+}
+
+static inline void parallel_sharded_counter_inc(parallel_sharded_counter_t *counter) {
+  parallel_sharded_counter_add(counter, 1);
+}
+
+static inline void parallel_sharded_counter_dec(parallel_sharded_counter_t *counter) {
+  parallel_sharded_counter_sub(counter, 1);
+}
+
+uint64_t parallel_sharded_counter_read(const parallel_sharded_counter_t *counter);
+
+#define PARALLEL_SHARDED_COUNTER(name) static parallel_sharded_counter_t parallel_sharded_counter_##name;
+
+#define PARALLEL_SHARDED_COUNTER_EXTERN(name) parallel_sharded_counter_t parallel_sharded_counter_##name;
+
+#define DECLARE_PARALLEL_SHARDED_COUNTER(name) extern parallel_sharded_counter_t parallel_sharded_counter_##name;
+
+#define PARALLEL_SHARDED_COUNTER_INC(name) parallel_sharded_counter_inc(&parallel_sharded_counter_##name)
+#define PARALLEL_SHARDED_COUNTER_DEC(name) parallel_sharded_counter_dec(&parallel_sharded_counter_##name)
+#define PARALLEL_SHARDED_COUNTER_ADD(name, value) parallel_sharded_counter_add(&parallel_sharded_counter_##name, value)
+#define PARALLEL_SHARDED_COUNTER_SUB(name, value) parallel_sharded_counter_sub(&parallel_sharded_counter_##name, value)
+#define PARALLEL_SHARDED_COUNTER_READ(name) parallel_sharded_counter_read(&parallel_sharded_counter_##name)
+
+#endif // KDB_COMMON_PARALLEL_SHARDED_COUNTER_H
@@ -9,6 +9,11 @@
 #include <limits>
 #include <type_traits>
 
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+#include "common/crc32c.h"
 #include "common/sanitizer.h"
 
 constexpr int STRLEN_WARNING_FLAG = 1 << 30;
@@ -71,22 +76,39 @@ private:
 inline int64_t string_hash(const char *p, size_t l) __attribute__ ((always_inline)) ubsan_supp("alignment");
 
 int64_t string_hash(const char *p, size_t l) {
-  constexpr uint64_t HASH_MUL = 1915239017;
-  uint64_t hash = 2147483648U;
-
-  size_t prev = (l & 3);
-  for (size_t i = 0; i < prev; i++) {
-    hash = hash * HASH_MUL + p[i];
+  // the standard CRC32C of the string; its value doesn't depend on the host cpu or implementation,
+  // so the hashes precomputed by the compiler for literal keys always match the ones computed
+  // at runtime, and collisions are harmless anyway: array lookups compare the keys after the hash
+#ifdef __SSE4_2__
+  // x86_64 builds target nehalem and up (see cmake/init-compilation-flags.cmake), so the crc32
+  // instruction can be used unconditionally and inlined right here
+  uint64_t hash = 0xffffffffu;
+  for (; l >= 8; l -= 8, p += 8) {
+    uint64_t chunk;
+    memcpy(&chunk, p, sizeof(chunk));
+    hash = _mm_crc32_u64(hash, chunk);
   }
-
-  const auto *p_uint = reinterpret_cast<const uint32_t *>(p + prev);
-  l >>= 2;
-  while (l-- > 0) {
-    hash = hash * HASH_MUL + *p_uint++;
+  auto hash32 = static_cast<uint32_t>(hash);
+  if (l & 4) {
+    uint32_t chunk;
+    memcpy(&chunk, p, sizeof(chunk));
+    hash32 = _mm_crc32_u32(hash32, chunk);
+    p += 4;
+  }
+  if (l & 2) {
+    uint16_t chunk;
+    memcpy(&chunk, p, sizeof(chunk));
+    hash32 = _mm_crc32_u16(hash32, chunk);
+    p += 2;
+  }
+  if (l & 1) {
+    hash32 = _mm_crc32_u8(hash32, static_cast<uint8_t>(*p));
   }
-  const auto result = static_cast<int64_t>(hash);
-  // to ensure that there is no way to get the -9223372036854775808L during code generation
-  return (result != std::numeric_limits<int64_t>::min()) * result;
+  return static_cast<int64_t>(hash32 ^ 0xffffffffu);
+#else
+  // other platforms go through the cpuid-dispatched crc32c_partial (aarch64 hw / table-driven sw)
+  return static_cast<int64_t>(compute_crc32c(p, static_cast<int>(l)));
+#endif
 }
 
 
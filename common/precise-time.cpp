@@ -73,6 +73,40 @@ double get_double_time() {
   return get_cached_time(get_time, 1e6);
 }
 
+double get_interpolated_double_time() {
+  // one real clock read per window; in between the elapsed cycles are converted with
+  // the rate measured over the previous window, so unlike get_cached_time the result
+  // keeps moving between reads instead of being stale for the whole window
+  constexpr uint64_t recalibration_window_cycles = 1u << 24; // ~5ms at 3GHz
+  thread_local static double base_time;
+  thread_local static uint64_t base_cycleclock;
+  thread_local static double seconds_per_cycle;
+
+  const uint64_t cycleclock = cycleclock_now();
+  const uint64_t elapsed_cycles = cycleclock - base_cycleclock;
+  if (likely(seconds_per_cycle > 0 && elapsed_cycles < recalibration_window_cycles)) {
+    return base_time + static_cast<double>(elapsed_cycles) * seconds_per_cycle;
+  }
+
+  struct timespec tp;
+  if (clock_gettime(CLOCK_REALTIME, &tp)) {
+    return base_time;
+  }
+  const double real_time = tp.tv_sec + (1e-9) * tp.tv_nsec;
+  // the rate is only trusted when measured over a full window: until then (the first
+  // few ms of a thread, or after a wall-clock step backwards resets it) every call
+  // simply reads the real clock while the anchor point stays put
+  if (base_cycleclock == 0) {
+    base_time = real_time;
+    base_cycleclock = cycleclock;
+  } else if (elapsed_cycles >= recalibration_window_cycles) {
+    seconds_per_cycle = real_time > base_time ? (real_time - base_time) / static_cast<double>(elapsed_cycles) : 0;
+    base_time = real_time;
+    base_cycleclock = cycleclock;
+  }
+  return real_time;
+}
+
 double get_network_time() {
   auto get_time = [](double last_cached_time) {
     struct timespec tp;
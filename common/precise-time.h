@@ -25,6 +25,12 @@ long long get_precise_time (unsigned precision);
 /* ??? */
 double get_double_time ();
 
+// wall-clock seconds interpolated from rdtsc deltas: the real clock is read and the
+// cycle rate recalibrated only once per few milliseconds, every call in between is a
+// cycle counter read and one fma; precision is within microseconds of CLOCK_REALTIME,
+// callers that time intervals should opt out and use get_utime/get_utime_monotonic
+double get_interpolated_double_time ();
+
 double get_network_time();
 
 int get_uptime();
@@ -17,6 +17,7 @@
 
 #include "common/kprintf.h"
 #include "common/options.h"
+#include "common/precise-time.h"
 
 #define	HOSTS_FILE	"/etc/hosts"
 #define	MAX_HOSTS_SIZE	(1L << 24)
@@ -333,6 +334,149 @@ int kdb_load_hosts () {
   return 1;
 }
 
+/* in-process DNS cache: every name that fell through to libc resolution is
+   remembered here. Expired entries keep being served while a refresh is in
+   flight (stale-while-revalidate), failures are remembered for a few seconds,
+   so only the very first lookup of a name can block. */
+
+#define DNS_CACHE_HASH_SIZE 1021
+#define DNS_CACHE_DEFAULT_TTL 60
+#define DNS_CACHE_MIN_TTL 5
+#define DNS_CACHE_MAX_TTL 3600
+#define DNS_CACHE_NEGATIVE_TTL 5
+#define DNS_CACHE_REFRESH_TIMEOUT 2
+
+int (*kdb_dns_cache_refresh_hook) (const char *name, int len);
+
+struct dns_cache_entry {
+  struct dns_cache_entry *hnext;
+  unsigned ip;            /* network byte order, 0 = negative entry */
+  double expires_at;
+  double refresh_started; /* non-zero while a refresh attempt is outstanding */
+  char len;
+  char name[];
+};
+
+static struct dns_cache_entry *dns_cache_htable[DNS_CACHE_HASH_SIZE];
+
+static int dns_cache_disabled;
+FLAG_OPTION_PARSER(OPT_NETWORK, "disable-dns-cache", dns_cache_disabled, "resolve host names with blocking libc calls only, without the in-process DNS cache");
+
+static struct dns_cache_entry *dns_cache_lookup (const char *name, int len, int create) {
+  int i, h = 0;
+
+  assert ((unsigned)len < 128);
+
+  for (i = 0; i < len; i++) {
+    h = (h * 17 + name[i]) % DNS_CACHE_HASH_SIZE;
+  }
+  struct dns_cache_entry *e;
+  for (e = dns_cache_htable[h]; e; e = e->hnext) {
+    if (e->len == len && !memcmp (e->name, name, len)) {
+      return e;
+    }
+  }
+  if (!create) {
+    return 0;
+  }
+  e = reinterpret_cast<dns_cache_entry *>(malloc (sizeof (struct dns_cache_entry) + len + 1));
+  assert (e);
+  e->ip = 0;
+  e->expires_at = 0;
+  e->refresh_started = 0;
+  e->len = len;
+  memcpy (e->name, name, len);
+  e->name[len] = 0;
+  e->hnext = dns_cache_htable[h];
+  return dns_cache_htable[h] = e;
+}
+
+void kdb_dns_cache_store (const char *name, int len, unsigned ip, int ttl) {
+  if ((unsigned)len >= 128) {
+    return;
+  }
+  if (!ip) {
+    ttl = DNS_CACHE_NEGATIVE_TTL;
+  } else if (ttl < DNS_CACHE_MIN_TTL) {
+    ttl = DNS_CACHE_MIN_TTL;
+  } else if (ttl > DNS_CACHE_MAX_TTL) {
+    ttl = DNS_CACHE_MAX_TTL;
+  }
+  struct dns_cache_entry *e = dns_cache_lookup (name, len, 1);
+  e->ip = ip;
+  e->expires_at = get_utime_monotonic () + ttl;
+  e->refresh_started = 0;
+  vkprintf (3, "dns cache: %.*s -> %u.%u.%u.%u, ttl %d\n", len, name, ip & 0xff, (ip >> 8) & 0xff, (ip >> 16) & 0xff, ip >> 24, ttl);
+}
+
+static void dns_cache_refresh_blocking (struct dns_cache_entry *e) {
+  struct hostent *h = gethostbyname (e->name);
+  if (h && h->h_addrtype == AF_INET && h->h_length == 4 && h->h_addr) {
+    unsigned ip;
+    memcpy (&ip, h->h_addr, 4);
+    kdb_dns_cache_store (e->name, e->len, ip, DNS_CACHE_DEFAULT_TTL);
+  } else {
+    kdb_dns_cache_store (e->name, e->len, 0, DNS_CACHE_NEGATIVE_TTL);
+  }
+}
+
+static struct hostent *dns_cache_to_hostent (struct dns_cache_entry *e, const char *name) {
+  if (!e->ip) {
+    return 0;
+  }
+
+  static unsigned ipaddr;
+  static char *h_array[] = {(char *)&ipaddr, 0};
+  static hostent hret = {
+    .h_name = nullptr,
+    .h_aliases = nullptr,
+    .h_addrtype = AF_INET,
+    .h_length = 4,
+    .h_addr_list = h_array
+  };
+
+  hret.h_name = (char *)name;
+  ipaddr = e->ip;
+  return &hret;
+}
+
+static struct hostent *cached_gethostbyname (const char *name, int len) {
+  if (dns_cache_disabled || (unsigned)len >= 128) {
+    return gethostbyname (name) ?: gethostbyname2 (name, AF_INET6);
+  }
+
+  struct dns_cache_entry *e = dns_cache_lookup (name, len, 0);
+  if (e) {
+    double now = get_utime_monotonic ();
+    if (now >= e->expires_at && (!e->refresh_started || now - e->refresh_started > DNS_CACHE_REFRESH_TIMEOUT)) {
+      e->refresh_started = now;
+      if (!kdb_dns_cache_refresh_hook) {
+        dns_cache_refresh_blocking (e);
+      } else if (kdb_dns_cache_refresh_hook (e->name, e->len) < 0) {
+        /* could not start a refresh: keep serving the stale entry, retry after the timeout window */
+        vkprintf (2, "dns cache: failed to start refresh of %s\n", e->name);
+      }
+    }
+    return dns_cache_to_hostent (e, name);
+  }
+
+  /* first sighting of this name: a single blocking lookup, the result goes into the cache */
+  struct hostent *h = gethostbyname (name);
+  if (h && h->h_addrtype == AF_INET && h->h_length == 4 && h->h_addr) {
+    unsigned ip;
+    memcpy (&ip, h->h_addr, 4);
+    kdb_dns_cache_store (name, len, ip, DNS_CACHE_DEFAULT_TTL);
+    return h;
+  }
+  if (!h) {
+    h = gethostbyname2 (name, AF_INET6);
+    if (!h) {
+      kdb_dns_cache_store (name, len, 0, DNS_CACHE_NEGATIVE_TTL);
+    }
+  }
+  return h; /* IPv6 answers are not cached */
+}
+
 struct hostent *kdb_gethostbyname (const char *name) {
   if (!kdb_hosts_loaded) {
     kdb_load_hosts ();
@@ -356,18 +500,18 @@ struct hostent *kdb_gethostbyname (const char *name) {
 
 
   if (kdb_hosts_loaded <= 0) {
-    return gethostbyname (name) ?: gethostbyname2 (name, AF_INET6);
+    return cached_gethostbyname (name, len);
   }
 
   if (len >= 128) {
-    return gethostbyname (name) ?: gethostbyname2 (name, AF_INET6);
+    return cached_gethostbyname (name, len);
   }
 
   struct host *res = getHash (&Hosts, name, len, 0);
 
   if (!res) {
     if (strchr (name, '.') || strchr (name, ':')) {
-      return gethostbyname (name) ?: gethostbyname2 (name, AF_INET6);
+      return cached_gethostbyname (name, len);
     } else {
       return 0;
     }
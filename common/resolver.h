@@ -13,4 +13,19 @@ int kdb_load_hosts ();
 struct hostent *kdb_gethostbyname (const char *name);
 const char *kdb_gethostname();
 
+/* in-process DNS cache behind kdb_gethostbyname: entries are served even after
+   their TTL expired while a refresh is in flight (stale-while-revalidate), and
+   resolution failures are cached for a few seconds, so a resolver hiccup never
+   stalls the event loop once a name has been seen.
+
+   The refresh hook is installed by net/net-resolver.cpp in binaries linked with
+   the net library; it starts an asynchronous refresh and returns 0, or returns
+   a negative value to make the caller keep serving the stale entry and retry
+   later. Without a hook stale entries are refreshed with a blocking lookup. */
+extern int (*kdb_dns_cache_refresh_hook) (const char *name, int len);
+
+/* stores an (asynchronously) resolved address: ip is in network byte order,
+   0 means a negative entry; ttl is clamped to sane bounds */
+void kdb_dns_cache_store (const char *name, int len, unsigned ip, int ttl);
+
 #endif
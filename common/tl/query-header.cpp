@@ -25,6 +25,57 @@ static long long rpc_queries_received;
 static long long rpc_answers_received;
 static long long rpc_answers_error;
 
+// Traffic concentrates on a handful of rpcInvokeReq header shapes: the bytes between
+// qid and the function magic repeat exactly, with only actor_id varying per query.
+// Cache the raw shape together with its parsed form, and on a byte-level match copy
+// the preparsed header and patch qid/actor_id instead of re-walking the fields.
+static constexpr int QUERY_HEADER_SHAPE_MAX_LEN = 64;
+static constexpr int QUERY_HEADER_SHAPE_CACHE_SIZE = 8;
+
+struct tl_query_header_shape_t {
+  int len{-1};                            /* bytes of header extra after qid, -1 = free entry */
+  int actor_offset{-1};                   /* offset of actor_id inside the shape, -1 = no actor */
+  char bytes[QUERY_HEADER_SHAPE_MAX_LEN]; /* raw shape with the actor_id field zeroed out */
+  tl_query_header_t header;               /* parsed template, qid and actor_id are patched on hit */
+};
+
+static tl_query_header_shape_t query_header_shape_cache[QUERY_HEADER_SHAPE_CACHE_SIZE];
+static int query_header_shape_victim;
+
+static bool query_header_shape_bytes_equal(const tl_query_header_shape_t *shape, const char *bytes, int len) {
+  if (shape->len != len) {
+    return false;
+  }
+  if (shape->actor_offset < 0) {
+    return !memcmp(shape->bytes, bytes, len);
+  }
+  return !memcmp(shape->bytes, bytes, shape->actor_offset)
+         && !memcmp(shape->bytes + shape->actor_offset + 8, bytes + shape->actor_offset + 8, len - shape->actor_offset - 8);
+}
+
+static bool query_header_shape_matches(const tl_query_header_shape_t *shape, const char *bytes, int avail) {
+  if (shape->len < 0 || shape->len > avail || !query_header_shape_bytes_equal(shape, bytes, shape->len)) {
+    return false;
+  }
+  /* the shape is only complete if it is not followed by yet another header op */
+  if (tl_fetch_unread() == shape->len) {
+    return true;
+  }
+  if (shape->len + 4 > avail) {
+    return false;
+  }
+  uint32_t next;
+  memcpy(&next, bytes + shape->len, 4);
+  return next != TL_RPC_DEST_ACTOR && next != TL_RPC_DEST_ACTOR_FLAGS && next != TL_RPC_DEST_FLAGS;
+}
+
+static bool query_header_shape_cacheable(const tl_query_header_t *header) {
+  namespace flag = vk::tl::common::rpc_invoke_req_extra_flags;
+  /* these payloads vary from query to query, caching them would only thrash the byte compare */
+  return !(header->flags & (flag::wait_binlog_pos | flag::string_forward_keys | flag::int_forward_keys
+                            | flag::string_forward | flag::int_forward | flag::random_delay));
+}
+
 
 static int tl_fetch_query_flags(tl_query_header_t *header) {
   namespace flag = vk::tl::common::rpc_invoke_req_extra_flags;
@@ -102,13 +153,37 @@ bool tl_fetch_query_header(tl_query_header_t *header) {
   assert (header);
   if (vk::tl::fetch_magic(TL_RPC_INVOKE_REQ)) {
     header->qid = tl_fetch_long();
+
+    char lookahead[QUERY_HEADER_SHAPE_MAX_LEN];
+    int avail = tl_fetch_unread() < QUERY_HEADER_SHAPE_MAX_LEN ? (int)tl_fetch_unread() : QUERY_HEADER_SHAPE_MAX_LEN;
+    if (!tl_fetch_error() && avail >= 4) {
+      tl_fetch_lookup_data(lookahead, avail);
+      for (const auto &shape : query_header_shape_cache) {
+        if (query_header_shape_matches(&shape, lookahead, avail)) {
+          long long qid = header->qid;
+          *header = shape.header;
+          header->qid = qid;
+          if (shape.actor_offset >= 0) {
+            memcpy(&header->actor_id, lookahead + shape.actor_offset, 8);
+          }
+          tl_fetch_raw_data(lookahead, shape.len); /* skip the already verified shape in one go */
+          rpc_queries_received++;
+          return true;
+        }
+      }
+    }
+
+    const int64_t extra_start = tl_bytes_fetched();
+    int actor_offset = -1;
     while (!tl_fetch_error() && tl_fetch_unread()) {
       uint32_t op = tl_fetch_lookup_int();
       if (op == TL_RPC_DEST_ACTOR) {
         assert (tl_fetch_int() == (int)TL_RPC_DEST_ACTOR);
+        actor_offset = (int)(tl_bytes_fetched() - extra_start);
         header->actor_id = tl_fetch_long();
       } else if (op == TL_RPC_DEST_ACTOR_FLAGS) {
         assert (tl_fetch_int() == (int)TL_RPC_DEST_ACTOR_FLAGS);
+        actor_offset = (int)(tl_bytes_fetched() - extra_start);
         header->actor_id = tl_fetch_long();
         tl_fetch_query_flags(header);
       } else if (op == TL_RPC_DEST_FLAGS) {
@@ -118,6 +193,27 @@ bool tl_fetch_query_header(tl_query_header_t *header) {
         break;
       }
     }
+
+    const int consumed = (int)(tl_bytes_fetched() - extra_start);
+    if (!tl_fetch_error() && consumed > 0 && consumed <= avail && query_header_shape_cacheable(header)) {
+      bool known = false;
+      for (const auto &shape : query_header_shape_cache) {
+        known = known || query_header_shape_bytes_equal(&shape, lookahead, consumed);
+      }
+      if (!known) {
+        tl_query_header_shape_t *shape = &query_header_shape_cache[query_header_shape_victim];
+        query_header_shape_victim = (query_header_shape_victim + 1) % QUERY_HEADER_SHAPE_CACHE_SIZE;
+        shape->len = consumed;
+        shape->actor_offset = actor_offset;
+        memcpy(shape->bytes, lookahead, consumed);
+        if (actor_offset >= 0) {
+          memset(shape->bytes + actor_offset, 0, 8);
+        }
+        shape->header = *header;
+        shape->header.qid = 0;
+        shape->header.actor_id = 0;
+      }
+    }
   } else {
     tl_fetch_reset_error();
     tl_fetch_set_error(TL_ERROR_HEADER, "Expected RPC_INVOKE_REQ");
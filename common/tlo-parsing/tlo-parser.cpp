@@ -127,6 +127,8 @@ void tlo_parser::get_schema_version() {
 
 void tlo_parser::get_types(bool rename_all_forbidden_names) {
   int count = get_value<int>();
+  tl_sch->types.reserve(count);
+  tl_sch->magics.reserve(count);
   for (int i = 0; i < count; ++i) {
     auto magic = get_value<unsigned int>();
     if (magic != TL_TLS_TYPE) {
@@ -137,12 +139,15 @@ void tlo_parser::get_types(bool rename_all_forbidden_names) {
     if (rename_all_forbidden_names) {
       rename_tl_name_if_forbidden(t->name);
     }
+    tl_sch->magics.emplace(t->name, t->id);
     tl_sch->types[t->id] = std::move(t);
   }
 }
 
 void tlo_parser::get_constructors(bool rename_all_forbidden_names) {
   int count = get_value<int>();
+  tl_sch->magics.reserve(tl_sch->magics.size() + count);
+  tl_sch->owner_type_magics.reserve(count);
   for (int i = 0; i < count; ++i) {
     auto magic = get_value<unsigned int>();
     if (magic != (tl_sch->scheme_version >= 4 ? TL_TLS_COMBINATOR_V4 : TL_TLS_COMBINATOR)) {
@@ -153,12 +158,16 @@ void tlo_parser::get_constructors(bool rename_all_forbidden_names) {
     if (rename_all_forbidden_names) {
       rename_tl_name_if_forbidden(c->name);
     }
+    tl_sch->magics.emplace(c->name, c->id);
+    tl_sch->owner_type_magics.emplace(c->id, c->type_id);
     tl_sch->types[c->type_id]->constructors.emplace_back(std::move(c));
   }
 }
 
 void tlo_parser::get_functions(bool rename_all_forbidden_names) {
   int count = get_value<int>();
+  tl_sch->functions.reserve(count);
+  tl_sch->magics.reserve(tl_sch->magics.size() + count);
   for (int i = 0; i < count; ++i) {
     auto magic = get_value<unsigned int>();
     if (magic != (tl_sch->scheme_version >= 4 ? TL_TLS_COMBINATOR_V4 : TL_TLS_COMBINATOR)) {
@@ -169,6 +178,7 @@ void tlo_parser::get_functions(bool rename_all_forbidden_names) {
     if (rename_all_forbidden_names) {
       rename_tl_name_if_forbidden(f->name);
     }
+    tl_sch->magics.emplace(f->name, f->id);
     tl_sch->functions[f->id] = std::move(f);
   }
 }
@@ -192,19 +202,11 @@ vk::expected<std::unique_ptr<tl_scheme>, std::string> parse_tlo(const char *tlo_
     reader.get_schema_version();
     reader.get_value<int>();
     reader.get_value<int>();
+    // the name and constructor-id indexes are filled inline by the get_*
+    // passes, right after the counts are known and the maps are preallocated
     reader.get_types(rename_all_forbidden_names);
     reader.get_constructors(rename_all_forbidden_names);
     reader.get_functions(rename_all_forbidden_names);
-    for (auto &item : reader.tl_sch->types) {
-      reader.tl_sch->magics[item.second->name] = item.first;
-      for (auto &ctor : item.second->constructors) {
-        reader.tl_sch->magics[ctor->name] = ctor->id;
-        reader.tl_sch->owner_type_magics[ctor->id] = item.second->id;
-      }
-    }
-    for (auto &item : reader.tl_sch->functions) {
-      reader.tl_sch->magics[item.second->name] = item.first;
-    }
   } catch (const std::exception &e) {
     return vk::make_unexpected(e.what());
   }
@@ -33,6 +33,7 @@ add_custom_command(
 
 vk_add_library(unicode OBJECT
                ${UNICODE_DIR}/unicode-utils.cpp
+               ${UNICODE_DIR}/utf8-simd.cpp
                ${UNICODE_DIR}/utf8-utils.cpp
                ${AUTO_DIR}/common/unicode-utils-auto.h)
 
@@ -0,0 +1,202 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/unicode/utf8-simd.h"
+
+#include <string.h>
+
+#ifdef __x86_64__
+#include <x86intrin.h>
+
+#include "common/cpuid.h"
+#endif
+
+bool utf8_check_generic(const void *data, size_t len) {
+  const unsigned char *s = (const unsigned char *)data;
+  const unsigned char *end = s + len;
+
+  while (s < end) {
+    unsigned int a = *s++;
+    if ((a & 0x80) == 0) {
+      continue;
+    }
+
+    if ((a & 0x40) == 0 || s == end) {
+      return false;
+    }
+    unsigned int b = *s++;
+    if ((b & 0xc0) != 0x80) {
+      return false;
+    }
+    if ((a & 0x20) == 0) {
+      if ((a & 0x1e) == 0) {//overlong forms
+        return false;
+      }
+      continue;
+    }
+
+    if (s == end) {
+      return false;
+    }
+    unsigned int c = *s++;
+    if ((c & 0xc0) != 0x80) {
+      return false;
+    }
+    if ((a & 0x10) == 0) {
+      unsigned int x = ((a & 0x0f) << 6) | (b & 0x20);
+      if (x == 0 || x == 0x360) {//overlong forms and surrogates
+        return false;
+      }
+      continue;
+    }
+
+    if (s == end) {
+      return false;
+    }
+    unsigned int d = *s++;
+    if ((d & 0xc0) != 0x80) {
+      return false;
+    }
+    if ((a & 0x08) == 0) {
+      unsigned int t = ((a & 0x07) << 6) | (b & 0x30);
+      if (t == 0 || t >= 0x110) {//overlong forms and end of unicode
+        return false;
+      }
+      continue;
+    }
+
+    return false;
+  }
+
+  return true;
+}
+
+size_t utf8_ascii_prefix_generic(const void *data, size_t len) {
+  const unsigned char *s = (const unsigned char *)data;
+  size_t i = 0;
+  while (i < len && s[i] < 0x80) {
+    i++;
+  }
+  return i;
+}
+
+#ifdef __x86_64__
+
+/******************** SSSE3 ********************/
+
+// "Validating UTF-8 In Less Than One Instruction Per Byte" (Keiser, Lemire).
+// The high nibble of the previous byte, its low nibble and the high nibble of the
+// current byte index three shuffled tables whose bits flag every malformed two-byte
+// window: stray or missing continuations, overlong forms, surrogates and code
+// points above U+10FFFF. Continuations required at distance two and three by
+// three- and four-byte leads are matched separately via saturated subtractions.
+
+static const unsigned char TOO_SHORT = 0x01;
+static const unsigned char TOO_LONG = 0x02;
+static const unsigned char OVERLONG_3 = 0x04;
+static const unsigned char TOO_LARGE = 0x08;
+static const unsigned char SURROGATE = 0x10;
+static const unsigned char OVERLONG_2 = 0x20;
+static const unsigned char TOO_LARGE_1000 = 0x40;
+static const unsigned char OVERLONG_4 = 0x40;
+static const unsigned char TWO_CONTS = 0x80;
+static const unsigned char CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+static inline __m128i utf8_check_block(__m128i input, __m128i prev, __m128i error) {
+  const __m128i byte_1_high = _mm_setr_epi8(
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+  const __m128i byte_1_low = _mm_setr_epi8(
+    (char)(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4),
+    (char)(CARRY | OVERLONG_2),
+    (char)CARRY, (char)CARRY,
+    (char)(CARRY | TOO_LARGE),
+    (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    (char)(CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE),
+    (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+    (char)(CARRY | TOO_LARGE | TOO_LARGE_1000));
+  const __m128i byte_2_high = _mm_setr_epi8(
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4),
+    (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE),
+    (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+    (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+  const __m128i low_nibble_mask = _mm_set1_epi8(0x0f);
+
+  __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+  __m128i sc = _mm_and_si128(
+    _mm_and_si128(_mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble_mask)),
+                  _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, low_nibble_mask))),
+    _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble_mask)));
+
+  __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+  __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+  __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xe0 - 0x80)));//only leads >= 0xe0 end up >= 0x80
+  __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xf0 - 0x80)));//only leads >= 0xf0 end up >= 0x80
+  __m128i must23_80 = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8((char)0x80));
+
+  return _mm_or_si128(error, _mm_xor_si128(must23_80, sc));
+}
+
+static bool utf8_check_ssse3(const void *data, size_t len) {
+  const unsigned char *s = (const unsigned char *)data;
+  __m128i prev = _mm_setzero_si128();
+  __m128i error = _mm_setzero_si128();
+
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i input = _mm_loadu_si128((const __m128i *)(s + i));
+    error = utf8_check_block(input, prev, error);
+    prev = input;
+  }
+
+  //the tail is checked as a zero-padded block: padding is ASCII,
+  //so a sequence left unfinished at the end of the input raises an error
+  unsigned char tail[16] = {0};
+  memcpy(tail, s + i, len - i);
+  error = utf8_check_block(_mm_loadu_si128((const __m128i *)tail), prev, error);
+
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xffff;
+}
+
+static size_t utf8_ascii_prefix_sse2(const void *data, size_t len) {
+  const unsigned char *s = (const unsigned char *)data;
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(s + i)));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  while (i < len && s[i] < 0x80) {
+    i++;
+  }
+  return i;
+}
+#endif
+
+utf8_check_func_t utf8_check = utf8_check_generic;
+utf8_ascii_prefix_func_t utf8_ascii_prefix = utf8_ascii_prefix_generic;
+
+#ifdef __x86_64__
+static void __attribute__((constructor(101))) utf8_simd_init() {
+  const kdb_cpuid_t *p = kdb_cpuid();
+  if (p->type == KDB_CPUID_X86_64 && (p->x86_64.ecx & (1 << 9))) {//SSSE3
+    utf8_check = utf8_check_ssse3;
+    utf8_ascii_prefix = utf8_ascii_prefix_sse2;
+  }
+}
+#endif
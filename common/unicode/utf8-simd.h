@@ -0,0 +1,21 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <stddef.h>
+
+// bulk UTF-8 kernels with runtime dispatch: the vectorized versions are selected
+// at startup when the CPU supports SSSE3, the per-byte versions are used otherwise
+
+// checks that data is valid UTF-8: no overlong forms, no surrogates, nothing above U+10FFFF
+typedef bool (*utf8_check_func_t)(const void *data, size_t len);
+extern utf8_check_func_t utf8_check;
+
+// returns the length of the leading run of ASCII bytes; converters copy such runs verbatim
+typedef size_t (*utf8_ascii_prefix_func_t)(const void *data, size_t len);
+extern utf8_ascii_prefix_func_t utf8_ascii_prefix;
+
+bool utf8_check_generic(const void *data, size_t len);
+size_t utf8_ascii_prefix_generic(const void *data, size_t len);
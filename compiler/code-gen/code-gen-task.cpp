@@ -4,7 +4,31 @@
 
 #include "compiler/code-gen/code-gen-task.h"
 
+#include <unordered_map>
+
+#include "compiler/compiler-core.h"
+#include "compiler/threading/locks.h"
+
 ProfilerRaw &get_code_gen_profiler() {
   static CachedProfiler profiler{"Code Generation"};
   return *profiler;
 }
+
+// tasks run on all scheduler threads, while the index is not thread-safe;
+// durations are accumulated here under a spinlock and moved into the index
+// by apply_codegen_task_durations() once codegen is over
+static std::unordered_map<std::string, double> codegen_task_durations;
+static volatile int codegen_task_durations_lock = 0;
+
+void record_codegen_task_duration(const std::string &out_file_rel_path, double seconds) {
+  AutoLocker<volatile int *> locker(&codegen_task_durations_lock);
+  codegen_task_durations[out_file_rel_path] = seconds;
+}
+
+void apply_codegen_task_durations() {
+  AutoLocker<volatile int *> locker(&codegen_task_durations_lock);
+  for (const auto &task_duration : codegen_task_durations) {
+    G->get_file_info(std::string{task_duration.first})->codegen_duration_hint = task_duration.second;
+  }
+  codegen_task_durations.clear();
+}
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <chrono>
+#include <string>
+
 #include "compiler/code-gen/code-generator.h"
 #include "compiler/scheduler/task.h"
 #include "compiler/stage.h"
@@ -11,36 +14,52 @@
 
 ProfilerRaw &get_code_gen_profiler();
 
+// per-task durations are collected while codegen tasks run (keyed by the output
+// file path relative to the dest dir) and flushed into the persistent index at
+// the end of the build, so the next build can schedule the heaviest tasks first
+void record_codegen_task_duration(const std::string &out_file_rel_path, double seconds);
+void apply_codegen_task_durations();
+
 template<class T>
 class CodeGenTask : public Task {
 private:
   CodeGenerator W;
   T cmd;
+  std::string duration_key;
 public:
-  CodeGenTask(const CodeGenerator &W, const T &cmd) :
+  CodeGenTask(const CodeGenerator &W, const T &cmd, std::string duration_key = {}) :
     W(W),
-    cmd(cmd) {
+    cmd(cmd),
+    duration_key(std::move(duration_key)) {
   }
 
   void execute() {
     AutoProfiler profler{get_code_gen_profiler()};
     stage::set_name("Async code generation");
+    if (duration_key.empty()) {
+      W << cmd;
+      return;
+    }
+    const auto started_at = std::chrono::steady_clock::now();
     W << cmd;
+    record_codegen_task_duration(duration_key, std::chrono::duration<double>(std::chrono::steady_clock::now() - started_at).count());
   }
 };
 
 template<class T>
 struct AsyncImpl {
   const T &cmd;
-  AsyncImpl(const T &cmd) :
-    cmd(cmd) {
+  std::string duration_key;
+  AsyncImpl(const T &cmd, std::string duration_key = {}) :
+    cmd(cmd),
+    duration_key(std::move(duration_key)) {
   }
   void compile(CodeGenerator &W) const {
-    register_async_task(new CodeGenTask<T>(W, cmd));
+    register_async_task(new CodeGenTask<T>(W, cmd, duration_key));
   }
 };
 
 template<class T>
-AsyncImpl<T> Async(const T &cmd) {
-  return AsyncImpl<T>(cmd);
+AsyncImpl<T> Async(const T &cmd, std::string duration_key = {}) {
+  return AsyncImpl<T>(cmd, std::move(duration_key));
 }
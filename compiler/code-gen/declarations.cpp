@@ -4,6 +4,8 @@
 
 #include "compiler/code-gen/declarations.h"
 
+#include <unordered_set>
+
 #include "common/algorithms/compare.h"
 
 #include "compiler/code-gen/common.h"
@@ -31,6 +33,21 @@ VarDeclaration VarPlainDeclaration(VarPtr var) {
   return VarDeclaration(var, false, false);
 }
 
+bool is_memset_resettable_global(VarPtr var) {
+  if (G->settings().is_static_lib_mode()) {
+    return false;
+  }
+  if (!var->is_in_global_scope() || var->is_builtin_global() || var->init_val || var->needs_const_iterator_flag) {
+    return false;
+  }
+  // hard_reset_var of these types is a placement-new of a zero value, so zero-filling
+  // the whole section at once is equivalent; anything with an optional flag or a
+  // nontrivial constructor must keep its per-var reset
+  const TypeData *type = tinf::get_type(var);
+  return !type->use_optional() &&
+         (vk::any_of_equal(type->ptype(), tp_int, tp_float, tp_future, tp_future_queue) || type->get_real_ptype() == tp_bool);
+}
+
 VarDeclaration::VarDeclaration(VarPtr var, bool extern_flag, bool defval_flag) :
   var(var),
   extern_flag(extern_flag),
@@ -48,6 +65,10 @@ void VarDeclaration::compile(CodeGenerator &W) const {
 
   W << (extern_flag ? "extern " : "") << TypeName(type) << " " << VarName(var);
 
+  if (!extern_flag && is_memset_resettable_global(var)) {
+    W << " __attribute__((section(\"kphp_pod_globals\")))";
+  }
+
   if (defval_flag) {
     if (vk::any_of_equal(type->ptype(), tp_float, tp_int, tp_future, tp_future_queue)) {
       W << " = 0";
@@ -68,6 +89,22 @@ void VarDeclaration::compile(CodeGenerator &W) const {
   }
 }
 
+SuperglobalUsedFlag::SuperglobalUsedFlag(VarPtr var) :
+  var(var) {
+}
+
+void SuperglobalUsedFlag::compile(CodeGenerator &W) const {
+  static const std::unordered_set<std::string> superglobal_arrays = {
+    "_SERVER", "_GET", "_POST", "_FILES", "_COOKIE", "_REQUEST", "_ENV"};
+  if (!var->is_builtin_global() || !superglobal_arrays.count(var->name)) {
+    return;
+  }
+  W << CloseNamespace();
+  // weak, as a static lib and the main binary may both mark the same superglobal
+  W << "__attribute__((weak)) bool " << VarName(var) << "$is_used = true;" << NL;
+  W << OpenNamespace();
+}
+
 FunctionDeclaration::FunctionDeclaration(FunctionPtr function, bool in_header, gen_out_style style) :
   function(function),
   in_header(in_header),
@@ -23,6 +23,21 @@ struct VarDeclaration {
 VarDeclaration VarExternDeclaration(VarPtr var);
 VarDeclaration VarPlainDeclaration(VarPtr var);
 
+// for each superglobal array the script really references, emits a weak
+// v$<name>$is_used flag next to its definition; the runtime probes these
+// through weak references and skips materializing the untouched superglobals
+// at request start (see init_superglobals in runtime/interface.cpp)
+struct SuperglobalUsedFlag {
+  VarPtr var;
+  explicit SuperglobalUsedFlag(VarPtr var);
+  void compile(CodeGenerator &W) const;
+};
+
+// true for request-scope globals whose reset is equivalent to zero-filling: such vars are
+// laid out in one contiguous linker section and swept with a single memset per request
+// instead of per-var hard_reset calls (see VarDeclaration and GlobalVarsReset)
+bool is_memset_resettable_global(VarPtr var);
+
 struct FunctionDeclaration {
   FunctionPtr function;
   bool in_header;
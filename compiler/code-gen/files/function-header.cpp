@@ -39,6 +39,12 @@ void FunctionH::compile(CodeGenerator &W) const {
   if (function->is_flatten) {
     W << " __attribute__((flatten))";
   }
+  // hot/cold also move the function into .text.hot/.text.unlikely, so the linker packs hot code together
+  if (function->hotness == FunctionData::code_hotness::hot) {
+    W << " __attribute__((hot))";
+  } else if (function->hotness == FunctionData::code_hotness::cold) {
+    W << " __attribute__((cold))";
+  }
   W << ";" << NL;
   if (function->is_resumable) {
     W << FunctionForkDeclaration(function, true) << ";" << NL;
@@ -175,6 +175,22 @@ void InitScriptsCpp::compile(CodeGenerator &W) const {
     W << Include(i->main_function->header_full_name);
   }
 
+  // the developer-provided warmup routine (KphpConfiguration['--warmup-function']) is
+  // registered as an extra script, the server runs it once per worker before accepting traffic
+  FunctionPtr warmup_function;
+  if (!G->settings().is_static_lib_mode() && !G->get_kphp_warmup_function().empty()) {
+    warmup_function = G->get_function(G->get_kphp_warmup_function());
+    kphp_error(warmup_function,
+               fmt_format("Can't find warmup function '{}', is it marked with @kphp-required?",
+                          G->get_kphp_warmup_function()));
+    if (warmup_function) {
+      kphp_error(warmup_function->get_min_argn() == 0,
+                 fmt_format("Warmup function '{}' must be callable without arguments",
+                            G->get_kphp_warmup_function()));
+      W << Include(warmup_function->header_full_name);
+    }
+  }
+
   if (!G->settings().is_static_lib_mode()) {
     W << NL;
     FunctionSignatureGenerator(W) << "void global_init_php_scripts()" << SemicolonAndNL();
@@ -196,9 +212,17 @@ void InitScriptsCpp::compile(CodeGenerator &W) const {
     W << GlobalResetFunction(i->main_function) << NL;
   }
 
+  if (warmup_function) {
+    W << RunFunction(warmup_function) << NL;
+  }
+
   FunctionSignatureGenerator(W) << "void init_php_scripts() " << BEGIN;
 
   for (auto i : main_file_ids) {
+    // never-written globals are excluded from the per-request $global_reset,
+    // so they are constructed exactly once here
+    W << "void " << GlobalVarsConstructOnceFuncName(i->main_function) << ";" << NL;
+    W << GlobalVarsConstructOnceFuncName(i->main_function) << ";" << NL;
     W << FunctionName(i->main_function) << "$global_reset();" << NL;
 
     W << "set_script (" <<
@@ -207,6 +231,14 @@ void InitScriptsCpp::compile(CodeGenerator &W) const {
       FunctionName(i->main_function) << "$global_reset);" << NL;
   }
 
+  if (warmup_function) {
+    // registered after the main scripts, so "#0" keeps pointing at the main entry
+    W << "set_script (" <<
+      "\"@warmup\", " <<
+      FunctionName(warmup_function) << "$run, " <<
+      FunctionName(main_file_ids.back()->main_function) << "$global_reset);" << NL;
+  }
+
   W << END;
 
   W << CloseFile();
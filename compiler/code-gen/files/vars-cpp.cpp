@@ -94,10 +94,14 @@ static std::vector<bool> compile_vars_part(CodeGenerator &W, const std::vector<V
   W << OpenNamespace();
   for (auto var : vars) {
     if (G->settings().is_static_lib_mode() && var->is_builtin_global()) {
+      // the definition comes from the main binary, but the usage flag must still
+      // be emitted: the lib may be the only place touching the superglobal
+      W << SuperglobalUsedFlag(var);
       continue;
     }
 
     W << VarDeclaration(var);
+    W << SuperglobalUsedFlag(var);
     if (var->is_constant()) {
       if (dep_mask.size() <= var->dependency_level) {
         dep_mask.resize(var->dependency_level + 1, false);
@@ -133,9 +137,10 @@ static std::vector<bool> compile_vars_part(CodeGenerator &W, const std::vector<V
   std::transform(const_raw_string_vars.begin(), const_raw_string_vars.end(),
                  values.begin(),
                  [](const VarPtr &var){ return var->init_val.as<op_string>()->get_string(); });
+  const auto string_element_ids = collect_raw_array_string_elements(const_raw_array_vars, values);
   auto const_string_shifts = compile_raw_data(W, values);
 
-  const std::vector<int> const_array_shifts = compile_arrays_raw_representation(const_raw_array_vars, W);
+  const std::vector<int> const_array_shifts = compile_arrays_raw_representation(const_raw_array_vars, string_element_ids, const_string_shifts, W);
   kphp_assert(const_array_shifts.size() == const_raw_array_vars.size());
 
   for (size_t dep_level = 0; dep_level < dep_mask.size(); ++dep_level) {
@@ -18,6 +18,16 @@ GlobalVarsReset::GlobalVarsReset(SrcFilePtr main_file) :
   main_file_(main_file) {
 }
 
+// a global the analysis proves is never written (see CheckModificationsOfConstVars) can't
+// become dirty during a request: it keeps the empty value it was constructed with, so the
+// per-request reset skips it and only the startup pass constructs it once
+static bool is_construct_once_global(VarPtr var) {
+  if (G->settings().is_static_lib_mode() || var->is_builtin_global() || var->init_val) {
+    return false;
+  }
+  return var->is_read_only;
+}
+
 void GlobalVarsReset::declare_extern_for_init_val(VertexPtr v, std::set<VarPtr> &externed_vars, CodeGenerator &W) {
   if (auto var_vertex = v.try_as<op_var>()) {
     VarPtr var = var_vertex->var_id;
@@ -52,6 +62,14 @@ void GlobalVarsReset::compile_part(FunctionPtr func, const std::set<VarPtr> &use
     if (G->settings().is_static_lib_mode() && var->is_builtin_global()) {
       continue;
     }
+    if (is_memset_resettable_global(var)) {
+      // such vars live in the kphp_pod_globals section and are zeroed by one memset sweep, see compile_func()
+      continue;
+    }
+    if (is_construct_once_global(var)) {
+      // constructed once at startup, can't get dirty between requests
+      continue;
+    }
 
     W << "hard_reset_var(" << VarName(var);
     //FIXME: brk and comments
@@ -63,20 +81,53 @@ void GlobalVarsReset::compile_part(FunctionPtr func, const std::set<VarPtr> &use
     W << ");" << NL;
   }
 
+  W << END;
+  W << NL;
+
+  FunctionSignatureGenerator(W) << "void " << GlobalVarsConstructOnceFuncName(func, part_i) << " " << BEGIN;
+  for (auto var : used_vars) {
+    if (is_construct_once_global(var) && !is_memset_resettable_global(var)) {
+      W << "hard_reset_var(" << VarName(var) << ");" << NL;
+    }
+  }
   W << END;
   W << NL;
   W << CloseNamespace();
 }
 
 void GlobalVarsReset::compile_func(FunctionPtr func, int parts_n, CodeGenerator &W) {
+  // the linker provides __start_/__stop_ symbols for the section filled by VarDeclaration;
+  // weak, so that a build without any memset-resettable global still links
+  if (!G->settings().is_static_lib_mode()) {
+    W << "extern \"C\" char __start_kphp_pod_globals[] __attribute__((weak));" << NL;
+    W << "extern \"C\" char __stop_kphp_pod_globals[] __attribute__((weak));" << NL;
+    W << NL;
+  }
+
   W << OpenNamespace();
   FunctionSignatureGenerator(W) << "void " << GlobalVarsResetFuncName(func) << " " << BEGIN;
 
+  if (!G->settings().is_static_lib_mode()) {
+    // trivially resettable globals are laid out contiguously, so their per-request
+    // reset is one cache-friendly sweep instead of thousands of scattered stores
+    W << "if (__start_kphp_pod_globals != __stop_kphp_pod_globals) " << BEGIN
+      << "memset(__start_kphp_pod_globals, 0, __stop_kphp_pod_globals - __start_kphp_pod_globals);" << NL
+      << END << NL;
+  }
+
   for (int i = 0; i < parts_n; i++) {
     W << "void " << GlobalVarsResetFuncName(func, i) << ";" << NL;
     W << GlobalVarsResetFuncName(func, i) << ";" << NL;
   }
 
+  W << END;
+  W << NL;
+
+  FunctionSignatureGenerator(W) << "void " << GlobalVarsConstructOnceFuncName(func) << " " << BEGIN;
+  for (int i = 0; i < parts_n; i++) {
+    W << "void " << GlobalVarsConstructOnceFuncName(func, i) << ";" << NL;
+    W << GlobalVarsConstructOnceFuncName(func, i) << ";" << NL;
+  }
   W << END;
   W << NL;
   W << CloseNamespace();
@@ -104,6 +155,7 @@ void GlobalVarsReset::compile(CodeGenerator &W) const {
 
   W << OpenFile(vars_reset_src_prefix + main_func->src_name, "", false);
   W << ExternInclude("runtime-headers.h");
+  W << "#include <cstring>" << NL;
   compile_func(main_func, used_vars.size(), W);
   W << CloseFile();
 }
@@ -218,3 +218,23 @@ private:
   const FunctionPtr main_func_;
   const int part_{-1};
 };
+
+// constructs the globals that are proven never written and therefore skipped by the
+// per-request reset; called once at startup from init_php_scripts()
+struct GlobalVarsConstructOnceFuncName {
+  explicit GlobalVarsConstructOnceFuncName(FunctionPtr main_func, int part = -1) :
+    main_func_(main_func),
+    part_(part) {}
+
+  void compile(CodeGenerator &W) const {
+    W << FunctionName(main_func_) << "$global_vars_construct_once";
+    if (part_ >= 0) {
+      W << std::to_string(part_);
+    }
+    W << "()";
+  }
+
+private:
+  const FunctionPtr main_func_;
+  const int part_{-1};
+};
@@ -74,19 +74,62 @@ static inline int array_len() {
   return (10 * sizeof(int)) / sizeof(double);
 }
 
+static VertexPtr get_actual_element_value(VertexPtr element) {
+  VertexPtr actual_vertex = GenTree::get_actual_value(element);
+  if (auto double_arrow = actual_vertex.try_as<op_double_arrow>()) {
+    actual_vertex = GenTree::get_actual_value(double_arrow->value());
+  }
+  return actual_vertex;
+}
+
+std::vector<std::vector<size_t>> collect_raw_array_string_elements(const std::vector<VarPtr> &const_raw_array_vars, std::vector<std::string> &values) {
+  std::vector<std::vector<size_t>> element_ids(const_raw_array_vars.size());
+
+  for (size_t var_id = 0; var_id < const_raw_array_vars.size(); ++var_id) {
+    VertexAdaptor<op_array> vertex = const_raw_array_vars[var_id]->init_val.as<op_array>();
+    const TypeData *vertex_inner_type = vertex->tinf_node.get_type()->lookup_at(Key::any_key());
+
+    const int array_size = vertex->size();
+    if (vertex_inner_type->ptype() != tp_string || vertex_inner_type->use_optional() ||
+        array_size < 0 || array_size > (1 << 30) - array_len() ||
+        !CanGenerateRawArray::is_raw(vertex)) {
+      continue;
+    }
+
+    const size_t saved_values_size = values.size();
+    auto &ids = element_ids[var_id];
+    ids.reserve(array_size);
+    for (auto it : vertex->args()) {
+      auto str_vertex = get_actual_element_value(it).try_as<op_string>();
+      if (!str_vertex) {
+        ids.clear();
+        values.resize(saved_values_size);
+        break;
+      }
+      ids.push_back(values.size());
+      values.emplace_back(str_vertex->get_string());
+    }
+  }
+
+  return element_ids;
+}
 
-std::vector<int> compile_arrays_raw_representation(const std::vector<VarPtr> &const_raw_array_vars, CodeGenerator &W) {
+std::vector<int> compile_arrays_raw_representation(const std::vector<VarPtr> &const_raw_array_vars,
+                                                   const std::vector<std::vector<size_t>> &string_element_ids,
+                                                   const std::vector<int> &const_string_shifts,
+                                                   CodeGenerator &W) {
   if (const_raw_array_vars.empty()) {
     return std::vector<int>();
   }
+  kphp_assert(string_element_ids.size() == const_raw_array_vars.size());
 
   std::vector<int> shifts;
   shifts.reserve(const_raw_array_vars.size());
 
   int shift = 0;
 
-  for (auto var_it : const_raw_array_vars) {
-    VertexAdaptor<op_array> vertex = var_it->init_val.as<op_array>();
+  for (size_t var_id = 0; var_id < const_raw_array_vars.size(); ++var_id) {
+    VertexAdaptor<op_array> vertex = const_raw_array_vars[var_id]->init_val.as<op_array>();
 
     TypeData *vertex_inner_type = vertex->tinf_node.get_type()->lookup_at(Key::any_key());
 
@@ -97,6 +140,10 @@ std::vector<int> compile_arrays_raw_representation(const std::vector<VarPtr> &co
     if (0 <= array_size && array_size <= (1 << 30) - array_len()) {
       if (vk::any_of_equal(vertex_inner_type->ptype(), tp_int, tp_float)) {
         array_len_in_doubles = array_len() + array_size;
+      } else if (vertex_inner_type->ptype() == tp_string &&
+                 string_element_ids[var_id].size() == static_cast<size_t>(array_size)) {
+        // a string entry is one pointer into the raw[] blob emitted alongside
+        array_len_in_doubles = array_len() + array_size;
       }
     }
 
@@ -113,6 +160,7 @@ std::vector<int> compile_arrays_raw_representation(const std::vector<VarPtr> &co
         << "struct { uint32_t a; uint32_t b; } is;" << NL
         << "double d;" << NL
         << "int64_t i64;" << NL
+        << "const char *s;" << NL
         << END
         << " raw_arrays[] = { ";
     }
@@ -133,19 +181,22 @@ std::vector<int> compile_arrays_raw_representation(const std::vector<VarPtr> &co
     // string_size, string_buf_size
     W << "{ .is = { .a = 0 , .b = " << std::numeric_limits<uint32_t>::max() << " }}";
 
+    size_t element_id = 0;
     auto args_end = vertex->args().end();
     for (auto it = vertex->args().begin(); it != args_end; ++it) {
-      VertexPtr actual_vertex = GenTree::get_actual_value(*it);
-      if (auto double_arrow = actual_vertex.try_as<op_double_arrow>()) {
-        actual_vertex = GenTree::get_actual_value(double_arrow->value());
-      }
-      kphp_assert(vk::any_of_equal(vertex_inner_type->ptype(), tp_int, tp_float));
+      VertexPtr actual_vertex = get_actual_element_value(*it);
+      kphp_assert(vk::any_of_equal(vertex_inner_type->ptype(), tp_int, tp_float, tp_string));
 
       if (vertex_inner_type->ptype() == tp_int) {
         W << ", { .i64 =" << actual_vertex << " }";
-      } else {
+      } else if (vertex_inner_type->ptype() == tp_float) {
         W << ", { .d =" << actual_vertex << " }";
+      } else {
+        // the string object is a pointer right past the string_inner header baked by string_raw()
+        const int string_data_shift = const_string_shifts[string_element_ids[var_id][element_id]] + 3 * sizeof(int);
+        W << ", { .s = raw + " << string_data_shift << " }";
       }
+      ++element_id;
     }
   }
 
@@ -24,7 +24,14 @@ private:
   std::string str;
 };
 
-std::vector<int> compile_arrays_raw_representation(const std::vector<VarPtr> &const_raw_array_vars, CodeGenerator &W);
+// appends element strings of string-vector constant arrays to values (so they get into the raw[] blob)
+// and returns per-array lists of indices into values; an index list stays empty if the array can't be baked
+std::vector<std::vector<size_t>> collect_raw_array_string_elements(const std::vector<VarPtr> &const_raw_array_vars, std::vector<std::string> &values);
+
+std::vector<int> compile_arrays_raw_representation(const std::vector<VarPtr> &const_raw_array_vars,
+                                                   const std::vector<std::vector<size_t>> &string_element_ids,
+                                                   const std::vector<int> &const_string_shifts,
+                                                   CodeGenerator &W);
 
 template <typename Container,
   typename = decltype(std::declval<Container>().begin()),
@@ -317,6 +317,41 @@ void compile_binary_func_op(VertexAdaptor<meta_op_binary> root, CodeGenerator &W
 }
 
 
+// $s .= $a . "b" . $c qualifies for part-by-part appending when every part is a constant
+// or a variable other than $s itself: a part reading $s must see its pre-assignment value,
+// and calls may have side effects on it, so both keep the ordinary build-then-append
+static bool can_append_string_build_inplace(VertexPtr lhs, VertexAdaptor<op_string_build> build) {
+  if (lhs->type() != op_var) {
+    return false;
+  }
+  VarPtr lhs_var = lhs.as<op_var>()->var_id;
+  for (auto part : build->args()) {
+    if (vk::any_of_equal(part->type(), op_string, op_int_const, op_float_const)) {
+      continue;
+    }
+    if (auto var = part.try_as<op_var>()) {
+      if (var->var_id != lhs_var) {
+        continue;
+      }
+    }
+    return false;
+  }
+  return true;
+}
+
+// appending the parts one by one skips materializing the rhs into a temporary
+// sized string that would be copied into $s and thrown away right after
+static void compile_set_dot_append_parts(VertexAdaptor<meta_op_binary> root, CodeGenerator &W) {
+  const auto parts = root->rhs().as<op_string_build>()->args();
+  for (int i = 0; i < parts.size(); i++) {
+    W << "append (";
+  }
+  W << Operand{root->lhs(), root->type(), true};
+  for (auto part : parts) {
+    W << ", " << part << ")";
+  }
+}
+
 void compile_binary_op(VertexAdaptor<meta_op_binary> root, CodeGenerator &W) {
   auto &root_type_str = OpInfo::str(root->type());
   kphp_error_return (root_type_str[0] != '@', fmt_format("Unexpected {}\n", vk::string_view{root_type_str}.substr(1)));
@@ -337,6 +372,12 @@ void compile_binary_op(VertexAdaptor<meta_op_binary> root, CodeGenerator &W) {
     return;
   }
 
+  if (root->type() == op_set_dot && rhs->type() == op_string_build &&
+      can_append_string_build_inplace(lhs, rhs.as<op_string_build>())) {
+    compile_set_dot_append_parts(root, W);
+    return;
+  }
+
   if (root->type() == op_add) {
     if (lhs_tp->ptype() == tp_array && rhs_tp->ptype() == tp_array && type_out(lhs_tp) != type_out(rhs_tp)) {
       const TypeData *res_tp = tinf::get_type(root)->const_read_at(Key::any_key());
@@ -655,15 +696,69 @@ void compile_foreach_noref_header(VertexAdaptor<op_foreach> root, CodeGenerator
   }
 }
 
+// foreach (range(...) as [key =>] x) with plain int bounds iterates a temporary that
+// provably never escapes the loop, so instead of materializing an array<mixed> of
+// counters it is lowered into a counting loop; range_loop_count() in the runtime
+// reproduces the bounds/step checks (and warnings) of a real range() call.
+// Resumable functions are skipped: raw locals don't survive resumable state switches.
+// Float/string ranges and range() results stored in variables keep the array.
+bool compile_foreach_lazy_range_header(VertexAdaptor<op_foreach> root, CodeGenerator &W) {
+  if (W.get_context().resumable_flag) {
+    return false;
+  }
+  auto params = root->params();
+  auto call = params->xs().try_as<op_func_call>();
+  if (!call || call->func_id->name != "range") {
+    return false;
+  }
+  auto args = call->args();
+  for (auto arg : args) {
+    const TypeData *arg_type = tinf::get_type(arg);
+    if (arg_type->ptype() != tp_int || arg_type->use_optional()) {
+      return false;
+    }
+  }
+
+  string value = gen_unique_name("range_value");
+  string to = gen_unique_name("range_to");
+  string step = gen_unique_name("range_step");
+  string count = gen_unique_name("range_count");
+  string key = gen_unique_name("range_key");
+
+  W << BEGIN;
+  //args are bound to locals first to keep the left-to-right evaluation order of a real call
+  W << "int64_t " << value << " = " << args[0] << ";" << NL;
+  W << "int64_t " << to << " = " << args[1] << ";" << NL;
+  W << "int64_t " << step << " = ";
+  if (args.size() > 2) {
+    W << args[2];
+  } else {
+    W << "1";
+  }
+  W << ";" << NL;
+  W << "int64_t " << count << " = range_loop_count(" << value << ", " << to << ", &" << step << ");" << NL;
+  W << "for (int64_t " << key << " = 0; " << key << " != " << count << "; ++" << key << ", " << value << " += " << step << ")" << BEGIN;
+
+  W << params->x() << " = " << value << ";" << NL;
+  if (params->has_key()) {
+    W << params->key() << " = " << key << ";" << NL;
+  }
+  return true;
+}
+
 void compile_foreach(VertexAdaptor<op_foreach> root, CodeGenerator &W) {
   auto params = root->params();
   auto cmd = root->cmd();
 
   //foreach (xs as [key =>] x)
+  bool lazy_range = false;
   if (params->x()->ref_flag) {
     compile_foreach_ref_header(root, W);
   } else {
-    compile_foreach_noref_header(root, W);
+    lazy_range = compile_foreach_lazy_range_header(root, W);
+    if (!lazy_range) {
+      compile_foreach_noref_header(root, W);
+    }
   }
 
   if (stage::has_error()) {
@@ -674,7 +769,7 @@ void compile_foreach(VertexAdaptor<op_foreach> root, CodeGenerator &W) {
     Label{root->continue_label_id} <<
     END <<
     Label{root->break_label_id} << NL;
-  if (!params->x()->ref_flag) {
+  if (!params->x()->ref_flag && !lazy_range) {
     VertexPtr temp_var = params->temp_var();
     W << "clear_array(" << temp_var << ");" << NL;
   }
@@ -925,6 +1020,19 @@ bool compile_tracing_profiler(FunctionPtr func, CodeGenerator &W) {
   return true;
 }
 
+void compile_memory_attribution(FunctionPtr func, CodeGenerator &W) {
+  // only the functions hot-listed via the hotness profile get an attribution context:
+  // the guard itself is two stores, but the point is to keep the context table compact;
+  // resumable functions are skipped as the guard wouldn't survive a suspension point,
+  // and inline functions are skipped as their static local would be duplicated per TU
+  if (func->hotness != FunctionData::code_hotness::hot || func->is_resumable || func->is_inline) {
+    return;
+  }
+  W << "static const uint16_t attribution_context__ = memory_resource::attribution::register_context("
+    << RawString(func->get_human_readable_name()) << ");" << NL;
+  W << "memory_resource::attribution_guard attribution_guard__{attribution_context__};" << NL << NL;
+}
+
 void compile_function_resumable(VertexAdaptor<op_function> func_root, CodeGenerator &W) {
   FunctionPtr func = func_root->func_id;
   W << "//RESUMABLE FUNCTION IMPLEMENTATION" << NL;
@@ -1020,6 +1128,7 @@ void compile_function(VertexAdaptor<op_function> func_root, CodeGenerator &W) {
   W << FunctionDeclaration(func, false) << " " << BEGIN;
 
   compile_tracing_profiler(func, W);
+  compile_memory_attribution(func, W);
 
   for (auto var : func->local_var_ids) {
     if (var->type() != VarData::var_local_inplace_t && !var->is_foreach_reference) {
@@ -1737,12 +1846,14 @@ void compile_vertex(VertexPtr root, CodeGenerator &W) {
 
   W << UpdateLocation(root->location);
 
-  bool close_par = root->val_ref_flag == val_r || root->val_ref_flag == val_l;
+  bool close_par = root->val_ref_flag == val_r || root->val_ref_flag == val_l || root->move_flag;
 
   if (root->val_ref_flag == val_r) {
     W << "val(";
   } else if (root->val_ref_flag == val_l) {
     W << "ref(";
+  } else if (root->move_flag) {
+    W << "std::move(";
   }
 
   if (root->extra_type == op_ex_safe_version) {
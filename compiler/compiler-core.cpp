@@ -18,6 +18,7 @@
 #include "compiler/data/function-data.h"
 #include "compiler/data/lib-data.h"
 #include "compiler/data/src-file.h"
+#include "compiler/gentree.h"
 #include "compiler/name-gen.h"
 
 namespace {
@@ -248,6 +249,9 @@ void CompilerCore::require_function(const string &name, DataStream<FunctionPtr>
 void CompilerCore::require_function(FunctionPtr function, DataStream<FunctionPtr> &os) {
   if (!function->is_required) {
     function->is_required = true;
+    if (function->deferred_body_tokens != nullptr) {
+      GenTree::lazy_parse_deferred_body(function, os);
+    }
     os << function;
   }
 }
@@ -535,6 +539,10 @@ void CompilerCore::init_composer_class_loader() {
   for (const auto &composer_root : find_composer_folders(vendor)) {
     composer_class_loader.load_file(composer_root);
   }
+
+  // all autoload dirs are known now; index their files once so that the
+  // concurrent psr4 lookups during the parsing pipes never touch the FS
+  composer_class_loader.build_file_index();
 }
 
 CompilerCore *G;
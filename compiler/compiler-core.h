@@ -35,6 +35,7 @@ private:
   ClassPtr memcache_class;
   TlClasses tl_classes;
   std::vector<std::string> kphp_runtime_opts;
+  std::string kphp_warmup_function;
   bool is_untyped_rpc_tl_used{false};
 
   inline bool try_require_file(SrcFilePtr file);
@@ -106,6 +107,9 @@ public:
   void add_kphp_runtime_opt(std::string opt) { kphp_runtime_opts.emplace_back(std::move(opt)); }
   const std::vector<std::string> &get_kphp_runtime_opts() const { return kphp_runtime_opts; }
 
+  void set_kphp_warmup_function(std::string name) { kphp_warmup_function = std::move(name); }
+  const std::string &get_kphp_warmup_function() const { return kphp_warmup_function; }
+
   void set_untyped_rpc_tl_used() {
     is_untyped_rpc_tl_used = true;
   }
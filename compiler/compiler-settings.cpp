@@ -180,6 +180,29 @@ void CompilerSettings::update_cxx_flags_sha256() {
 void CompilerSettings::init() {
   option_as_dir(kphp_src_path);
   functions_file.value_ = get_full_path(functions_file.get());
+  if (!hotness_profile_file.get().empty()) {
+    hotness_profile_file.value_ = get_full_path(hotness_profile_file.get());
+  }
+  if (pgo_mode.get() != "none") {
+    if (pgo_profile.get().empty()) {
+      throw std::runtime_error{"Option " + pgo_profile.get_env_var() + " is required for pgo mode '" + pgo_mode.get() + "'"};
+    }
+    if (pgo_mode.get() == "collect") {
+      mkdir_recursive(pgo_profile.get().c_str(), 0777);
+    }
+    std::string pgo_profile_full_path = get_full_path(pgo_profile.get());
+    if (pgo_profile_full_path.empty()) {
+      throw std::runtime_error{"Can't open pgo profile dir '" + pgo_profile.get() + "'"};
+    }
+    pgo_profile.value_ = std::move(pgo_profile_full_path);
+  }
+  if (!bolt_profile.get().empty()) {
+    std::string bolt_profile_full_path = get_full_path(bolt_profile.get());
+    if (bolt_profile_full_path.empty()) {
+      throw std::runtime_error{"Can't open bolt profile '" + bolt_profile.get() + "'"};
+    }
+    bolt_profile.value_ = std::move(bolt_profile_full_path);
+  }
   runtime_sha256_file.value_ = get_full_path(runtime_sha256_file.get());
   link_file.value_ = get_full_path(link_file.get());
 
@@ -190,6 +213,9 @@ void CompilerSettings::init() {
     if (!tl_schema_file.get().empty()) {
       throw std::runtime_error{"Option " + tl_schema_file.get_env_var() + " is forbidden for static lib mode"};
     }
+    if (!bolt_profile.get().empty()) {
+      throw std::runtime_error{"Option " + bolt_profile.get_env_var() + " is forbidden for static lib mode"};
+    }
     std::string lib_dir = get_full_path(main_files.get().back());
     std::size_t last_slash = lib_dir.rfind('/');
     if (last_slash == std::string::npos) {
@@ -254,6 +280,25 @@ void CompilerSettings::init() {
   if (vk::contains(cxx.get(), "clang")) {
     ss << " -Wno-invalid-source-encoding";
   }
+  // the profile path ends up in cxx_flags on purpose: cxx_flags_sha256 below is
+  // the cache key for precompiled headers and the object dir, so instrumented,
+  // profile-guided and plain objects never mix
+  if (pgo_mode.get() == "collect") {
+    if (vk::contains(cxx.get(), "clang")) {
+      ss << " -fprofile-generate=" << pgo_profile.get();
+    } else {
+      // workers forked from one master update the same .gcda files concurrently
+      ss << " -fprofile-dir=" << pgo_profile.get() << " -fprofile-generate -fprofile-update=atomic";
+    }
+  } else if (pgo_mode.get() == "apply") {
+    if (vk::contains(cxx.get(), "clang")) {
+      // merged.profdata is produced from raw profiles by the merge step in run_make()
+      ss << " -fprofile-use=" << pgo_profile.get() << "/merged.profdata";
+    } else {
+      ss << " -fprofile-dir=" << pgo_profile.get() << " -fprofile-use -fprofile-correction -Wno-missing-profile";
+    }
+  }
+
   #if __cplusplus <= 201402L
     ss << " -std=gnu++14";
   #elif __cplusplus <= 201703L
@@ -282,6 +327,24 @@ void CompilerSettings::init() {
   append_if_doesnt_contain(ld_flags.value_, external_libs, "-l");
   append_if_doesnt_contain(ld_flags.value_, external_static_libs, "-l:lib", ".a");
 
+  // a linked-in malloc replacement interposes every heap allocation outside
+  // script memory: heap_resource, net buffers, libc internals; script memory
+  // stays on the arena allocator and doesn't go through malloc at all
+  if (php_allocator.get() == "jemalloc") {
+    append_if_doesnt_contain(ld_flags.value_, std::initializer_list<const char *>{"jemalloc"}, "-l");
+  } else if (php_allocator.get() == "tcmalloc") {
+    append_if_doesnt_contain(ld_flags.value_, std::initializer_list<const char *>{"tcmalloc_minimal"}, "-l");
+  }
+
+  if (pgo_mode.get() == "collect") {
+    // links the profiling runtime into the instrumented binary
+    ld_flags.value_ += vk::contains(cxx.get(), "clang") ? " -fprofile-generate=" + pgo_profile.get() : " -fprofile-generate";
+  }
+  if (!bolt_profile.get().empty()) {
+    // llvm-bolt rewrites the layout after linking and needs relocations kept in the binary
+    ld_flags.value_ += " -Wl,--emit-relocs";
+  }
+
   ld_flags.value_ += " -rdynamic";
 
   for (auto &main_file : main_files.value_) {
@@ -302,6 +365,12 @@ void CompilerSettings::init() {
   option_as_dir(dest_dir);
   dest_cpp_dir.value_ = dest_dir.get() + "kphp/";
   dest_objs_dir.value_ = dest_dir.get() + "objs/";
+  if (pgo_mode.get() != "none") {
+    // separate object cache per flags hash: a pgo mode switch must not reuse
+    // objects built with different instrumentation, and the plain objs/ cache
+    // stays valid for the next non-pgo build
+    dest_objs_dir.value_ = dest_dir.get() + "objs-" + cxx_flags_sha256.get().substr(0, 16) + "/";
+  }
   binary_path.value_ = dest_dir.get() + mode.get();
   generated_runtime_path.value_ = kphp_src_path.get() + "objs/generated/auto/runtime/";
   cxx_flags.value_ += " -iquote" + dest_cpp_dir.get();
@@ -121,6 +121,12 @@ public:
   KphpOption<std::string> tl_schema_file;
   KphpOption<bool> gen_tl_internals;
 
+  KphpOption<std::string> hotness_profile_file;
+
+  KphpOption<std::string> pgo_mode;
+  KphpOption<std::string> pgo_profile;
+  KphpOption<std::string> bolt_profile;
+
   KphpOption<bool> error_on_warns;
   KphpOption<std::string> warnings_file;
   KphpOption<uint64_t> warnings_level;
@@ -129,12 +135,15 @@ public:
 
   KphpOption<std::string> stats_file;
   KphpOption<std::string> compilation_metrics_file;
+  KphpOption<std::string> compilation_metrics_json_file;
+  KphpOption<std::string> profiler_trace_file;
   KphpOption<std::string> override_kphp_version;
   KphpOption<std::string> php_code_version;
 
   KphpOption<std::string> cxx;
   KphpOption<std::string> extra_cxx_flags;
   KphpOption<std::string> extra_ld_flags;
+  KphpOption<std::string> php_allocator;
   KphpOption<std::string> debug_level;
   KphpOption<std::string> archive_creator;
   KphpOption<bool> dynamic_incremental_linkage;
@@ -161,6 +161,7 @@ prepend(KPHP_COMPILER_SOURCES ${KPHP_COMPILER_DIR}/
         debug.cpp
         compiler-settings.cpp
         gentree.cpp
+        hotness-profile.cpp
         index.cpp
         lexer.cpp
         name-gen.cpp
@@ -23,6 +23,7 @@
 #include "common/version-string.h"
 #include "common/precise-time.h"
 
+#include "compiler/code-gen/code-gen-task.h"
 #include "compiler/compiler-core.h"
 #include "compiler/lexer.h"
 #include "compiler/make/make.h"
@@ -274,9 +275,8 @@ bool compiler_execute(CompilerSettings *settings) {
     >> PassC<ExtractAsyncPass>{}
     >> PassC<CheckNestedForeachPass>{}
     >> PassC<InlineSimpleFunctions>{}
-    >> PassC<CommonAnalyzerPass>{}
-    >> PassC<CheckTlClasses>{}
-    >> PassC<CheckAccessModifiersPass>{}
+    // read-only checks that don't modify the tree are fused into a single walk
+    >> PassC<FusedPasses<CommonAnalyzerPass, CheckTlClasses, CheckAccessModifiersPass>>{}
     >> PassC<FinalCheckPass>{}
     >> PassC<RegisterKphpConfiguration>{}
     >> SyncC<CodeGenF>{}
@@ -333,6 +333,9 @@ bool compiler_execute(CompilerSettings *settings) {
   }
 
   const std::string compilation_metrics_file = G->settings().compilation_metrics_file.get();
+  const std::string compilation_metrics_json_file = G->settings().compilation_metrics_json_file.get();
+  G->stats.total_files = G->get_index().get_files().size();
+  apply_codegen_task_durations();
   G->finish();
   auto profiler_stats = collect_profiler_stats();
   G->stats.update_memory_stats();
@@ -340,13 +343,25 @@ bool compiler_execute(CompilerSettings *settings) {
   if (verbosity >= 1) {
     profiler_print_all(profiler_stats);
     std::cerr << std::endl;
+    profiler_print_critical_path(profiler_stats);
+    std::cerr << std::endl;
     std::cerr << "Compile stats:" << std::endl;
     G->stats.write_to(std::cerr);
   }
-  if (!compilation_metrics_file.empty()) {
+  const std::string profiler_trace_file = G->settings().profiler_trace_file.get();
+  if (!profiler_trace_file.empty()) {
+    profiler_dump_chrome_trace(profiler_trace_file);
+  }
+  if (!compilation_metrics_file.empty() || !compilation_metrics_json_file.empty()) {
     G->stats.profiler_stats = std::move(profiler_stats);
-    std::ofstream compilation_metrics{compilation_metrics_file};
-    G->stats.write_to(compilation_metrics, false);
+    if (!compilation_metrics_file.empty()) {
+      std::ofstream compilation_metrics{compilation_metrics_file};
+      G->stats.write_to(compilation_metrics, false);
+    }
+    if (!compilation_metrics_json_file.empty()) {
+      std::ofstream compilation_metrics_json{compilation_metrics_json_file};
+      G->stats.write_json_to(compilation_metrics_json);
+    }
   }
   return true;
 }
@@ -4,16 +4,72 @@
 
 #include "compiler/composer.h"
 
+#include <dirent.h>
+#include <set>
+#include <sys/stat.h>
+
 #include <yaml-cpp/yaml.h> // using YAML parser to handle JSON files
 
 #include "compiler/kphp_assert.h"
 #include "common/wrappers/fmt_format.h"
 #include "compiler/stage.h"
 
+void ComposerClassLoader::index_php_files_in_dir(const std::string &dir) {
+  DIR *dp = opendir(dir.c_str());
+  if (dp == nullptr) {
+    // composer files routinely declare autoload dirs that don't exist
+    // (e.g. "tests/" stripped by --prefer-dist); access() would have
+    // failed for every candidate inside them, so an empty index is right
+    return;
+  }
+
+  while (const auto *entry = readdir(dp)) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    std::string path = dir + entry->d_name;
+    bool is_dir = entry->d_type == DT_DIR;
+    if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN) {
+      // composer symlinks path-repository packages instead of copying them
+      struct stat path_info;
+      is_dir = stat(path.c_str(), &path_info) == 0 && S_ISDIR(path_info.st_mode);
+    }
+    if (is_dir) {
+      path.push_back('/');
+      index_php_files_in_dir(path);
+    } else if (vk::string_view{path}.ends_with(".php")) {
+      file_index_.insert(std::move(path));
+    }
+  }
+  closedir(dp);
+}
+
+void ComposerClassLoader::build_file_index() {
+  // a bulk readdir enumeration of the autoload roots is much cheaper than the
+  // per-candidate access() probes it replaces: on an NFS-backed vendor tree the
+  // lookup stat storm at the front of the build used to dominate cold-cache runs;
+  // paths are collected exactly as psr4_lookup_nocache concatenates its
+  // candidates (starting from the stored dir string), so set lookups match
+  // byte-for-byte
+  std::set<std::string> roots;
+  for (const auto &kv : autoload_psr4_) {
+    for (const auto &dir : kv.second) {
+      roots.insert(dir);
+    }
+  }
+  for (const auto &root : roots) {
+    index_php_files_in_dir(root);
+  }
+  file_index_ready_ = true;
+}
+
 std::string ComposerClassLoader::psr4_lookup_nocache(const std::string &class_name) const {
   std::string prefix = class_name;
 
-  auto file_exists = [](const std::string &filename) {
+  auto file_exists = [this](const std::string &filename) {
+    if (file_index_ready_) {
+      return file_index_.find(filename) != file_index_.end();
+    }
     return access(filename.c_str(), F_OK) == 0;
   };
 
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <vector>
 #include <mutex>
@@ -20,15 +21,25 @@ public:
   void load_file(const std::string& filename);
   void load_root_file(const std::string& filename);
 
+  // enumerate all .php files under the registered autoload dirs with one readdir
+  // walk per dir; after that psr4_lookup answers (including misses) from memory
+  // instead of doing an access() call per candidate; called once, after all
+  // composer files are loaded and before concurrent lookups start
+  void build_file_index();
+
   std::string psr4_lookup(const std::string &class_name) const;
 
 private:
   void load_file(const std::string& filename, bool root);
+  void index_php_files_in_dir(const std::string& dir);
   std::string psr4_lookup_nocache(const std::string& class_name) const;
 
   bool use_dev_;
   std::map<std::string, std::vector<std::string>, std::less<>> autoload_psr4_;
 
+  bool file_index_ready_{false};
+  std::unordered_set<std::string> file_index_;
+
   mutable std::mutex mutex_;
   mutable std::unordered_map<std::string, std::string> psr4_cache_;
 };
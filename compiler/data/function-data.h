@@ -21,6 +21,8 @@
 #include "compiler/threading/data-stream.h"
 #include "compiler/vertex-meta_op_base.h"
 
+class Token;
+
 class FunctionData {
   // code outside of the data/ should use FunctionData::create_function()
   FunctionData() = default;
@@ -57,6 +59,11 @@ public:
   VertexAdaptor<op_function> root;
   bool is_required = false;
 
+  // plain global functions parse their bodies lazily: the body token range is saved here at parse
+  // time and turned into a tree on the first require (see GenTree::lazy_parse_deferred_body);
+  // nullptr means the body is already a tree
+  std::vector<Token> *deferred_body_tokens{nullptr};
+
   enum func_type_t {
     func_main,
     func_local,
@@ -117,6 +124,13 @@ public:
   bool is_no_return = false;
   bool warn_unused_result = false;
   bool is_flatten = false;
+  // filled from the hotness profile (see CompilerSettings::hotness_profile_file),
+  // turns into __attribute__((hot/cold)) on the generated declaration
+  enum class code_hotness : uint8_t {
+    unspecified,
+    hot,
+    cold,
+  } hotness = code_hotness::unspecified;
   enum class profiler_status : uint8_t {
     disable,
     // A function that is being profiled that starts and ends the profiling
@@ -10,6 +10,7 @@
 #include <unistd.h>
 
 #include "auto/compiler/vertex/vertex-all.h"
+#include "common/crc32.h"
 #include "common/wrappers/likely.h"
 
 #include "compiler/compiler-core.h"
@@ -46,6 +47,8 @@ bool SrcFile::load() {
     }
   }
 
+  file_hash = compute_crc64(text.data(), file_size);
+
   loaded = true;
   close(fid);
 
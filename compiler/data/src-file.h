@@ -19,6 +19,8 @@ public:
   std::string unified_dir_name;
   bool loaded{false};
   bool is_required{false};
+  // crc64 of text, filled on load; the key for content-addressed caching of per-file artifacts
+  uint64_t file_hash{0};
 
   std::string main_func_name;
   FunctionPtr main_function;
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <array>
+#include <tuple>
+#include <utility>
 
 #include "common/type_traits/function_traits.h"
 
@@ -155,3 +158,107 @@ public:
   }
 };
 
+/*** Pass fusion ***/
+// Composes several passes into one that applies all of them during a single tree walk:
+// every vertex gets each sub-pass's on_enter_vertex in the listed order and each
+// on_exit_vertex in reverse order, which nests exactly like running the passes back to back,
+// but the function tree is traversed (and its memory touched) only once.
+// Dispatch goes through a tuple of concrete sub-passes, so it is resolved at compile time
+// without a virtual call per sub-pass per vertex.
+// Only read-mostly passes compose safely: a sub-pass must not take over the recursion
+// (user_recursion) and must not export extra data into the stream (get_data);
+// both requirements are enforced below. check_function() is evaluated per sub-pass,
+// so a function skipped by one sub-pass is still visited by the others.
+template<class... Passes>
+class FusedPasses final : public FunctionPassBase {
+  template<bool... values>
+  using all_of = std::is_same<std::integer_sequence<bool, true, values...>, std::integer_sequence<bool, values..., true>>;
+
+  static_assert(sizeof...(Passes) >= 2, "Fusing less than two passes is pointless");
+  static_assert(all_of<std::is_same<decltype(&Passes::user_recursion), bool (FunctionPassBase::*)(VertexPtr)>::value...>::value,
+                "Fused passes must not override user_recursion");
+  static_assert(all_of<FunctionPassTraits<Passes>::IsNullPtr::value...>::value,
+                "Fused passes must not have get_data");
+  static_assert(all_of<std::is_same<typename Passes::ExecuteType, FunctionPtr>::value...>::value,
+                "Fused passes must be executed on plain FunctionPtr");
+
+  using Indexes = std::make_index_sequence<sizeof...(Passes)>;
+
+  std::tuple<Passes...> passes_;
+  std::array<bool, sizeof...(Passes)> pass_enabled_{{}};
+
+public:
+  std::string get_description() override {
+    return get_description_impl(Indexes{});
+  }
+
+  bool check_function(FunctionPtr function) const override {
+    return check_function_impl(function, Indexes{});
+  }
+
+  void on_start() override {
+    on_start_impl(Indexes{});
+    // sub-passes' setup() has overwritten the stage name, restore the fused one
+    stage::set_name(get_description());
+  }
+
+  void on_finish() override {
+    on_finish_impl(Indexes{});
+  }
+
+  VertexPtr on_enter_vertex(VertexPtr vertex) override {
+    return on_enter_impl(vertex, Indexes{});
+  }
+
+  VertexPtr on_exit_vertex(VertexPtr vertex) override {
+    return on_exit_impl(vertex, Indexes{});
+  }
+
+private:
+  template<size_t... Is>
+  std::string get_description_impl(std::index_sequence<Is...>) {
+    std::string description;
+    (void)std::initializer_list<int>{(description += (Is ? " + " : "") + std::get<Is>(passes_).get_description(), 0)...};
+    return description;
+  }
+
+  template<size_t... Is>
+  bool check_function_impl(FunctionPtr function, std::index_sequence<Is...>) const {
+    bool any_enabled = false;
+    (void)std::initializer_list<int>{(any_enabled = any_enabled || std::get<Is>(passes_).check_function(function), 0)...};
+    return any_enabled;
+  }
+
+  template<class PassT>
+  void start_one(PassT &pass, bool &enabled) {
+    enabled = pass.check_function(current_function);
+    if (enabled) {
+      pass.setup(current_function);
+      pass.on_start();
+    }
+  }
+
+  template<size_t... Is>
+  void on_start_impl(std::index_sequence<Is...>) {
+    (void)std::initializer_list<int>{(start_one(std::get<Is>(passes_), pass_enabled_[Is]), 0)...};
+  }
+
+  template<size_t... Is>
+  void on_finish_impl(std::index_sequence<Is...>) {
+    (void)std::initializer_list<int>{(pass_enabled_[Is] ? (void)std::get<Is>(passes_).on_finish() : (void)0, 0)...};
+  }
+
+  template<size_t... Is>
+  VertexPtr on_enter_impl(VertexPtr vertex, std::index_sequence<Is...>) {
+    (void)std::initializer_list<int>{(pass_enabled_[Is] ? (void)(vertex = std::get<Is>(passes_).on_enter_vertex(vertex)) : (void)0, 0)...};
+    return vertex;
+  }
+
+  template<size_t... Is>
+  VertexPtr on_exit_impl(VertexPtr vertex, std::index_sequence<Is...>) {
+    constexpr size_t last = sizeof...(Passes) - 1;
+    (void)std::initializer_list<int>{(pass_enabled_[last - Is] ? (void)(vertex = std::get<last - Is>(passes_).on_exit_vertex(vertex)) : (void)0, 0)...};
+    return vertex;
+  }
+};
+
@@ -1509,16 +1509,24 @@ VertexAdaptor<op_function> GenTree::get_function(vk::string_view phpdoc_str, Fun
     kphp_error(!cur_function->return_typehint.empty(), "Expected return typehint after :");
   }
 
+  const bool kphp_required_flag = phpdoc_str.find("@kphp-required") != std::string::npos ||
+                                  phpdoc_str.find("@kphp-lib-export") != std::string::npos;
+  // a plain global function can be deferred: a share of parsed functions never becomes required,
+  // so their bodies are saved as token ranges and turned into trees only on the first require
+  const bool deferrable = !is_lambda && !cur_class && !kphp_required_flag && !processing_file->is_builtin();
+
   // then we have '{ cmd }' or ';' — function is marked as func_extern in the latter case
   if (test_expect(tok_opbrc)) {
     CE(!kphp_error(!cur_function->modifiers.is_abstract(), fmt_format("abstract methods must have empty body: {}", cur_function->get_human_readable_name())));
-    is_top_of_the_function_ = true;
-    cur_function->root->cmd_ref() = get_statement().as<op_seq>();
-    CE(!kphp_error(cur_function->root->cmd(), "Failed to parse function body"));
-    if (cur_function->is_constructor()) {
-      func_force_return(cur_function->root, ClassData::gen_vertex_this(Location(line_num)));
-    } else {
-      func_force_return(cur_function->root);
+    if (!deferrable || !try_defer_function_body()) {
+      is_top_of_the_function_ = true;
+      cur_function->root->cmd_ref() = get_statement().as<op_seq>();
+      CE(!kphp_error(cur_function->root->cmd(), "Failed to parse function body"));
+      if (cur_function->is_constructor()) {
+        func_force_return(cur_function->root, ClassData::gen_vertex_this(Location(line_num)));
+      } else {
+        func_force_return(cur_function->root);
+      }
     }
   } else {
     CE(!kphp_error(cur_function->modifiers.is_abstract() || processing_file->is_builtin(), "function must have non-empty body"));
@@ -1540,8 +1548,6 @@ VertexAdaptor<op_function> GenTree::get_function(vk::string_view phpdoc_str, Fun
     // the function is ready, register it;
     // the constructor is registered later, after the entire class is parsed
     if (!cur_function->is_constructor()) {
-      const bool kphp_required_flag = phpdoc_str.find("@kphp-required") != std::string::npos ||
-                                      phpdoc_str.find("@kphp-lib-export") != std::string::npos;
       const bool auto_require = cur_function->is_extern()
                                 || cur_function->modifiers.is_abstract()
                                 || cur_function->modifiers.is_instance()
@@ -1557,6 +1563,64 @@ VertexAdaptor<op_function> GenTree::get_function(vk::string_view phpdoc_str, Fun
   return {};
 }
 
+// tries to save the body of cur_function (cur points at its opening brace) as a token range
+// instead of building the tree right away; the tree is then built lazily on the first require.
+// bodies that declare nested functions, lambdas or classes are parsed eagerly, so that laziness
+// never delays a registration in the global scope
+bool GenTree::try_defer_function_body() {
+  kphp_assert(cur->type() == tok_opbrc);
+  const auto body_begin = cur;
+  int depth = 0;
+  auto body_end = cur;
+  for (; body_end != end; ++body_end) {
+    const TokenType tp = body_end->type();
+    if (vk::any_of_equal(tp, tok_function, tok_class, tok_interface, tok_trait)) {
+      return false;
+    }
+    if (tp == tok_opbrc) {
+      depth++;
+    } else if (tp == tok_clbrc && --depth == 0) {
+      ++body_end;
+      break;
+    }
+  }
+  if (depth != 0) {
+    return false;   // unbalanced braces: let the eager path report the error
+  }
+
+  auto *body_tokens = new std::vector<Token>(body_begin, body_end);
+  body_tokens->emplace_back(tok_end);
+  cur_function->deferred_body_tokens = body_tokens;
+  cur_function->root->cmd_ref() = VertexAdaptor<op_seq>::create();
+  while (cur != body_end) {
+    next_cur();
+  }
+  return true;
+}
+
+void GenTree::lazy_parse_deferred_body(FunctionPtr function, DataStream<FunctionPtr> &os) {
+  std::unique_ptr<std::vector<Token>> body_tokens{function->deferred_body_tokens};
+  function->deferred_body_tokens = nullptr;
+
+  // the parse can be triggered in the middle of another stage: save its location and restore below
+  const Location saved_location = stage::get_location();
+  stage::set_file(function->file_id);
+  stage::set_function(function);
+
+  GenTree body_gen{std::move(*body_tokens), function->file_id, os};
+  StackPushPop<FunctionPtr> f_alive(body_gen.functions_stack, body_gen.cur_function, function);
+  body_gen.is_top_of_the_function_ = true;
+  auto cmd = body_gen.get_statement();
+  kphp_error(cmd, "Failed to parse function body");
+  if (cmd) {
+    function->root->cmd_ref() = cmd.as<op_seq>();
+    func_force_return(function->root);
+  }
+  // bodies with lambdas are never deferred, so there is nothing else to require here
+  kphp_assert(body_gen.lambda_generators.empty());
+  stage::set_location(saved_location);
+}
+
 bool GenTree::check_seq_end() {
   if (!test_expect(tok_clbrc)) {
     kphp_error (0, "Failed to parse sequence");
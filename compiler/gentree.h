@@ -131,6 +131,9 @@ public:
   VertexAdaptor<op_do> get_do();
   VertexAdaptor<op_switch> get_switch();
   VertexAdaptor<op_shape> get_shape();
+  // builds the body tree of a function whose body was deferred at parse time (see try_defer_function_body)
+  static void lazy_parse_deferred_body(FunctionPtr function, DataStream<FunctionPtr> &os);
+
   bool parse_function_uses(std::vector<VertexAdaptor<op_func_param>> *uses_of_lambda);
   static bool check_uses_and_args_are_not_intersecting(const std::vector<VertexAdaptor<op_func_param>> &uses, const VertexRange &params);
   VertexAdaptor<op_func_call> get_anonymous_function(bool is_static = false);
@@ -159,6 +162,8 @@ public:
 private:
   std::string get_typehint();
 
+  bool try_defer_function_body();
+
   VertexAdaptor<op_func_param_list> parse_cur_function_param_list();
 
   VertexAdaptor<op_empty> get_static_field_list(vk::string_view phpdoc_str, FieldModifiers modifiers);
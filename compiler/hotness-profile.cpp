@@ -0,0 +1,49 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/hotness-profile.h"
+
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+
+#include "compiler/compiler-core.h"
+#include "compiler/data/function-data.h"
+#include "compiler/stage.h"
+
+static std::unordered_map<std::string, bool> load_hotness_profile() {
+  std::unordered_map<std::string, bool> is_hot_by_name;
+  const std::string &path = G->settings().hotness_profile_file.get();
+  if (path.empty()) {
+    return is_hot_by_name;
+  }
+  FILE *f = fopen(path.c_str(), "r");
+  kphp_error(f, fmt_format("Can't open hotness profile file [{}]", path));
+  if (!f) {
+    return is_hot_by_name;
+  }
+  double weight = 0;
+  char name[4096];
+  while (fscanf(f, "%lf %4095s", &weight, name) == 2) {
+    is_hot_by_name[name] = weight > 0;
+  }
+  fclose(f);
+  return is_hot_by_name;
+}
+
+static const std::unordered_map<std::string, bool> &get_hotness_profile() {
+  static const std::unordered_map<std::string, bool> profile = load_hotness_profile();
+  return profile;
+}
+
+void apply_hotness_profile(FunctionPtr function) {
+  const auto &profile = get_hotness_profile();
+  if (profile.empty()) {
+    return;
+  }
+  auto it = profile.find(function->name);
+  if (it != profile.end()) {
+    function->hotness = it->second ? FunctionData::code_hotness::hot : FunctionData::code_hotness::cold;
+  }
+}
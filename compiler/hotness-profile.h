@@ -0,0 +1,13 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include "compiler/data/data_ptr.h"
+
+// the hotness profile is a text file with a `<weight> <function_name>` line per function,
+// usually dumped from production call counters; a positive weight marks the function hot,
+// a zero weight marks it cold, functions not listed stay unannotated;
+// the profile is loaded lazily on the first call and shared by all passes that consume it
+void apply_hotness_profile(FunctionPtr function);
@@ -247,7 +247,7 @@ void Index::save_into_index_file() {
 
   for (const auto &file : get_files()) {
     const std::string path = file->path.substr(dir.length());
-    if (fprintf(f.get(), "%s %llu %llu\n", path.c_str(), file->crc64, file->crc64_with_comments) <= 0) {
+    if (fprintf(f.get(), "%s %llu %llu %.6f\n", path.c_str(), file->crc64, file->crc64_with_comments, file->codegen_duration_hint) <= 0) {
       kphp_warning (fmt_format("Can't write crc32 into tmp index file '{}'", index_file_tmp_name));
       return;
     }
@@ -280,11 +280,19 @@ void Index::load_from_index_file() {
     return;
   }
 
+  char line[601] = {0};
   char tmp[501] = {0};
   unsigned long long crc64 = -1;
   unsigned long long crc64_with_comments = -1;
+  double codegen_duration_hint = 0;
   for (size_t i = 0; i < files; i++) {
-    if (fscanf(f.get(), "%500s %llu %llu", tmp, &crc64, &crc64_with_comments) != 3) {
+    if (fgets(line, sizeof(line), f.get()) == nullptr) {
+      kphp_warning(fmt_format("Can't read line from index file '{}:{}'", index_file, i + 2));
+      return;
+    }
+    // the duration column is optional: index files written by older versions have only three
+    codegen_duration_hint = 0;
+    if (sscanf(line, "%500s %llu %llu %lf", tmp, &crc64, &crc64_with_comments, &codegen_duration_hint) < 3) {
       kphp_warning(fmt_format("Can't read crc32 from index file '{}:{}'", index_file, i + 2));
       return;
     }
@@ -292,6 +300,7 @@ void Index::load_from_index_file() {
     if (file && file->mtime < file_index_mtime) {
       file->crc64 = crc64;
       file->crc64_with_comments = crc64_with_comments;
+      file->codegen_duration_hint = codegen_duration_hint;
     }
   }
 }
@@ -39,6 +39,9 @@ public:
   std::vector<std::string> lib_includes;
   bool compile_with_debug_info_flag{true};
   bool is_changed{false};
+  // seconds it took to generate this file in a previous build (0 if unknown);
+  // used only as a scheduling hint to start the heaviest codegen tasks first
+  double codegen_duration_hint{0};
 
   explicit File(const std::string &path = {});
   long long read_stat() __attribute__ ((warn_unused_result));
@@ -28,6 +28,8 @@ public:
 
   inline bool is_any_key() const { return id == 0; }
 
+  inline size_t hash() const { return static_cast<size_t>(id); }
+
   inline bool is_int_key() const { return id > 0 && id % 2 == 1; }
 
   inline bool is_string_key() const { return id > 0 && id % 2 == 0; }
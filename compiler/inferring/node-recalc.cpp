@@ -163,7 +163,9 @@ void NodeRecalc::on_changed() {
   __sync_synchronize();
 
   //fmt_fprintf(stderr, "{} : {} -> {}\n", node_->get_description(), type_out(node_->get_type()), type_out(new_type()));
-  node_->set_type(new_type_);
+  // structurally identical recalc results of different nodes collapse into one shared instance,
+  // so millions of nodes inferred to the same array<int>-like shapes don't each keep a deep copy
+  node_->set_type(TypeData::intern(new_type_));
   new_type_ = nullptr;
 
   __sync_synchronize();
@@ -312,6 +312,63 @@ TypeData *TypeData::clone() const {
   return new TypeData(*this);
 }
 
+uint64_t TypeData::structural_hash() const {
+  // generation_ and parent_ are deliberately ignored: they are bookkeeping
+  // of the inference process, not a part of the type structure
+  uint64_t hash = 0x9e3779b97f4a7c15ULL;
+  hash = hash * 31 + ptype_;
+  hash = hash * 31 + flags_;
+  for (ClassPtr klass : class_type_) {
+    hash ^= std::hash<ClassPtr>{}(klass);   // class_type_ order is unspecified
+  }
+  if (anykey_value != nullptr) {
+    hash = hash * 31 + anykey_value->structural_hash();
+  }
+  for (const auto &subkey : subkeys_values) {  // subkeys order is unspecified too
+    hash ^= subkey.first.hash() * 0x9e3779b97f4a7c15ULL + subkey.second->structural_hash();
+  }
+  return hash != 0 ? hash : 1;    // TSHashTable treats hash 0 as an empty slot
+}
+
+bool TypeData::structurally_equals(const TypeData &rhs) const {
+  if (ptype_ != rhs.ptype_ || flags_ != rhs.flags_) {
+    return false;
+  }
+  if (std::distance(class_type_.begin(), class_type_.end()) != std::distance(rhs.class_type_.begin(), rhs.class_type_.end()) ||
+      !vk::all_of(class_type_, [&](ClassPtr c) { return vk::contains(rhs.class_type_, c); })) {
+    return false;
+  }
+  if ((anykey_value == nullptr) != (rhs.anykey_value == nullptr) ||
+      (anykey_value != nullptr && !anykey_value->structurally_equals(*rhs.anykey_value))) {
+    return false;
+  }
+  if (subkeys_values.size() != rhs.subkeys_values.size()) {
+    return false;
+  }
+  for (const auto &subkey : subkeys_values) {
+    const TypeData *rhs_value = rhs.subkeys_values.find(subkey.first);
+    if (rhs_value == nullptr || !subkey.second->structurally_equals(*rhs_value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static TSHashTable<std::forward_list<const TypeData *>> interned_types_ht;
+
+const TypeData *TypeData::intern(TypeData *type_data) {
+  auto *ht_node = interned_types_ht.at(type_data->structural_hash());
+  AutoLocker<Lockable *> locker(ht_node);
+  for (const TypeData *existing : ht_node->data) {
+    if (existing->structurally_equals(*type_data)) {
+      delete type_data;
+      return existing;
+    }
+  }
+  ht_node->data.push_front(type_data);
+  return type_data;
+}
+
 void TypeData::convert_Unknown_to_Any() {
   if (get_real_ptype() == tp_Unknown) {
     set_ptype(tp_Any);
@@ -791,6 +848,9 @@ bool can_be_same_type(const TypeData *type1, const TypeData *type2) {
 
 // compare types in sense of cpp type out
 bool are_equal_types(const TypeData *type1, const TypeData *type2) {
+  if (type1 == type2) {  // inferred types are hash-consed, so the same structure is usually the same instance
+    return true;
+  }
   if (type1 == nullptr) {
     return type2 == nullptr;
   }
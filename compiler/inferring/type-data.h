@@ -144,6 +144,13 @@ public:
   TypeData *clone() const;
   void convert_Unknown_to_Any();
 
+  uint64_t structural_hash() const;
+  bool structurally_equals(const TypeData &rhs) const;
+  // hash-consing of inferred types: returns the shared instance structurally equal to type_data,
+  // taking ownership of it (it is deleted when an equal instance is already interned);
+  // the returned instance is shared between tinf nodes and must never be mutated
+  static const TypeData *intern(TypeData *type_data);
+
   TypeData *lookup_at(const Key &key) const;
   lookup_iterator lookup_begin() const;
   lookup_iterator lookup_end() const;
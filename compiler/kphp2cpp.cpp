@@ -239,6 +239,14 @@ int main(int argc, char *argv[]) {
              'T', "tl-schema", "KPHP_TL_SCHEMA");
   parser.add("Generate storers and fetchers for internal tl functions", settings->gen_tl_internals,
              "gen-tl-internals", "KPHP_GEN_TL_INTERNALS");
+  parser.add("Annotate functions hot/cold from a profile file; every line is `<weight> <function_name>`, positive weight means hot, zero means cold", settings->hotness_profile_file,
+             "hotness-profile", "KPHP_HOTNESS_PROFILE");
+  parser.add("Profile guided optimization mode: 'collect' builds an instrumented binary that writes profile data into --pgo-profile, 'apply' rebuilds using that data", settings->pgo_mode,
+             "pgo", "KPHP_PGO", "none", {"none", "collect", "apply"});
+  parser.add("Directory with pgo profile data: the instrumented binary writes there, the apply rebuild reads from there; raw clang profiles are merged automatically", settings->pgo_profile,
+             "pgo-profile", "KPHP_PGO_PROFILE");
+  parser.add("Post-link binary layout optimization: perf2bolt data file, the linked binary is rewritten by llvm-bolt using it", settings->bolt_profile,
+             "bolt-profile", "KPHP_BOLT_PROFILE");
   parser.add("All compile time warnings will be errors", settings->error_on_warns,
              'W', "Werror", "KPHP_ERROR_ON_WARNINGS");
   parser.add("Print all warnings to file, otherwise warnings are printed to stderr", settings->warnings_file,
@@ -253,6 +261,10 @@ int main(int argc, char *argv[]) {
              "stats-file", "KPHP_STATS_FILE");
   parser.add("Save transpilation metrics to file", settings->compilation_metrics_file,
              "compilation-metrics-file", "KPHP_COMPILATION_METRICS_FILE");
+  parser.add("Save transpilation metrics as a JSON document to file", settings->compilation_metrics_json_file,
+             "compilation-metrics-json-file", "KPHP_COMPILATION_METRICS_JSON_FILE");
+  parser.add("Save a Chrome-trace timeline of the transpilation pipeline to file", settings->profiler_trace_file,
+             "profiler-trace-file", "KPHP_PROFILER_TRACE_FILE");
   parser.add("Override kphp version string", settings->override_kphp_version,
              "kphp-version-override", "KPHP_VERSION_OVERRIDE");
   parser.add("Specify the compiled php code version", settings->php_code_version,
@@ -263,6 +275,8 @@ int main(int argc, char *argv[]) {
              "extra-cxx-flags", "KPHP_EXTRA_CXXFLAGS", get_default_extra_cxxflags());
   parser.add("Extra linker flags for building the output binary", settings->extra_ld_flags,
              "extra-linker-flags", "KPHP_EXTRA_LDFLAGS", get_default_extra_ldflags());
+  parser.add("Heap allocator linked into the output binary; replaces glibc malloc for everything outside script memory", settings->php_allocator,
+             "allocator", "KPHP_ALLOCATOR", "glibc", {"glibc", "jemalloc", "tcmalloc"});
   parser.add("C++ compiler debug level for building the output binary", settings->debug_level,
              "debug-level", "KPHP_DEBUG_LEVEL");
   parser.add("Archive creator for building the output binary", settings->archive_creator,
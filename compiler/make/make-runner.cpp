@@ -25,6 +25,13 @@ void MakeRunner::run_target(Target *target) {
 
   if (!ready) {
     target->compute_priority();
+    // longest-job-first: a compile time measured on the previous run beats the
+    // file-size heuristic, so known stragglers start as early as possible and
+    // the final link isn't gated on one late huge translation unit
+    auto it = compile_time_history_.find(target->get_name());
+    if (it != compile_time_history_.end()) {
+      target->priority = static_cast<long long>(it->second * 1e6);
+    }
     pending_jobs.push(target);
   } else {
     ready_target(target);
@@ -128,8 +135,10 @@ bool MakeRunner::finish_job(int pid, int return_code, int by_signal) {
   auto it = jobs.find(pid);
   assert (it != jobs.end());
   Target *target = it->second;
+  double passed = get_utime(CLOCK_MONOTONIC) - target->start_time;
+  compile_time_history_[target->get_name()] = passed;
+  history_updated_ = true;
   if (stats_file_) {
-    double passed = get_utime(CLOCK_MONOTONIC) - target->start_time;
     fmt_fprintf(stats_file_, "{}s {}\n", passed, target->get_name());
   }
   jobs.erase(it);
@@ -265,11 +274,41 @@ bool MakeRunner::make_target(Target *target, int jobs_count) {
   return !fail_flag && target->is_ready;
 }
 
+void MakeRunner::load_compile_time_history() {
+  FILE *f = fopen(history_path_.c_str(), "r");
+  if (!f) {
+    return;
+  }
+  double seconds = 0;
+  char name[4096];
+  while (fscanf(f, "%lf %4095[^\n]\n", &seconds, name) == 2) {
+    compile_time_history_[name] = seconds;
+  }
+  fclose(f);
+}
+
+void MakeRunner::save_compile_time_history() {
+  if (!history_updated_) {
+    return;
+  }
+  FILE *f = fopen(history_path_.c_str(), "w");
+  if (!f) {
+    return;
+  }
+  for (const auto &name_and_time : compile_time_history_) {
+    fmt_fprintf(f, "{} {}\n", name_and_time.second, name_and_time.first);
+  }
+  fclose(f);
+}
+
 MakeRunner::MakeRunner(FILE *stats_file) noexcept:
-  stats_file_(stats_file) {
+  stats_file_(stats_file),
+  history_path_(G->settings().dest_dir.get() + "compile_times.txt") {
+  load_compile_time_history();
 }
 
 MakeRunner::~MakeRunner() {
+  save_compile_time_history();
   //TODO: delete targets
   for (auto target : all_targets) {
     delete target;
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <queue>
+#include <string>
 
 #include "common/mixin/not_copyable.h"
 
@@ -24,6 +25,15 @@ private:
   std::vector<Target *> all_targets;
   FILE *stats_file_{nullptr};
 
+  // measured compile times of the previous run, target name -> seconds;
+  // used for longest-job-first scheduling of pending targets
+  std::map<std::string, double> compile_time_history_;
+  std::string history_path_;
+  bool history_updated_{false};
+
+  void load_compile_time_history();
+  void save_compile_time_history();
+
   std::priority_queue<Target *, std::vector<Target *>, compare_by_priority> pending_jobs;
   std::map<int, Target *> jobs;
 
@@ -4,10 +4,12 @@
 
 #include "compiler/make/make.h"
 
+#include <cstdlib>
 #include <forward_list>
 #include <queue>
 #include <unordered_map>
 
+#include "common/algorithms/contains.h"
 #include "common/wrappers/mkdir_recursive.h"
 
 #include "compiler/compiler-core.h"
@@ -272,9 +274,26 @@ static std::unordered_map<File *, long long> create_dep_mtime(const Index &cpp_d
   return dep_mtime;
 }
 
+// objects built with -fprofile-use must be rebuilt when the profile data
+// changes, even though no source changed: fold the profile mtime into the
+// dep mtime of every cpp target
+static long long get_pgo_profile_mtime() {
+  const auto &settings = G->settings();
+  if (settings.pgo_mode.get() != "apply") {
+    return 0;
+  }
+  std::string profile_path = settings.pgo_profile.get();
+  if (vk::contains(settings.cxx.get(), "clang")) {
+    profile_path += "/merged.profdata";
+  }
+  File profile(profile_path);
+  return profile.read_stat() > 0 ? profile.mtime : 0;
+}
+
 static std::vector<File *> create_obj_files(MakeSetup *make, Index &obj_dir, const Index &cpp_dir,
                                             const std::forward_list<Index> &imported_headers) {
   std::unordered_map<File *, long long> dep_mtime = create_dep_mtime(cpp_dir, imported_headers);
+  const long long profile_mtime = get_pgo_profile_mtime();
   std::vector<File *> objs;
   for (const auto &cpp_file : cpp_dir.get_files()) {
     if (cpp_file->ext == ".cpp") {
@@ -282,7 +301,7 @@ static std::vector<File *> create_obj_files(MakeSetup *make, Index &obj_dir, con
       obj_file->compile_with_debug_info_flag = cpp_file->compile_with_debug_info_flag;
       make->create_cpp2obj_target(cpp_file, obj_file);
       Target *cpp_target = cpp_file->target;
-      cpp_target->force_changed(dep_mtime[cpp_file]);
+      cpp_target->force_changed(std::max(dep_mtime[cpp_file], profile_mtime));
       objs.push_back(obj_file);
     }
   }
@@ -352,6 +371,34 @@ static bool kphp_make_static_lib(File &static_lib, Index &obj_dir, const Index &
   return make.make_target(&static_lib, static_cast<int32_t>(settings.jobs_count.get()));
 }
 
+static bool run_tool_cmd(const std::string &cmd) {
+  fmt_fprintf(stderr, "{}\n", cmd);
+  return std::system(cmd.c_str()) == 0;
+}
+
+// clang writes one raw profile per process (every worker of a forked master),
+// the apply rebuild needs them merged; gcc .gcda files accumulate on their own
+static bool kphp_make_pgo_merge(const CompilerSettings &settings) {
+  if (settings.pgo_mode.get() != "apply" || !vk::contains(settings.cxx.get(), "clang")) {
+    return true;
+  }
+  const std::string &profile_dir = settings.pgo_profile.get();
+  return run_tool_cmd("llvm-profdata merge -output=" + profile_dir + "/merged.profdata " + profile_dir + "/*.profraw");
+}
+
+// post-link layout optimization from production perf data (converted with
+// perf2bolt); the linked binary is rewritten in place
+static bool kphp_make_bolt(File &bin, const CompilerSettings &settings) {
+  std::string bolted_path = bin.path + ".bolt";
+  bool ok = run_tool_cmd("llvm-bolt " + bin.path + " -data=" + settings.bolt_profile.get() + " -o " + bolted_path +
+                         " -reorder-blocks=ext-tsp -reorder-functions=hfsort -split-functions -split-all-cold -use-gnu-stack");
+  if (ok) {
+    ok = rename(bolted_path.c_str(), bin.path.c_str()) == 0;
+    kphp_error(ok, fmt_format("Can't move '{}' over '{}': {}", bolted_path, bin.path, strerror(errno)));
+  }
+  return ok;
+}
+
 static std::forward_list<Index> collect_imported_headers() {
   std::forward_list<Index> imported_headers;
   for (const auto &lib: G->get_libs()) {
@@ -395,6 +442,10 @@ void run_make() {
     ok = !gch_dir.empty();
     kphp_error (ok, "Make precompiled header failed");
   }
+  if (ok) {
+    ok = kphp_make_pgo_merge(settings);
+    kphp_error (ok, "Merge of pgo profile data failed");
+  }
   if (ok) {
     auto lib_header_dirs = collect_imported_headers();
     ok = settings.is_static_lib_mode()
@@ -402,6 +453,10 @@ void run_make() {
          : kphp_make(bin_file, obj_index, G->get_index(), collect_imported_libs(), lib_header_dirs, settings, gch_dir, make_stats_file);
     kphp_error (ok, "Make failed");
   }
+  if (ok && !settings.is_static_lib_mode() && !settings.bolt_profile.get().empty()) {
+    ok = kphp_make_bolt(bin_file, settings);
+    kphp_error (ok, "Bolt post-link step failed");
+  }
 
   if (make_stats_file) {
     fclose(make_stats_file);
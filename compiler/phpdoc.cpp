@@ -5,6 +5,7 @@
 #include "compiler/phpdoc.h"
 
 #include <cstdio>
+#include <forward_list>
 #include <utility>
 
 #include "common/termformat/termformat.h"
@@ -15,6 +16,7 @@
 #include "compiler/lexer.h"
 #include "compiler/name-gen.h"
 #include "compiler/stage.h"
+#include "compiler/threading/hash-table.h"
 #include "compiler/utils/string-utils.h"
 
 using std::vector;
@@ -51,12 +53,7 @@ const std::map<string, php_doc_tag::doc_type> php_doc_tag::str2doc_type = {
   {"@kphp-profile-allow-inline", kphp_profile_allow_inline},
 };
 
-vector<php_doc_tag> parse_php_doc(vk::string_view phpdoc) {
-  if (phpdoc.empty()) {
-    return {};
-  }
-
-  int line_num_of_function_declaration = stage::get_line();
+static vector<php_doc_tag> parse_php_doc_impl(vk::string_view phpdoc, int line_num_of_function_declaration) {
 
   vector<string> lines(1);
   bool have_star = false;
@@ -122,6 +119,35 @@ vector<php_doc_tag> parse_php_doc(vk::string_view phpdoc) {
   return result;
 }
 
+// the same phpdoc is re-tokenized by every phpdoc_find_tag* / phpdoc_tag_exists call,
+// often several times per pipe for one function, so parsed tag lists are cached globally;
+// the stage line is a part of the key, as it is baked into the resulting tags' line_num
+const vector<php_doc_tag> &parse_php_doc(vk::string_view phpdoc) {
+  static const vector<php_doc_tag> no_tags;
+  if (phpdoc.empty()) {
+    return no_tags;
+  }
+
+  struct ParsedPhpDoc {
+    std::string phpdoc;
+    int line_num;
+    vector<php_doc_tag> tags;
+  };
+  static TSHashTable<std::forward_list<ParsedPhpDoc>> parsed_php_docs_ht;
+
+  const int line_num = stage::get_line();
+  uint64_t hash = std::hash<vk::string_view>{}(phpdoc) * 31 + static_cast<uint64_t>(line_num + 1);
+  auto *ht_node = parsed_php_docs_ht.at(hash != 0 ? hash : 1);
+  AutoLocker<Lockable *> locker(ht_node);
+  for (const auto &cached : ht_node->data) {
+    if (cached.line_num == line_num && cached.phpdoc == phpdoc) {
+      return cached.tags;
+    }
+  }
+  ht_node->data.push_front(ParsedPhpDoc{std::string{phpdoc}, line_num, parse_php_doc_impl(phpdoc, line_num)});
+  return ht_node->data.front().tags;
+}
+
 VertexPtr PhpDocTypeRuleParser::parse_classname(const std::string &phpdoc_class_name) {
   const std::string &class_name = resolve_uses(current_function, phpdoc_class_name, '\\');
   ClassPtr klass = G->get_class(class_name);
@@ -96,7 +96,8 @@ private:
   VertexPtr parse_type_expression();
 };
 
-std::vector<php_doc_tag> parse_php_doc(vk::string_view phpdoc);
+// returns a reference to a globally cached parsed tag list, valid until the process exits
+const std::vector<php_doc_tag> &parse_php_doc(vk::string_view phpdoc);
 PhpDocTagParseResult phpdoc_parse_type_and_var_name(vk::string_view phpdoc_tag_str, FunctionPtr current_function);
 
 PhpDocTagParseResult phpdoc_find_tag(vk::string_view phpdoc, php_doc_tag::doc_type tag_type, FunctionPtr current_function);
@@ -2,13 +2,20 @@
 // Copyright (c) 2020 LLC «V Kontakte»
 // Distributed under the GPL v3 License, see LICENSE.notice.txt
 
+#include <atomic>
+#include <functional>
 #include <queue>
+#include <unistd.h>
+
 #include "compiler/pipes/calc-bad-vars.h"
 
 #include "compiler/compiler-core.h"
 #include "compiler/data/class-data.h"
 #include "compiler/data/src-file.h"
 #include "compiler/function-pass.h"
+#include "compiler/scheduler/scheduler-base.h"
+#include "compiler/scheduler/task.h"
+#include "compiler/threading/tls.h"
 #include "compiler/utils/idmap.h"
 
 /*** Common algorithm ***/
@@ -59,6 +66,22 @@ private:
     }
   }
 
+  // a scheduler task merging a slice of one topological wave; the sync node's
+  // thread spins until every slice of the wave reports completion
+  class MergeWaveTask : public Task {
+    std::function<void()> merge_slice_;
+    std::atomic<int> &slices_left_;
+  public:
+    MergeWaveTask(std::function<void()> merge_slice, std::atomic<int> &slices_left) :
+      merge_slice_(std::move(merge_slice)),
+      slices_left_(slices_left) {
+    }
+    void execute() final {
+      merge_slice_();
+      --slices_left_;
+    }
+  };
+
 public:
   void run(const GraphT &graph, const GraphT &rev_graph, const vector<VertexT> &vertices,
            MergeReachalbeCallback<VertexT> *callback) {
@@ -69,9 +92,17 @@ public:
       dfs(vertex, rev_graph, &was, &topsorted);
     }
 
+    // condense the graph into strongly connected components; they come out in
+    // topological order — every edge of a component points into an earlier one
     std::fill(was.begin(), was.end(), 0);
     vector<int> was_color(vertex_n + 1, 0);
     int current_color = 0;
+    struct ComponentData {
+      vector<VertexT> component;
+      vector<VertexT> edges;
+    };
+    std::vector<ComponentData> components;
+    std::vector<int> depth; // per component: the longest edge chain below it
     for (auto vertex_it = topsorted.rbegin(); vertex_it != topsorted.rend(); ++vertex_it) {
       auto &vertex = *vertex_it;
       if (was[vertex]) {
@@ -82,7 +113,45 @@ public:
       dfs_component(vertex, graph, ++current_color, &was,
                     &was_color, &component, &edges);
 
-      callback->for_component(component, edges);
+      int max_edge_depth = 0;
+      for (const auto &edge : edges) {
+        max_edge_depth = std::max(max_edge_depth, depth[was[edge] - 1]);
+      }
+      depth.push_back(max_edge_depth + 1);
+      components.emplace_back(ComponentData{std::move(component), std::move(edges)});
+    }
+
+    // components of equal depth never reference each other, so each wave can be
+    // merged concurrently on the scheduler threads once all earlier waves are done
+    std::vector<std::vector<int>> waves;
+    for (int i = 0; i < (int)components.size(); i++) {
+      if (depth[i] > (int)waves.size()) {
+        waves.resize(depth[i]);
+      }
+      waves[depth[i] - 1].push_back(i);
+    }
+
+    const int threads_n = static_cast<int>(G->settings().threads_count.get());
+    for (const auto &wave : waves) {
+      const int slices_n = std::min<int>(threads_n, (int)wave.size());
+      // with a single thread there is nobody to drain the task pull while we wait
+      if (slices_n <= 1) {
+        for (int component_i : wave) {
+          callback->for_component(components[component_i].component, components[component_i].edges);
+        }
+        continue;
+      }
+      std::atomic<int> slices_left{slices_n};
+      for (int slice_i = 0; slice_i < slices_n; slice_i++) {
+        register_async_task(new MergeWaveTask([&, slice_i]() {
+          for (int component_i = slice_i; component_i < (int)wave.size(); component_i += slices_n) {
+            callback->for_component(components[wave[component_i]].component, components[wave[component_i]].edges);
+          }
+        }, slices_left));
+      }
+      while (slices_left > 0) {
+        usleep(250);
+      }
     }
   }
 };
@@ -119,21 +188,46 @@ class CalcBadVars {
 private:
   class MergeBadVarsCallback : public MergeReachalbeCallback<FunctionPtr> {
     IdMap<vector<VarPtr>> tmp_vars;
+    int bad_vars_n;
+    // per-thread dedup bitset over the pre-numbered bad-var universe; only the
+    // words of actually merged vars are cleared afterwards, so a component costs
+    // O(its input sets), not O(universe)
+    TLS<std::vector<uint64_t>> seen_vars;
   public:
-    explicit MergeBadVarsCallback(IdMap<vector<VarPtr>> tmp_vars) : tmp_vars(std::move(tmp_vars)) {}
+    MergeBadVarsCallback(IdMap<vector<VarPtr>> tmp_vars, int bad_vars_n) :
+      tmp_vars(std::move(tmp_vars)),
+      bad_vars_n(bad_vars_n) {
+    }
     void for_component(const vector<FunctionPtr> &component, const vector<FunctionPtr> &edges) override {
-      std::unordered_set<VarPtr> bad_vars_uniq;
+      std::vector<uint64_t> &seen = *seen_vars;
+      seen.resize((static_cast<size_t>(bad_vars_n) + 63) / 64, 0);
+
+      auto bad_vars = new vector<VarPtr>();
+      auto add_var = [&](VarPtr var) {
+        const int index = get_index(var);
+        if (!(seen[index >> 6] & (1ULL << (index & 63)))) {
+          seen[index >> 6] |= 1ULL << (index & 63);
+          bad_vars->push_back(var);
+        }
+      };
 
       for (FunctionPtr f : component) {
-        bad_vars_uniq.insert(tmp_vars[f].begin(), tmp_vars[f].end());
+        for (VarPtr var : tmp_vars[f]) {
+          add_var(var);
+        }
       }
 
       for (FunctionPtr f : edges) {
         kphp_assert(f->bad_vars != nullptr);
-        bad_vars_uniq.insert(f->bad_vars->begin(), f->bad_vars->end());
+        for (VarPtr var : *f->bad_vars) {
+          add_var(var);
+        }
+      }
+
+      for (VarPtr var : *bad_vars) {
+        seen[get_index(var) >> 6] = 0;
       }
 
-      auto bad_vars = new vector<VarPtr>(bad_vars_uniq.begin(), bad_vars_uniq.end());
       for (FunctionPtr f : component) {
         f->bad_vars = bad_vars;
       }
@@ -148,9 +242,18 @@ private:
 
     IdMap<std::vector<VarPtr>> tmp_vars(call_graph.n);
 
+    // number the bad-var universe: the merge below dedups through a bitset
+    // indexed by these ids; a var listed by several functions is just numbered
+    // again — only its final id is used, and no two distinct vars share one
+    // (generate_ref_vars re-numbers vars later anyway)
+    int bad_vars_n = 0;
+
     for (int i = 0; i < call_graph.n; i++) {
       FunctionPtr func = call_graph.functions[i];
       tmp_vars[func] = std::move(dep_datas[i].used_global_vars);
+      for (VarPtr var : tmp_vars[func]) {
+        set_index(var, bad_vars_n++);
+      }
 
       if (func->is_resumable) {
         call_graph.graph[wait_func].push_back(func);
@@ -161,7 +264,7 @@ private:
       }
     }
 
-    MergeBadVarsCallback callback(std::move(tmp_vars));
+    MergeBadVarsCallback callback(std::move(tmp_vars), bad_vars_n);
     MergeReachalbe<FunctionPtr> merge_bad_vars;
     merge_bad_vars.run(call_graph.graph, call_graph.rev_graph, call_graph.functions, &callback);
   }
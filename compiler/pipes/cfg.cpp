@@ -8,6 +8,7 @@
 #include "compiler/function-pass.h"
 #include "compiler/gentree.h"
 #include "compiler/inferring/ifi.h"
+#include "compiler/threading/tls.h"
 #include "compiler/utils/dsu.h"
 #include "compiler/utils/idgen.h"
 #include "compiler/utils/string-utils.h"
@@ -85,9 +86,14 @@ class CFG {
   int cur_dfs_mark = 0;
   Node current_start;
 
+  // the per-var dfs scratch maps are not cleared between vars: an entry is valid
+  // only when its mark equals cur_dfs_mark, so switching to the next var is a
+  // single counter bump instead of O(nodes) fills per variable
   IdMap<int> node_was;
   IdMap<is_func_id_t> node_checked_type;
+  IdMap<int> node_checked_type_mark;
   IdMap<UsagePtr> node_mark_dfs;
+  IdMap<int> node_mark_dfs_mark;
   IdMap<int> node_mark_dfs_type_hint;
   IdMap<VarSplitPtr> var_split_data;
 
@@ -119,6 +125,7 @@ class CFG {
   void calc_used(Node v);
   void confirm_usage(VertexPtr, bool recursive_flags);
 
+  is_func_id_t get_checked_type(Node v) const;
   void dfs_checked_types(Node v, VarPtr var, is_func_id_t current_mask);
 
   bool try_uni_usages(UsagePtr usage, UsagePtr another_usage);
@@ -958,12 +965,13 @@ void CFG::compress_usages(std::vector<UsagePtr> &usages) {
 }
 
 void CFG::dfs_uni_rw_usages(Node v, UsagePtr usage) {
-  UsagePtr other_usage = node_mark_dfs[v];
+  UsagePtr other_usage = node_mark_dfs_mark[v] == cur_dfs_mark ? node_mark_dfs[v] : UsagePtr{};
   if (other_usage) {
     try_uni_usages(usage, other_usage);
     return;
   }
   node_mark_dfs[v] = usage;
+  node_mark_dfs_mark[v] = cur_dfs_mark;
 
   bool write_usage_found = false;
   for (auto another_usage : node_usages[v]) {
@@ -980,16 +988,17 @@ void CFG::dfs_uni_rw_usages(Node v, UsagePtr usage) {
 }
 
 void CFG::dfs_apply_type_hint(Node v, UsagePtr usage) {
-  UsagePtr other_usage = node_mark_dfs[v];
+  UsagePtr other_usage = node_mark_dfs_mark[v] == cur_dfs_mark ? node_mark_dfs[v] : UsagePtr{};
   if (other_usage && other_usage->type != usage_type_hint_t) {
     try_uni_usages(usage, other_usage);
   }
   // this check is needed to avoid the infinite loop (node_next is a graph with cycles)
-  if (node_mark_dfs_type_hint[v]) {
+  if (node_mark_dfs_type_hint[v] == cur_dfs_mark) {
     return;
   }
   node_mark_dfs[v] = usage;
-  node_mark_dfs_type_hint[v] = 1;
+  node_mark_dfs_mark[v] = cur_dfs_mark;
+  node_mark_dfs_type_hint[v] = cur_dfs_mark;
 
   bool another_type_hint_found = false;
   for (UsagePtr another_usage : node_usages[v]) {
@@ -1007,11 +1016,17 @@ void CFG::dfs_apply_type_hint(Node v, UsagePtr usage) {
   }
 }
 
+is_func_id_t CFG::get_checked_type(Node v) const {
+  return node_checked_type_mark[v] == cur_dfs_mark ? node_checked_type[v] : static_cast<is_func_id_t>(0);
+}
+
 void CFG::dfs_checked_types(Node v, VarPtr var, is_func_id_t current_mask) {
-  if ((node_checked_type[v] | current_mask) == node_checked_type[v]) {
+  const is_func_id_t old_mask = get_checked_type(v);
+  if ((old_mask | current_mask) == old_mask) {
     return;
   }
-  node_checked_type[v] = static_cast<is_func_id_t>(node_checked_type[v] | current_mask);
+  node_checked_type[v] = static_cast<is_func_id_t>(old_mask | current_mask);
+  node_checked_type_mark[v] = cur_dfs_mark;
 
   for (UsagePtr another_usage : node_usages[v]) {
     if (another_usage->v->var_id == var) {
@@ -1109,17 +1124,15 @@ void CFG::process_var(FunctionPtr function, VarPtr var) {
   kphp_assert (var_split);
 
   cur_dfs_mark++;
-  std::fill(node_checked_type.begin(), node_checked_type.end(), static_cast<is_func_id_t>(0));
   dfs_checked_types(current_start, var, static_cast<is_func_id_t>(ifi_any_type | ((var->type() == VarData::var_param_t) ? 0 : ifi_unset)));
   for (UsagePtr u : var_split->usage_gen) {
-    if (u->type == usage_read_t && (node_checked_type[u->node] & ifi_unset)) {
+    if (u->type == usage_read_t && (get_checked_type(u->node) & ifi_unset)) {
       add_uninited_var(u->v);
     }
-    vertex_convertions[u->v] = static_cast<is_func_id_t>(vertex_convertions[u->v] | node_checked_type[u->node]);
+    vertex_convertions[u->v] = static_cast<is_func_id_t>(vertex_convertions[u->v] | get_checked_type(u->node));
   }
 
-  std::fill(node_mark_dfs.begin(), node_mark_dfs.end(), UsagePtr());
-  std::fill(node_mark_dfs_type_hint.begin(), node_mark_dfs_type_hint.end(), 0);
+  cur_dfs_mark++;
   for (UsagePtr u : var_split->usage_gen) {
     if (u->type != usage_type_hint_t) {
       dfs_uni_rw_usages(u->node, u);
@@ -1291,6 +1304,13 @@ void CFG::process_function(FunctionPtr function) {
     return;
   }
 
+  // the CFG object is recycled between functions: clearing the id maps keeps the
+  // capacity of their vectors, so the next function reuses the same allocations
+  data = CFGData();
+  vertex_usage.clear();
+  vertex_convertions.clear();
+  var_split_data.clear();
+
   auto splittable_vars = collect_splittable_vars(function);
   var_split_data.update_size(static_cast<int>(splittable_vars.size()));
   int var_i = 0;
@@ -1307,7 +1327,9 @@ void CFG::process_function(FunctionPtr function) {
   node_gen.add_id_map(&node_prev);
   node_gen.add_id_map(&node_was);
   node_gen.add_id_map(&node_checked_type);
+  node_gen.add_id_map(&node_checked_type_mark);
   node_gen.add_id_map(&node_mark_dfs);
+  node_gen.add_id_map(&node_mark_dfs_mark);
   node_gen.add_id_map(&node_mark_dfs_type_hint);
   node_gen.add_id_map(&node_usages);
   node_gen.add_id_map(&node_subtrees);
@@ -1343,7 +1365,10 @@ void CFGBeginF::execute(FunctionPtr function, DataStream<FunctionAndCFG> &os) {
   stage::set_name("Calc control flow graph");
   stage::set_function(function);
 
-  cfg::CFG cfg;
+  // one CFG instance per thread: its scratch tables survive between functions,
+  // so per-function processing stops churning large transient allocations
+  static TLS<cfg::CFG> cfg_pool;
+  cfg::CFG &cfg = *cfg_pool;
   cfg.process_function(function);
 
   if (stage::has_error()) {
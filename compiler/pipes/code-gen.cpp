@@ -4,6 +4,9 @@
 
 #include "compiler/pipes/code-gen.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "compiler/code-gen/code-gen-task.h"
 #include "compiler/code-gen/code-generator.h"
 #include "compiler/code-gen/common.h"
@@ -24,6 +27,7 @@
 #include "compiler/data/lib-data.h"
 #include "compiler/data/src-file.h"
 #include "compiler/function-pass.h"
+#include "compiler/hotness-profile.h"
 #include "compiler/inferring/public.h"
 
 class CollectForkableTypes final : public FunctionPassBase {
@@ -70,7 +74,38 @@ void CodeGenF::execute(FunctionPtr function, DataStream<WriterData> &os) {
 }
 
 size_t CodeGenF::calc_count_of_parts(size_t cnt_global_vars) {
-  return 1u + cnt_global_vars / G->settings().globals_split_count.get();
+  // vars are distributed between the parts by a stable hash of their names, so an
+  // unchanged var keeps landing in the same vars{N}.cpp only while the parts count
+  // stays the same; round it up to a power of two, then adding a handful of globals
+  // remaps (and recompiles) everything only when their count doubles past the split
+  // setting instead of on every crossing of its next multiple
+  const size_t parts = 1u + cnt_global_vars / G->settings().globals_split_count.get();
+  size_t rounded_parts = 1;
+  while (rounded_parts < parts) {
+    rounded_parts *= 2;
+  }
+  return std::min(rounded_parts, size_t{1024});
+}
+
+static size_t count_vertices(VertexPtr root) {
+  size_t n = 1;
+  for (auto child : *root) {
+    n += count_vertices(child);
+  }
+  return n;
+}
+
+// expected codegen cost of a function in seconds: the duration measured on a previous
+// build when the persistent index has one, otherwise a rough estimate from the AST size
+static double estimate_codegen_cost(FunctionPtr function) {
+  if (!function->src_name.empty()) {
+    const File *prev_out = G->get_index().get_file(function->subdir + "/" + function->src_name);
+    if (prev_out != nullptr && prev_out->codegen_duration_hint > 0) {
+      return prev_out->codegen_duration_hint;
+    }
+  }
+  constexpr double estimated_seconds_per_vertex = 2e-6;
+  return count_vertices(function->root) * estimated_seconds_per_vertex;
 }
 
 void CodeGenF::on_finish(DataStream<WriterData> &os) {
@@ -103,6 +138,7 @@ void CodeGenF::on_finish(DataStream<WriterData> &os) {
   //TODO: parallelize;
   for (const auto &fun : xall) {
     if (should_gen_function(fun)) {
+      apply_hotness_profile(fun);
       G->stats.on_function_processed(fun);
       prepare_generate_function(fun);
     }
@@ -115,6 +151,7 @@ void CodeGenF::on_finish(DataStream<WriterData> &os) {
 
   vector<FunctionPtr> all_functions;
   vector<FunctionPtr> exported_functions;
+  vector<std::pair<double, FunctionPtr>> costed_functions;
 
   for (const auto &function : xall) {
     if (!should_gen_function(function)) {
@@ -124,14 +161,30 @@ void CodeGenF::on_finish(DataStream<WriterData> &os) {
       continue;
     }
     all_functions.push_back(function);
-    W << Async(FunctionH(function));
-    W << Async(FunctionCpp(function));
+    costed_functions.emplace_back(estimate_codegen_cost(function), function);
 
     if (function->kphp_lib_export && G->settings().is_static_lib_mode()) {
       exported_functions.emplace_back(function);
     }
   }
 
+  // the task stream is a LIFO stack: the most recently pushed task is picked up first,
+  // so pushing in ascending cost order leaves the giant functions (generated routers,
+  // 50k-line switches from split-switch) on top once emission finishes — they start
+  // early instead of straggling the stage tail; the .cpp tasks are keyed so that their
+  // measured durations land in the index and refine this ordering on the next build
+  std::sort(costed_functions.begin(), costed_functions.end(),
+            [](const std::pair<double, FunctionPtr> &lhs, const std::pair<double, FunctionPtr> &rhs) { return lhs.first < rhs.first; });
+  for (const auto &costed : costed_functions) {
+    FunctionPtr function = costed.second;
+    W << Async(FunctionH(function));
+    if (!function->src_name.empty()) {
+      W << Async(FunctionCpp(function), function->subdir + "/" + function->src_name);
+    } else {
+      W << Async(FunctionCpp(function));
+    }
+  }
+
   for (const auto &c : all_classes) {
     if (!ClassData::does_need_codegen(c)) {
       continue;
@@ -159,6 +212,7 @@ void CodeGenF::on_finish(DataStream<WriterData> &os) {
   if (G->settings().enable_global_vars_memory_stats.get()) {
     W << Async(GlobalVarsMemoryStats{main_files});
   }
+  write_php_functions_map(W, all_functions);
   W << Async(InitScriptsCpp(std::move(main_files), std::move(all_functions)));
 
   std::vector<VarPtr> vars = G->get_global_vars();
@@ -222,6 +276,22 @@ void CodeGenF::write_lib_version(CodeGenerator &W) {
   W << CloseFile();
 }
 
+void CodeGenF::write_php_functions_map(CodeGenerator &W, const std::vector<FunctionPtr> &all_functions) {
+  // sidecar for perf/flamegraph attribution: maps the emitted c++ names back to
+  // php functions, tools/perf-php-map.py joins it with nm output after link;
+  // no crc header - the file is consumed by scripts, not by the c++ build
+  W << OpenFile("php_functions.map", "", false, false);
+  W << "# <c++ name>\t<php function>\t<php file>" << NL;
+  for (FunctionPtr function : all_functions) {
+    const std::string file_name = function->file_id ? function->file_id->file_name : "";
+    W << "f$" << function->name << "\t" << function->get_human_readable_name() << "\t" << file_name << NL;
+    if (function->is_resumable) {
+      W << "f$fork$" << function->name << "\t" << function->get_human_readable_name() << " (fork)" << "\t" << file_name << NL;
+    }
+  }
+  W << CloseFile();
+}
+
 void CodeGenF::write_main(CodeGenerator &W) {
   kphp_assert(G->settings().is_server_mode() || G->settings().is_cli_mode());
   W << OpenFile("main.cpp");
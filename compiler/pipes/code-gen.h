@@ -5,6 +5,7 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 
 #include "compiler/code-gen/writer-data.h"
 #include "compiler/inferring/type-data.h"
@@ -22,6 +23,7 @@ class CodeGenF final : public SyncPipeF<FunctionPtr, WriterData> {
   void prepare_generate_function(FunctionPtr func);
   std::string get_subdir(const std::string &base);
   void write_lib_version(CodeGenerator &W);
+  void write_php_functions_map(CodeGenerator &W, const std::vector<FunctionPtr> &all_functions);
   void write_main(CodeGenerator &W);
   size_t calc_count_of_parts(size_t cnt_global_vars);
 
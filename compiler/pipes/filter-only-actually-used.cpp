@@ -15,7 +15,7 @@ namespace {
 using EdgeInfo = FilterOnlyActuallyUsedFunctionsF::EdgeInfo;
 using FunctionAndEdges = FilterOnlyActuallyUsedFunctionsF::FunctionAndEdges;
 
-void calc_throws_dfs(FunctionPtr callee, const IdMap<std::vector<FunctionPtr>> &throws_graph) {
+void calc_throws_dfs(FunctionPtr callee, const SparseIdMap<std::vector<FunctionPtr>> &throws_graph) {
   for (const FunctionPtr &caller : throws_graph[callee]) {
     if (!caller->can_throw) {
       caller->can_throw = true;
@@ -25,7 +25,7 @@ void calc_throws_dfs(FunctionPtr callee, const IdMap<std::vector<FunctionPtr>> &
   }
 }
 
-void calc_non_empty_body_dfs(FunctionPtr callee, const IdMap<std::vector<FunctionPtr>> &non_empty_body_graph) {
+void calc_non_empty_body_dfs(FunctionPtr callee, const SparseIdMap<std::vector<FunctionPtr>> &non_empty_body_graph) {
   for (const FunctionPtr &caller : non_empty_body_graph[callee]) {
     kphp_assert_msg(caller->body_seq != FunctionData::body_value::empty, "Body can't be empty!");
     if (caller->body_seq == FunctionData::body_value::unknown) {
@@ -36,8 +36,10 @@ void calc_non_empty_body_dfs(FunctionPtr callee, const IdMap<std::vector<Functio
 }
 
 void calc_throws_and_body_value_through_call_edges(const std::vector<FunctionAndEdges> &all) {
-  IdMap<std::vector<FunctionPtr>> throws_graph(static_cast<int>(all.size()));
-  IdMap<std::vector<FunctionPtr>> non_empty_body_graph(static_cast<int>(all.size()));
+  // only a small share of functions have throwing or unknown-body callers,
+  // so these reverse graphs are paged instead of full program width
+  SparseIdMap<std::vector<FunctionPtr>> throws_graph(static_cast<int>(all.size()));
+  SparseIdMap<std::vector<FunctionPtr>> non_empty_body_graph(static_cast<int>(all.size()));
   for (const auto &f_and_e : all) {
     for (const auto &edge : f_and_e.second) {
       if (edge.inside_fork) {
@@ -6,10 +6,14 @@
 
 #include "compiler/data/src-file.h"
 #include "compiler/data/var-data.h"
+#include "compiler/hotness-profile.h"
 #include "compiler/inferring/public.h"
 
 void InlineSimpleFunctions::on_simple_operation() noexcept {
-  if (++n_simple_operations_ > 6) {
+  // the budget is frequency-aware: a function marked hot by the profile is worth
+  // inlining even when its body is a few times bigger than the default cutoff
+  const int budget = current_function->hotness == FunctionData::code_hotness::hot ? 24 : 6;
+  if (++n_simple_operations_ > budget) {
     inline_is_possible_ = false;
   }
 }
@@ -58,7 +62,18 @@ VertexPtr InlineSimpleFunctions::on_enter_vertex(VertexPtr root) {
       in_param_list_ = true;
       // fallthrough
     case op_seq:
-      if (root->size() > 5) {
+      if (root->size() > (current_function->hotness == FunctionData::code_hotness::hot ? 12 : 5)) {
+        inline_is_possible_ = false;
+      }
+      break;
+    case op_switch:
+    case op_case:
+    case op_default:
+      // the body of a generated virtual method is a switch on the class hash;
+      // don't count its scaffolding as work, so that an effectively monomorphic
+      // dispatcher (a single concrete case) fits the budget and gets inlined into
+      // call sites as a guarded direct call, while wide hierarchies stay out of line
+      if (!current_function->is_virtual_method) {
         inline_is_possible_ = false;
       }
       break;
@@ -88,7 +103,12 @@ bool InlineSimpleFunctions::user_recursion(VertexPtr) {
 }
 
 bool InlineSimpleFunctions::check_function(FunctionPtr function) const {
-  return !function->is_resumable &&
+  // hotness is applied here (and not only at codegen) so the inlining cost model
+  // below can see it; cold functions are never inlined — keeping them out of
+  // line is what the profile asked for
+  apply_hotness_profile(function);
+  return function->hotness != FunctionData::code_hotness::cold &&
+         !function->is_resumable &&
          !function->is_inline &&
          !function->can_throw &&
          !function->has_variadic_param &&
@@ -72,6 +72,127 @@ VarPtr cast_const_array(VertexPtr &type_acceptor, const T &type_donor) {
 }
 } // namespace
 
+void OptimizationPass::on_start() {
+  // resumable functions are compiled into re-enterable state machines, don't reason about their locals
+  if (!current_function->is_resumable) {
+    collect_var_usages(current_function->root, 0);
+  }
+}
+
+void OptimizationPass::collect_var_usages(VertexPtr root, int loop_depth) {
+  if (auto var_vertex = root.try_as<op_var>()) {
+    VarPtr var = var_vertex->var_id;
+    if (var && vk::any_of_equal(var->type(), VarData::var_local_t, VarData::var_local_inplace_t, VarData::var_param_t)) {
+      auto &usage = local_var_usages_[var];
+      if (var_vertex->rl_type == val_r) {
+        ++usage.reads;
+        usage.read_in_loop |= loop_depth > 0;
+      } else if (var_vertex->rl_type != val_l) {
+        usage.unsupported_usage = true;
+      }
+    }
+  }
+  // op_switch is a cycle_op as well: treating it as a loop is stricter than necessary, but safe
+  const int children_loop_depth = loop_depth + (OpInfo::type(root->type()) == cycle_op);
+  for (auto child : *root) {
+    collect_var_usages(child, children_loop_depth);
+  }
+}
+
+// rewrite the last use of a non-escaping local passed into a by-value parameter into a move,
+// so that the callee steals the container buffer instead of bumping and dropping its refcount
+void OptimizationPass::try_mark_movable_args(VertexAdaptor<op_func_call> call) {
+  auto args = call->args();
+  const auto &params = call->func_id->param_ids;
+  for (size_t index = 0; index < args.size() && index < params.size(); ++index) {
+    if (auto arg = args[index].try_as<op_var>()) {
+      if (can_move_arg_into_call(arg, params[index])) {
+        arg->move_flag = true;
+      }
+    }
+  }
+}
+
+bool OptimizationPass::can_move_arg_into_call(VertexAdaptor<op_var> arg, VarPtr param) const {
+  // the callee must take the parameter by value, see FunctionParams::declare_cpp_param()
+  if (!param || param->is_reference || param->marked_as_const || param->is_read_only) {
+    return false;
+  }
+  return is_dying_local_var(arg) && !tinf::get_type(arg)->is_primitive_type();
+}
+
+bool OptimizationPass::is_dying_local_var(VertexAdaptor<op_var> var_vertex) const {
+  VarPtr var = var_vertex->var_id;
+  if (!var || var_vertex->rl_type != val_r || var_vertex->ref_flag ||
+      var->is_reference || var->is_foreach_reference || var->marked_as_const) {
+    return false;
+  }
+  switch (var->type()) {
+    case VarData::var_local_t:
+    case VarData::var_local_inplace_t:
+      break;
+    case VarData::var_param_t:
+      // a read-only param is declared as const&, moving from it would silently degrade into a copy
+      if (var->is_read_only) {
+        return false;
+      }
+      break;
+    default:
+      return false;
+  }
+  const auto usage_it = local_var_usages_.find(var);
+  if (usage_it == local_var_usages_.end()) {
+    return false;
+  }
+  // a single read outside of any loop executes at most once, so the value is dead after it;
+  // writes don't matter: overwriting a moved-out var is fine, and nothing ever reads it again
+  const LocalVarUsage &usage = usage_it->second;
+  return usage.reads == 1 && !usage.read_in_loop && !usage.unsupported_usage;
+}
+
+void OptimizationPass::try_mark_movable_set(VertexAdaptor<op_set> set) {
+  auto lhs = set->lhs().try_as<op_var>();
+  if (!lhs) {
+    return;
+  }
+  // $x = $y: the whole container moves, the callee-side CoW never triggers
+  if (auto rhs = set->rhs().try_as<op_var>()) {
+    // self-assignment would self-move; the move operators don't expect that
+    if (rhs->var_id != lhs->var_id && is_dying_local_var(rhs) && !tinf::get_type(rhs)->is_primitive_type()) {
+      rhs->move_flag = true;
+    }
+    return;
+  }
+  // $x = $arr[$i]: extracting from a dying array steals the element from the
+  // bucket, see the rvalue-qualified array::get_value() overloads
+  if (auto index = set->rhs().try_as<op_index>()) {
+    if (index->has_key() && tinf::get_type(index->array())->ptype() == tp_array) {
+      if (auto array_vertex = index->array().try_as<op_var>()) {
+        if (is_dying_local_var(array_vertex)) {
+          array_vertex->move_flag = true;
+        }
+      }
+    }
+  }
+}
+
+void OptimizationPass::try_mark_movable_return(VertexAdaptor<op_return> ret) {
+  if (!ret->has_expr()) {
+    return;
+  }
+  auto expr = ret->expr().try_as<op_var>();
+  if (!expr || !is_dying_local_var(expr) || tinf::get_type(expr)->is_primitive_type()) {
+    return;
+  }
+  // returning a local of exactly the return type already moves implicitly (or elides
+  // entirely), and an explicit std::move would defeat nrvo; only a converting return
+  // constructs the result from an lvalue and pays for a copy
+  if (are_equal_types(tinf::get_type(expr), tinf::get_type(current_function, -1))) {
+    return;
+  }
+  expr->move_flag = true;
+}
+
 VertexPtr OptimizationPass::optimize_set_push_back(VertexAdaptor<op_set> set_op) {
   if (set_op->lhs()->type() != op_index) {
     return set_op;
@@ -279,6 +400,9 @@ VertexPtr OptimizationPass::on_exit_vertex(VertexPtr root) {
     if (auto var_id = cast_const_array(set_vertex->rhs(), set_vertex->lhs())) {
       current_function->explicit_const_var_ids.emplace(var_id);
     }
+    try_mark_movable_set(set_vertex);
+  } else if (auto return_vertex = root.try_as<op_return>()) {
+    try_mark_movable_return(return_vertex);
   } else if (auto func_call = root.try_as<op_func_call>()) {
     auto func = func_call->func_id;
     if (!func->has_variadic_param && !func->is_extern()) {
@@ -289,6 +413,9 @@ VertexPtr OptimizationPass::on_exit_vertex(VertexPtr root) {
           current_function->explicit_const_var_ids.emplace(var_id);
         }
       }
+      if (!func->is_resumable) {
+        try_mark_movable_args(func_call);
+      }
     }
   }
   return root;
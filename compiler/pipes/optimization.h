@@ -4,11 +4,27 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include "compiler/compiler-core.h"
 #include "compiler/function-pass.h"
 
 class OptimizationPass final : public FunctionPassBase {
 private:
+  struct LocalVarUsage {
+    int reads{0};
+    bool read_in_loop{false};
+    bool unsupported_usage{false};
+  };
+  std::unordered_map<VarPtr, LocalVarUsage> local_var_usages_;
+
+  void collect_var_usages(VertexPtr root, int loop_depth);
+  void try_mark_movable_args(VertexAdaptor<op_func_call> call);
+  void try_mark_movable_set(VertexAdaptor<op_set> set);
+  void try_mark_movable_return(VertexAdaptor<op_return> ret);
+  bool can_move_arg_into_call(VertexAdaptor<op_var> arg, VarPtr param) const;
+  bool is_dying_local_var(VertexAdaptor<op_var> var_vertex) const;
+
   VertexPtr optimize_set_push_back(VertexAdaptor<op_set> set_op);
   void collect_concat(VertexPtr root, vector<VertexPtr> *collected);
   VertexPtr optimize_string_building(VertexPtr root);
@@ -27,6 +43,8 @@ public:
 
   bool check_function(FunctionPtr function) const override;
 
+  void on_start() override;
+
   VertexPtr on_enter_vertex(VertexPtr root) override;
   VertexPtr on_exit_vertex(VertexPtr root) override;
 
@@ -54,6 +54,8 @@ void RegisterKphpConfiguration::on_start() {
         register_mysql_db_name(opt_pair->value());
       } else if (*opt_key == net_dc_mask_key_) {
         register_net_dc_mask(opt_pair->value());
+      } else if (*opt_key == warmup_function_key_) {
+        register_warmup_function(opt_pair->value());
       } else {
         kphp_error(0, fmt_format("Got unexpected option {}::{}['{}']",
                                  configuration_class_name_, runtime_options_name_, *opt_key));
@@ -98,6 +100,14 @@ void RegisterKphpConfiguration::register_mysql_db_name(VertexPtr value) const no
   G->add_kphp_runtime_opt(*opt_value);
 }
 
+void RegisterKphpConfiguration::register_warmup_function(VertexPtr value) const noexcept {
+  const auto *opt_value = GenTree::get_constexpr_string(value);
+  kphp_error_return(opt_value && !opt_value->empty(),
+                    fmt_format("{}[{}] must be a non empty constexpr string",
+                               runtime_options_name_, warmup_function_key_));
+  G->set_kphp_warmup_function(*opt_value);
+}
+
 void RegisterKphpConfiguration::register_net_dc_mask(VertexPtr value) const noexcept {
   auto dc_masks = value.try_as<op_array>();
   kphp_error_return(dc_masks, fmt_format("{}[{}] must be a constexpr array",
@@ -21,6 +21,7 @@ private:
   void register_confdata_predefined_wildcard(VertexPtr value) const noexcept;
   void register_mysql_db_name(VertexPtr value) const noexcept;
   void register_net_dc_mask(VertexPtr value) const noexcept;
+  void register_warmup_function(VertexPtr value) const noexcept;
 
   const vk::string_view configuration_class_name_{"KphpConfiguration"};
   const vk::string_view runtime_options_name_{"DEFAULT_RUNTIME_OPTIONS"};
@@ -29,4 +30,5 @@ private:
   const vk::string_view confdata_predefined_wildcard_key_{"--confdata-predefined-wildcard"};
   const vk::string_view mysql_db_name_key_{"--mysql-db-name"};
   const vk::string_view net_dc_mask_key_{"--net-dc-mask"};
+  const vk::string_view warmup_function_key_{"--warmup-function"};
 };
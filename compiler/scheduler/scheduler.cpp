@@ -115,12 +115,25 @@ void Scheduler::thread_execute(ThreadContext *tls) {
     }
     return at_least_one_task_executed;
   };
+  // scan the parallel nodes starting from a per-thread offset, so threads spread
+  // over the pipes instead of all contending on the first stream's lock
+  auto process_all_nodes = [this, &process_node, tls] {
+    bool at_least_one_task_executed = false;
+    const size_t nodes_size = nodes.size();
+    for (size_t i = 0; i < nodes_size; ++i) {
+      at_least_one_task_executed |= process_node(nodes[(tls->thread_id + i) % nodes_size]);
+    }
+    return at_least_one_task_executed;
+  };
   while (tls->run_flag) {
     bool at_least_one_task_executed = false;
     if (tls->node != nullptr) {
       at_least_one_task_executed = process_node(tls->node);
-    } else {
-      at_least_one_task_executed = std::count_if(nodes.begin(), nodes.end(), process_node) > 0;
+    }
+    if (!at_least_one_task_executed && !nodes.empty()) {
+      // threads with a dedicated single-thread node steal work from the parallel
+      // pipes while their own node is empty, instead of sleeping through the tail
+      at_least_one_task_executed = process_all_nodes();
     }
     if (!at_least_one_task_executed) {
       usleep(250);
@@ -57,9 +57,16 @@ void Stats::update_memory_stats() {
   memory_rss_peak_ = mem_info.rss_peak;
 }
 
+static std::string sanitize_profiler_name(const std::string &raw_name) {
+  std::string name = raw_name;
+  std::replace_if(name.begin(), name.end(), [](char c) { return !std::isalnum(c); }, '_');
+  return name;
+}
+
 void Stats::write_to(std::ostream &out, bool with_indent) const {
   const char *indent = with_indent ? "  " : "";
   const char *block_sep = with_indent ? "\n" : "";
+  out << indent << "files.total: " << total_files << std::endl;
   out << indent << "classes.total: " << total_classes << std::endl;
   out << indent << "classes.total_lambdas: " << total_lambdas << std::endl;
   out << block_sep;
@@ -90,8 +97,7 @@ void Stats::write_to(std::ostream &out, bool with_indent) const {
   out << block_sep;
   out << std::fixed;
   for (const auto &prof : profiler_stats) {
-    std::string name = prof.first;
-    std::replace_if(name.begin(), name.end(), [](char c) { return !std::isalnum(c); }, '_');
+    const std::string name = sanitize_profiler_name(prof.first);
     out << "pipes." << name << ".working_time: " << std::chrono::duration<double>(prof.second.get_working_time()).count() << std::endl;
     out << "pipes." << name << ".duration: " << std::chrono::duration<double>(prof.second.get_duration()).count() << std::endl;
     out << "pipes." << name << ".memory_usage: " << prof.second.get_memory_usage() << std::endl;
@@ -100,3 +106,41 @@ void Stats::write_to(std::ostream &out, bool with_indent) const {
   }
   out.unsetf(std::ios_base::floatfield);
 }
+
+void Stats::write_json_to(std::ostream &out) const {
+  // pipe names are sanitized to [alnum_], every other key is a literal,
+  // so no JSON string escaping is needed here
+  out << std::fixed;
+  out << "{";
+  out << "\"files\":{\"total\":" << total_files << "},";
+  out << "\"classes\":{\"total\":" << total_classes << ",\"total_lambdas\":" << total_lambdas << "},";
+  out << "\"vars\":{"
+      << "\"local\":" << local_vars_ << ",\"local_inplace\":" << local_inplace_vars_
+      << ",\"static\":" << static_vars_ << ",\"global\":" << global_vars_
+      << ",\"global_const\":" << global_const_vars_ << ",\"param\":" << param_vars_
+      << ",\"param_make_clone\":" << cnt_make_clone << "},";
+  out << "\"types\":{"
+      << "\"instance\":" << instance_vars_ << ",\"local_mixed\":" << cnt_mixed_vars
+      << ",\"params_mixed\":" << cnt_mixed_params << ",\"const_params_mixed\":" << cnt_const_mixed_params << "},";
+  out << "\"functions\":{"
+      << "\"total\":" << total_functions_ << ",\"total_inline\":" << total_inline_functions_
+      << ",\"total_throwing\":" << total_throwing_functions_ << ",\"total_resumable\":" << total_resumable_functions_ << "},";
+  out << "\"memory\":{\"rss\":" << memory_rss_ * 1024 << ",\"rss_peak\":" << memory_rss_peak_ * 1024 << "},";
+  out << "\"compilation\":{"
+      << "\"transpilation_time\":" << transpilation_time << ",\"total_time\":" << total_time
+      << ",\"object_out_size\":" << object_out_size << "},";
+  out << "\"pipes\":{";
+  bool first_pipe = true;
+  for (const auto &prof : profiler_stats) {
+    out << (first_pipe ? "" : ",");
+    first_pipe = false;
+    out << "\"" << sanitize_profiler_name(prof.first) << "\":{"
+        << "\"working_time\":" << std::chrono::duration<double>(prof.second.get_working_time()).count()
+        << ",\"duration\":" << std::chrono::duration<double>(prof.second.get_duration()).count()
+        << ",\"memory_usage\":" << prof.second.get_memory_usage()
+        << ",\"memory_allocated\":" << prof.second.get_memory_total_allocated()
+        << ",\"calls\":" << prof.second.get_calls() << "}";
+  }
+  out << "}}" << std::endl;
+  out.unsetf(std::ios_base::floatfield);
+}
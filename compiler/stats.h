@@ -18,7 +18,11 @@ public:
   void update_memory_stats();
 
   void write_to(std::ostream &out, bool with_indent = true) const;
+  // same metrics as write_to(), but as a single JSON object — one document per
+  // build, meant to be collected from many builds and compared over time
+  void write_json_to(std::ostream &out) const;
 
+  std::atomic<std::uint64_t> total_files{0u};
   std::atomic<std::uint64_t> total_classes{0u};
   std::atomic<std::uint64_t> total_lambdas{0u};
   std::atomic<std::uint64_t> cnt_mixed_params{0u};
@@ -4,16 +4,21 @@
 
 #pragma once
 #include <forward_list>
-#include <mutex>
 #include <vector>
 
 #include "common/algorithms/find.h"
+#include "common/mixin/not_copyable.h"
 
 #include "compiler/scheduler/scheduler-base.h"
 #include "compiler/stage.h"
+#include "compiler/threading/locks.h"
 
+// the stream is a lock-free LIFO list: every pipe task running on any scheduler thread
+// pushes its results into the next stream, so producers prepend a node with a single CAS
+// and never block each other or the consumers; pops are serialized by a spinlock, which
+// is uncontended in comparison — one stream feeds one pipe, while many feed into it
 template<class DataT>
-class DataStream {
+class DataStream : private vk::not_copyable {
 public:
   using DataType = DataT;
   using StreamType = DataStream<DataType>;
@@ -26,27 +31,56 @@ public:
   {
   }
 
+  ~DataStream() {
+    ListNode *node = head_;
+    while (node != nullptr) {
+      ListNode *next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+
   bool get(DataType &result) {
-    std::lock_guard<std::mutex> lock{mutex_};
-    if (!queue_.empty()) {
-      result = std::move(queue_.front());
-      queue_.pop_front();
-      return true;
+    AutoLocker<volatile int *> locker(&pop_lock_);
+    ListNode *node = head_;
+    if (node == nullptr) {
+      return false;
+    }
+    // we are the only popper, so node->next is stable and the CAS can fail
+    // only because of a concurrent push — retry against the fresh head
+    while (!__sync_bool_compare_and_swap(&head_, node, node->next)) {
+      node = head_;
     }
-    return false;
+    result = std::move(node->data);
+    delete node;
+    return true;
   }
 
   void operator<<(DataType input) {
     if (!is_sink_mode_) {
       __sync_fetch_and_add(&tasks_before_sync_node, 1);
     }
-    std::lock_guard<std::mutex> lock{mutex_};
-    queue_.push_front(std::move(input));
+    auto *node = new ListNode{std::move(input), head_};
+    while (!__sync_bool_compare_and_swap(&head_, node->next, node)) {
+      node->next = head_;
+    }
   }
 
   std::forward_list<DataType> flush() {
-    std::lock_guard<std::mutex> lock{mutex_};
-    return std::move(queue_);
+    AutoLocker<volatile int *> locker(&pop_lock_);
+    ListNode *node = head_;
+    while (node != nullptr && !__sync_bool_compare_and_swap(&head_, node, nullptr)) {
+      node = head_;
+    }
+    std::forward_list<DataType> result;
+    auto after_it = result.before_begin();
+    while (node != nullptr) {
+      after_it = result.emplace_after(after_it, std::move(node->data));
+      ListNode *next = node->next;
+      delete node;
+      node = next;
+    }
+    return result;
   }
 
   std::vector<DataType> flush_as_vector() {
@@ -55,8 +89,13 @@ public:
   }
 
 private:
-  std::mutex mutex_;
-  std::forward_list<DataT> queue_;
+  struct ListNode {
+    DataT data;
+    ListNode *next;
+  };
+
+  ListNode *volatile head_{nullptr};
+  volatile int pop_lock_{0};
   const bool is_sink_mode_;
 };
 
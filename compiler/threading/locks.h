@@ -25,6 +25,17 @@ inline bool try_lock(volatile int *locker) {
 }
 
 inline void lock(volatile int *locker) {
+  // critical sections guarded by these locks are tiny (a couple of vector pushes in
+  // tinf::Node), so spin for a while before paying for a 250us sleep: under inferring
+  // load the lock is almost always released within a few iterations
+  for (int iter = 0; iter < 256; iter++) {
+    if (try_lock(locker)) {
+      return;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+  }
   while (!try_lock(locker)) {
     usleep(250);
   }
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cxxabi.h>
+#include <fstream>
 #include <vector>
 
 #include "common/termformat/termformat.h"
@@ -94,6 +95,111 @@ void profiler_print_all(const std::unordered_map<std::string, ProfilerRaw> &coll
   fmt_fprintf(stderr, "-{0:-^{1}}-\n", "", name_width + table_fixed_size);
 }
 
+void profiler_print_critical_path(const std::unordered_map<std::string, ProfilerRaw> &collected) {
+  struct Span {
+    const std::string *name;
+    std::chrono::nanoseconds start;
+    std::chrono::nanoseconds finish;
+    std::chrono::nanoseconds working;
+  };
+  std::vector<Span> spans;
+  spans.reserve(collected.size());
+  for (const auto &prof : collected) {
+    if (prof.second.get_calls() > 0) {
+      spans.push_back({&prof.first, prof.second.get_start_time(), prof.second.get_finish_time(), prof.second.get_working_time()});
+    }
+  }
+  if (spans.empty()) {
+    return;
+  }
+  std::sort(spans.begin(), spans.end(), [](const Span &a, const Span &b) { return a.start < b.start; });
+
+  // greedily chain the stages whose spans cover the build wall time:
+  // among the stages starting before the chain end, take the one finishing last
+  std::vector<const Span *> chain;
+  const auto t0 = spans.front().start;
+  auto chain_end = t0;
+  size_t scan_from = 0;
+  while (scan_from < spans.size()) {
+    const Span *best = nullptr;
+    size_t j = scan_from;
+    for (; j < spans.size() && spans[j].start <= chain_end; ++j) {
+      if (spans[j].finish > chain_end && (!best || spans[j].finish > best->finish)) {
+        best = &spans[j];
+      }
+    }
+    if (!best) {
+      if (j > scan_from) {
+        // fully covered by the chain already
+        scan_from = j;
+        continue;
+      }
+      // an idle gap in the pipeline, restart the chain from the next stage
+      best = &spans[scan_from];
+      j = scan_from + 1;
+    }
+    chain.push_back(best);
+    chain_end = best->finish;
+    scan_from = j;
+  }
+
+  fmt_fprintf(stderr, "Critical path (start/span/busy):\n");
+  for (const Span *span : chain) {
+    fmt_fprintf(stderr, "  {0: >8.3f} sec |{1} |{2} | {3}\n",
+                std::chrono::duration<double>(span->start - t0).count(),
+                pretty_time(span->finish - span->start),
+                pretty_time(span->working),
+                *span->name);
+  }
+}
+
+static std::string json_escaped(const std::string &s) {
+  std::string res;
+  res.reserve(s.size());
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      res += '\\';
+    }
+    res += c;
+  }
+  return res;
+}
+
+void profiler_dump_chrome_trace(const std::string &file_name) {
+  std::ofstream trace{file_name};
+  if (!trace.is_open()) {
+    fmt_fprintf(stderr, "Can't open profiler trace file [{}]\n", file_name);
+    return;
+  }
+
+  auto t0 = std::chrono::nanoseconds::max();
+  for (int i = 0; i <= MAX_THREADS_COUNT; i++) {
+    for (const auto &raw : profiler.get(i)) {
+      if (raw.second.get_calls() > 0) {
+        t0 = std::min(t0, raw.second.get_start_time());
+      }
+    }
+  }
+
+  trace << "{\"traceEvents\":[\n";
+  bool first = true;
+  for (int i = 0; i <= MAX_THREADS_COUNT; i++) {
+    for (const auto &raw : profiler.get(i)) {
+      if (raw.second.get_calls() == 0) {
+        continue;
+      }
+      const auto ts = std::chrono::duration_cast<std::chrono::microseconds>(raw.second.get_start_time() - t0);
+      const auto dur = std::chrono::duration_cast<std::chrono::microseconds>(raw.second.get_duration());
+      const auto busy = std::chrono::duration_cast<std::chrono::microseconds>(raw.second.get_working_time());
+      trace << (first ? "" : ",\n")
+            << fmt_format(R"({{"ph":"X","pid":0,"tid":{},"name":"{}","ts":{},"dur":{},"args":{{"calls":{},"busy_us":{}}}}})",
+                          i, json_escaped(raw.first), ts.count(), dur.count(), raw.second.get_calls(), busy.count());
+      first = false;
+    }
+  }
+  trace << "\n]}\n";
+}
+
 ProfilerRaw &get_profiler(const std::string &name) {
   return (*profiler)[name];
 }
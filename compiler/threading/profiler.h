@@ -67,6 +67,14 @@ public:
     return working_time_;
   }
 
+  std::chrono::nanoseconds get_start_time() const noexcept {
+    return min_time_;
+  }
+
+  std::chrono::nanoseconds get_finish_time() const noexcept {
+    return max_time_;
+  }
+
   std::chrono::nanoseconds get_duration() const noexcept {
     return max_time_ - min_time_;
   }
@@ -93,6 +101,12 @@ std::unordered_map<std::string, ProfilerRaw> collect_profiler_stats();
 
 void profiler_print_all(const std::unordered_map<std::string, ProfilerRaw> &collected);
 
+// prints the chain of pipeline stages whose [first start; last finish] spans bound the build wall time
+void profiler_print_critical_path(const std::unordered_map<std::string, ProfilerRaw> &collected);
+
+// dumps per-thread per-stage spans in Chrome trace format (load via chrome://tracing or ui.perfetto.dev)
+void profiler_dump_chrome_trace(const std::string &file_name);
+
 std::string demangle(const char *name);
 
 
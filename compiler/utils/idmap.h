@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <array>
+#include <memory>
+
 #include "compiler/stage.h"
 
 struct IdMapBase {
@@ -76,3 +79,56 @@ void IdMap<DataType>::update_size(int n) {
   kphp_assert((int)data.size() <= n);
   data.resize(n);
 }
+
+// a paged IdMap for program-wide tables that stay mostly untouched: pages are
+// allocated on the first write, so a map over hundreds of thousands of ids
+// costs only the pages actually hit instead of the full dense vector
+template<class DataType>
+struct SparseIdMap : public IdMapBase {
+  static constexpr int PAGE_BITS = 9;
+  static constexpr int PAGE_SIZE = 1 << PAGE_BITS;
+
+  using Page = std::array<DataType, PAGE_SIZE>;
+  std::vector<std::unique_ptr<Page>> pages;
+
+  SparseIdMap() = default;
+  explicit SparseIdMap(int size) {
+    update_size(size);
+  }
+
+  template<class IndexType>
+  DataType &operator[](const IndexType &i) {
+    int index = get_index(i);
+    kphp_assert(index >= 0);
+    const size_t page = static_cast<size_t>(index) >> PAGE_BITS;
+    kphp_assert_msg(page < pages.size(), fmt_format("{} of {}\n", index, (int)pages.size() * PAGE_SIZE));
+    if (!pages[page]) {
+      pages[page] = std::unique_ptr<Page>{new Page{}};
+    }
+    return (*pages[page])[index & (PAGE_SIZE - 1)];
+  }
+
+  template<class IndexType>
+  const DataType &operator[](const IndexType &i) const {
+    int index = get_index(i);
+    kphp_assert(index >= 0);
+    const size_t page = static_cast<size_t>(index) >> PAGE_BITS;
+    kphp_assert_msg(page < pages.size(), fmt_format("{} of {}\n", index, (int)pages.size() * PAGE_SIZE));
+    if (!pages[page]) {
+      static const DataType untouched{};
+      return untouched;
+    }
+    return (*pages[page])[index & (PAGE_SIZE - 1)];
+  }
+
+  void clear() {
+    pages.clear();
+  }
+
+  void update_size(int n) {
+    const size_t pages_needed = (static_cast<size_t>(n) + PAGE_SIZE - 1) >> PAGE_BITS;
+    if (pages.size() < pages_needed) {
+      pages.resize(pages_needed);
+    }
+  }
+};
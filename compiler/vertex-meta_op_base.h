@@ -40,6 +40,7 @@ public:
   ConstValueType const_type : 2;
   bool ref_flag : 1;
   bool throw_flag : 1;
+  bool move_flag : 1; // the value is dead after this vertex, codegen may std::move() it; see OptimizationPass
 
 private:
   VertexPtr *arr() const {
@@ -120,7 +121,8 @@ public:
     val_ref_flag(val_none),
     const_type(cnst_error_),
     ref_flag(false),
-    throw_flag(false) {
+    throw_flag(false),
+    move_flag(false) {
   }
 
   vertex_inner(const vertex_inner<meta_op_base> &from) :
@@ -136,7 +138,8 @@ public:
     val_ref_flag(from.val_ref_flag),
     const_type(from.const_type),
     ref_flag(from.ref_flag),
-    throw_flag(from.throw_flag) {
+    throw_flag(from.throw_flag),
+    move_flag(from.move_flag) {
   }
 
   virtual ~vertex_inner() {}
@@ -34,6 +34,9 @@ size_t vertex_inner_shift(int args_n) {
   return sizeof(VertexPtr) * args_n;
 }
 
+// this malloc is not a libc call: compiler threads link against the bump allocator in
+// compiler/threading/allocator.cpp, so vertices created while one thread parses a function
+// come out of consecutive slots of its 64MB slab and later passes walk them almost linearly
 template<Operation Op>
 vertex_inner<Op> *raw_create_vertex_inner(int args_n) {
   size_t size = vertex_inner_size<Op>(args_n);
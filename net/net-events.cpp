@@ -10,15 +10,16 @@ net_reactor_ctx_t main_thread_reactor = {.epoll_fd = -1,
                                          .max_events = 0,
                                          .max_timers = 0,
                                          .event_heap_size = 0,
-                                         .timer_heap_size = 0,
+                                         .timers_count = 0,
                                          .now = 0,
                                          .prev_now = 0,
                                          .timestamp = 0,
+                                         .timers_now_ms = 0,
                                          .epoll_events = NULL,
                                          .events = NULL,
                                          .timers = NULL,
                                          .event_heap = NULL,
-                                         .timer_heap = NULL,
+                                         .timer_wheel = NULL,
                                          .pre_runqueue = NULL,
                                          .post_runqueue = NULL,
                                          .pre_event = NULL,
@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <zlib.h>
 
 #include "common/crc32.h"
 #include "common/kprintf.h"
@@ -17,6 +18,7 @@
 #include "net/net-buffers.h"
 #include "net/net-connections.h"
 #include "net/net-events.h"
+#include "net/net-trace.h"
 
 /*
  *
@@ -304,6 +306,8 @@ int hts_parse_execute (struct connection *c) {
                 D->host_size = D->wlen;
               } else if (D->wlen == 10 && !strncasecmp (D->word, "keep-alive", 10)) {
                 D->query_flags |= QF_KEEPALIVE;
+              } else if (D->wlen == 5 && !strncasecmp (D->word, "close", 5)) {
+                D->query_flags |= QF_CONNCLOSE;
               }
             }
             D->query_flags &= ~(QF_HOST | QF_CONNECTION);
@@ -553,7 +557,13 @@ int hts_parse_execute (struct connection *c) {
         }
         D->query_flags |= QF_ERROR;
       }
+      /* HTTP/1.1 defaults to a persistent connection: the Connection header
+         only opts out, so its absence must not drop keep-alive */
+      if (D->http_ver >= HTTP_V11 && !(D->query_flags & (QF_CONNCLOSE | QF_ERROR))) {
+        D->query_flags |= QF_KEEPALIVE;
+      }
       if (!(D->query_flags & QF_ERROR)) {
+        trace_request_query_parsed (c);
         c->status = conn_running;
         if (!HTS_FUNC(c)->execute) {
           HTS_FUNC(c)->execute = hts_default_execute;
@@ -863,6 +873,66 @@ int write_basic_http_header (struct connection *c, int code, int date, int len,
 
 
 
+/*
+ *
+ *		RESPONSE COMPRESSION
+ *
+ */
+
+/* called by the worker after the script has finished, so the cpu is charged
+   to the engine, not to script time; large bodies get a cheaper level to
+   bound the time the worker stays busy per response */
+static int http_compression_level (int body_len) {
+  if (body_len < (64 << 10)) {
+    return 6;
+  }
+  if (body_len < (1 << 20)) {
+    return 4;
+  }
+  return 2;
+}
+
+int http_compress_response_body (const char *body, int body_len, int encoding, const char **out_body) {
+  static char *buff;
+  static unsigned long buff_size;
+
+  assert (encoding == HTTP_COMPRESSION_GZIP || encoding == HTTP_COMPRESSION_DEFLATE);
+  if (body_len <= 0) {
+    return -1;
+  }
+
+  z_stream strm;
+  memset (&strm, 0, sizeof (strm));
+  /* MAX_WBITS + 16 selects the gzip wrapper, plain MAX_WBITS the zlib one
+     ("deflate" in http terms) */
+  const int window_bits = encoding == HTTP_COMPRESSION_GZIP ? MAX_WBITS + 16 : MAX_WBITS;
+  if (deflateInit2 (&strm, http_compression_level (body_len), Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return -1;
+  }
+
+  const unsigned long bound = deflateBound (&strm, body_len);
+  if (bound > buff_size) {
+    free (buff);
+    buff_size = bound;
+    buff = static_cast<char *>(malloc (buff_size));
+    assert (buff != NULL);
+  }
+
+  strm.next_in = (Bytef *) body;
+  strm.avail_in = body_len;
+  strm.next_out = (Bytef *) buff;
+  strm.avail_out = buff_size;
+  const int status = deflate (&strm, Z_FINISH);
+  const int compressed_len = (int) strm.total_out;
+  deflateEnd (&strm);
+
+  if (status != Z_STREAM_END || compressed_len >= body_len) {
+    return -1;
+  }
+  *out_body = buff;
+  return compressed_len;
+}
+
 /*
  *
  *		END (HTTP SERVER)
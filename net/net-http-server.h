@@ -63,6 +63,7 @@ enum hts_query_type {
 #define	QF_CONNECTION	8
 #define	QF_KEEPALIVE	0x100
 #define	QF_EXTRA_HEADERS	0x200
+#define	QF_CONNCLOSE	0x400
 
 #define	HTS_DATA(c)	((struct hts_data *) ((c)->custom_data))
 #define	HTS_FUNC(c)	((struct http_server_functions *) ((c)->extra))
@@ -90,5 +91,14 @@ int write_basic_http_header (struct connection *c, int code, int date, int len,
 int write_http_error (struct connection *c, int code);
 int format_http_error_page(int code, char *buff);
 
+/* Content-Encoding values understood by http_compress_response_body */
+#define	HTTP_COMPRESSION_GZIP	1
+#define	HTTP_COMPRESSION_DEFLATE	2
+
+/* compresses a response body with a level tuned by its size; returns the
+   compressed length and points *out_body at an internal buffer valid until
+   the next call, or -1 when compression fails or does not shrink the body */
+int http_compress_response_body (const char *body, int body_len, int encoding, const char **out_body);
+
 /* END */
 #endif
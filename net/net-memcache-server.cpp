@@ -11,6 +11,7 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "common/algorithms/simd-token-scan.h"
 #include "common/crc32.h"
 #include "common/kprintf.h"
 #include "common/options.h"
@@ -204,10 +205,14 @@ int mcs_execute (struct connection *c, int op) {
       len = 0;
       skip = 0;
       while (ptr < ptr_e && *ptr != ' ' && *ptr != '\t' && *ptr != '\r' && *ptr != '\n') {
+        int span = (int) vk::simd_mc_token_span (ptr, ptr_e - ptr);
         if (len <= MAX_KEY_LEN) {
-          key_buffer[len++] = *ptr;
+          // len saturates at MAX_KEY_LEN + 1, the key is then reported too long
+          int copy = span < MAX_KEY_LEN + 1 - len ? span : MAX_KEY_LEN + 1 - len;
+          memcpy (key_buffer + len, ptr, copy);
+          len += copy;
         }
-        ptr++;
+        ptr += span;
         if (ptr == ptr_e) {
           nbit_advance (&r_it, ptr - ptr_s);
           skip += ptr - ptr_s;
@@ -454,11 +459,11 @@ int mcs_parse_execute (struct connection *c) {
           break;
         }
        
-      case mqp_readkey:
-        while (ptr < ptr_e && (unsigned char) *ptr > ' ') {
-          D->key_len++;
-          ptr++;
-        }
+      case mqp_readkey: {
+        const int span = (int) vk::simd_mc_key_span (ptr, ptr_e - ptr);
+        D->key_len += span;
+        ptr += span;
+      }
         if (ptr == ptr_e) {
           break;
         }
@@ -530,10 +535,12 @@ int mcs_parse_execute (struct connection *c) {
       case mqp_readtoeoln:
 
         while (ptr < ptr_e && (*ptr != '\r' && *ptr != '\n')) {
-          if ((unsigned char) *ptr < ' ' && *ptr != '\t') {
+          ptr += vk::simd_mc_line_span (ptr, ptr_e - ptr);
+          if (ptr < ptr_e && *ptr != '\r' && *ptr != '\n') {
+            // a control byte other than tab poisons the query, as before
             D->query_flags |= 16;
+            ptr++;
           }
-          ptr++;
         }
         if (ptr == ptr_e) {
           break;
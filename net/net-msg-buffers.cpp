@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include "common/kprintf.h"
@@ -29,6 +30,9 @@ PARALLEL_COUNTER(total_used_buffers);
 PARALLEL_COUNTER(total_used_buffers_size);
 PARALLEL_MAXIMUM(max_total_used_buffers_size);
 PARALLEL_LIMIT_COUNTER(allocated_buffer_bytes);
+PARALLEL_COUNTER(huge_buffer_allocations);
+PARALLEL_COUNTER(huge_buffers_used);
+PARALLEL_COUNTER(huge_buffers_used_size);
 
 static long long allocated_buffer_bytes_limit = MSG_DEFAULT_MAX_ALLOCATED_BYTES;
 
@@ -41,6 +45,33 @@ OPTION_PARSER(OPT_NETWORK, "msg-buffers-size", required_argument, "memory for ud
   return 0;
 }
 
+#define BUFFER_SIZE_NUM 5
+static const int default_buffer_sizes[BUFFER_SIZE_NUM] = {48, 512, 2048, 16384, 262144};
+static lockfree_slab_cache_t slab_caches[BUFFER_SIZE_NUM];
+static __thread lockfree_slab_cache_tls_t slab_caches_tls[BUFFER_SIZE_NUM];
+
+// per size class: slab blocks held from the system and buffers handed out of them,
+// aggregated over threads; the ratio shows how fragmented each slab class is
+static parallel_counter_t buffer_slab_used_blocks[BUFFER_SIZE_NUM];
+static __thread parallel_counter_tls_t buffer_slab_used_blocks_tls[BUFFER_SIZE_NUM];
+static parallel_counter_t buffer_slab_used_buffers[BUFFER_SIZE_NUM];
+static __thread parallel_counter_tls_t buffer_slab_used_buffers_tls[BUFFER_SIZE_NUM];
+static parallel_counter_t buffer_slab_total_allocations[BUFFER_SIZE_NUM];
+static __thread parallel_counter_tls_t buffer_slab_total_allocations_tls[BUFFER_SIZE_NUM];
+
+// huge buffers bypass the slab caches: each one lives in its own anonymous mapping
+// which is returned to the system as soon as the last reference is dropped. The
+// embedded cache_tls only carries the payload size for msg_buffer_size() and the
+// sentinel cache pointer free_msg_buffer() dispatches on.
+struct msg_huge_buffer {
+  lockfree_slab_cache_tls_t cache_tls;
+  size_t mmap_bytes;
+  msg_buffer_t buffer;
+};
+typedef struct msg_huge_buffer msg_huge_buffer_t;
+
+static lockfree_slab_cache_t huge_buffer_cache_sentinel;
+
 STATS_PROVIDER(msg_buffers, 1000) {
   add_histogram_stat_long(stats, "allocated_buffer_bytes", PARALLEL_LIMIT_COUNTER_READ(allocated_buffer_bytes));
   add_histogram_stat_long(stats, "buffer_chunk_allocations", PARALLEL_COUNTER_READ(buffer_slab_alloc_ops));
@@ -48,6 +79,24 @@ STATS_PROVIDER(msg_buffers, 1000) {
   add_histogram_stat_long(stats, "max_total_used_buffers_size", PARALLEL_MAXIMUM_READ(max_total_used_buffers_size));
   add_histogram_stat_long(stats, "total_used_buffers", PARALLEL_COUNTER_READ(total_used_buffers));
   add_histogram_stat_long(stats, "total_used_buffers_size", PARALLEL_COUNTER_READ(total_used_buffers_size));
+
+  for (int i = 0; i < BUFFER_SIZE_NUM; ++i) {
+    char key[64];
+    const uint64_t blocks = parallel_counter_read(&buffer_slab_used_blocks[i]);
+    const uint64_t buffers = parallel_counter_read(&buffer_slab_used_buffers[i]);
+    snprintf(key, sizeof(key), "buffer_slab_%d_used_blocks", default_buffer_sizes[i]);
+    add_histogram_stat_long(stats, key, blocks);
+    snprintf(key, sizeof(key), "buffer_slab_%d_used_buffers", default_buffer_sizes[i]);
+    add_histogram_stat_long(stats, key, buffers);
+    snprintf(key, sizeof(key), "buffer_slab_%d_occupancy", default_buffer_sizes[i]);
+    add_histogram_stat_double(stats, key, blocks ? 1.0 * buffers / (blocks * slab_caches[i].objects_in_block) : 0);
+    snprintf(key, sizeof(key), "buffer_slab_%d_total_allocations", default_buffer_sizes[i]);
+    add_histogram_stat_long(stats, key, parallel_counter_read(&buffer_slab_total_allocations[i]));
+  }
+
+  add_histogram_stat_long(stats, "huge_buffer_allocations", PARALLEL_COUNTER_READ(huge_buffer_allocations));
+  add_histogram_stat_long(stats, "huge_buffers_used", PARALLEL_COUNTER_READ(huge_buffers_used));
+  add_histogram_stat_long(stats, "huge_buffers_used_size", PARALLEL_COUNTER_READ(huge_buffers_used_size));
 }
 
 void decrease_msg_buffers_size(int factor) {
@@ -66,11 +115,6 @@ bool is_allocated_buffers_overflow() {
   return PARALLEL_LIMIT_COUNTER_READ_APPROX(allocated_buffer_bytes) * 3LL > allocated_buffer_bytes_limit * 2LL;
 }
 
-#define BUFFER_SIZE_NUM 5
-static const int default_buffer_sizes[BUFFER_SIZE_NUM] = {48, 512, 2048, 16384, 262144};
-static lockfree_slab_cache_t slab_caches[BUFFER_SIZE_NUM];
-static __thread lockfree_slab_cache_tls_t slab_caches_tls[BUFFER_SIZE_NUM];
-
 static void msg_buffers_constructor() __attribute__((constructor));
 static void msg_buffers_constructor() {
   for (int i = 0; i < BUFFER_SIZE_NUM; ++i) {
@@ -83,6 +127,9 @@ static void init_slab_caches() {
   for (int i = 0; i < BUFFER_SIZE_NUM; ++i) {
     lockfree_slab_cache_register_thread(&slab_caches[i], &slab_caches_tls[i]);
     slab_caches_tls[i].extra = default_buffer_sizes[i];
+    parallel_counter_register_thread(&buffer_slab_used_blocks[i], &buffer_slab_used_blocks_tls[i]);
+    parallel_counter_register_thread(&buffer_slab_used_buffers[i], &buffer_slab_used_buffers_tls[i]);
+    parallel_counter_register_thread(&buffer_slab_total_allocations[i], &buffer_slab_total_allocations_tls[i]);
   }
 }
 
@@ -96,6 +143,9 @@ void msg_buffers_register_thread() {
   PARALLEL_COUNTER_REGISTER_THREAD(total_used_buffers_size);
   PARALLEL_MAXIMUM_REGISTER_THREAD(max_total_used_buffers_size);
   PARALLEL_LIMIT_COUNTER_REGISTER_THREAD(allocated_buffer_bytes);
+  PARALLEL_COUNTER_REGISTER_THREAD(huge_buffer_allocations);
+  PARALLEL_COUNTER_REGISTER_THREAD(huge_buffers_used);
+  PARALLEL_COUNTER_REGISTER_THREAD(huge_buffers_used_size);
   init_msg();
 }
 
@@ -108,12 +158,69 @@ void preallocate_msg_buffers() {
   }
 }
 
-/* allocates buffer of at least given size, -1 = maximal */
+static msg_buffer_t *alloc_huge_msg_buffer(int size_hint) {
+  const size_t header_bytes = offsetof(msg_huge_buffer_t, buffer) + offsetof(msg_buffer_t, data);
+  const size_t page_mask = sysconf(_SC_PAGESIZE) - 1;
+  const size_t mmap_bytes = (header_bytes + size_hint + page_mask) & ~page_mask;
+
+  if (!PARALLEL_LIMIT_COUNTER_ADD(allocated_buffer_bytes, mmap_bytes)) {
+    return NULL;
+  }
+
+  void *region = mmap(NULL, mmap_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (region == MAP_FAILED) {
+    PARALLEL_LIMIT_COUNTER_SUB(allocated_buffer_bytes, mmap_bytes);
+    return NULL;
+  }
+
+  msg_huge_buffer_t *huge = static_cast<msg_huge_buffer_t *>(region);
+  huge->cache_tls.cache = &huge_buffer_cache_sentinel;
+  huge->cache_tls.extra = mmap_bytes - header_bytes;
+  huge->mmap_bytes = mmap_bytes;
+  huge->buffer.cache_tls = &huge->cache_tls;
+  huge->buffer.refcnt = 1;
+
+  PARALLEL_COUNTER_INC(huge_buffer_allocations);
+  PARALLEL_COUNTER_INC(huge_buffers_used);
+  PARALLEL_COUNTER_ADD(huge_buffers_used_size, mmap_bytes);
+  PARALLEL_COUNTER_INC(total_used_buffers);
+  PARALLEL_COUNTER_ADD(total_used_buffers_size, mmap_bytes);
+  PARALLEL_MAXIMUM_ADD(max_total_used_buffers_size, mmap_bytes);
+
+  return &huge->buffer;
+}
+
+static void free_huge_msg_buffer(msg_buffer_t *buffer) {
+  msg_huge_buffer_t *huge = (msg_huge_buffer_t *)((char *)buffer - offsetof(msg_huge_buffer_t, buffer));
+  const size_t mmap_bytes = huge->mmap_bytes;
+
+  PARALLEL_COUNTER_DEC(huge_buffers_used);
+  PARALLEL_COUNTER_SUB(huge_buffers_used_size, mmap_bytes);
+  PARALLEL_COUNTER_DEC(total_used_buffers);
+  PARALLEL_COUNTER_SUB(total_used_buffers_size, mmap_bytes);
+  PARALLEL_MAXIMUM_SUB(max_total_used_buffers_size, mmap_bytes);
+  PARALLEL_LIMIT_COUNTER_SUB(allocated_buffer_bytes, mmap_bytes);
+
+  assert(!munmap(huge, mmap_bytes));
+}
+
+int msg_buffer_floor_size(int bytes) {
+  int si = 0;
+  while (si + 1 < BUFFER_SIZE_NUM && default_buffer_sizes[si + 1] <= bytes) {
+    si++;
+  }
+  return default_buffer_sizes[si];
+}
+
+/* allocates buffer of at least given size, -1 = maximal size class */
 msg_buffer_t *alloc_msg_buffer(int size_hint) {
   preallocate_msg_buffers();
 
   int si = buffer_size_values - 1;
   if (size_hint >= 0) {
+    if (size_hint > default_buffer_sizes[si]) {
+      return alloc_huge_msg_buffer(size_hint);
+    }
     while (si > 0 && default_buffer_sizes[si - 1] >= size_hint) {
       si--;
     }
@@ -129,6 +236,9 @@ msg_buffer_t *alloc_msg_buffer(int size_hint) {
   msg_buffer_t *buffer = static_cast<msg_buffer_t *>(lockfree_slab_cache_alloc(cache_tls));
   const unsigned delta = lockfree_slab_cache_count_used_blocks(cache_tls) - blocks_before;
   PARALLEL_COUNTER_ADD(buffer_slab_alloc_ops, delta);
+  parallel_counter_add(&buffer_slab_used_blocks_tls[si], delta);
+  parallel_counter_inc(&buffer_slab_used_buffers_tls[si]);
+  parallel_counter_inc(&buffer_slab_total_allocations_tls[si]);
 
   buffer->cache_tls = cache_tls;
   buffer->refcnt = 1;
@@ -144,6 +254,10 @@ void free_msg_buffer(msg_buffer_t *buffer) {
   assert(!buffer->refcnt);
 
   lockfree_slab_cache_t *cache = buffer->cache_tls->cache;
+  if (cache == &huge_buffer_cache_sentinel) {
+    free_huge_msg_buffer(buffer);
+    return;
+  }
   lockfree_slab_cache_tls_t *cache_tls = &slab_caches_tls[cache - slab_caches];
 
   PARALLEL_COUNTER_DEC(total_used_buffers);
@@ -151,10 +265,13 @@ void free_msg_buffer(msg_buffer_t *buffer) {
   PARALLEL_MAXIMUM_SUB(max_total_used_buffers_size, cache->object_size);
   PARALLEL_LIMIT_COUNTER_SUB(allocated_buffer_bytes, cache->object_size);
 
+  const int si = cache - slab_caches;
   const unsigned blocks_before = lockfree_slab_cache_count_used_blocks(cache_tls);
   lockfree_slab_cache_free(cache_tls, buffer);
   const unsigned delta = blocks_before - lockfree_slab_cache_count_used_blocks(cache_tls);
   PARALLEL_COUNTER_SUB(buffer_slab_alloc_ops, delta);
+  parallel_counter_sub(&buffer_slab_used_blocks_tls[si], delta);
+  parallel_counter_dec(&buffer_slab_used_buffers_tls[si]);
 }
 
 double msg_buffers_usage() {
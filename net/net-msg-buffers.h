@@ -15,6 +15,11 @@
 #define MSG_SMALL_BUFFER 512
 #define MSG_TINY_BUFFER 48
 
+/* size hints of at least this many bytes are served by a dedicated anonymous
+   mapping instead of the slab size classes, so multi-megabyte payloads occupy
+   one part instead of a long chain */
+#define MSG_HUGE_BUFFER (1 << 20)
+
 DECLARE_VERBOSITY(net_msg);
 
 struct msg_buffer {
@@ -36,6 +41,10 @@ void preallocate_msg_buffers();
 
 msg_buffer_t *alloc_msg_buffer(int size_hint);
 
+/* largest buffer size class not exceeding the given byte count (the smallest
+   class if nothing fits); lets bulk writers pick buffers they will fill completely */
+int msg_buffer_floor_size(int bytes);
+
 void free_msg_buffer(msg_buffer_t *buffer);
 
 void decrease_msg_buffers_size(int factor);
@@ -8,11 +8,21 @@
 
 #include "common/allocators/lockfree-slab.h"
 #include "common/parallel/counter.h"
+#include "common/stats/provider.h"
 
 static lockfree_slab_cache_t msg_part_cache;
 static __thread lockfree_slab_cache_tls_t msg_part_cache_tls;
 
 PARALLEL_COUNTER(rwm_total_msg_parts);
+PARALLEL_COUNTER(rwm_msg_part_slab_blocks);
+
+STATS_PROVIDER(msg_parts, 1000) {
+  const uint64_t blocks = PARALLEL_COUNTER_READ(rwm_msg_part_slab_blocks);
+  const uint64_t parts = PARALLEL_COUNTER_READ(rwm_total_msg_parts);
+  add_histogram_stat_long(stats, "msg_part_slab_blocks", blocks);
+  add_histogram_stat_long(stats, "total_msg_parts", parts);
+  add_histogram_stat_double(stats, "msg_part_slab_occupancy", blocks ? 1.0 * parts / (blocks * msg_part_cache.objects_in_block) : 0);
+}
 
 static void __attribute__((constructor)) msg_part_constructor() {
   lockfree_slab_cache_init(&msg_part_cache, sizeof(msg_part_t));
@@ -20,7 +30,10 @@ static void __attribute__((constructor)) msg_part_constructor() {
 
 static msg_part_t *alloc_msg_part() {
   PARALLEL_COUNTER_INC(rwm_total_msg_parts);
-  return static_cast<msg_part_t*>(lockfree_slab_cache_alloc(&msg_part_cache_tls));
+  const unsigned blocks_before = lockfree_slab_cache_count_used_blocks(&msg_part_cache_tls);
+  msg_part_t *mp = static_cast<msg_part_t*>(lockfree_slab_cache_alloc(&msg_part_cache_tls));
+  PARALLEL_COUNTER_ADD(rwm_msg_part_slab_blocks, lockfree_slab_cache_count_used_blocks(&msg_part_cache_tls) - blocks_before);
+  return mp;
 }
 
 msg_part_t *new_msg_part(msg_buffer_t *X) {
@@ -36,12 +49,15 @@ msg_part_t *new_msg_part(msg_buffer_t *X) {
 
 void init_msg_part() {
   PARALLEL_COUNTER_REGISTER_THREAD(rwm_total_msg_parts);
+  PARALLEL_COUNTER_REGISTER_THREAD(rwm_msg_part_slab_blocks);
   lockfree_slab_cache_register_thread(&msg_part_cache, &msg_part_cache_tls);
 }
 
 void free_msg_part(msg_part_t *mp) {
   PARALLEL_COUNTER_DEC(rwm_total_msg_parts);
+  const unsigned blocks_before = lockfree_slab_cache_count_used_blocks(&msg_part_cache_tls);
   lockfree_slab_cache_free(&msg_part_cache_tls, mp);
+  PARALLEL_COUNTER_SUB(rwm_msg_part_slab_blocks, blocks_before - lockfree_slab_cache_count_used_blocks(&msg_part_cache_tls));
 }
 
 int rwm_total_msg_parts() {
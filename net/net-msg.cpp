@@ -205,7 +205,17 @@ int rwm_push_data_ext(raw_message_t *raw, const void *data, int alloc_bytes, int
   }
   while (alloc_bytes > 0) {
     mpl = mp;
-    msg_buffer_t *buffer = alloc_msg_buffer(raw->total_bytes + alloc_bytes >= std_buffer ? std_buffer : small_buffer);
+    int size_hint;
+    if (alloc_bytes >= MSG_HUGE_BUFFER) {
+      // one mmap-backed buffer for the whole tail instead of a long part chain
+      size_hint = alloc_bytes;
+    } else if (alloc_bytes > std_buffer) {
+      // largest size class the remaining bytes fill completely
+      size_hint = std::max(msg_buffer_floor_size(alloc_bytes), std_buffer);
+    } else {
+      size_hint = raw->total_bytes + alloc_bytes >= std_buffer ? std_buffer : small_buffer;
+    }
+    msg_buffer_t *buffer = alloc_msg_buffer(size_hint);
     if (!buffer) {
       return res;
     }
@@ -72,6 +72,10 @@ void rwm_check(raw_message_t *raw);
 void fork_message_chain(raw_message_t *raw);
 void rwm_fork_deep(raw_message_t *raw);
 
+// maps the msg_part chain onto iovecs without copying; tcp_server_writer feeds the
+// result (up to IOV_MAX entries) straight to writev, partial writes are resumed by
+// advancing the message with rwm_fetch_data — the only copying transmit path left
+// is the crypto one, which has to encrypt into c->out_p anyway
 int rwm_prepare_iovec(const raw_message_t *raw, struct iovec *iov, int iov_len, int bytes);
 void rwm_dump_sizes(raw_message_t *raw);
 void rwm_dump(raw_message_t *raw);
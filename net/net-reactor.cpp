@@ -37,12 +37,16 @@ void net_reactor_alloc(net_reactor_ctx_t *ctx, int max_events, int max_timers) {
   ctx->max_timers = max_timers;
   ctx->timestamp = 0;
   ctx->event_heap_size = 0;
-  ctx->timer_heap_size = 0;
+  ctx->timers_count = 0;
   ctx->now = 0;
   ctx->prev_now = 0;
+  ctx->timers_now_ms = 0;
   ctx->events = static_cast<event_t*>(calloc(max_events, sizeof(ctx->events[0])));
   ctx->event_heap = static_cast<event_t**>(calloc(max_events + 1, sizeof(ctx->event_heap[0])));
-  ctx->timer_heap = static_cast<event_timer_t**>(calloc(max_timers + 1, sizeof(ctx->timer_heap[0])));
+  ctx->timer_wheel = static_cast<event_timer_t*>(calloc(EVENT_TIMER_WHEEL_SLOTS, sizeof(ctx->timer_wheel[0])));
+  for (int i = 0; i < EVENT_TIMER_WHEEL_SLOTS; i++) {
+    ctx->timer_wheel[i].wheel_prev = ctx->timer_wheel[i].wheel_next = &ctx->timer_wheel[i];
+  }
   ctx->epoll_events = static_cast<epoll_event*>(calloc(max_events, sizeof(ctx->epoll_events[0])));
   ctx->pre_runqueue = ctx->post_runqueue = ctx->pre_event = NULL;
   ctx->wait_start = 0;
@@ -55,7 +59,7 @@ void net_reactor_alloc(net_reactor_ctx_t *ctx, int max_events, int max_timers) {
 void net_reactor_free(net_reactor_ctx_t *ctx) {
   free(ctx->events);
   free(ctx->event_heap);
-  free(ctx->timer_heap);
+  free(ctx->timer_wheel);
   free(ctx->epoll_events);
 }
 
@@ -273,7 +277,7 @@ void net_reactor_fetch_events(net_reactor_ctx_t *ctx, int num_events) {
     event_t *event = &ctx->events[fd];
     assert(event->fd == fd);
     event->epoll_ready = ctx->epoll_events[i].events;
-    event->ready |= epoll_unconv_flags(event->epoll_ready = ctx->epoll_events[i].events);
+    event->ready |= epoll_unconv_flags(event->epoll_ready);
     event->timestamp = ctx->timestamp;
     net_reactor_put_event_into_heap(ctx, event);
   }
@@ -382,33 +386,100 @@ int net_reactor_close(net_reactor_ctx_t *ctx, int fd) {
   return 0;
 }
 
-static inline int basic_et_adjust(net_reactor_ctx_t *ctx, event_timer_t *et, int i) {
-  int j;
-  while (i > 1) {
-    j = (i >> 1);
-    if (ctx->timer_heap[j]->wakeup_time <= et->wakeup_time) {
-      break;
-    }
-    ctx->timer_heap[i] = ctx->timer_heap[j];
-    ctx->timer_heap[i]->h_idx = i;
-    i = j;
+/* hierarchical timing wheel: O(1) arm and disarm, which matters because the vast
+   majority of timeouts are cancelled long before they fire; expiry cost is paid
+   per wheel tick actually crossed instead of per-timer heap churn */
+
+static inline uint64_t event_timer_tick(double wakeup_time) {
+  return (uint64_t)(wakeup_time * 1e3);
+}
+
+static inline void event_timer_unlink(event_timer_t *et) {
+  et->wheel_prev->wheel_next = et->wheel_next;
+  et->wheel_next->wheel_prev = et->wheel_prev;
+}
+
+static inline void event_timer_link(event_timer_t *slot, event_timer_t *et) {
+  et->wheel_prev = slot->wheel_prev;
+  et->wheel_next = slot;
+  slot->wheel_prev->wheel_next = et;
+  slot->wheel_prev = et;
+}
+
+static event_timer_t *net_reactor_timer_wheel_slot(net_reactor_ctx_t *ctx, uint64_t tick) {
+  const uint64_t delta = tick - ctx->timers_now_ms; /* caller guarantees tick > timers_now_ms */
+  if (delta < (1ull << EVENT_TIMER_WHEEL_L0_BITS)) {
+    return &ctx->timer_wheel[tick & ((1 << EVENT_TIMER_WHEEL_L0_BITS) - 1)];
   }
-  j = 2 * i;
-  while (j <= ctx->timer_heap_size) {
-    if (j < ctx->timer_heap_size && ctx->timer_heap[j]->wakeup_time > ctx->timer_heap[j + 1]->wakeup_time) {
-      j++;
+  int shift = EVENT_TIMER_WHEEL_L0_BITS;
+  int base = 1 << EVENT_TIMER_WHEEL_L0_BITS;
+  for (int level = 1;; level++) {
+    if (level == EVENT_TIMER_WHEEL_LEVELS - 1 || delta < (1ull << (shift + EVENT_TIMER_WHEEL_LEVEL_BITS))) {
+      /* deltas beyond the top level range park in the top wheel and recascade */
+      return &ctx->timer_wheel[base + ((tick >> shift) & ((1 << EVENT_TIMER_WHEEL_LEVEL_BITS) - 1))];
     }
-    if (et->wakeup_time <= ctx->timer_heap[j]->wakeup_time) {
+    shift += EVENT_TIMER_WHEEL_LEVEL_BITS;
+    base += 1 << EVENT_TIMER_WHEEL_LEVEL_BITS;
+  }
+}
+
+static void net_reactor_timer_wheel_place(net_reactor_ctx_t *ctx, event_timer_t *et) {
+  uint64_t tick = event_timer_tick(et->wakeup_time);
+  if (tick <= ctx->timers_now_ms) {
+    tick = ctx->timers_now_ms + 1; /* already due: fire on the next tick the wheel crosses */
+  }
+  event_timer_link(net_reactor_timer_wheel_slot(ctx, tick), et);
+}
+
+/* at a lower wheel wraparound, reinsert the timers of the current coarse slot:
+   they are now within range of a finer level (or due) */
+static void net_reactor_timer_wheel_cascade(net_reactor_ctx_t *ctx, int level) {
+  const int shift = EVENT_TIMER_WHEEL_L0_BITS + (level - 1) * EVENT_TIMER_WHEEL_LEVEL_BITS;
+  const int base = (1 << EVENT_TIMER_WHEEL_L0_BITS) + (level - 1) * (1 << EVENT_TIMER_WHEEL_LEVEL_BITS);
+  event_timer_t *slot = &ctx->timer_wheel[base + ((ctx->timers_now_ms >> shift) & ((1 << EVENT_TIMER_WHEEL_LEVEL_BITS) - 1))];
+
+  event_timer_t *et = slot->wheel_next;
+  slot->wheel_prev = slot->wheel_next = slot;
+  while (et != slot) {
+    event_timer_t *next = et->wheel_next;
+    net_reactor_timer_wheel_place(ctx, et);
+    et = next;
+  }
+}
+
+/* lower bound in ms on the next moment the wheel has work: exact for the ms level,
+   the next cascade boundary for coarser levels; may wake early, never late */
+static int net_reactor_timer_wheel_wait(net_reactor_ctx_t *ctx) {
+  const uint64_t now = ctx->timers_now_ms;
+  uint64_t bound = 100000;
+
+  for (uint64_t d = 1; d < (1 << EVENT_TIMER_WHEEL_L0_BITS) && d < bound; d++) {
+    const event_timer_t *slot = &ctx->timer_wheel[(now + d) & ((1 << EVENT_TIMER_WHEEL_L0_BITS) - 1)];
+    if (slot->wheel_next != slot) {
+      bound = d;
       break;
     }
-    ctx->timer_heap[i] = ctx->timer_heap[j];
-    ctx->timer_heap[i]->h_idx = i;
-    i = j;
-    j <<= 1;
   }
-  ctx->timer_heap[i] = et;
-  et->h_idx = i;
-  return i;
+
+  int shift = EVENT_TIMER_WHEEL_L0_BITS;
+  int base = 1 << EVENT_TIMER_WHEEL_L0_BITS;
+  for (int level = 1; level < EVENT_TIMER_WHEEL_LEVELS; level++) {
+    const uint64_t cur = now >> shift;
+    for (uint64_t d = 1; d <= (1 << EVENT_TIMER_WHEEL_LEVEL_BITS); d++) {
+      const event_timer_t *slot = &ctx->timer_wheel[base + ((cur + d) & ((1 << EVENT_TIMER_WHEEL_LEVEL_BITS) - 1))];
+      if (slot->wheel_next != slot) {
+        const uint64_t cascade_at = (cur + d) << shift;
+        if (cascade_at - now < bound) {
+          bound = cascade_at - now;
+        }
+        break;
+      }
+    }
+    shift += EVENT_TIMER_WHEEL_LEVEL_BITS;
+    base += 1 << EVENT_TIMER_WHEEL_LEVEL_BITS;
+  }
+
+  return (int)(bound < 100000 ? bound : 100000);
 }
 
 static int event_timer_cmp(const void *l, const void *r) {
@@ -424,73 +495,98 @@ static int event_timer_cmp(const void *l, const void *r) {
 }
 
 static void dump_too_many_event_timers(net_reactor_ctx_t *ctx) {
-  tvkprintf(net_events, 0, "Too many event timers: %d\n", ctx->timer_heap_size);
-  qsort(&ctx->timer_heap[1], (size_t) ctx->timer_heap_size, sizeof(ctx->timer_heap[0]), event_timer_cmp);
-  for (int i = 1; i <= ctx->timer_heap_size;) {
+  tvkprintf(net_events, 0, "Too many event timers: %d\n", ctx->timers_count);
+  event_timer_t **all = static_cast<event_timer_t **>(malloc(sizeof(event_timer_t *) * ctx->timers_count));
+  int n = 0;
+  for (int i = 0; i < EVENT_TIMER_WHEEL_SLOTS; i++) {
+    for (event_timer_t *et = ctx->timer_wheel[i].wheel_next; et != &ctx->timer_wheel[i]; et = et->wheel_next) {
+      all[n++] = et;
+    }
+  }
+  assert(n == ctx->timers_count);
+  qsort(all, (size_t) n, sizeof(all[0]), event_timer_cmp);
+  for (int i = 0; i < n;) {
     int j = i;
-    while (j != ctx->timer_heap_size + 1 && event_timer_cmp(&ctx->timer_heap[i], &ctx->timer_heap[j]) == 0) {
+    while (j != n && event_timer_cmp(&all[i], &all[j]) == 0) {
       j++;
     }
-    tvkprintf(net_events, 0, "%d * %s\n", j - i, ctx->timer_heap[i]->operation);
+    tvkprintf(net_events, 0, "%d * %s\n", j - i, all[i]->operation);
     i = j;
   }
+  free(all);
 }
 
 bool net_reactor_has_too_many_timers(net_reactor_ctx_t *ctx) {
-  return ctx->timer_heap_size * 2 >= ctx->max_timers;
+  return ctx->timers_count * 2 >= ctx->max_timers;
 }
 
 int net_reactor_insert_event_timer(net_reactor_ctx_t *ctx, event_timer_t *et) {
-  int i;
   if (et->h_idx) {
-    i = et->h_idx;
-    assert(i > 0 && i <= ctx->timer_heap_size && ctx->timer_heap[i] == et);
+    event_timer_unlink(et); /* re-arm with a new wakeup_time */
   } else {
-    if (ctx->timer_heap_size >= ctx->max_timers) {
+    if (ctx->timers_count >= ctx->max_timers) {
       dump_too_many_event_timers(ctx);
     }
-    assert(ctx->timer_heap_size < ctx->max_timers);
-    i = ++ctx->timer_heap_size;
+    assert(ctx->timers_count < ctx->max_timers);
+    if (!ctx->timers_count) {
+      /* the wheel did not tick while empty, bring it up to date in O(1) */
+      ctx->timers_now_ms = event_timer_tick(precise_now);
+    }
+    ctx->timers_count++;
+    et->h_idx = 1;
   }
-
-  return basic_et_adjust(ctx, et, i);
+  net_reactor_timer_wheel_place(ctx, et);
+  return 1;
 }
 
 int net_reactor_remove_event_timer(net_reactor_ctx_t *ctx, event_timer_t *et) {
-  int i = et->h_idx;
-  if (!i) {
+  if (!et->h_idx) {
     return 0;
   }
-  assert(i > 0 && i <= ctx->timer_heap_size && ctx->timer_heap[i] == et);
   et->h_idx = 0;
-
-  et = ctx->timer_heap[ctx->timer_heap_size--];
-  if (i > ctx->timer_heap_size) {
-    return 1;
-  }
-  basic_et_adjust(ctx, et, i);
+  event_timer_unlink(et);
+  ctx->timers_count--;
   return 1;
 }
 
 int net_reactor_run_timers(net_reactor_ctx_t *ctx) {
-  double wait_time;
-  event_timer_t *et;
-  if (!ctx->timer_heap_size) {
+  if (!ctx->timers_count) {
+    ctx->timers_now_ms = event_timer_tick(precise_now);
     return 100000;
   }
-  wait_time = ctx->timer_heap[1]->wakeup_time - precise_now;
-  if (wait_time > 0) {
+  const uint64_t now_ms = event_timer_tick(precise_now);
+  if (ctx->timers_now_ms >= now_ms) {
+    const int wait_time = net_reactor_timer_wheel_wait(ctx);
     // do not remove this useful debug!
-    tvkprintf(net_events, 3, "%d event timers, next in %.3f seconds\n", ctx->timer_heap_size, wait_time);
-    return (int)(std::min(100.0, wait_time) * 1000) + 1; // min to prevent integer overflow
+    tvkprintf(net_events, 3, "%d event timers, next in at most %.3f seconds\n", ctx->timers_count, wait_time * 0.001);
+    return wait_time;
   }
 
   const vk::net::TimeSlice time_slice(max_time_slice);
-  while (ctx->timer_heap_size > 0 && ctx->timer_heap[1]->wakeup_time <= precise_now && !pending_signals && !time_slice.expired()) {
-    et = ctx->timer_heap[1];
-    assert(et->h_idx == 1);
-    net_reactor_remove_event_timer(ctx, et);
-    et->wakeup(et);
+  while (ctx->timers_now_ms < now_ms && !pending_signals && !time_slice.expired()) {
+    ctx->timers_now_ms++;
+    if ((ctx->timers_now_ms & ((1 << EVENT_TIMER_WHEEL_L0_BITS) - 1)) == 0) {
+      int shift = EVENT_TIMER_WHEEL_L0_BITS;
+      for (int level = 1; level < EVENT_TIMER_WHEEL_LEVELS; level++) {
+        net_reactor_timer_wheel_cascade(ctx, level);
+        shift += EVENT_TIMER_WHEEL_LEVEL_BITS;
+        if (ctx->timers_now_ms & ((1ull << shift) - 1)) {
+          break;
+        }
+      }
+    }
+
+    event_timer_t *slot = &ctx->timer_wheel[ctx->timers_now_ms & ((1 << EVENT_TIMER_WHEEL_L0_BITS) - 1)];
+    while (slot->wheel_next != slot && !pending_signals && !time_slice.expired()) {
+      event_timer_t *et = slot->wheel_next;
+      net_reactor_remove_event_timer(ctx, et);
+      et->wakeup(et);
+    }
+
+    if (!ctx->timers_count) {
+      ctx->timers_now_ms = now_ms; /* nothing left to expire or cascade */
+      break;
+    }
   }
   return 0;
 }
@@ -551,7 +647,7 @@ int net_reactor_runqueue(net_reactor_ctx_t *ctx) {
 }
 
 int net_reactor_work_timers(net_reactor_ctx_t *ctx, int timeout) {
-  if (ctx->event_heap_size || ctx->timer_heap_size) {
+  if (ctx->event_heap_size || ctx->timers_count) {
     ctx->now = time(0);
     get_utime_monotonic();
     const vk::net::TimeSlice time_slice(max_time_slice);
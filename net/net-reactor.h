@@ -9,6 +9,7 @@
 #include <sys/epoll.h>
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #define EVT_READ        4
 #define EVT_WRITE       2
@@ -52,9 +53,18 @@ struct event_descr {
 
 typedef struct event_timer event_timer_t;
 
+/* hierarchical timing wheel geometry: 256 one-millisecond slots near-term,
+   then four levels of 64 slots each 64x coarser, covering ~49 days total */
+#define EVENT_TIMER_WHEEL_L0_BITS 8
+#define EVENT_TIMER_WHEEL_LEVEL_BITS 6
+#define EVENT_TIMER_WHEEL_LEVELS 5
+#define EVENT_TIMER_WHEEL_SLOTS ((1 << EVENT_TIMER_WHEEL_L0_BITS) + (EVENT_TIMER_WHEEL_LEVELS - 1) * (1 << EVENT_TIMER_WHEEL_LEVEL_BITS))
+
 typedef int (*event_timer_wakeup_t)(event_timer_t *et);
 struct event_timer {
-  int h_idx;
+  event_timer_t *wheel_prev; /* intrusive slot list, meaningful only while armed */
+  event_timer_t *wheel_next;
+  int h_idx; /* non-zero while armed; kept under the historical name, external code checks and zeroes it */
   event_timer_wakeup_t wakeup;
   double wakeup_time;
   const char *operation;
@@ -65,15 +75,16 @@ struct net_reactor_ctx {
   int max_events;
   int max_timers;
   int event_heap_size;
-  int timer_heap_size;
+  int timers_count;
   int now;
   int prev_now;
   int64_t timestamp;
+  uint64_t timers_now_ms; /* last wheel tick brought up to date by net_reactor_run_timers */
   struct epoll_event *epoll_events;
   event_t *events;
   event_t *timers;
   event_t **event_heap;
-  event_timer_t **timer_heap;
+  event_timer_t *timer_wheel; /* EVENT_TIMER_WHEEL_SLOTS sentinel list heads */
   epoll_func_vector_t pre_runqueue;
   epoll_func_vector_t post_runqueue;
   epoll_func_vector_t pre_event;
@@ -90,7 +101,7 @@ static inline int net_reactor_events(const net_reactor_ctx_t *reactor_ctx) {
 }
 
 static inline int net_reactor_timers(const net_reactor_ctx_t *reactor_ctx) {
-  return reactor_ctx->timer_heap_size;
+  return reactor_ctx->timers_count;
 }
 
 void net_reactor_alloc(net_reactor_ctx_t *ctx, int max_events, int max_timers);
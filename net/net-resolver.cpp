@@ -0,0 +1,247 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "net/net-resolver.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "common/kprintf.h"
+#include "common/resolver.h"
+
+#include "net/net-events.h"
+
+#define RESOLV_CONF "/etc/resolv.conf"
+#define DNS_PORT 53
+#define DNS_MAX_PACKET 2048
+#define DNS_RESOLVER_MAX_INFLIGHT 64
+
+/* queries waiting for an answer, indexed by qid; a slot is simply overwritten
+   if its answer never arrives, the cache retries on its own schedule */
+struct dns_query {
+  unsigned short qid;
+  char len; /* 0 = slot free or already answered */
+  char name[128];
+};
+
+static struct dns_query dns_inflight[DNS_RESOLVER_MAX_INFLIGHT];
+static int dns_socket = -1;
+static unsigned short dns_next_qid;
+static unsigned dns_server_ip; /* network byte order */
+
+static void parse_resolv_conf () {
+  dns_server_ip = htonl (INADDR_LOOPBACK);
+  FILE *f = fopen (RESOLV_CONF, "r");
+  if (!f) {
+    return;
+  }
+  char line[256];
+  while (fgets (line, sizeof (line), f)) {
+    char *p = line;
+    while (*p == ' ' || *p == '\t') {
+      p++;
+    }
+    if (strncmp (p, "nameserver", 10) || (p[10] != ' ' && p[10] != '\t')) {
+      continue;
+    }
+    p += 10;
+    while (*p == ' ' || *p == '\t') {
+      p++;
+    }
+    char *end = p;
+    while (*end && *end != ' ' && *end != '\t' && *end != '\n') {
+      end++;
+    }
+    *end = 0;
+    struct in_addr addr;
+    if (inet_pton (AF_INET, p, &addr) == 1) {
+      dns_server_ip = addr.s_addr;
+      break;
+    }
+    /* IPv6 nameservers are skipped, keep looking for an IPv4 one */
+  }
+  fclose (f);
+}
+
+static int dns_skip_name (const unsigned char *buf, int len, int pos) {
+  while (pos < len) {
+    int c = buf[pos];
+    if (!c) {
+      return pos + 1;
+    }
+    if ((c & 0xc0) == 0xc0) {
+      return pos + 2;
+    }
+    pos += c + 1;
+  }
+  return -1;
+}
+
+static void dns_process_reply (const unsigned char *buf, int len) {
+  if (len < 12 || !(buf[2] & 0x80)) {
+    return;
+  }
+  const unsigned short qid = (buf[0] << 8) + buf[1];
+  struct dns_query *q = &dns_inflight[qid % DNS_RESOLVER_MAX_INFLIGHT];
+  if (q->qid != qid || !q->len) {
+    return; /* not ours or already answered */
+  }
+  const int rcode = buf[3] & 0xf;
+  const int qdcount = (buf[4] << 8) + buf[5];
+  const int ancount = (buf[6] << 8) + buf[7];
+  int pos = 12, i;
+  for (i = 0; i < qdcount; i++) {
+    pos = dns_skip_name (buf, len, pos);
+    if (pos < 0 || pos + 4 > len) {
+      return;
+    }
+    pos += 4;
+  }
+  if (rcode) {
+    if (rcode == 3) {
+      /* NXDOMAIN: remember the failure */
+      kdb_dns_cache_store (q->name, q->len, 0, 0);
+    } else {
+      /* SERVFAIL and friends: keep serving the stale entry, the cache retries on its own */
+      vkprintf (2, "dns resolver: rcode %d for %s\n", rcode, q->name);
+    }
+    q->len = 0;
+    return;
+  }
+  for (i = 0; i < ancount; i++) {
+    pos = dns_skip_name (buf, len, pos);
+    if (pos < 0 || pos + 10 > len) {
+      return;
+    }
+    const int type = (buf[pos] << 8) + buf[pos + 1];
+    const int qclass = (buf[pos + 2] << 8) + buf[pos + 3];
+    const unsigned ttl = ((unsigned)buf[pos + 4] << 24) | (buf[pos + 5] << 16) | (buf[pos + 6] << 8) | buf[pos + 7];
+    const int rdlength = (buf[pos + 8] << 8) + buf[pos + 9];
+    pos += 10;
+    if (pos + rdlength > len) {
+      return;
+    }
+    if (type == 1 && qclass == 1 && rdlength == 4) {
+      unsigned ip;
+      memcpy (&ip, buf + pos, 4); /* already in network byte order */
+      kdb_dns_cache_store (q->name, q->len, ip, ttl > 86400 ? 86400 : (int)ttl);
+      q->len = 0;
+      return;
+    }
+    pos += rdlength;
+  }
+  /* a successful answer without a single A record is as good as NXDOMAIN */
+  kdb_dns_cache_store (q->name, q->len, 0, 0);
+  q->len = 0;
+}
+
+static int dns_resolver_reply_gateway (int fd, void *data __attribute__((unused)), event_t *ev __attribute__((unused))) {
+  unsigned char buf[DNS_MAX_PACKET];
+  while (1) {
+    const ssize_t r = recv (fd, buf, sizeof (buf), 0);
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r < 0) {
+      break;
+    }
+    dns_process_reply (buf, (int)r);
+  }
+  return EVA_CONTINUE;
+}
+
+static int open_dns_socket () {
+  if (dns_socket >= 0) {
+    return dns_socket;
+  }
+  if (main_thread_reactor.epoll_fd == -1) {
+    return -1; /* reactor is not initialized yet */
+  }
+  parse_resolv_conf ();
+  const int fd = socket (AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    vkprintf (1, "dns resolver: cannot create socket: %m\n");
+    return -1;
+  }
+  struct sockaddr_in addr;
+  memset (&addr, 0, sizeof (addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (DNS_PORT);
+  addr.sin_addr.s_addr = dns_server_ip;
+  if (connect (fd, (struct sockaddr *)&addr, sizeof (addr)) < 0) {
+    vkprintf (1, "dns resolver: cannot connect to nameserver: %m\n");
+    close (fd);
+    return -1;
+  }
+  epoll_sethandler (fd, 0, dns_resolver_reply_gateway, NULL);
+  epoll_insert (fd, EVT_READ | EVT_SPEC);
+  dns_next_qid = lrand48 ();
+  dns_socket = fd;
+  vkprintf (1, "dns resolver: using nameserver %s\n", inet_ntoa (addr.sin_addr));
+  return dns_socket;
+}
+
+static int dns_make_query (unsigned char *buf, unsigned short qid, const char *name, int len) {
+  memset (buf, 0, 12);
+  buf[0] = qid >> 8;
+  buf[1] = qid & 0xff;
+  buf[2] = 0x01; /* RD */
+  buf[5] = 1;    /* QDCOUNT */
+  int pos = 12;
+  const char *s = name;
+  while (*s) {
+    const char *dot = strchr (s, '.');
+    const int l = dot ? (int)(dot - s) : (int)strlen (s);
+    if (!l || l > 63) {
+      return -1;
+    }
+    buf[pos++] = l;
+    memcpy (buf + pos, s, l);
+    pos += l;
+    s += l;
+    if (*s == '.') {
+      s++;
+    }
+  }
+  buf[pos++] = 0;
+  buf[pos++] = 0;
+  buf[pos++] = 1; /* QTYPE = A */
+  buf[pos++] = 0;
+  buf[pos++] = 1; /* QCLASS = IN */
+  return pos;
+}
+
+int dns_resolver_refresh (const char *name, int len) {
+  if ((unsigned)len >= 128 || open_dns_socket () < 0) {
+    return -1;
+  }
+  unsigned char buf[DNS_MAX_PACKET];
+  const unsigned short qid = ++dns_next_qid;
+  const int r = dns_make_query (buf, qid, name, len);
+  if (r < 0) {
+    return -1;
+  }
+  if (send (dns_socket, buf, r, 0) != r) {
+    vkprintf (2, "dns resolver: send to nameserver failed: %m\n");
+    return -1;
+  }
+  struct dns_query *q = &dns_inflight[qid % DNS_RESOLVER_MAX_INFLIGHT];
+  q->qid = qid;
+  q->len = len;
+  memcpy (q->name, name, len);
+  q->name[len] = 0;
+  vkprintf (3, "dns resolver: refreshing %s, qid %d\n", q->name, qid);
+  return 0;
+}
+
+static void dns_resolver_constructor () __attribute__((constructor));
+static void dns_resolver_constructor () {
+  kdb_dns_cache_refresh_hook = dns_resolver_refresh;
+}
@@ -0,0 +1,15 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#ifndef KDB_NET_NET_RESOLVER_H
+#define KDB_NET_NET_RESOLVER_H
+
+/* asynchronous DNS client behind the resolver cache (common/resolver.cpp):
+   refreshes expired entries with non-blocking UDP queries to the first IPv4
+   nameserver from /etc/resolv.conf, served by the main thread reactor, and
+   stores the answers back through kdb_dns_cache_store(). Installed as
+   kdb_dns_cache_refresh_hook on startup in every binary linked with net. */
+int dns_resolver_refresh (const char *name, int len);
+
+#endif
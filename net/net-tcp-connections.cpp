@@ -20,11 +20,20 @@
 #include "net/net-crypto-aes.h"
 #include "net/net-msg-buffers.h"
 #include "net/net-msg.h"
+#include "net/net-trace.h"
 
 static int tcp_buffers_number = MAX_TCP_RECV_BUFFERS;
 static int tcp_buffers_size = MAX_TCP_RECV_BUFFER_SIZE;
 int tcp_buffers = 1;
 
+static int tcp_write_quantum = 4 << 20;
+OPTION_PARSER(OPT_NETWORK, "tcp-write-quantum", required_argument,
+              "maximum bytes written to one connection per event loop iteration, so one huge response"
+              " cannot head-of-line-block small ones on other connections (default %d, 0 - unlimited)", tcp_write_quantum) {
+  tcp_write_quantum = atoi(optarg);
+  return 0;
+}
+
 static void parse_tcp_buffers(const char *buffers, int *number, int *size) {
   *number = MAX_TCP_RECV_BUFFERS;
   *size = MAX_TCP_RECV_BUFFER_SIZE;
@@ -155,10 +164,16 @@ int tcp_server_writer(struct connection *c) {
       if (r > 0) {
         rwm_fetch_data(out, 0, r);
         t += r;
+        trace_request_bytes_out(c, out->total_bytes == 0);
       }
 
       if (r < s) {
         c->flags |= C_NOWR;
+      } else if (tcp_write_quantum && t >= tcp_write_quantum) {
+        /* the quantum is spent: yield to other ready connections; C_NOWR makes
+           compute_conn_events re-arm the write event level-triggered, so the next
+           epoll iteration returns here with a fresh quantum */
+        c->flags |= C_NOWR;
       }
     }
 
@@ -22,6 +22,16 @@ OPTION_PARSER(OPT_RPC, "no-crc32c", no_argument, "Force use of CRC32 instead of
   return 0;
 }
 
+OPTION_PARSER(OPT_RPC, "rpc-disable-checksum", no_argument, "Skip TCP RPC packet checksums with peers that also enable this option; "
+                                                           "only for trusted networks where the link layer already covers integrity") {
+  default_rpc_flags |= RPC_CRYPTO_NO_CRC32;
+  return 0;
+}
+
+unsigned crc32_partial_ignore (const void *data __attribute__((unused)), long len __attribute__((unused)), unsigned crc) {
+  return crc;
+}
+
 // Flags:
 //   Flag 1 - can not edit this message. Need to make copy.
 
@@ -74,6 +74,11 @@ struct tcp_rpc_data {
 #define RPC_CRYPTO_ENCRYPTED_MASK     (RPC_CRYPTO_ALLOW_ENCRYPTED | RPC_CRYPTO_NONCE_SENT | RPC_CRYPTO_ENCRYPTION_ON)
 #define RPC_CRYPTO_ALLOW_QACK         0x00000200
 #define RPC_CRYPTO_USE_CRC32C         0x00000800
+#define RPC_CRYPTO_NO_CRC32           0x00001000
+
+/* leaves the 4-byte checksum trailer in the packet format but neither computes nor
+   verifies it; negotiated only when both peers run with --rpc-disable-checksum */
+unsigned crc32_partial_ignore (const void *data, long len, unsigned crc);
 
 #define RPC_NONCE           0x7acb87aa
 #define RPC_HANDSHAKE       0x7682eef5
@@ -183,7 +183,7 @@ static int tcp_rpcs_send_handshake_packet (struct connection *c) {
   assert (PID.pid);
   memset (&P, 0, sizeof (P));
   P.type = RPC_HANDSHAKE;
-  P.flags = D->crypto_flags & RPC_CRYPTO_USE_CRC32C;
+  P.flags = D->crypto_flags & (RPC_CRYPTO_USE_CRC32C | RPC_CRYPTO_NO_CRC32);
   memcpy (&P.sender_pid, &PID, sizeof (struct process_id));
   memcpy (&P.peer_pid, &D->remote_pid, sizeof (struct process_id));
 
@@ -239,6 +239,9 @@ static int tcp_rpcs_process_handshake_packet (struct connection *c, raw_message_
   if (P.flags & default_rpc_flags & RPC_CRYPTO_USE_CRC32C) {
     D->crypto_flags |= RPC_CRYPTO_USE_CRC32C;
   }
+  if (P.flags & default_rpc_flags & RPC_CRYPTO_NO_CRC32) {
+    D->crypto_flags |= RPC_CRYPTO_NO_CRC32;
+  }
   return 0;
 }
 
@@ -400,7 +403,9 @@ int tcp_rpcs_parse_execute (struct connection *c) {
         res = tcp_rpcs_process_handshake_packet (c, &msg);
         if (res >= 0) {
           res = tcp_rpcs_send_handshake_packet (c);
-	  if (D->crypto_flags & RPC_CRYPTO_USE_CRC32C) {
+	  if (D->crypto_flags & RPC_CRYPTO_NO_CRC32) {
+	    D->custom_crc_partial = crc32_partial_ignore;
+	  } else if (D->crypto_flags & RPC_CRYPTO_USE_CRC32C) {
 	    D->custom_crc_partial = crc32c_partial;
 	  }
           if (res >= 0 && TCP_RPCS_FUNC(c)->rpc_ready) {
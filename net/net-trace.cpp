@@ -0,0 +1,162 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "net/net-trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#include "common/kprintf.h"
+#include "common/precise-time.h"
+#include "common/server/limits.h"
+
+#include "net/net-connections.h"
+
+namespace {
+
+constexpr size_t TRACE_RING_SIZE = 4096; // power of two, ~one cron interval of sampled events
+
+struct trace_event_t {
+  uint64_t trace_id;
+  double timestamp;
+  trace_event_type type;
+};
+
+// per-fd state of the currently traced request on that connection; a slot is
+// reused by the next sampled query on the same fd, so no cleanup on close is
+// needed - stale slots are deactivated by trace_request_query_parsed
+struct trace_slot_t {
+  uint64_t trace_id;
+  bool active;
+  bool first_byte_recorded;
+};
+
+char trace_log_prefix[256];
+int trace_sampling_rate = 0; // 0 - tracing disabled
+uint64_t parsed_queries_counter = 0;
+uint64_t next_trace_id = 0;
+
+trace_slot_t trace_slots[MAX_CONNECTIONS];
+
+// the worker is single-threaded: the producer (event loop) and the consumer
+// (cron) never race, the ring only bounds memory and keeps recording wait-free
+trace_event_t trace_ring[TRACE_RING_SIZE];
+size_t ring_write_pos = 0;
+size_t ring_read_pos = 0;
+uint64_t dropped_events = 0;
+
+FILE *trace_log = nullptr;
+
+const char *event_name(trace_event_type type) noexcept {
+  switch (type) {
+    case trace_event_type::query_parsed:
+      return "query_parsed";
+    case trace_event_type::script_start:
+      return "script_start";
+    case trace_event_type::script_end:
+      return "script_end";
+    case trace_event_type::first_byte_out:
+      return "first_byte_out";
+    case trace_event_type::last_byte_out:
+      return "last_byte_out";
+  }
+  return "unknown";
+}
+
+void record_event(uint64_t trace_id, trace_event_type type) noexcept {
+  if (ring_write_pos - ring_read_pos == TRACE_RING_SIZE) {
+    dropped_events++;
+    return;
+  }
+  trace_event_t &event = trace_ring[ring_write_pos++ & (TRACE_RING_SIZE - 1)];
+  event.trace_id = trace_id;
+  event.timestamp = get_utime_monotonic();
+  event.type = type;
+}
+
+} // namespace
+
+int set_request_trace_config(const char *description) {
+  int one_in_n = 0;
+  if (sscanf(description, "%255[^:]:%d", trace_log_prefix, &one_in_n) != 2 || one_in_n <= 0) {
+    kprintf("cannot parse request trace config: expected <log-prefix>:<one-in-n>, got '%s'\n", description);
+    return -1;
+  }
+  trace_sampling_rate = one_in_n;
+  return 0;
+}
+
+void trace_request_query_parsed(connection *c) {
+  // fake connections live above MAX_CONNECTIONS and carry no real requests
+  if (trace_sampling_rate == 0 || c->fd >= MAX_CONNECTIONS) {
+    return;
+  }
+  trace_slot_t &slot = trace_slots[c->fd];
+  if (parsed_queries_counter++ % trace_sampling_rate != 0) {
+    // the previous request of this connection is over; without this an
+    // untraced keep-alive request would inherit the byte-out events
+    slot.active = false;
+    return;
+  }
+  slot.trace_id = ++next_trace_id;
+  slot.active = true;
+  slot.first_byte_recorded = false;
+  record_event(slot.trace_id, trace_event_type::query_parsed);
+}
+
+void trace_request_event(connection *c, trace_event_type type) {
+  if (trace_sampling_rate == 0 || c == nullptr || c->fd >= MAX_CONNECTIONS) {
+    return;
+  }
+  const trace_slot_t &slot = trace_slots[c->fd];
+  if (slot.active) {
+    record_event(slot.trace_id, type);
+  }
+}
+
+void trace_request_bytes_out(connection *c, bool out_buffer_empty) {
+  if (trace_sampling_rate == 0 || c->fd >= MAX_CONNECTIONS) {
+    return;
+  }
+  trace_slot_t &slot = trace_slots[c->fd];
+  if (!slot.active) {
+    return;
+  }
+  if (!slot.first_byte_recorded) {
+    slot.first_byte_recorded = true;
+    record_event(slot.trace_id, trace_event_type::first_byte_out);
+  }
+  if (out_buffer_empty) {
+    record_event(slot.trace_id, trace_event_type::last_byte_out);
+    slot.active = false;
+  }
+}
+
+void flush_request_trace_events() {
+  if (ring_read_pos == ring_write_pos) {
+    return;
+  }
+  if (trace_log == nullptr) {
+    char trace_log_name[sizeof(trace_log_prefix) + 32];
+    snprintf(trace_log_name, sizeof(trace_log_name), "%s.%d", trace_log_prefix, static_cast<int>(getpid()));
+    trace_log = fopen(trace_log_name, "a");
+    if (trace_log == nullptr) {
+      kprintf("cannot open request trace log '%s': %m; request tracing is disabled\n", trace_log_name);
+      trace_sampling_rate = 0;
+      ring_read_pos = ring_write_pos;
+      return;
+    }
+  }
+  while (ring_read_pos != ring_write_pos) {
+    const trace_event_t &event = trace_ring[ring_read_pos++ & (TRACE_RING_SIZE - 1)];
+    fprintf(trace_log, "{\"trace_id\":%llu,\"event\":\"%s\",\"ts\":%.6f}\n",
+            static_cast<unsigned long long>(event.trace_id), event_name(event.type), event.timestamp);
+  }
+  if (dropped_events) {
+    fprintf(trace_log, "{\"dropped_events\":%llu}\n", static_cast<unsigned long long>(dropped_events));
+    dropped_events = 0;
+  }
+  fflush(trace_log);
+}
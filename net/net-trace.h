@@ -0,0 +1,43 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+
+struct connection;
+
+// Sampled request lifecycle tracing: when a p99 spike hits, aggregated timers
+// can't say whether the time went to queueing, parsing, script compute, net
+// wait or the response write. 1-in-N parsed queries open a trace; every
+// lifecycle transition is timestamped into a small ring, which decouples the
+// hot path (two stores) from formatting; the ring is drained by the worker
+// cron into <prefix>.<pid> as one JSON line per event, events of one request
+// share a trace id.
+
+enum class trace_event_type : uint8_t {
+  query_parsed = 0,
+  script_start,
+  script_end,
+  first_byte_out,
+  last_byte_out,
+};
+
+// parses "<log-prefix>:<one-in-n>" and thereby enables tracing; returns -1 on error
+int set_request_trace_config(const char *description);
+
+// every fully parsed incoming query goes through here: applies the 1-in-N
+// decision, opens a trace slot for the connection and records query_parsed;
+// an unsampled query closes the slot left from the previous one
+void trace_request_query_parsed(connection *c);
+
+// no-op unless the connection's current request is traced
+void trace_request_event(connection *c, trace_event_type type);
+
+// called from the writer after every successful write with the post-write
+// buffer state; derives first_byte_out/last_byte_out for the traced request
+void trace_request_bytes_out(connection *c, bool out_buffer_empty);
+
+// drains the ring to the trace log; cheap when the ring is empty
+void flush_request_trace_events();
@@ -15,10 +15,12 @@ prepend(NET_SOURCES ${BASE_DIR}/net/
         net-aes-keys.cpp
         net-socket.cpp
         net-reactor.cpp
+        net-resolver.cpp
         net-msg-part.cpp
         net-mysql-client.cpp
         net-memcache-client.cpp
         net-http-server.cpp
+        net-trace.cpp
         net-msg-buffers.cpp
         net-msg.cpp
         net-msg-part.cpp)
@@ -52,6 +52,10 @@ const memory_resource::MemoryStats &get_script_memory_stats() noexcept {
   return get_memory_dealer().current_script_resource().get_memory_stats();
 }
 
+const memory_resource::SizeClassStatsArray &get_script_size_class_stats() noexcept {
+  return get_memory_dealer().current_script_resource().get_size_class_stats();
+}
+
 size_t get_heap_memory_used() noexcept {
   return get_memory_dealer().get_heap_resource().memory_used();
 }
@@ -23,6 +23,7 @@ void set_current_script_allocator(memory_resource::unsynchronized_pool_resource
 void restore_default_script_allocator(bool force_disable) noexcept;
 
 const memory_resource::MemoryStats &get_script_memory_stats() noexcept;
+const memory_resource::SizeClassStatsArray &get_script_size_class_stats() noexcept;
 size_t get_heap_memory_used() noexcept;
 
 void global_init_script_allocator() noexcept;
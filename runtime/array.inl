@@ -40,6 +40,21 @@ array_size &array_size::min(const array_size &other) {
 
 namespace dl {
 
+// moves every element left while it precedes its neighbour; optimal on the short
+// subranges that quicksort recursion bottoms out on, [begin, end] is inclusive
+template<class T, class T1>
+void insertion_sort(T *begin, T *end, const T1 &compare) {
+  for (T *i = begin + 1; i <= end; i++) {
+    T value = std::move(*i);
+    T *j = i;
+    while (j > begin && compare(*(j - 1), value) > 0) {
+      *j = std::move(*(j - 1));
+      j--;
+    }
+    *j = std::move(value);
+  }
+}
+
 template<class T, class T1>
 void sort(T *begin_init, T *end_init, const T1 &compare) {
   T *begin_stack[32];
@@ -53,6 +68,10 @@ void sort(T *begin_init, T *end_init, const T1 &compare) {
     T *end = end_stack[depth];
 
     while (begin < end) {
+      if (end - begin < 16) {
+        insertion_sort(begin, end, compare);
+        break;
+      }
       const auto offset = (end - begin) >> 1;
       swap(*begin, begin[offset]);
 
@@ -93,6 +112,59 @@ void sort(T *begin_init, T *end_init, const T1 &compare) {
   }
 }
 
+// ascending LSD radix sort: eight stable counting passes over a scratch buffer,
+// the top byte is xored with 0x80 so that negative keys order before positive ones
+inline void int64_radix_sort(int64_t *begin, int64_t *end) {
+  const size_t n = end - begin;
+  auto *tmp = static_cast<int64_t *>(dl::allocate(n * sizeof(int64_t)));
+  int64_t *src = begin;
+  int64_t *dst = tmp;
+  for (int shift = 0; shift < 64; shift += 8) {
+    const uint64_t sign_flip = shift == 56 ? 0x80 : 0x00;
+    size_t count[256] = {0};
+    for (size_t i = 0; i < n; i++) {
+      count[((static_cast<uint64_t>(src[i]) >> shift) & 0xff) ^ sign_flip]++;
+    }
+    if (count[((static_cast<uint64_t>(src[0]) >> shift) & 0xff) ^ sign_flip] == n) {
+      continue; // all keys share this byte, the stable pass would be an identity copy
+    }
+    size_t offset = 0;
+    for (size_t c = 0; c < 256; c++) {
+      const size_t cnt = count[c];
+      count[c] = offset;
+      offset += cnt;
+    }
+    for (size_t i = 0; i < n; i++) {
+      dst[count[((static_cast<uint64_t>(src[i]) >> shift) & 0xff) ^ sign_flip]++] = src[i];
+    }
+    std::swap(src, dst);
+  }
+  if (src != begin) {
+    memcpy(begin, src, n * sizeof(int64_t));
+  }
+  dl::deallocate(tmp, n * sizeof(int64_t));
+}
+
+// returns true iff the range was sorted by the radix fast path: it engages only for plain
+// int64 keys under a comparator known to mean ascending order (std::greater under the
+// compare(lhs, rhs) > 0 convention of dl::sort), where byte passes beat comparison
+// sorting well before the 100k-element result sets sort() is commonly fed with
+template<class T, class T1>
+std::enable_if_t<std::is_same<T, int64_t>::value && std::is_base_of<std::greater<int64_t>, T1>::value, bool>
+try_radix_sort(T *begin, T *end, const T1 &) {
+  if (end - begin < 256) {
+    return false;
+  }
+  int64_radix_sort(begin, end);
+  return true;
+}
+
+template<class T, class T1>
+std::enable_if_t<!std::is_same<T, int64_t>::value || !std::is_base_of<std::greater<int64_t>, T1>::value, bool>
+try_radix_sort(T *, T *, const T1 &) {
+  return false;
+}
+
 } // namespace dl
 
 template<class T>
@@ -247,6 +319,12 @@ size_t array<T>::array_inner::estimate_size(int64_t &new_int_size, int64_t &new_
   if (is_vector) {
     php_assert (new_string_size == 0);
     new_int_size += 2;
+    // tiny vectors dominate generated code (argument packing, short returns);
+    // rounding the first allocation up to 4 slots lets arrays of up to 4 elements
+    // grow from the empty singleton without an intermediate reallocation
+    if (new_int_size < 4) {
+      new_int_size = 4;
+    }
     return sizeof_vector(static_cast<uint32_t>(new_int_size));
   }
 
@@ -475,6 +553,7 @@ template<class T>
 template<class S>
 auto &array<T>::array_inner::find_map_entry(S &self, int64_t int_key) noexcept {
   uint32_t bucket = self.choose_bucket_int(int_key);
+  __builtin_prefetch(&self.int_entries[bucket]);
   while (self.int_entries[bucket].next != EMPTY_POINTER && self.int_entries[bucket].int_key != int_key) {
     if (unlikely (++bucket == self.int_buf_size)) {
       bucket = 0;
@@ -489,6 +568,8 @@ template<class S>
 auto &array<T>::array_inner::find_map_entry(S &self, const string &string_key, int64_t precomuted_hash) noexcept {
   auto *string_entries = self.get_string_entries();
   uint32_t bucket = self.choose_bucket_string(precomuted_hash);
+  __builtin_prefetch(&string_entries[bucket]);
+  // the precomputed 64-bit hash works as an exact tag here: full key compare runs only on hash match
   while (string_entries[bucket].next != EMPTY_POINTER &&
          (string_entries[bucket].int_key != precomuted_hash || string_entries[bucket].string_key != string_key)) {
     if (unlikely (++bucket == self.string_buf_size)) {
@@ -863,6 +944,41 @@ void array<T>::convert_to_map() {
   p = new_array;
 }
 
+template<class T>
+bool array<T>::try_convert_back_to_vector() {
+  // a map whose keys are exactly 0..n-1 in insertion order (e.g. array_filter that dropped
+  // nothing, or unset-then-refill patterns) can be stored as a vector again;
+  // the O(1) precheck rejects string-keyed and sparse maps before the O(n) order walk
+  if (p->string_size != 0 || p->max_key + 1 != int64_t{p->int_size}) {
+    return false;
+  }
+
+  int64_t expected_key = 0;
+  for (const string_hash_entry *it = p->begin(); it != p->end(); it = p->next(it)) {
+    if (p->is_string_hash_entry(it) || it->int_key != expected_key++) {
+      return false;
+    }
+  }
+
+  array_inner *new_array = array_inner::create(p->int_size, 0, true);
+
+  if (p->ref_cnt == 0) {
+    for (string_hash_entry *it = p->begin(); it != p->end(); it = p->next(it)) {
+      new_array->emplace_back_vector_value(std::move(it->value));
+    }
+  } else {
+    for (const string_hash_entry *it = p->begin(); it != p->end(); it = p->next(it)) {
+      new_array->push_back_vector_value(it->value);
+    }
+  }
+
+  php_assert (new_array->max_key == p->max_key);
+
+  p->dispose();
+  p = new_array;
+  return true;
+}
+
 template<class T>
 template<class T1>
 void array<T>::copy_from(const array<T1> &other) {
@@ -1592,17 +1708,38 @@ const mixed array<T>::get_var(const K &key) const {
 
 template<class T>
 template<class K>
-const T array<T>::get_value(const K &key) const {
+const T array<T>::get_value(const K &key) const & {
   auto *value = find_value(key);
   return value ? *value : T{};
 }
 
 template<class T>
-const T array<T>::get_value(const string &string_key, int64_t precomuted_hash) const {
+const T array<T>::get_value(const string &string_key, int64_t precomuted_hash) const & {
   auto *value = find_value(string_key, precomuted_hash);
   return value ? *value : T{};
 }
 
+template<class T>
+template<class K>
+T array<T>::get_value(const K &key) && {
+  const T *value = find_value(key);
+  if (!value) {
+    return T{};
+  }
+  // the buffer of a dying unshared array is about to be disposed anyway,
+  // so the bucket may be left holding a moved-out husk
+  return p->ref_cnt == 0 ? std::move(*const_cast<T *>(value)) : *value;
+}
+
+template<class T>
+T array<T>::get_value(const string &string_key, int64_t precomuted_hash) && {
+  const T *value = find_value(string_key, precomuted_hash);
+  if (!value) {
+    return T{};
+  }
+  return p->ref_cnt == 0 ? std::move(*const_cast<T *>(value)) : *value;
+}
+
 template<class T>
 template<class K>
 bool array<T>::has_key(const K &key) const {
@@ -1693,19 +1830,47 @@ array_size array<T>::size() const {
 template<class T>
 template<class T1, class>
 void array<T>::merge_with(const array<T1> &other) {
+  if (other.empty()) {
+    return;
+  }
+
+  if (other.p->is_vector() && is_vector()) {
+    // bulk path for the common vector-into-vector merge: detach and reserve the exact
+    // final size once, then append without per-element refcount and capacity checks
+    const auto other_size = static_cast<uint32_t>(other.p->int_size);
+    const int64_t new_size = int64_t{p->int_size} + other_size;
+    if (!mutate_to_size_if_vector_shared(new_size) && int64_t{p->int_buf_size} < new_size) {
+      mutate_to_size(new_size);
+    }
+    const T1 *entries = reinterpret_cast<const T1 *>(other.p->int_entries);
+    for (uint32_t i = 0; i < other_size; i++) {
+      p->push_back_vector_value(entries[i]);
+    }
+    return;
+  }
+
   for (typename array<T1>::const_iterator it = other.begin(); it != other.end(); ++it) {
-    if (it.self_->is_vector()) {//TODO move if outside for
-      if (is_vector()) {
-        mutate_if_vector_needed_int();
-        p->push_back_vector_value(*reinterpret_cast<const T1 *>(it.entry_));
-      } else {
-        mutate_if_map_needed_int();
-        p->set_map_value(overwrite_element::YES, get_next_key(), *reinterpret_cast<const T1 *>(it.entry_));
-      }
+    if (it.self_->is_vector()) {
+      // this is a map here: vector into vector is handled by the bulk path above
+      mutate_if_map_needed_int();
+      p->set_map_value(overwrite_element::YES, get_next_key(), *reinterpret_cast<const T1 *>(it.entry_));
     } else {
       const typename array<T1>::string_hash_entry *entry = (const typename array<T1>::string_hash_entry *)it.entry_;
       const T1 &value = entry->value;
 
+      if (!is_vector()) {
+        // hide the dependent-load hash walk of the next insert behind the current one;
+        // for string entries int_key holds the precomputed hash, so the bucket is known in advance
+        const auto *next_entry = (const typename array<T1>::string_hash_entry *)it.self_->next(entry);
+        if (next_entry != (const typename array<T1>::string_hash_entry *)it.self_->end()) {
+          if (it.self_->is_string_hash_entry(next_entry)) {
+            __builtin_prefetch(&p->get_string_entries()[p->choose_bucket_string(next_entry->int_key)]);
+          } else {
+            __builtin_prefetch(&p->int_entries[p->choose_bucket_int(next_entry->int_key)]);
+          }
+        }
+      }
+
       if (it.self_->is_string_hash_entry(entry)) {
         mutate_to_map_if_vector_or_map_need_string();
         p->set_map_value(overwrite_element::YES, entry->int_key, entry->string_key, value);
@@ -2024,11 +2189,14 @@ void array<T>::sort(const T1 &compare, bool renumber) {
       mutate_if_vector_shared();
     }
 
+    T *begin = reinterpret_cast<T *>(p->int_entries);
+    if (dl::try_radix_sort(begin, begin + n, compare)) {
+      return;
+    }
     const auto elements_cmp =
       [&compare](const T &lhs, const T &rhs) {
         return compare(lhs, rhs) > 0;
       };
-    T *begin = reinterpret_cast<T *>(p->int_entries);
     dl::sort<T, decltype(elements_cmp)>(begin, begin + n, elements_cmp);
     return;
   }
@@ -206,6 +206,7 @@ private:
   inline void mutate_to_map_if_vector_or_map_need_string();
 
   inline void convert_to_map();
+  inline bool try_convert_back_to_vector();
 
   template<class T1>
   inline void copy_from(const array<T1> &other);
@@ -321,8 +322,15 @@ public:
   const mixed get_var(const K &key) const;
 
   template<class K>
-  const T get_value(const K &key) const;
-  const T get_value(const string &string_key, int64_t precomuted_hash) const;
+  const T get_value(const K &key) const &;
+  const T get_value(const string &string_key, int64_t precomuted_hash) const &;
+
+  // last-use element extraction, codegen calls these on std::move()d arrays
+  // (see OptimizationPass): a dying unshared array gives its element away
+  // instead of copying it
+  template<class K>
+  T get_value(const K &key) &&;
+  T get_value(const string &string_key, int64_t precomuted_hash) &&;
 
   template<class ...Args>
   T &emplace_back(Args &&... args) noexcept;
@@ -417,15 +425,17 @@ public:
   template<typename U>
   static array<T> convert_from(const array<U> &);
 
-private:
-  template<class ...Key>
-  iterator find_iterator_in_map_no_mutate(const Key &... key) noexcept;
-
+  // appends to a unique vector with enough capacity reserved, skipping the per-element
+  // copy-on-write and growth checks of push_back; unsafe otherwise
   void push_back_values() {}
 
   template<class Arg, class...Args>
   void push_back_values(Arg &&arg, Args &&... args);
 
+private:
+  template<class ...Key>
+  iterator find_iterator_in_map_no_mutate(const Key &... key) noexcept;
+
 private:
   array_inner *p;
 
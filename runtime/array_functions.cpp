@@ -4,11 +4,47 @@
 
 #include "runtime/array_functions.h"
 
-array<string> explode(char delimiter, const string &str, int64_t limit) {
-  array<string> res(array_size(limit < 10 ? limit : 1, 0, true));
+#include <cstring>
+#include <emmintrin.h>
+
+static size_t count_char_sse2(const char *s, size_t n, char value) {
+  const __m128i needle = _mm_set1_epi8(value);
+  size_t i = 0;
+  size_t count = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+    count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+  }
+  for (; i < n; i++) {
+    count += s[i] == value;
+  }
+  return count;
+}
 
+array<string> explode(char delimiter, const string &str, int64_t limit) {
   const string::size_type s_len = str.size();
   const char *s = str.c_str();
+
+  if (limit > s_len) {
+    // no effective limit (the common call): count the delimiters up front and presize
+    // the vector exactly, so pushing pieces never reallocates the result mid-fill
+    const int64_t pieces = static_cast<int64_t>(count_char_sse2(s, s_len, delimiter)) + 1;
+    array<string> res(array_size(pieces, 0, true));
+
+    const char *prev = s;
+    const char *end = s + s_len;
+    for (int64_t i = 1; i < pieces; i++) {
+      const auto *pos = static_cast<const char *>(memchr(prev, delimiter, end - prev));
+      res.push_back(string(prev, static_cast<string::size_type>(pos - prev)));
+      prev = pos + 1;
+    }
+    res.push_back(string(prev, static_cast<string::size_type>(end - prev)));
+
+    return res;
+  }
+
+  array<string> res(array_size(limit < 10 ? limit : 1, 0, true));
+
   string::size_type prev = 0;
 
   if (limit > 1) {
@@ -102,6 +138,26 @@ array<mixed> range_int(int64_t from, int64_t to, int64_t step) {
   }
 }
 
+int64_t range_loop_count(int64_t from, int64_t to, int64_t *step) noexcept {
+  if (from < to) {
+    if (*step <= 0) {
+      php_warning("Wrong parameters from = %ld, to = %ld, step = %ld in function range", from, to, *step);
+      return 0;
+    }
+    return (to - from + *step) / *step;
+  }
+  if (*step == 0) {
+    php_warning("Wrong parameters from = %ld, to = %ld, step = %ld in function range", from, to, *step);
+    return 0;
+  }
+  if (*step < 0) {
+    *step = -*step;
+  }
+  const int64_t count = (from - to + *step) / *step;
+  *step = -*step;
+  return count;
+}
+
 array<mixed> range_string(const string &from_s, const string &to_s, int64_t step) {
   if (from_s.empty() || to_s.empty() || from_s.size() > 1 || to_s.size() > 1) {
     php_warning("Wrong parameters \"%s\" and \"%s\" for function range", from_s.c_str(), to_s.c_str());
@@ -4,9 +4,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <climits>
+#include <new>
 #include <numeric>
 
+#include "common/algorithms/simd-int64-find.h"
+#include "common/algorithms/simd-reductions.h"
+#include "common/mixin/not_copyable.h"
 #include "common/type_traits/constexpr_if.h"
 #include "common/type_traits/function_traits.h"
 #include "common/vector-product.h"
@@ -15,6 +20,107 @@
 #include "runtime/math_functions.h"
 #include "runtime/string_functions.h"
 
+namespace impl_ {
+
+inline uint64_t value_set_hash(int64_t key) {
+  uint64_t hash = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL;
+  return hash ^ (hash >> 32);
+}
+
+inline uint64_t value_set_hash(const string &key) {
+  return value_set_hash(key.hash());
+}
+
+// flat open-addressing set used as the probe side of array_unique/array_diff/array_intersect:
+// a single script memory allocation with linear probing instead of a temporary array<int64_t>
+// map, which pays refcounting, order list maintenance and string key storage per probe;
+// sized for all insertions upfront, so the load factor stays below 1/2 and it never grows
+template<class KeyT>
+class array_value_set : vk::not_copyable {
+public:
+  explicit array_value_set(int64_t expected_elements) {
+    while (capacity_ < 2 * static_cast<uint64_t>(expected_elements)) {
+      capacity_ *= 2;
+    }
+    entries_ = static_cast<entry *>(dl::allocate(capacity_ * sizeof(entry)));
+    for (uint64_t i = 0; i < capacity_; i++) {
+      entries_[i].hash = 0;
+    }
+  }
+
+  ~array_value_set() {
+    for (uint64_t i = 0; i < capacity_; i++) {
+      if (entries_[i].hash != 0) {
+        entries_[i].key.~KeyT();
+      }
+    }
+    dl::deallocate(entries_, capacity_ * sizeof(entry));
+  }
+
+  // returns true when the key was not in the set yet
+  bool insert(const KeyT &key) {
+    const uint64_t hash = value_set_hash(key) | 1; // zero marks an empty slot
+    uint64_t i = hash & (capacity_ - 1);
+    while (entries_[i].hash != 0) {
+      if (entries_[i].hash == hash && entries_[i].key == key) {
+        return false;
+      }
+      i = (i + 1) & (capacity_ - 1);
+    }
+    entries_[i].hash = hash;
+    new(&entries_[i].key) KeyT(key);
+    return true;
+  }
+
+  bool contains(const KeyT &key) const {
+    const uint64_t hash = value_set_hash(key) | 1;
+    for (uint64_t i = hash & (capacity_ - 1); entries_[i].hash != 0; i = (i + 1) & (capacity_ - 1)) {
+      if (entries_[i].hash == hash && entries_[i].key == key) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  struct entry {
+    uint64_t hash;
+    KeyT key;
+  };
+
+  entry *entries_{nullptr};
+  uint64_t capacity_{8};
+};
+
+// int64_t elements are compared directly, everything else through the string representation,
+// exactly as the former array<int64_t> sets keyed by f$strval did
+template<class T, class T1 = T>
+using value_set_key_t = std::conditional_t<std::is_same<T, int64_t>::value && std::is_same<T1, int64_t>::value, int64_t, string>;
+
+template<class KeyT>
+struct value_set_key_maker;
+
+template<>
+struct value_set_key_maker<int64_t> {
+  static int64_t make(int64_t value) {
+    return value;
+  }
+};
+
+template<>
+struct value_set_key_maker<string> {
+  static const string &make(const string &value) {
+    return value;
+  }
+
+  template<class T>
+  static string make(const T &value) {
+    return f$strval(value);
+  }
+};
+
+} // namespace impl_
+
 template<class T>
 string f$implode(const string &s, const array<T> &a);
 
@@ -50,6 +156,12 @@ array<T> f$array_filter(const array<T> &a, const T1 &callback) noexcept;
 template<class T, class T1>
 array<T> f$array_filter_by_key(const array<T> &a, const T1 &callback) noexcept;
 
+template<class T>
+array<T> f$array_filter_values(const array<T> &a) noexcept;
+
+template<class T, class T1>
+array<T> f$array_filter_values(const array<T> &a, const T1 &callback) noexcept;
+
 template<class T>
 T f$array_merge(const T &a1);
 
@@ -129,6 +241,8 @@ bool f$array_key_exists(K, const array<T> &);
 template<class T, class T1>
 typename array<T>::key_type f$array_search(const T1 &val, const array<T> &a, bool strict = false);
 
+inline array<int64_t>::key_type f$array_search(int64_t val, const array<int64_t> &a, bool strict = false);
+
 template<class T>
 typename array<T>::key_type f$array_rand(const array<T> &a);
 
@@ -160,6 +274,11 @@ array<typename array<T>::key_type> f$array_flip(const array<T> &a);
 template<class T, class T1>
 bool f$in_array(const T1 &value, const array<T> &a, bool strict = false);
 
+inline bool f$in_array(int64_t value, const array<int64_t> &a, bool strict = false);
+
+template<class T, class T1>
+bool f$in_array_sorted(const T1 &value, const array<T> &a);
+
 
 template<class T>
 array<T> f$array_fill(int64_t start_index, int64_t num, const T &value);
@@ -200,6 +319,11 @@ bool f$array_is_vector(const array<T> &a);
 
 array<mixed> f$range(const mixed &from, const mixed &to, int64_t step = 1);
 
+// runtime support for the codegen lowering of foreach-over-range() into a counting
+// loop: returns the iteration count and replaces *step with the signed per-iteration
+// increment; mirrors the bounds/step checks of f$range so the warnings stay identical
+int64_t range_loop_count(int64_t from, int64_t to, int64_t *step) noexcept;
+
 
 template<class T>
 void f$shuffle(array<T> &a);
@@ -241,6 +365,17 @@ void f$natsort(array<T> &a);
 template<class T, class ReturnT = std::conditional_t<std::is_same<T, int64_t>{}, int64_t, double>>
 ReturnT f$array_sum(const array<T> &a);
 
+inline int64_t f$array_sum(const array<int64_t> &a);
+
+inline double f$array_sum(const array<double> &a);
+
+template<class T>
+std::tuple<T, T> f$array_min_max(const array<T> &a);
+
+inline std::tuple<int64_t, int64_t> f$array_min_max(const array<int64_t> &a);
+
+inline std::tuple<double, double> f$array_min_max(const array<double> &a);
+
 
 template<class T>
 mixed f$getKeyByPos(const array<T> &a, int64_t pos);
@@ -619,6 +754,24 @@ inline auto f$array_column(const Optional<T> &a, const mixed &column_key, const
 template<class T, class F>
 array<T> array_filter_impl(const array<T> &a, const F &pred) noexcept {
   array<T> result(a.size());
+  if (a.is_vector()) {
+    // the result stays a vector while nothing has been dropped (php keeps the original keys,
+    // so the first gap forces map mode); until then elements are appended into the freshly
+    // allocated exact-capacity vector without per-element copy-on-write checks
+    bool dropped = false;
+    for (const auto &it : a) {
+      if (pred(it)) {
+        if (dropped) {
+          result.set_value(it);
+        } else {
+          result.push_back_values(it.get_value());
+        }
+      } else {
+        dropped = true;
+      }
+    }
+    return result;
+  }
   for (const auto &it : a) {
     if (pred(it)) {
       result.set_value(it);
@@ -648,10 +801,45 @@ array<T> f$array_filter_by_key(const array<T> &a, const T1 &callback) noexcept {
   });
 }
 
+template<class T, class F>
+array<T> array_filter_values_impl(const array<T> &a, const F &pred) noexcept {
+  // unlike array_filter, the keys are renumbered, so the result is always a compact vector
+  // built in one pass - a fused array_values(array_filter(...)) without the intermediate array
+  array<T> result(array_size(a.count(), 0, true));
+  for (const auto &it : a) {
+    if (pred(it)) {
+      result.push_back_values(it.get_value());
+    }
+  }
+  return result;
+}
+
+template<class T>
+array<T> f$array_filter_values(const array<T> &a) noexcept {
+  return array_filter_values_impl(a, [](const auto &it) {
+    return f$boolval(it.get_value());
+  });
+}
+
+template<class T, class T1>
+array<T> f$array_filter_values(const array<T> &a, const T1 &callback) noexcept {
+  return array_filter_values_impl(a, [&callback](const auto &it) {
+    return f$boolval(callback(it.get_value()));
+  });
+}
+
 
 template<class T, class CallbackT, class R = typename std::result_of<std::decay_t<CallbackT>(T)>::type>
 array<R> f$array_map(const CallbackT &callback, const array<T> &a) {
   array<R> result(a.size());
+  if (a.is_vector()) {
+    // vector in - vector out: append into the freshly allocated exact-size vector,
+    // skipping the per-element key dispatch and copy-on-write checks of set_value
+    for (const auto &it : a) {
+      result.push_back_values(callback(it.get_value()));
+    }
+    return result;
+  }
   for (const auto &it : a) {
     result.set_value(it.get_key(), callback(it.get_value()));
   }
@@ -744,13 +932,14 @@ template<class T, class T1>
 array<T> f$array_intersect(const array<T> &a1, const array<T1> &a2) {
   array<T> result(a1.size().min(a2.size()));
 
-  array<int64_t> values(array_size(0, a2.count(), false));
+  using key_maker = impl_::value_set_key_maker<impl_::value_set_key_t<T, T1>>;
+  impl_::array_value_set<impl_::value_set_key_t<T, T1>> values{a2.count()};
   for (const auto &it : a2) {
-    values.set_value(f$strval(it.get_value()), 1);
+    values.insert(key_maker::make(it.get_value()));
   }
 
   for (const auto &it : a1) {
-    if (values.has_key(f$strval(it.get_value()))) {
+    if (values.contains(key_maker::make(it.get_value()))) {
       result.set_value(it);
     }
   }
@@ -793,13 +982,14 @@ template<class T, class T1>
 array<T> f$array_diff(const array<T> &a1, const array<T1> &a2) {
   array<T> result(a1.size());
 
-  array<int64_t> values(array_size(0, a2.count(), false));
+  using key_maker = impl_::value_set_key_maker<impl_::value_set_key_t<T, T1>>;
+  impl_::array_value_set<impl_::value_set_key_t<T, T1>> values{a2.count()};
   for (const auto &it : a2) {
-    values.set_value(f$strval(it.get_value()), 1);
+    values.insert(key_maker::make(it.get_value()));
   }
 
   for (const auto &it : a1) {
-    if (!values.has_key(f$strval(it.get_value()))) {
+    if (!values.contains(key_maker::make(it.get_value()))) {
       result.set_value(it);
     }
   }
@@ -898,6 +1088,27 @@ typename array<T>::key_type f$array_search(const T1 &val, const array<T> &a, boo
   return typename array<T>::key_type(false);
 }
 
+// both strict and loose comparison of two int64s is a plain ==, so for vector-mode
+// arrays the search is a SIMD scan over the flat entries instead of the generic loop
+inline array<int64_t>::key_type f$array_search(int64_t val, const array<int64_t> &a, bool strict __attribute__((unused))) {
+  const int64_t n = a.count();
+  if (a.is_vector() && n > 0) {
+    const int64_t *begin = a.get_const_vector_pointer();
+    const int64_t *it = vk::simd_int64_find(begin, begin + n, val);
+    if (it != begin + n) {
+      return array<int64_t>::key_type(it - begin);
+    }
+    return array<int64_t>::key_type(false);
+  }
+
+  for (const auto &it : a) {
+    if (it.get_value() == val) {
+      return it.get_key();
+    }
+  }
+  return array<int64_t>::key_type(false);
+}
+
 template<class T, class T1>
 std::tuple<typename array<T>::key_type, T> f$array_find(const array<T> &a,  const T1 &callback) {
   for (const auto &it : a) {
@@ -952,8 +1163,28 @@ auto transform_to_vector(const array<T> &a, const F &op) {
   return result;
 }
 
+// vector keys are the indexes 0..n-1, so generate them without touching the
+// entries of the parent array at all
+template<class T>
+array<int64_t> array_keys_of_vector(const array<T> &a) {
+  const int64_t n = a.count();
+  array<int64_t> result(array_size(n, 0, true));
+  for (int64_t i = 0; i < n; i++) {
+    result.push_back(i);
+  }
+  return result;
+}
+
 template<class T>
 array<typename array<T>::key_type> f$array_keys(const array<T> &a) {
+  if (a.is_vector()) {
+    const int64_t n = a.count();
+    array<typename array<T>::key_type> result(array_size(n, 0, true));
+    for (int64_t i = 0; i < n; i++) {
+      result.push_back(typename array<T>::key_type{i});
+    }
+    return result;
+  }
   using Iterator = typename array<T>::const_iterator;
   return transform_to_vector(a, [](Iterator it) { return it.get_key(); });
 }
@@ -966,26 +1197,32 @@ array<string> f$array_keys_as_strings(const array<T> &a) {
 
 template<class T>
 array<int64_t> f$array_keys_as_ints(const array<T> &a) {
+  if (a.is_vector()) {
+    return array_keys_of_vector(a);
+  }
   using Iterator = typename array<T>::const_iterator;
   return transform_to_vector(a, [](Iterator it) { return it.get_key().to_int(); });
 }
 
 template<class T>
 array<T> f$array_values(const array<T> &a) {
+  if (a.is_vector()) {
+    // the values of a vector are the vector itself: share the refcounted buffer,
+    // the usual copy-on-write kicks in if either side is mutated later
+    return a;
+  }
   using Iterator = typename array<T>::const_iterator;
   return transform_to_vector(a, [](Iterator it) { return it.get_value(); });
 }
 
 template<class T>
 array<T> f$array_unique(const array<T> &a) {
-  array<int64_t> values(array_size(a.count(), a.count(), false));
+  using key_maker = impl_::value_set_key_maker<impl_::value_set_key_t<T>>;
+  impl_::array_value_set<impl_::value_set_key_t<T>> values{a.count()};
   array<T> result(a.size());
 
   for (const auto &it : a) {
-    const T &value = it.get_value();
-    int64_t &cnt = values[f$strval(value)];
-    if (!cnt) {
-      cnt = 1;
+    if (values.insert(key_maker::make(it.get_value()))) {
       result.set_value(it);
     }
   }
@@ -1037,6 +1274,35 @@ bool f$in_array(const T1 &value, const array<T> &a, bool strict) {
   return false;
 }
 
+inline bool f$in_array(int64_t value, const array<int64_t> &a, bool strict __attribute__((unused))) {
+  const int64_t n = a.count();
+  if (a.is_vector() && n > 0) {
+    const int64_t *begin = a.get_const_vector_pointer();
+    return vk::simd_int64_find(begin, begin + n, value) != begin + n;
+  }
+
+  for (const auto &it : a) {
+    if (it.get_value() == value) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// opt-in counterpart of in_array() for vector arrays pre-sorted in ascending order:
+// a binary search instead of a linear scan, worth it for the large whitelist arrays
+// typical in access checks; map arrays fall back to the ordinary full scan
+template<class T, class T1>
+bool f$in_array_sorted(const T1 &value, const array<T> &a) {
+  if (a.is_vector() && a.count() > 0) {
+    const T *begin = a.get_const_vector_pointer();
+    const T *end = begin + a.count();
+    const T *it = std::lower_bound(begin, end, value, [](const T &lhs, const T1 &rhs) { return lt(lhs, rhs); });
+    return it != end && eq2(*it, value);
+  }
+  return f$in_array(value, a);
+}
+
 
 template<class T>
 array<T> f$array_fill(int64_t start_index, int64_t num, const T &value) {
@@ -1202,6 +1468,12 @@ struct sort_compare {
   }
 };
 
+// gt() on int64 is a plain >, deriving from std::greater lets array::sort
+// recognize the comparator and take the radix fast path on int64 vectors
+template<>
+struct sort_compare<int64_t> : std::greater<int64_t> {
+};
+
 template<class T>
 struct sort_compare_numeric {
   static_assert(!std::is_same<T, int>{}, "int is forbidden");
@@ -1378,6 +1650,94 @@ ReturnT f$array_sum(const array<T> &a) {
   return result;
 }
 
+// when inference proves the element type, the reduction over vector-mode arrays
+// runs straight over the flat entries with SIMD accumulation
+inline int64_t f$array_sum(const array<int64_t> &a) {
+  const int64_t n = a.count();
+  if (a.is_vector() && n > 0) {
+    const int64_t *begin = a.get_const_vector_pointer();
+    return vk::simd_int64_sum(begin, begin + n);
+  }
+
+  int64_t result = 0;
+  for (const auto &it : a) {
+    result += it.get_value();
+  }
+  return result;
+}
+
+inline double f$array_sum(const array<double> &a) {
+  const int64_t n = a.count();
+  if (a.is_vector() && n > 0) {
+    const double *begin = a.get_const_vector_pointer();
+    return vk::simd_double_sum(begin, begin + n);
+  }
+
+  double result = 0;
+  for (const auto &it : a) {
+    result += it.get_value();
+  }
+  return result;
+}
+
+template<class T>
+std::tuple<T, T> f$array_min_max(const array<T> &a) {
+  if (a.count() == 0) {
+    php_warning("Empty array specified to function array_min_max");
+    return {};
+  }
+
+  auto it = a.begin();
+  T min_value = it.get_value();
+  T max_value = min_value;
+  for (++it; it != a.end(); ++it) {
+    if (lt(it.get_value(), min_value)) {
+      min_value = it.get_value();
+    } else if (lt(max_value, it.get_value())) {
+      max_value = it.get_value();
+    }
+  }
+  return std::make_tuple(min_value, max_value);
+}
+
+inline std::tuple<int64_t, int64_t> f$array_min_max(const array<int64_t> &a) {
+  if (a.count() == 0) {
+    php_warning("Empty array specified to function array_min_max");
+    return {};
+  }
+
+  if (a.is_vector()) {
+    const int64_t *it = a.get_const_vector_pointer();
+    const int64_t *end = it + a.count();
+    int64_t min_value = *it;
+    int64_t max_value = *it;
+    for (++it; it != end; ++it) {
+      min_value = *it < min_value ? *it : min_value;
+      max_value = *it > max_value ? *it : max_value;
+    }
+    return std::make_tuple(min_value, max_value);
+  }
+
+  return f$array_min_max<int64_t>(a);
+}
+
+inline std::tuple<double, double> f$array_min_max(const array<double> &a) {
+  if (a.count() == 0) {
+    php_warning("Empty array specified to function array_min_max");
+    return {};
+  }
+
+  if (a.is_vector()) {
+    const double *begin = a.get_const_vector_pointer();
+    double min_value = 0;
+    double max_value = 0;
+    vk::simd_double_min_max(begin, begin + a.count(), &min_value, &max_value);
+    return std::make_tuple(min_value, max_value);
+  }
+
+  return f$array_min_max<double>(a);
+}
+
 
 template<class T>
 mixed f$getKeyByPos(const array<T> &a, int64_t pos) {
@@ -123,6 +123,11 @@ public:
     }
 
     arr.mutate_if_map_shared();
+    // the copy above is private, so this is a safe point to drop the map layout
+    // when the keys turned out to be a dense 0..n-1 range again
+    if (arr.try_convert_back_to_vector()) {
+      return array_iterator{arr.p, arr.p->int_entries};
+    }
     return array_iterator{arr.p, arr.p->begin()};
   }
 
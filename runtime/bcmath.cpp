@@ -444,7 +444,159 @@ static string bc_div_positive(const char *lhs, int lint, int ldot, int lfrac, in
 }
 
 
+// Operands with at most 18 significant digits and scales up to 18 are handled
+// with native 128-bit integer arithmetic instead of the per-digit algorithms above:
+// a number is packed into an unsigned mantissa scaled by a power of ten, so
+// bcadd/bcsub/bcmul/bccomp become a couple of machine operations plus formatting.
+// The digit limits keep every intermediate below 2 * 10^36, well within 128 bits.
+
+using bc_uint128 = unsigned __int128;
+
+static const int BC_FAST_MAX_DIGITS = 18;
+static const int BC_FAST_MAX_SCALE = 18;
+
+static bc_uint128 bc_pow10(int pow) {
+  bc_uint128 result = 1;
+  while (pow-- > 0) {
+    result *= 10;
+  }
+  return result;
+}
+
+//packs a number parsed by bc_parse_number into a mantissa scaled by 10^lscale,
+//returns false when it has too many digits for the fast path
+static bool bc_fast_parse(const char *s, int lint, int ldot, int lfrac, int lscale, bc_uint128 &mantissa) {
+  if (ldot - lint + lscale > BC_FAST_MAX_DIGITS) {
+    return false;
+  }
+  mantissa = 0;
+  for (int i = lint; i < ldot; i++) {
+    mantissa = mantissa * 10 + (s[i] - '0');
+  }
+  for (int i = lfrac; i < lfrac + lscale; i++) {
+    mantissa = mantissa * 10 + (s[i] - '0');
+  }
+  return true;
+}
+
+//prints mantissa / 10^scale with exactly scale fraction digits, the same way
+//bc_round formats the results of the fast-path callers
+static string bc_fast_format(bc_uint128 mantissa, int scale, int sign) {
+  char buffer[60];
+  int cur_pos = 60;
+  if (scale > 0) {
+    for (int i = 0; i < scale; i++) {
+      buffer[--cur_pos] = (char)(mantissa % 10 + '0');
+      mantissa /= 10;
+    }
+    buffer[--cur_pos] = '.';
+  }
+  do {
+    buffer[--cur_pos] = (char)(mantissa % 10 + '0');
+    mantissa /= 10;
+  } while (mantissa > 0);
+  if (sign < 0) {
+    buffer[--cur_pos] = '-';
+  }
+  return string(buffer + cur_pos, 60 - cur_pos);
+}
+
+static bool bc_fast_add(const char *lhs, int lsign, int lint, int ldot, int lfrac, int lscale, const char *rhs, int rsign, int rint, int rdot, int rfrac, int rscale, int scale, string &result) {
+  if (scale > BC_FAST_MAX_SCALE) {
+    return false;
+  }
+
+  bc_uint128 l, r;
+  if (!bc_fast_parse(lhs, lint, ldot, lfrac, lscale, l) ||
+      !bc_fast_parse(rhs, rint, rdot, rfrac, rscale, r)) {
+    return false;
+  }
+
+  int result_scale = max(lscale, rscale);
+  l *= bc_pow10(result_scale - lscale);
+  r *= bc_pow10(result_scale - rscale);
+
+  int sign;
+  bc_uint128 res;
+  if (lsign == rsign) {
+    res = l + r;
+    sign = lsign;
+  } else if (l >= r) {
+    res = l - r;
+    sign = lsign;
+  } else {
+    res = r - l;
+    sign = rsign;
+  }
+  //the sign is chosen before truncation, so "-0.001" at scale 0 yields "-0" like bc_round does
+  if (res == 0) {
+    sign = 1;
+  }
+
+  if (result_scale > scale) {
+    res /= bc_pow10(result_scale - scale);
+  } else {
+    res *= bc_pow10(scale - result_scale);
+  }
+
+  result = bc_fast_format(res, scale, sign);
+  return true;
+}
+
+static bool bc_fast_mul(const char *lhs, int lint, int ldot, int lfrac, int lscale, const char *rhs, int rint, int rdot, int rfrac, int rscale, int scale, int sign, string &result) {
+  if (scale > BC_FAST_MAX_SCALE) {
+    return false;
+  }
+
+  bc_uint128 l, r;
+  if (!bc_fast_parse(lhs, lint, ldot, lfrac, lscale, l) ||
+      !bc_fast_parse(rhs, rint, rdot, rfrac, rscale, r)) {
+    return false;
+  }
+
+  bc_uint128 res = l * r;
+  if (res == 0) {
+    sign = 1;
+  }
+
+  //unlike bcadd, bcmul doesn't pad the result with trailing zeroes up to scale
+  int result_scale = lscale + rscale;
+  if (result_scale > scale) {
+    res /= bc_pow10(result_scale - scale);
+    result_scale = scale;
+  }
+
+  result = bc_fast_format(res, result_scale, sign);
+  return true;
+}
+
+static bool bc_fast_comp(const char *lhs, int lint, int ldot, int lfrac, int lscale, const char *rhs, int rint, int rdot, int rfrac, int rscale, int scale, int &result) {
+  if (scale > BC_FAST_MAX_SCALE) {
+    return false;
+  }
+
+  bc_uint128 l, r;
+  if (!bc_fast_parse(lhs, lint, ldot, lfrac, lscale, l) ||
+      !bc_fast_parse(rhs, rint, rdot, rfrac, rscale, r)) {
+    return false;
+  }
+
+  int lkeep = min(lscale, scale);
+  int rkeep = min(rscale, scale);
+  l = l / bc_pow10(lscale - lkeep) * bc_pow10(scale - lkeep);
+  r = r / bc_pow10(rscale - rkeep) * bc_pow10(scale - rkeep);
+
+  result = (l < r ? -1 : (l > r ? 1 : 0));
+  return true;
+}
+
+
 static string bc_add(const char *lhs, int lsign, int lint, int ldot, int lfrac, int lscale, const char *rhs, int rsign, int rint, int rdot, int rfrac, int rscale, int scale) {
+  string fast_result;
+  if (bc_fast_add(lhs, lsign, lint, ldot, lfrac, lscale, rhs, rsign, rint, rdot, rfrac, rscale, scale, fast_result)) {
+    return fast_result;
+  }
+
   if (lsign > 0 && rsign > 0) {
     return bc_add_positive(lhs, lint, ldot, lfrac, lscale, rhs, rint, rdot, rfrac, rscale, scale, 1);
   }
@@ -715,6 +867,13 @@ string f$bcmul(const string &lhs, const string &rhs, int64_t scale) {
     return ZERO;
   }
 
+  string fast_result;
+  if (bc_fast_mul(lhs.c_str(), lint, ldot, lfrac, lscale,
+                  rhs.c_str(), rint, rdot, rfrac, rscale,
+                  static_cast<int>(scale), lsign * rsign, fast_result)) {
+    return fast_result;
+  }
+
   return bc_mul_positive(lhs.c_str(), lint, ldot, lfrac, lscale,
                          rhs.c_str(), rint, rdot, rfrac, rscale,
                          static_cast<int>(scale), lsign * rsign);
@@ -752,6 +911,13 @@ int64_t f$bccomp(const string &lhs, const string &rhs, int64_t scale) {
     return (lsign - rsign) / 2;
   }
 
+  int fast_result;
+  if (bc_fast_comp(lhs.c_str(), lint, ldot, lfrac, lscale,
+                   rhs.c_str(), rint, rdot, rfrac, rscale,
+                   static_cast<int>(scale), fast_result)) {
+    return (1 - 2 * (lsign < 0)) * fast_result;
+  }
+
   return (1 - 2 * (lsign < 0)) * bc_comp(lhs.c_str(), lint, ldot, lfrac, lscale,
                                          rhs.c_str(), rint, rdot, rfrac, rscale,
                                          static_cast<int>(scale));
@@ -34,6 +34,11 @@ public:
     return acquired_sample_->get_confdata();
   }
 
+  const ConfdataSample &get_acquired_sample() const noexcept {
+    php_assert(acquired_sample_);
+    return *acquired_sample_;
+  }
+
   bool is_initialized() const noexcept {
     return global_manager_.is_initialized();
   }
@@ -88,6 +93,25 @@ bool f$is_confdata_loaded() noexcept {
   return ConfdataLocalManager::get().is_initialized();
 }
 
+int64_t f$confdata_get_global_epoch() noexcept {
+  if (unlikely(!ConfdataLocalManager::get().is_initialized())) {
+    return 0;
+  }
+  return static_cast<int64_t>(ConfdataGlobalManager::get().get_epoch_table().get_global_epoch());
+}
+
+int64_t f$confdata_get_epoch(const string &key) noexcept {
+  if (unlikely(!verify_confdata_key_param(key, "key"))) {
+    return 0;
+  }
+
+  ConfdataKeyMaker key_maker;
+  key_maker.update(key.c_str(), static_cast<int16_t>(key.size()), ConfdataLocalManager::get().get_predefined_wildcards());
+  const string &first_key = key_maker.get_first_key();
+  const size_t slot = ConfdataEpochTable::get_slot(vk::string_view{first_key.c_str(), first_key.size()});
+  return static_cast<int64_t>(ConfdataGlobalManager::get().get_epoch_table().get_slot_epoch(slot));
+}
+
 mixed f$confdata_get_value(const string &key) noexcept {
   if (unlikely(!verify_confdata_key_param(key, "key"))) {
     return {};
@@ -96,16 +120,14 @@ mixed f$confdata_get_value(const string &key) noexcept {
   const auto &local_manager = ConfdataLocalManager::get();
   ConfdataKeyMaker key_maker;
   key_maker.update(key.c_str(), static_cast<int16_t>(key.size()), local_manager.get_predefined_wildcards());
-  const auto &confdata_storage = local_manager.get_confdata_storage();
-  auto it = confdata_storage.find(key_maker.get_first_key());
-  if (it != confdata_storage.end()) {
+  if (const mixed *section = local_manager.get_acquired_sample().find_first_key(key_maker.get_first_key())) {
     // if key doesn't contain prefixes
     if (key_maker.get_first_key_type() == ConfdataFirstKeyType::simple_key) {
-      return it->second;
+      return *section;
     }
     // it must be an array (we loaded it this way)
-    php_assert(it->second.is_array());
-    if (auto *value = it->second.as_array().find_value(key_maker.get_second_key())) {
+    php_assert(section->is_array());
+    if (auto *value = section->as_array().find_value(key_maker.get_second_key())) {
       return *value;
     }
   }
@@ -203,17 +225,15 @@ array<mixed> f$confdata_get_values_by_predefined_wildcard(const string &wildcard
   }
 
   const auto &local_manager = ConfdataLocalManager::get();
-  const auto &confdata_storage = local_manager.get_confdata_storage();
   const vk::string_view wildcard_view{wildcard.c_str(), wildcard.size()};
   if (local_manager.get_predefined_wildcards().detect_first_key_type(wildcard_view) == ConfdataFirstKeyType::simple_key) {
     php_warning("Trying to get elements by non predefined wildcard '%s'", wildcard.c_str());
     return {};
   }
 
-  const auto elements_it = confdata_storage.find(wildcard);
-  if (elements_it != confdata_storage.end()) {
-    php_assert(elements_it->second.is_array());
-    return elements_it->second.as_array();
+  if (const mixed *elements = local_manager.get_acquired_sample().find_first_key(wildcard)) {
+    php_assert(elements->is_array());
+    return elements->as_array();
   }
   return {};
 }
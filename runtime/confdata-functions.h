@@ -11,6 +11,10 @@ void free_confdata_functions_lib();
 
 bool f$is_confdata_loaded() noexcept;
 
+int64_t f$confdata_get_global_epoch() noexcept;
+
+int64_t f$confdata_get_epoch(const string &key) noexcept;
+
 mixed f$confdata_get_value(const string &key) noexcept;
 
 array<mixed> f$confdata_get_values_by_any_wildcard(const string &wildcard) noexcept;
@@ -4,6 +4,8 @@
 
 #include "runtime/confdata-global-manager.h"
 
+#include <algorithm>
+
 #include "runtime/php_assert.h"
 
 namespace {
@@ -43,10 +45,54 @@ void ConfdataSample::init(memory_resource::unsynchronized_pool_resource &resourc
 void ConfdataSample::reset(confdata_sample_storage &&new_confdata) noexcept {
   clear();
   *confdata_storage_ = std::move(new_confdata);
+  rebuild_first_key_index();
+}
+
+void ConfdataSample::rebuild_first_key_index() noexcept {
+  destroy_first_key_index();
+  const size_t index_size = confdata_storage_->size();
+  if (!index_size) {
+    return;
+  }
+  auto *mem = resource_->allocate(sizeof(FirstKeyEntry) * index_size);
+  if (unlikely(!mem)) {
+    // lookups fall back to the tree
+    return;
+  }
+  first_key_index_ = static_cast<FirstKeyEntry *>(mem);
+  first_key_index_size_ = index_size;
+  // the map is iterated in key order, so the index is born sorted
+  size_t i = 0;
+  for (const auto &section : *confdata_storage_) {
+    first_key_index_[i++] = FirstKeyEntry{&section.first, &section.second};
+  }
+}
+
+void ConfdataSample::destroy_first_key_index() noexcept {
+  if (first_key_index_) {
+    resource_->deallocate(first_key_index_, sizeof(FirstKeyEntry) * first_key_index_size_);
+    first_key_index_ = nullptr;
+    first_key_index_size_ = 0;
+  }
+}
+
+const mixed *ConfdataSample::find_first_key(const string &first_key) const noexcept {
+  if (unlikely(!first_key_index_)) {
+    const auto it = confdata_storage_->find(first_key);
+    return it == confdata_storage_->end() ? nullptr : &it->second;
+  }
+  const FirstKeyEntry *first = first_key_index_;
+  const FirstKeyEntry *last = first + first_key_index_size_;
+  const FirstKeyEntry *entry = std::lower_bound(first, last, first_key,
+                                                [](const FirstKeyEntry &lhs, const string &rhs) {
+                                                  return lhs.first_key->compare(rhs) < 0;
+                                                });
+  return entry != last && entry->first_key->compare(first_key) == 0 ? entry->value : nullptr;
 }
 
 void ConfdataSample::clear() noexcept {
   php_assert(confdata_storage_);
+  destroy_first_key_index();
   confdata_storage_->clear();
 
   if (garbage_) {
@@ -87,6 +133,16 @@ void ConfdataSample::save_garbage(std::forward_list<ConfdataGarbageNode> &&garba
   }
 }
 
+void ConfdataEpochTable::on_sample_published(const std::bitset<SLOTS_AMOUNT> &modified_slots) noexcept {
+  const uint64_t epoch = global_epoch_.load(std::memory_order_relaxed) + 1;
+  for (size_t slot = 0; slot != SLOTS_AMOUNT; ++slot) {
+    if (modified_slots.test(slot)) {
+      slot_epochs_[slot].store(epoch, std::memory_order_release);
+    }
+  }
+  global_epoch_.store(epoch, std::memory_order_release);
+}
+
 ConfdataGlobalManager &ConfdataGlobalManager::get() noexcept {
   static ConfdataGlobalManager manager;
   return manager;
@@ -102,6 +158,11 @@ void ConfdataGlobalManager::init(size_t confdata_memory_limit,
   confdata_samples_.init(resource_);
   predefined_wildcards_.set_wildcards(std::move(predefined_wilrdcards));
   key_blacklist_.set_blacklist(std::move(blacklist_pattern));
+
+  void *mem_for_epoch_table = mmap(nullptr, sizeof(ConfdataEpochTable),
+                                   PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_SHARED, -1, 0);
+  php_assert(mem_for_epoch_table);
+  epoch_table_ = new(mem_for_epoch_table) ConfdataEpochTable{};
 }
 
 ConfdataGlobalManager::~ConfdataGlobalManager() noexcept {
@@ -109,5 +170,8 @@ ConfdataGlobalManager::~ConfdataGlobalManager() noexcept {
     confdata_samples_.destroy();
     munmap(resource_.memory_begin(), resource_.get_memory_stats().memory_limit);
     resource_.init(nullptr, 0);
+    epoch_table_->~ConfdataEpochTable();
+    munmap(epoch_table_, sizeof(ConfdataEpochTable));
+    epoch_table_ = nullptr;
   }
 }
@@ -3,6 +3,8 @@
 // Distributed under the GPL v3 License, see LICENSE.notice.txt
 
 #pragma once
+#include <atomic>
+#include <bitset>
 #include <forward_list>
 #include <unordered_set>
 
@@ -40,12 +42,65 @@ public:
     return *confdata_storage_;
   }
 
+  // point lookups binary search a flat sorted index rebuilt on each publish,
+  // it is much more cache friendly than walking the tree nodes spread over the shared memory pool
+  const mixed *find_first_key(const string &first_key) const noexcept;
+
 private:
+  struct FirstKeyEntry {
+    const string *first_key;
+    const mixed *value;
+  };
+
+  void rebuild_first_key_index() noexcept;
+  void destroy_first_key_index() noexcept;
+
   memory_resource::unsynchronized_pool_resource *resource_{nullptr};
   confdata_sample_storage *confdata_storage_{nullptr};
+  FirstKeyEntry *first_key_index_{nullptr};
+  size_t first_key_index_size_{0};
   std::forward_list<ConfdataGarbageNode> *garbage_{nullptr};
 };
 
+// workers cache parsed confdata values in script memory across requests and need
+// a cheap way to notice changes. Every published sample advances the global epoch,
+// and the slot of every first key modified by that sample is set to the new epoch.
+// The table is hashed, so any key maps to a slot without any registration; a slot
+// collision can only make an unchanged value look stale, never the opposite.
+// The table lives in shared memory, the master process is the only writer
+class ConfdataEpochTable : vk::not_copyable {
+public:
+  static constexpr size_t SLOTS_AMOUNT = 4096;
+
+  ConfdataEpochTable() noexcept {
+    global_epoch_.store(0, std::memory_order_relaxed);
+    for (auto &slot_epoch: slot_epochs_) {
+      slot_epoch.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  static size_t get_slot(vk::string_view first_key) noexcept {
+    return std::hash<vk::string_view>{}(first_key) % SLOTS_AMOUNT;
+  }
+
+  uint64_t get_global_epoch() const noexcept {
+    return global_epoch_.load(std::memory_order_acquire);
+  }
+
+  uint64_t get_slot_epoch(size_t slot) const noexcept {
+    return slot_epochs_[slot].load(std::memory_order_acquire);
+  }
+
+  // called from the master only, after the new sample became visible to the workers:
+  // a worker racing with the switch may cache a fresh value under the old epoch and
+  // drop it once in vain; the opposite order could keep a stale value forever
+  void on_sample_published(const std::bitset<SLOTS_AMOUNT> &modified_slots) noexcept;
+
+private:
+  std::atomic<uint64_t> global_epoch_;
+  std::array<std::atomic<uint64_t>, SLOTS_AMOUNT> slot_epochs_;
+};
+
 class ConfdataGlobalManager : vk::not_copyable {
 public:
   static ConfdataGlobalManager &get() noexcept;
@@ -100,6 +155,10 @@ public:
     return key_blacklist_;
   }
 
+  ConfdataEpochTable &get_epoch_table() noexcept {
+    return *epoch_table_;
+  }
+
   ~ConfdataGlobalManager() noexcept;
 
 private:
@@ -109,4 +168,5 @@ private:
 
   ConfdataPredefinedWildcards predefined_wildcards_;
   ConfdataKeyBlacklist key_blacklist_;
+  ConfdataEpochTable *epoch_table_{nullptr};
 };
@@ -7,14 +7,39 @@
 #include <utility>
 
 #include "common/mixin/not_copyable.h"
+#include "common/wrappers/likely.h"
+
+#include "runtime/php_assert.h"
+
+// the server provides a real implementation; this weak default is a no-op
+void check_stack_overflow() __attribute__ ((weak));
 
 namespace dl {
 
 extern volatile int in_critical_section;
 extern volatile long long pending_signals;
 
-void enter_critical_section() noexcept;
-void leave_critical_section() noexcept;
+// out-of-line slow path of leave_critical_section: re-raises the signals
+// that arrived while the section was held
+void raise_pending_signals() noexcept;
+
+// enter/leave are inline on purpose: guards sit on hot runtime paths (every
+// heap allocation among others), and an out-of-line call per enter/leave pair
+// used to show up in worker profiles; the fast path is two volatile writes
+// plus a predictable branch
+inline void enter_critical_section() noexcept {
+  check_stack_overflow();
+  php_assert (in_critical_section >= 0);
+  in_critical_section = in_critical_section + 1;
+}
+
+inline void leave_critical_section() noexcept {
+  in_critical_section = in_critical_section - 1;
+  php_assert (in_critical_section >= 0);
+  if (unlikely(pending_signals != 0) && in_critical_section <= 0) {
+    raise_pending_signals();
+  }
+}
 
 struct CriticalSectionGuard : private vk::not_copyable {
   CriticalSectionGuard() noexcept { enter_critical_section(); }
@@ -29,4 +54,4 @@ auto critical_section_call(F &&f, Args &&...args) noexcept {
 
 void init_critical_section() noexcept;
 
-} // namespace dl
\ No newline at end of file
+} // namespace dl
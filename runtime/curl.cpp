@@ -14,7 +14,7 @@
 #include "runtime/global_storage.h"
 #include "runtime/integer_types.h"
 #include "runtime/interface.h"
-#include "runtime/openssl.h"
+#include "runtime/net_events.h"
 #include "common/smart_ptrs/singleton.h"
 #include "common/wrappers/to_array.h"
 
@@ -37,6 +37,102 @@ namespace {
 
 constexpr int64_t BAD_CURL_OPTION = static_cast<int>(CURL_LAST) + static_cast<int>(CURL_FORMADD_LAST);
 
+// libcurl allocates from heap memory (persistent between script runs), not from the script arena:
+// this lets easy handles — and their cached TCP connections and TLS sessions — survive the request,
+// so reused handles skip the handshake entirely. Allocation sizes are kept in a small header
+// because the curl free/realloc callbacks don't pass them
+void *curl_mem_malloc(size_t size) noexcept {
+  auto *mem = static_cast<size_t *>(dl::heap_allocate(size + 2 * sizeof(size_t)));
+  if (unlikely(mem == nullptr)) {
+    return nullptr;
+  }
+  mem[0] = size;
+  return mem + 2;
+}
+
+void curl_mem_free(void *ptr) noexcept {
+  if (ptr != nullptr) {
+    auto *mem = static_cast<size_t *>(ptr) - 2;
+    dl::heap_deallocate(mem, mem[0] + 2 * sizeof(size_t));
+  }
+}
+
+void *curl_mem_realloc(void *ptr, size_t new_size) noexcept {
+  if (ptr == nullptr) {
+    return curl_mem_malloc(new_size);
+  }
+  auto *mem = static_cast<size_t *>(ptr) - 2;
+  mem = static_cast<size_t *>(dl::heap_reallocate(mem, new_size + 2 * sizeof(size_t), mem[0] + 2 * sizeof(size_t)));
+  if (unlikely(mem == nullptr)) {
+    return nullptr;
+  }
+  mem[0] = new_size;
+  return mem + 2;
+}
+
+char *curl_mem_strdup(const char *str) noexcept {
+  const size_t len = strlen(str) + 1;
+  auto *copy = static_cast<char *>(curl_mem_malloc(len));
+  if (likely(copy != nullptr)) {
+    memcpy(copy, str, len);
+  }
+  return copy;
+}
+
+void *curl_mem_calloc(size_t nmemb, size_t size) noexcept {
+  void *mem = curl_mem_malloc(nmemb * size);
+  if (likely(mem != nullptr)) {
+    memset(mem, 0, nmemb * size);
+  }
+  return mem;
+}
+
+// worker-local pool of reset easy handles kept alive between requests;
+// bounded, so at most CURL_HANDLE_POOL_MAX idle handles (with their connection caches) persist
+constexpr size_t CURL_HANDLE_POOL_MAX = 16;
+CURL *easy_handle_pool[CURL_HANDLE_POOL_MAX];
+size_t easy_handle_pool_size = 0;
+
+// one share object per worker: TLS session tickets and dns entries learned by one easy handle
+// become reusable by every other, including fresh handles created after the pool ran empty.
+// the worker is single-threaded, so the share needs no lock callbacks
+static CURLSH *get_share_handle() noexcept {
+  static CURLSH *share_handle = nullptr;
+  if (share_handle == nullptr) {
+    share_handle = curl_share_init();
+    if (share_handle != nullptr) {
+      curl_share_setopt(share_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+      curl_share_setopt(share_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    }
+  }
+  return share_handle;
+}
+
+CURL *acquire_easy_handle() noexcept {
+  CURL *easy_handle = easy_handle_pool_size > 0
+                      ? easy_handle_pool[--easy_handle_pool_size]
+                      : dl::critical_section_call(curl_easy_init);
+  if (easy_handle != nullptr) {
+    // CURLOPT_SHARE is dropped by curl_easy_reset, so it is re-attached on every acquire
+    dl::critical_section_call([easy_handle] {
+      if (CURLSH *share_handle = get_share_handle()) {
+        curl_easy_setopt(easy_handle, CURLOPT_SHARE, share_handle);
+      }
+    });
+  }
+  return easy_handle;
+}
+
+void release_easy_handle(CURL *easy_handle) noexcept {
+  if (easy_handle_pool_size < CURL_HANDLE_POOL_MAX) {
+    // reset drops all options (they point into script memory), but keeps the connection cache
+    dl::critical_section_call(curl_easy_reset, easy_handle);
+    easy_handle_pool[easy_handle_pool_size++] = easy_handle;
+  } else {
+    dl::critical_section_call(curl_easy_cleanup, easy_handle);
+  }
+}
+
 size_t curl_write(char *data, size_t size, size_t nmemb, void *userdata);
 
 class BaseContext {
@@ -167,6 +263,9 @@ public:
   Optional<string> private_data{false};
 
   bool return_transfer{false};
+  // the user's total transfer timeout in ms, 0 = unlimited; kept here because
+  // curl_exec() re-applies it clamped to the request's remaining deadline
+  long timeout_ms{0};
 };
 
 class MultiContext : public BaseContext {
@@ -219,7 +318,7 @@ T *get_context(int64_t id) noexcept {
 }
 
 void easy_close(EasyContext *easy_context) noexcept {
-  dl::critical_section_call(curl_easy_cleanup, easy_context->easy_handle);
+  release_easy_handle(easy_context->easy_handle);
   easy_context->cleanup_slists_and_posts();
   easy_context->~EasyContext();
   dl::deallocate(easy_context, sizeof(EasyContext));
@@ -587,6 +686,11 @@ bool curl_setopt(EasyContext *easy_context, int64_t option, const mixed &value)
   if (easy_context->check_option_value<CURLOPT_OPTION_OFFSET, curlopt_options.size()>(option, "parameter option", "curl_setopt")) {
     auto curl_option = curlopt_options[option - CURLOPT_OPTION_OFFSET];
     easy_context->error_num = CURLE_OK;
+    if (curl_option.option == CURLOPT_TIMEOUT) {
+      easy_context->timeout_ms = static_cast<long>(f$longval(value).l) * 1000;
+    } else if (curl_option.option == CURLOPT_TIMEOUT_MS) {
+      easy_context->timeout_ms = static_cast<long>(f$longval(value).l);
+    }
     curl_option.option_setter(easy_context, curl_option.option, value);
   }
   return easy_context->error_num == CURLE_OK;
@@ -607,7 +711,7 @@ void init_curl_lib() noexcept;
 curl_easy f$curl_init(const string &url) noexcept {
   init_curl_lib();
 
-  CURL *easy_handle = dl::critical_section_call(curl_easy_init);
+  CURL *easy_handle = acquire_easy_handle();
   if (unlikely(easy_handle == nullptr)) {
     php_warning("Could not initialize a new curl easy handle");
     return 0;
@@ -632,6 +736,7 @@ void f$curl_reset(curl_easy easy_id) noexcept {
   if (auto *easy_context = get_context<EasyContext>(easy_id)) {
     curl_easy_reset(easy_context->easy_handle);
     easy_context->return_transfer = false;
+    easy_context->timeout_ms = 0;
     easy_context->private_data = false;
     easy_context->cleanup_slists_and_posts();
     easy_context->cleanup_for_next_request();
@@ -669,6 +774,19 @@ mixed f$curl_exec(curl_easy easy_id) noexcept {
   }
 
   easy_context->cleanup_for_next_request();
+
+  // clamp the transfer to the request's remaining deadline budget: once the
+  // client has given up there is no point in finishing the download
+  long effective_timeout_ms = easy_context->timeout_ms;
+  const double budget = get_request_deadline_budget();
+  if (budget < MAX_TIMEOUT) {
+    const long budget_ms = std::max(static_cast<long>(budget * 1000), 1L);
+    if (effective_timeout_ms <= 0 || budget_ms < effective_timeout_ms) {
+      effective_timeout_ms = budget_ms;
+    }
+  }
+  easy_context->set_option(CURLOPT_TIMEOUT_MS, effective_timeout_ms);
+
   easy_context->error_num = dl::critical_section_call(curl_easy_perform, easy_context->easy_handle);
 
   if (easy_context->error_num != CURLE_OK && easy_context->error_num != CURLE_PARTIAL_FILE) {
@@ -933,21 +1051,28 @@ Optional<string> f$curl_multi_strerror(int64_t error_num) noexcept {
 }
 
 void init_curl_lib() noexcept {
-  if (dl::query_num != CurlContexts::get().get_query_tag()) {
+  // the library itself lives on heap memory and is initialized once per worker:
+  // a per-request curl_global_cleanup() would drop the pooled handles and their TLS sessions
+  // (and used to de-initialize openssl, see the removed reinit_openssl_lib_hack() call)
+  static bool lib_initialized = false;
+  if (unlikely(!lib_initialized)) {
     const CURLcode result = dl::critical_section_call([] {
       return curl_global_init_mem(
         CURL_GLOBAL_ALL,
-        dl::script_allocator_malloc,
-        dl::script_allocator_free,
-        dl::script_allocator_realloc,
-        dl::script_allocator_strdup,
-        dl::script_allocator_calloc);
+        curl_mem_malloc,
+        curl_mem_free,
+        curl_mem_realloc,
+        curl_mem_strdup,
+        curl_mem_calloc);
     });
 
     if (result != CURLE_OK) {
       php_critical_error ("can't initialize curl");
     }
+    lib_initialized = true;
+  }
 
+  if (dl::query_num != CurlContexts::get().get_query_tag()) {
     CurlContexts::get().init(dl::query_num);
   }
 }
@@ -967,10 +1092,6 @@ void free_curl_lib() noexcept {
       }
     }
 
-    curl_global_cleanup();
     CurlContexts::get().hard_reset();
-    // curl_global_cleanup() from libcurl de-initializes openssl completely
-    // TODO: understand how to live without curl_global_cleanup() and remove this kludge from here
-    reinit_openssl_lib_hack();
   }
 }
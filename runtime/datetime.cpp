@@ -8,6 +8,8 @@
 #include <ctime>
 #include <sys/time.h>
 
+#include "common/precise-time.h"
+
 #include "runtime/critical_section.h"
 #include "runtime/string_functions.h"
 
@@ -359,15 +361,76 @@ static string date(const string &format, const tm &t, int64_t timestamp, bool lo
   return SB.str();
 }
 
+// the broken-down time of the last seen timestamp is memoized per clock: the typical logging
+// pattern formats the current second over and over, while localtime_r goes through glibc
+// timezone locking on every call. the default timezone can't change at runtime (see
+// f$date_default_timezone_set), so the memo never turns stale
+static const tm &cached_localtime(time_t timestamp) {
+  static time_t cached_timestamp = std::numeric_limits<time_t>::min();
+  static tm cached_tm;
+  if (timestamp != cached_timestamp) {
+    localtime_r(&timestamp, &cached_tm);
+    cached_timestamp = timestamp;
+  }
+  return cached_tm;
+}
+
+static const tm &cached_gmtime(time_t timestamp) {
+  static time_t cached_timestamp = std::numeric_limits<time_t>::min();
+  static tm cached_tm;
+  if (timestamp != cached_timestamp) {
+    gmtime_r(&timestamp, &cached_tm);
+    cached_timestamp = timestamp;
+  }
+  return cached_tm;
+}
+
+// rendered (format, timestamp, clock) triples are cached, so that the handful of distinct
+// formats the logging layer uses turn repeated date() calls within one second into a memcpy;
+// the output of date() depends on nothing else, the entry can't go stale
+struct date_result_cache_entry {
+  uint8_t format_len;
+  char format[47];
+  int64_t timestamp;
+  bool local;
+  uint8_t result_len;
+  char result[120];
+};
+static date_result_cache_entry date_result_cache[16];
+
+static string cached_date(const string &format, int64_t timestamp, bool local) {
+  if (format.size() >= sizeof(date_result_cache_entry{}.format)) {
+    const tm &t = local ? cached_localtime(timestamp) : cached_gmtime(timestamp);
+    return date(format, t, timestamp, local);
+  }
+
+  const uint64_t format_hash = static_cast<uint64_t>(string_hash(format.c_str(), format.size())) * 2 + local;
+  date_result_cache_entry &entry = date_result_cache[format_hash % (sizeof(date_result_cache) / sizeof(date_result_cache[0]))];
+  if (entry.format_len == format.size() && !memcmp(entry.format, format.c_str(), format.size()) &&
+      entry.timestamp == timestamp && entry.local == local) {
+    return string(entry.result, entry.result_len);
+  }
+
+  const tm &t = local ? cached_localtime(timestamp) : cached_gmtime(timestamp);
+  string res = date(format, t, timestamp, local);
+  if (res.size() < sizeof(entry.result)) {
+    entry.format_len = static_cast<uint8_t>(format.size());
+    memcpy(entry.format, format.c_str(), format.size());
+    entry.timestamp = timestamp;
+    entry.local = local;
+    entry.result_len = static_cast<uint8_t>(res.size());
+    memcpy(entry.result, res.c_str(), res.size());
+  } else {
+    entry.format_len = 0;
+  }
+  return res;
+}
+
 string f$date(const string &format, int64_t timestamp) {
   if (timestamp == std::numeric_limits<int64_t>::min()) {
     timestamp = time(nullptr);
   }
-  tm t;
-  time_t timestamp_t = timestamp;
-  localtime_r(&timestamp_t, &t);
-
-  return date(format, t, timestamp, true);
+  return cached_date(format, timestamp, true);
 }
 
 bool f$date_default_timezone_set(const string &s) {
@@ -389,9 +452,7 @@ array<mixed> f$getdate(int64_t timestamp) {
   if (timestamp == std::numeric_limits<int64_t>::min()) {
     timestamp = time(nullptr);
   }
-  tm t;
-  time_t timestamp_t = timestamp;
-  localtime_r(&timestamp_t, &t);
+  tm t = cached_localtime(timestamp);
 
   array<mixed> result(array_size(1, 10, false));
 
@@ -414,17 +475,11 @@ string f$gmdate(const string &format, int64_t timestamp) {
   if (timestamp == std::numeric_limits<int64_t>::min()) {
     timestamp = time(nullptr);
   }
-  tm t;
-  time_t timestamp_t = timestamp;
-  gmtime_r(&timestamp_t, &t);
-
-  return date(format, t, timestamp, false);
+  return cached_date(format, timestamp, false);
 }
 
 int64_t f$gmmktime(int64_t h, int64_t m, int64_t s, int64_t month, int64_t day, int64_t year) {
-  tm t;
-  time_t timestamp_t = time(nullptr);
-  gmtime_r(&timestamp_t, &t);
+  tm t = cached_gmtime(time(nullptr));
 
   if (h != std::numeric_limits<int64_t>::min()) {
     t.tm_hour = static_cast<int32_t>(h);
@@ -458,9 +513,7 @@ array<mixed> f$localtime(int64_t timestamp, bool is_associative) {
   if (timestamp == std::numeric_limits<int64_t>::min()) {
     timestamp = time(nullptr);
   }
-  tm t;
-  time_t timestamp_t = timestamp;
-  localtime_r(&timestamp_t, &t);
+  tm t = cached_localtime(timestamp);
 
   if (!is_associative) {
     return array<mixed>::create(t.tm_sec, t.tm_min, t.tm_hour, t.tm_mday, t.tm_mon, t.tm_year, t.tm_wday, t.tm_yday, t.tm_isdst);
@@ -489,17 +542,18 @@ double microtime_monotonic() {
 }
 
 static string microtime_string() {
-  struct timespec T;
-  php_assert (clock_gettime(CLOCK_REALTIME, &T) >= 0);
+  // the interpolated clock is microsecond-accurate, which is all a timestamp needs;
+  // interval measurements use microtime_monotonic, which stays on the real clock
+  const double now = get_interpolated_double_time();
+  const auto sec = static_cast<int>(now);
+  const auto nsec = static_cast<int>((now - sec) * 1e9);
   char buf[45];
-  int len = sprintf(buf, "0.%09d %d", (int)T.tv_nsec, (int)T.tv_sec);
+  int len = sprintf(buf, "0.%09d %d", nsec, sec);
   return string(buf, len);
 }
 
 double microtime() {
-  struct timespec T;
-  php_assert (clock_gettime(CLOCK_REALTIME, &T) >= 0);
-  return static_cast<double>(T.tv_sec) + static_cast<double>(T.tv_nsec) * 1e-9;
+  return get_interpolated_double_time();
 }
 
 mixed f$microtime(bool get_as_float) {
@@ -511,9 +565,7 @@ mixed f$microtime(bool get_as_float) {
 }
 
 int64_t f$mktime(int64_t h, int64_t m, int64_t s, int64_t month, int64_t day, int64_t year) {
-  tm t;
-  time_t timestamp_t = time(nullptr);
-  localtime_r(&timestamp_t, &t);
+  tm t = cached_localtime(time(nullptr));
 
   if (h != std::numeric_limits<int64_t>::min()) {
     t.tm_hour = static_cast<int32_t>(h);
@@ -548,9 +600,7 @@ string f$strftime(const string &format, int64_t timestamp) {
   if (timestamp == std::numeric_limits<int64_t>::min()) {
     timestamp = time(nullptr);
   }
-  tm t;
-  time_t timestamp_t = timestamp;
-  localtime_r(&timestamp_t, &t);
+  tm t = cached_localtime(timestamp);
 
   if (!strftime(php_buf, PHP_BUF_LEN, format.c_str(), &t)) {
     return string();
@@ -563,9 +613,7 @@ Optional<int64_t> f$strtotime(const string &time_str, int64_t timestamp) {
   if (timestamp == std::numeric_limits<int64_t>::min()) {
     timestamp = time(nullptr);
   }
-  tm t;
-  time_t timestamp_t = timestamp;
-  localtime_r(&timestamp_t, &t);
+  tm t = cached_localtime(timestamp);
 
   string s = f$trim(time_str);
 
@@ -814,7 +862,7 @@ Optional<int64_t> f$strtotime(const string &time_str, int64_t timestamp) {
 }
 
 int64_t f$time() {
-  return time(nullptr);
+  return static_cast<int64_t>(get_interpolated_double_time());
 }
 
 
@@ -7,6 +7,7 @@
 #include <dirent.h>
 #include <errno.h>
 #include <libgen.h>
+#include <sys/mman.h>
 #include <sys/utsname.h>
 #include <unistd.h>
 
@@ -16,8 +17,10 @@
 
 #include "runtime/critical_section.h"
 #include "runtime/interface.h"
+#include "runtime/resumable.h"
 #include "runtime/streams.h"
 #include "runtime/string_functions.h"//php_buf, TODO
+#include "server/file-io-pool.h"
 
 static int32_t opened_fd{-1};
 
@@ -806,6 +809,95 @@ static bool file_fclose(const Stream &stream) {
 }
 
 
+//files at least this large are mmap'd read-only instead of being copied into script
+//memory: the bytes are exposed as a shared const string and the mapping is cached
+//across requests keyed by (path, mtime), so repeated reads of big static files
+//neither copy the data nor spike the script memory usage
+static const size_t MMAP_FILE_CONTENTS_MIN_SIZE = 1 << 20;
+static const int MAPPED_FILES_MAX = 16;
+
+struct mapped_file_entry {
+  char *path;
+  time_t mtime;
+  size_t size;
+  char *data;//the file bytes, the string header lies in the page just before them
+  size_t region_len;
+};
+
+static mapped_file_entry mapped_files[MAPPED_FILES_MAX];
+
+//a stale mapping can't be munmap'd right away: strings returned earlier in this
+//request may still point into it, so it is kept until the request ends
+struct retired_file_mapping {
+  void *region;
+  size_t region_len;
+  retired_file_mapping *next;
+};
+static retired_file_mapping *retired_file_mappings;
+
+//must be called under the critical section
+static void retire_file_mapping(mapped_file_entry &entry) {
+  auto *retired = static_cast<retired_file_mapping *>(malloc(sizeof(retired_file_mapping)));
+  retired->region = entry.data - sysconf(_SC_PAGESIZE);
+  retired->region_len = entry.region_len;
+  retired->next = retired_file_mappings;
+  retired_file_mappings = retired;
+
+  free(entry.path);
+  entry.path = nullptr;
+}
+
+//must be called under the critical section; maps the file read-only with a writable
+//anonymous page before it for the string header and zero pages after it providing
+//the terminating '\0', returns a pointer to the file bytes
+static char *map_file_contents(int file_fd, size_t size, size_t &region_len) {
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  region_len = page_size + (size + page_size) / page_size * page_size;
+
+  char *region = static_cast<char *>(mmap(nullptr, region_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (region == MAP_FAILED) {
+    return nullptr;
+  }
+  if (mmap(region + page_size, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, file_fd, 0) == MAP_FAILED) {
+    munmap(region, region_len);
+    return nullptr;
+  }
+  return region + page_size;
+}
+
+//must be called under the critical section
+static bool get_mapped_file_contents(const char *path, int file_fd, const struct stat &stat_buf, string &contents) {
+  const size_t size = stat_buf.st_size;
+  mapped_file_entry &entry = mapped_files[static_cast<uint64_t>(string_hash(path, strlen(path))) % MAPPED_FILES_MAX];
+
+  if (entry.path != nullptr && (strcmp(entry.path, path) != 0 || entry.mtime != stat_buf.st_mtime || entry.size != size)) {
+    retire_file_mapping(entry);
+  }
+
+  if (entry.path == nullptr) {
+    size_t region_len = 0;
+    char *data = map_file_contents(file_fd, size, region_len);
+    if (data == nullptr) {
+      return false;
+    }
+    if (data[size] != '\0') {
+      //the file grew between the caller's fstat and our mmap, so the byte past the
+      //expected end is file data instead of the guaranteed zero padding;
+      //drop the mapping and let the caller fall back to a plain read
+      munmap(data - sysconf(_SC_PAGESIZE), region_len);
+      return false;
+    }
+    entry.path = strdup(path);
+    entry.mtime = stat_buf.st_mtime;
+    entry.size = size;
+    entry.data = data;
+    entry.region_len = region_len;
+  }
+
+  contents = string::make_const_string_on_mapped_memory(entry.data, static_cast<string::size_type>(size));
+  return true;
+}
+
 Optional<string> file_file_get_contents(const string &name) {
   auto offset = file_wrapper_name.size();
   if (strncmp(name.c_str(), file_wrapper_name.c_str(), offset)) {
@@ -839,6 +931,16 @@ Optional<string> file_file_get_contents(const string &name) {
     dl::leave_critical_section();
     return false;
   }
+
+  if (size >= MMAP_FILE_CONTENTS_MIN_SIZE) {
+    string mapped_contents;
+    if (get_mapped_file_contents(name.c_str() + offset, file_fd, stat_buf, mapped_contents)) {
+      close_safe(file_fd);
+      dl::leave_critical_section();
+      return mapped_contents;
+    }
+    //on mapping failure fall back to a plain read
+  }
   dl::leave_critical_section();
 
   string res(static_cast<string::size_type>(size), false);
@@ -855,6 +957,81 @@ Optional<string> file_file_get_contents(const string &name) {
   return res;
 }
 
+class file_io_resumable : public Resumable {
+  using ReturnT = Optional<string>;
+
+public:
+  file_io_job *answer{nullptr};
+
+protected:
+  bool run() {
+    php_assert (answer != nullptr);
+    Optional<string> result = false;
+    if (answer->data_len >= 0) {
+      if (answer->data_len > string::max_size()) {
+        php_warning("File \"%s\" is too large to get its content", answer->filename);
+      } else {
+        result = string(answer->data, static_cast<string::size_type>(answer->data_len));
+      }
+    } else if (answer->error_code == EINVAL) {
+      php_warning("Regular file expected as first argument in function file_get_contents_async, \"%s\" is given", answer->filename);
+    }
+    dl::enter_critical_section();//OK
+    file_io_job_free(answer);
+    dl::leave_critical_section();
+    answer = nullptr;
+    output_->save<Optional<string>>(result);
+    return true;
+  }
+};
+
+int64_t f$file_get_contents_async(const string &name) {
+  auto offset = file_wrapper_name.size();
+  if (strncmp(name.c_str(), file_wrapper_name.c_str(), offset)) {
+    offset = 0;
+  }
+
+  auto *resumable = new file_io_resumable();
+  const int64_t resumable_id = register_forked_resumable(resumable);
+
+  dl::enter_critical_section();//OK
+  file_io_job *job = file_io_job_create(name.c_str() + offset);
+  dl::leave_critical_section();
+  if (job == nullptr) {
+    php_critical_error ("not enough memory for a file io job");
+  }
+  job->resumable_id = resumable_id;
+
+  bool offloaded = false;
+  if (file_io_pool_size > 0) {
+    const slot_id_t slot_id = create_slot();
+    if (slot_id > 0) {
+      job->slot_id = slot_id;
+      dl::enter_critical_section();//OK
+      offloaded = file_io_pool_submit(job);
+      dl::leave_critical_section();
+    }
+  }
+  if (!offloaded) {
+    // no pool: do the blocking read right here and finish the future at once
+    dl::enter_critical_section();//OK
+    file_io_job_perform(job);
+    dl::leave_critical_section();
+    resumable->answer = job;
+    resumable_run_ready(resumable_id);
+  }
+  return resumable_id;
+}
+
+void process_file_io_answer(int32_t slot_id __attribute__((unused)), file_io_job *job) {
+  const int64_t resumable_id = job->resumable_id;
+  php_assert (resumable_id > 0);
+  auto *resumable = static_cast<file_io_resumable *>(get_forked_resumable(resumable_id));
+  php_assert (resumable != nullptr);
+  resumable->answer = job;
+  resumable_run_ready(resumable_id);
+}
+
 static Optional<int64_t> file_file_put_contents(const string &name, const string &content, int64_t flags) {
   auto offset = file_wrapper_name.size();
   if (strncmp(name.c_str(), file_wrapper_name.c_str(), offset)) {
@@ -924,6 +1101,13 @@ void free_files_lib() {
     close_safe(opened_fd);
   }
   opened_fd = -1;
+
+  while (retired_file_mappings != nullptr) {
+    retired_file_mapping *next = retired_file_mappings->next;
+    munmap(retired_file_mappings->region, retired_file_mappings->region_len);
+    free(retired_file_mappings);
+    retired_file_mappings = next;
+  }
   dl::leave_critical_section();
 }
 
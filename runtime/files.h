@@ -68,6 +68,15 @@ Optional<array<string>> f$scandir(const string &directory);
 
 Optional<string> file_file_get_contents(const string &name);
 
+struct file_io_job;
+
+// reads the file on the I/O offload pool (see server/file-io-pool.h) and
+// returns a future the caller waits on like a fork; with the pool disabled the
+// read happens synchronously and the future is already finished
+int64_t f$file_get_contents_async(const string &name);
+
+void process_file_io_answer(int32_t slot_id, file_io_job *job);
+
 
 void global_init_files_lib();
 
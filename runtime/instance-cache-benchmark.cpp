@@ -0,0 +1,222 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+// instance cache contention stress: forks worker processes that hammer
+// store/fetch/delete on a shared key space through the real inter-process
+// machinery (shared memory allocator, storage mutexes, element refcounting),
+// while the parent plays the master and purges expired elements in parallel.
+// Reports aggregate throughput, the worst per-process p99 latency and the
+// shared memory allocator/eviction state after each episode.
+//
+// Build with -DKPHP_BENCHMARKS=On, run e.g.:
+//   benchmark-instance-cache --benchmark_counters_tabular=true
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "runtime/instance_cache.h"
+#include "runtime/interface.h"
+#include "runtime/kphp_core.h"
+#include "runtime/storage.h"
+#include "runtime/tl/rpc_response.h"
+#include "server/php-engine-vars.h"
+
+namespace {
+
+constexpr int MAX_BENCH_PROCESSES = 16;
+constexpr int OPS_PER_PROCESS = 20000;
+// worker processes reset the whole script environment between "requests",
+// so request local caches behave as they do in production
+constexpr int OPS_PER_REQUEST = 256;
+constexpr int KEY_SPACE_SIZE = 512;
+
+// op mix out of 100: the rest are deletes
+constexpr int FETCH_OPS_SHARE = 80;
+constexpr int STORE_OPS_SHARE = 15;
+
+struct WorkerResult {
+  uint64_t ops{0};
+  uint64_t p99_ns{0};
+};
+
+// each process needs its own script memory; the buffer is in bss and
+// becomes private to every child on fork
+std::array<uint8_t, 16 * 1024 * 1024> script_memory;
+
+string make_bench_key(std::mt19937 &gen) {
+  char buffer[64];
+  const int len = snprintf(buffer, sizeof(buffer), "instance_cache_bench_%d", static_cast<int>(gen() % KEY_SPACE_SIZE));
+  return {buffer, static_cast<string::size_type>(len)};
+}
+
+void run_worker(int worker_index, size_t blob_size, int pipe_fd) {
+  pid = getpid();
+  logname_id = worker_index;
+
+  std::mt19937 gen{std::random_device{}() + static_cast<uint32_t>(worker_index)};
+  std::vector<uint64_t> latencies;
+  latencies.reserve(OPS_PER_PROCESS);
+
+  init_runtime_environment(nullptr, script_memory.data(), script_memory.size());
+  for (int op = 0; op < OPS_PER_PROCESS; ++op) {
+    if (op && op % OPS_PER_REQUEST == 0) {
+      free_runtime_environment();
+      init_runtime_environment(nullptr, script_memory.data(), script_memory.size());
+    }
+    const string key = make_bench_key(gen);
+    const int op_choice = static_cast<int>(gen() % 100);
+    // short ttls for a part of the stores keep the expiration and purge paths busy
+    const int64_t ttl = gen() % 4 ? 0 : 1;
+
+    const auto started_at = std::chrono::steady_clock::now();
+    if (op_choice < FETCH_OPS_SHARE) {
+      benchmark::DoNotOptimize(f$instance_cache_fetch_blob(key));
+    } else if (op_choice < FETCH_OPS_SHARE + STORE_OPS_SHARE) {
+      benchmark::DoNotOptimize(f$instance_cache_store_blob(key, string(static_cast<string::size_type>(blob_size), 'b'), ttl));
+    } else {
+      benchmark::DoNotOptimize(f$instance_cache_delete(key));
+    }
+    latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started_at).count());
+  }
+  free_runtime_environment();
+
+  std::sort(latencies.begin(), latencies.end());
+  WorkerResult result;
+  result.ops = latencies.size();
+  result.p99_ns = latencies[latencies.size() * 99 / 100];
+  const ssize_t written = write(pipe_fd, &result, sizeof(result));
+  assert(written == sizeof(result));
+  close(pipe_fd);
+  _exit(0);
+}
+
+void BM_instance_cache_contention(benchmark::State &state) {
+  const int processes = static_cast<int>(state.range(0));
+  const size_t blob_size = static_cast<size_t>(state.range(1));
+
+  const auto &stats = instance_cache_get_stats();
+  const uint64_t expired_before = stats.elements_expired.load(std::memory_order_relaxed);
+  const uint64_t destroyed_before = stats.elements_destroyed.load(std::memory_order_relaxed);
+  uint64_t total_ops = 0;
+  uint64_t worst_p99_ns = 0;
+
+  for (auto _ : state) {
+    std::array<int, MAX_BENCH_PROCESSES> read_fds;
+    std::array<pid_t, MAX_BENCH_PROCESSES> workers;
+
+    const auto episode_started_at = std::chrono::steady_clock::now();
+    for (int i = 0; i < processes; ++i) {
+      int pipe_fds[2]{};
+      const int pipe_created = pipe(pipe_fds);
+      assert(!pipe_created);
+      read_fds[i] = pipe_fds[0];
+      workers[i] = fork();
+      assert(workers[i] >= 0);
+      if (!workers[i]) {
+        close(pipe_fds[0]);
+        run_worker(i, blob_size, pipe_fds[1]);
+      }
+      close(pipe_fds[1]);
+    }
+
+    // the parent plays the master: purge expired elements while the workers run,
+    // the same work the real master does from its cron
+    for (int alive = processes; alive > 0;) {
+      instance_cache_purge_expired_elements();
+      int status = 0;
+      if (waitpid(-1, &status, WNOHANG) > 0) {
+        --alive;
+        continue;
+      }
+      usleep(1000);
+    }
+
+    for (int i = 0; i < processes; ++i) {
+      WorkerResult result;
+      const ssize_t read_bytes = read(read_fds[i], &result, sizeof(result));
+      assert(read_bytes == sizeof(result));
+      close(read_fds[i]);
+      total_ops += result.ops;
+      worst_p99_ns = std::max(worst_p99_ns, result.p99_ns);
+    }
+    state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - episode_started_at).count());
+  }
+
+  state.SetItemsProcessed(total_ops);
+  state.counters["p99_us"] = static_cast<double>(worst_p99_ns) / 1000.0;
+  state.counters["expired"] = static_cast<double>(stats.elements_expired.load(std::memory_order_relaxed) - expired_before);
+  state.counters["destroyed"] = static_cast<double>(stats.elements_destroyed.load(std::memory_order_relaxed) - destroyed_before);
+  state.counters["cached"] = static_cast<double>(stats.elements_cached.load(std::memory_order_relaxed));
+
+  const auto &memory_stats = instance_cache_get_memory_stats();
+  state.counters["mem_used"] = static_cast<double>(memory_stats.memory_used);
+  state.counters["real_mem_used"] = static_cast<double>(memory_stats.real_memory_used);
+  state.counters["defragmentations"] = static_cast<double>(memory_stats.defragmentation_calls);
+}
+
+} // namespace
+
+BENCHMARK(BM_instance_cache_contention)
+  ->ArgNames({"processes", "blob_size"})
+  ->ArgsProduct({{1, 2, 4, 8, 16}, {64, 4096, 262144}})
+  ->UseManualTime()
+  ->Unit(benchmark::kMillisecond);
+
+// linkage stubs: the full runtime expects these symbols from the generated code,
+// same set as in tests/cpp/runtime/_runtime-tests-env.cpp
+template<> int Storage::tagger<bool>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<int64_t>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<Optional<int64_t>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<void>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<thrown_exception>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<mixed>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<array<mixed>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<Optional<string>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<Optional<array<mixed>>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<array<array<mixed>>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<class_instance<C$VK$TL$RpcResponse>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<array<class_instance<C$VK$TL$RpcResponse>>>::get_tag() noexcept { return 0; }
+template<> Storage::loader<mixed>::loader_fun Storage::loader<mixed>::get_function(int) noexcept { return nullptr; }
+
+void init_php_scripts() noexcept {
+  assert(0 && "this code shouldn't be executed and only for linkage");
+}
+void global_init_php_scripts() noexcept {
+  assert(0 && "this code shouldn't be executed and only for linkage");
+}
+const char *get_php_scripts_version() noexcept {
+  assert(0 && "this code shouldn't be executed and only for linkage");
+}
+
+char **get_runtime_options(int *) noexcept {
+  assert(0 && "this code shouldn't be executed and only for linkage");
+  return nullptr;
+}
+
+int main(int argc, char **argv) {
+  pid = getpid();
+  logname_id = 0;
+  workers_n = MAX_BENCH_PROCESSES;
+
+  php_disable_warnings = true;
+  php_warning_level = 0;
+
+  // the shared memory and its control structures are created once in the parent,
+  // the forked workers inherit them the same way the real workers do
+  global_init_runtime_libs();
+  global_init_script_allocator();
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -18,8 +18,19 @@ public:
     return std::move(result_);
   }
 
+  // the visitor starts in a counting pass: the first accept() only counts the top level fields,
+  // so that the result can be preallocated to its exact final size before the filling accept()
+  void prepare_result() {
+    result_.reserve(0, fields_count_, false);
+    counting_pass_ = false;
+  }
+
   template<typename T>
   void operator()(const char *field_name, const T &value) {
+    if (counting_pass_) {
+      ++fields_count_;
+      return;
+    }
     process_impl(field_name, value);
   }
 
@@ -96,6 +107,8 @@ private:
 
 private:
   array<mixed> result_;
+  bool counting_pass_{true};
+  int64_t fields_count_{0};
 };
 
 template<class T>
@@ -109,6 +122,8 @@ std::enable_if_t<!std::is_empty<T>{}, array<mixed>> f$instance_to_array(const cl
     return {};
   }
   InstanceToArrayVisitor visitor;
-  c.get()->accept(visitor);
+  c.get()->accept(visitor);   // counting pass, does no work per field
+  visitor.prepare_result();
+  c.get()->accept(visitor);   // filling pass into the exact-size result
   return visitor.flush_result();
 }
@@ -8,7 +8,11 @@
 #include <forward_list>
 #include <map>
 #include <mutex>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include <unordered_set>
+#include <vector>
 
 #include "common/kprintf.h"
 
@@ -19,6 +23,8 @@
 #include "runtime/memory_resource/resource_allocator.h"
 #include "runtime/refcountable_php_classes.h"
 
+const char *get_php_scripts_version() noexcept;
+
 namespace ic_impl_ {
 
 //#define DEBUG_INSTANCE_CACHE
@@ -47,6 +53,10 @@ static constexpr std::chrono::minutes PHYSICAL_REMOVING_DELAY{1};
 static constexpr size_t DATA_SHARDS_COUNT{997u};
 // The buckets check step during the cache cleanup
 static constexpr size_t SHARDS_PURGE_PERIOD{5u};
+// An upper bound of elements unlinked during one purge tick; together with unlinking
+// and destroying in separate phases it keeps the per shard lock hold times bounded,
+// so fetch latency does not depend on the amount of expired garbage
+static constexpr size_t PURGE_MAX_UNLINKED_ELEMENTS_PER_TICK{256u};
 
 class ElementHolder;
 
@@ -144,6 +154,16 @@ struct SharedDataStorages : private vk::not_copyable {
   inter_process_mutex storage_mutex;
   ElementStorage_ storage;
   std::atomic<bool> is_storage_empty{true};
+  // a lower bound of expiring_at over the stored elements, maintained on every expiry change
+  // under the storage_mutex; lets purge_expired() skip the shard without scanning it
+  std::atomic<std::chrono::nanoseconds::rep> earliest_expiring_at{std::chrono::nanoseconds::max().count()};
+
+  // should be called under the storage_mutex
+  void note_expiring_at(std::chrono::nanoseconds expiring_at) noexcept {
+    if (expiring_at.count() < earliest_expiring_at.load(std::memory_order_relaxed)) {
+      earliest_expiring_at.store(expiring_at.count(), std::memory_order_relaxed);
+    }
+  }
 };
 
 void CacheContext::move_to_garbage(ElementHolder *element) noexcept {
@@ -165,6 +185,27 @@ void CacheContext::clear_garbage() noexcept {
   }
 }
 
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+// the region is backed by a memfd when the kernel supports it, so the master can hand
+// it to the next master generation on a binary upgrade (see server/php-master.cpp);
+// without memfd the cache works exactly as before, it just can't survive an upgrade
+static int create_shared_memory_fd(size_t size) noexcept {
+#ifdef SYS_memfd_create
+  const int fd = static_cast<int>(syscall(SYS_memfd_create, "kphp_instance_cache", MFD_CLOEXEC));
+  if (fd >= 0 && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+#else
+  static_cast<void>(size);
+  return -1;
+#endif
+}
+
 class SharedMemoryData : vk::not_copyable {
 public:
   void init(size_t pool_size) noexcept {
@@ -173,11 +214,58 @@ public:
     php_assert(!shared_memory_);
     shared_memory_pool_size_ = pool_size;
     share_memory_full_size_ = get_context_size() + get_data_size() + shared_memory_pool_size_;
-    shared_memory_ = mmap(nullptr, share_memory_full_size_, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_SHARED, -1, 0);
-    php_assert(shared_memory_);
+    shm_fd_ = create_shared_memory_fd(share_memory_full_size_);
+    if (shm_fd_ >= 0) {
+      shared_memory_ = mmap(nullptr, share_memory_full_size_, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd_, 0);
+      if (shared_memory_ == MAP_FAILED) {
+        close(shm_fd_);
+        shm_fd_ = -1;
+        shared_memory_ = nullptr;
+      }
+    }
+    if (!shared_memory_) {
+      shared_memory_ = mmap(nullptr, share_memory_full_size_, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_SHARED, -1, 0);
+    }
+    php_assert(shared_memory_ && shared_memory_ != MAP_FAILED);
     construct_data_inplace();
   }
 
+  // binary-upgrade handoff: replace the freshly initialized region with the memfd-backed
+  // region inherited from the previous master; the pool keeps absolute pointers, so the
+  // inherited region is usable only when mapped at the exact same address, and the pool
+  // sizes must match since they define the region layout; on any mismatch nothing changes
+  bool adopt(int fd, size_t pool_size, void *base) noexcept {
+    php_assert(shared_memory_);
+    if (pool_size != shared_memory_pool_size_) {
+      return false;
+    }
+    void *mem = mmap(base, share_memory_full_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+      return false;
+    }
+    if (mem != base) {
+      munmap(mem, share_memory_full_size_);
+      return false;
+    }
+    destroy_data();
+    munmap(shared_memory_, share_memory_full_size_);
+    if (shm_fd_ >= 0) {
+      close(shm_fd_);
+    }
+    shared_memory_ = mem;
+    shm_fd_ = fd;
+    attach_data_inplace();
+    return true;
+  }
+
+  int get_shm_fd() const noexcept {
+    return shm_fd_;
+  }
+
+  void *get_shm_base() const noexcept {
+    return shared_memory_;
+  }
+
   void reset() noexcept {
     destroy_data();
     construct_data_inplace();
@@ -229,6 +317,13 @@ private:
     }
   }
 
+  // like construct_data_inplace(), but the region already holds the live data of the
+  // previous master generation, so only the pointers are rebound
+  void attach_data_inplace() noexcept {
+    cache_context_ = static_cast<CacheContext *>(shared_memory_);
+    data_shards_ = reinterpret_cast<SharedDataStorages *>(static_cast<uint8_t *>(shared_memory_) + get_context_size());
+  }
+
   static constexpr size_t get_context_size() noexcept {
     return (sizeof(CacheContext) + 7) & -8;
   }
@@ -240,6 +335,7 @@ private:
   void *shared_memory_{nullptr};
   size_t share_memory_full_size_{0};
   size_t shared_memory_pool_size_{0};
+  int shm_fd_{-1};
   CacheContext *cache_context_{nullptr};
   SharedDataStorages *data_shards_{nullptr};
 };
@@ -340,6 +436,18 @@ public:
 
   const InstanceWrapperBase *fetch(const string &key, bool even_if_expired) {
     php_assert(current_ && context_);
+    // repeated fetches of the same key within one request are common, so serve them
+    // from the request cache without touching sync_delayed() or any locks;
+    // this shortcut is valid only while there are no pending delayed stores:
+    // a delayed store may supersede the element the request cache points at
+    if (storing_delayed_.empty()) {
+      // request_cache_ uses a script memory
+      if (const ElementHolder *const *cached_element_ptr = request_cache_.find_value(key)) {
+        ic_debug("fetch '%s' from request cache\n", key.c_str());
+        context_->stats.elements_fetched_from_request_cache.fetch_add(1, std::memory_order_relaxed);
+        return (*cached_element_ptr)->instance_wrapper.get();
+      }
+    }
     sync_delayed();
     // storing_delayed_ uses a script memory
     if (const auto *delayed_instance = storing_delayed_.find_value(key)) {
@@ -349,6 +457,7 @@ public:
     // request_cache_ uses a script memory
     if (const ElementHolder *const *cached_element_ptr = request_cache_.find_value(key)) {
       ic_debug("fetch '%s' from request cache\n", key.c_str());
+      context_->stats.elements_fetched_from_request_cache.fetch_add(1, std::memory_order_relaxed);
       return (*cached_element_ptr)->instance_wrapper.get();
     }
 
@@ -425,6 +534,7 @@ public:
     }
 
     it->second->update_time_points(now_, ttl);
+    data.note_expiring_at(it->second->expiring_at);
     return true;
   }
 
@@ -449,6 +559,7 @@ public:
     auto new_expiring_at = std::chrono::duration_cast<std::chrono::nanoseconds>(it->second->stored_at + new_element_ttl);
     new_expiring_at = std::min(new_expiring_at, now_ + DELETED_ELEMENT_LIFETIME_LIMIT);
     it->second->expiring_at = std::max(new_expiring_at, it->second->stored_at);
+    data.note_expiring_at(it->second->expiring_at);
     return true;
   }
 
@@ -468,39 +579,65 @@ public:
     // we need to explicitly activate and deactivate it
     auto shared_memory_guard = context.memory_replacement_guard(true);
 
+    // expired elements are only unlinked from the shard under its storage_mutex;
+    // their keys and bodies are destroyed after the mutex is released, so fetches
+    // from the shard resume while the master frees the memory. An element still
+    // referenced by a worker survives through its refcount until the worker drops
+    // the last reference and it reaches the garbage list (see move_to_garbage)
+    std::vector<string> unlinked_keys;
+    std::vector<vk::intrusive_ptr<ElementHolder>> unlinked_elements;
+
     auto *data_shards = current_data.get_data_shards();
     const size_t shards_count = current_data.get_data_shards_count();
-    for (size_t shard_id = purge_shard_offset_; shard_id < shards_count; shard_id += SHARDS_PURGE_PERIOD) {
+    size_t purge_budget = PURGE_MAX_UNLINKED_ELEMENTS_PER_TICK;
+    for (size_t shard_id = purge_shard_offset_; shard_id < shards_count && purge_budget; shard_id += SHARDS_PURGE_PERIOD) {
       auto &data_shard = data_shards[shard_id];
       if (data_shard.is_storage_empty.load(std::memory_order_relaxed)) {
         continue;
       }
-      {
-        std::lock_guard<inter_process_mutex> shared_data_lock{data_shard.storage_mutex};
-        if (std::none_of(data_shard.storage.begin(), data_shard.storage.end(),
-                         [now_with_delay](const auto &stored_element) {
-                           return stored_element.second->expiring_at <= now_with_delay;
-                         })) {
-          continue;
-        }
+      // the watermark is maintained on every expiry change, so the shard can be skipped
+      // without taking the storage_mutex and scanning all its elements
+      if (std::chrono::nanoseconds{data_shard.earliest_expiring_at.load(std::memory_order_relaxed)} > now_with_delay) {
+        continue;
       }
 
+      unlinked_keys.clear();
+      unlinked_elements.clear();
       // lock in this very order and do not move allocator_lock anywhere below, otherwise it will result in a deadlock!
       std::lock_guard<inter_process_mutex> allocator_lock{context.allocator_mutex};
-      std::lock_guard<inter_process_mutex> shared_data_lock{data_shard.storage_mutex};
+      std::unique_lock<inter_process_mutex> shared_data_lock{data_shard.storage_mutex};
+      auto earliest_left = std::chrono::nanoseconds::max();
+      bool scan_finished = true;
       for (auto it = data_shard.storage.begin(); it != data_shard.storage.end();) {
         if (it->second->expiring_at <= now_with_delay) {
           ic_debug("purge '%s'\n", it->first.c_str());
-          string removing_key = it->first;
+          unlinked_keys.emplace_back(it->first);
+          unlinked_elements.emplace_back(std::move(it->second));
           it = data_shard.storage.erase(it);
-          DeepDestroyFromCacheVisitor{}.process(removing_key);
           context.stats.elements_expired.fetch_add(1, std::memory_order_relaxed);
           context.stats.elements_cached.fetch_sub(1, std::memory_order_relaxed);
+          if (!--purge_budget) {
+            scan_finished = it == data_shard.storage.end();
+            break;
+          }
         } else {
+          earliest_left = std::min(earliest_left, it->second->expiring_at);
           ++it;
         }
       }
+      if (scan_finished) {
+        data_shard.earliest_expiring_at.store(earliest_left.count(), std::memory_order_relaxed);
+      }
+      // on an interrupted scan the watermark stays in the past and the next tick returns here
       data_shard.is_storage_empty.store(data_shard.storage.empty(), std::memory_order_relaxed);
+
+      // readers of this shard may proceed: destruction needs only the allocator
+      shared_data_lock.unlock();
+      for (auto &removed_key : unlinked_keys) {
+        DeepDestroyFromCacheVisitor{}.process(removed_key);
+      }
+      // dropping the last reference sends the element to the garbage list
+      unlinked_elements.clear();
     }
 
     purge_shard_offset_ = (purge_shard_offset_ + 1) % SHARDS_PURGE_PERIOD;
@@ -533,6 +670,33 @@ public:
     return last_memory_stats_;
   }
 
+  // this function should be called only from master
+  inter_process_mutex_stats get_mutex_stats() noexcept {
+    inter_process_mutex_stats stats;
+    auto &current_data = data_manager_.get_current_resource();
+    current_data.get_context().allocator_mutex.accumulate_stats_to(stats);
+    auto *data_shards = current_data.get_data_shards();
+    const size_t shards_count = current_data.get_data_shards_count();
+    for (size_t shard_id = 0; shard_id != shards_count; ++shard_id) {
+      data_shards[shard_id].storage_mutex.accumulate_stats_to(stats);
+    }
+    return stats;
+  }
+
+  // this function should be called only from master;
+  // handle of the active buffer for the binary-upgrade handoff, fd is -1 without memfd support
+  InstanceCacheSharedMemoryHandle get_shared_memory_handle() noexcept {
+    auto &current_data = data_manager_.get_current_resource();
+    return InstanceCacheSharedMemoryHandle{current_data.get_shm_fd(), instance_cache_settings.total_memory_limit, current_data.get_shm_base()};
+  }
+
+  // this function should be called only from master, strictly before the workers are forked;
+  // replaces the active buffer with the region inherited from the previous master generation
+  bool adopt_inherited_shared_memory(int fd, size_t pool_size, void *base) noexcept {
+    php_assert(!current_ && !context_);
+    return data_manager_.get_current_resource().adopt(fd, pool_size, base);
+  }
+
 private:
   bool is_element_insertion_can_be_skipped(SharedDataStorages &data, const string &key) const {
     std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
@@ -550,7 +714,7 @@ private:
 
   void sync_delayed() noexcept {
     php_assert(current_ && context_);
-    if (context_->memory_swap_required) {
+    if (storing_delayed_.empty() || context_->memory_swap_required) {
       return;
     }
 
@@ -627,6 +791,7 @@ private:
         // replace element and save previous element into used_elements_;
         // it'll make it possible to free it without taking a storage_mutex lock
         it->second.swap(element);
+        data.note_expiring_at(it->second->expiring_at);
         if (element) {
           // used_elements_ uses heap memory for its internal allocations
           used_elements_.emplace(std::move(element));
@@ -729,6 +894,32 @@ const InstanceWrapperBase *instance_cache_fetch_wrapper(const string &key, bool
   return InstanceCache::get().fetch(key, even_if_expired);
 }
 
+// bump on any runtime change that affects how cached data is laid out or looked up
+// without changing the struct sizes below — e.g. string_hash semantics, which decide
+// the shard and bucket placement of every adopted key
+constexpr uint64_t CACHE_LAYOUT_VERSION = 2;
+
+uint64_t shared_memory_layout_hash() noexcept {
+  // cached elements embed compiled-class layouts, so two binaries may share a region
+  // only when they were built from the same php code; the sizes of the shared runtime
+  // structures and a manually bumped layout version are mixed in to also reject
+  // changes on the runtime side of the layout
+  const char *version = get_php_scripts_version();
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  const auto mix = [&hash](uint64_t value) {
+    hash = (hash ^ value) * 0x100000001b3ULL;
+  };
+  while (*version) {
+    mix(static_cast<uint64_t>(*version++));
+  }
+  mix(sizeof(CacheContext));
+  mix(sizeof(SharedDataStorages));
+  mix(sizeof(ElementHolder));
+  mix(DATA_SHARDS_COUNT);
+  mix(CACHE_LAYOUT_VERSION);
+  return hash;
+}
+
 } // namespace ic_impl_
 
 void global_init_instance_cache_lib() {
@@ -763,6 +954,26 @@ const memory_resource::MemoryStats &instance_cache_get_memory_stats() {
   return ic_impl_::InstanceCache::get().get_last_memory_stats();
 }
 
+// should be called only from master
+inter_process_mutex_stats instance_cache_get_mutex_stats() {
+  return ic_impl_::InstanceCache::get().get_mutex_stats();
+}
+
+// should be called only from master
+InstanceCacheSharedMemoryHandle instance_cache_get_shared_memory_handle() {
+  return ic_impl_::InstanceCache::get().get_shared_memory_handle();
+}
+
+// should be called only from master
+uint64_t instance_cache_shared_memory_layout_hash() {
+  return ic_impl_::shared_memory_layout_hash();
+}
+
+// should be called only from master, strictly before the workers are forked
+bool instance_cache_adopt_inherited_shared_memory(int fd, size_t pool_size, void *base) {
+  return ic_impl_::InstanceCache::get().adopt_inherited_shared_memory(fd, pool_size, base);
+}
+
 // should be called only from master
 void instance_cache_purge_expired_elements() {
   ic_impl_::InstanceCache::get().purge_expired();
@@ -779,3 +990,18 @@ bool f$instance_cache_update_ttl(const string &key, int64_t ttl) {
 bool f$instance_cache_delete(const string &key) {
   return ic_impl_::InstanceCache::get().del(key);
 }
+
+bool f$instance_cache_store_blob(const string &key, const string &blob, int64_t ttl) {
+  ic_impl_::BlobWrapper blob_wrapper{blob};
+  return ic_impl_::instance_cache_store(key, blob_wrapper, ttl);
+}
+
+Optional<string> f$instance_cache_fetch_blob(const string &key, bool even_if_expired) {
+  if (const auto *base_wrapper = ic_impl_::instance_cache_fetch_wrapper(key, even_if_expired)) {
+    if (likely(typeid(*base_wrapper) == typeid(ic_impl_::BlobWrapper))) {
+      return static_cast<const ic_impl_::BlobWrapper *>(base_wrapper)->get_blob();
+    }
+    php_warning("Trying to fetch blob, but '%s' holds an instance of class '%s'", key.c_str(), base_wrapper->get_class());
+  }
+  return false;
+}
@@ -16,8 +16,11 @@
 //  6) All instances (with all members) are destroyed strictly before or after request,
 //    and shouldn't be destroyed while request.
 
+#include <typeinfo>
+
 #include "common/mixin/not_copyable.h"
 
+#include "runtime/inter-process-mutex.h"
 #include "runtime/kphp_core.h"
 #include "runtime/memory_resource/unsynchronized_pool_resource.h"
 #include "runtime/shape.h"
@@ -282,6 +285,54 @@ private:
   const bool deep_destroy_required_{false};
 };
 
+// shares one raw string (e.g. an instance_serialize or msgpack blob) between all workers;
+// unlike instances, fetch returns the cached string as is — its data stays in shared memory
+// with ExtraRefCnt::for_instance_cache and is pinned by the cache until the end of the request,
+// so identical large blobs are kept once per host instead of once per worker
+class BlobWrapper final : public InstanceWrapperBase {
+public:
+  explicit BlobWrapper(const string &blob, bool deep_destroy_required = false) noexcept:
+    blob_(blob),
+    deep_destroy_required_(deep_destroy_required) {
+  }
+
+  const char *get_class() const noexcept final {
+    return "instance_cache blob";
+  }
+
+  std::unique_ptr<InstanceWrapperBase> clone_and_detach_shared_ref(
+    DeepMoveFromScriptToCacheVisitor &detach_processor) const noexcept final {
+    auto detached_blob = blob_;
+    detach_processor.process(detached_blob);
+
+    constexpr auto size_for_wrapper = sizeof(size_t) + sizeof(BlobWrapper);
+    if (unlikely(!detach_processor.is_ok() ||
+                 !detach_processor.is_enough_memory_for(size_for_wrapper))) {
+      DeepDestroyFromCacheVisitor{}.process(detached_blob);
+      return {};
+    }
+    return make_unique_on_script_memory<BlobWrapper>(detached_blob, true);
+  }
+
+  std::unique_ptr<InstanceWrapperBase> clone_on_script_memory() const noexcept final {
+    return make_unique_on_script_memory<BlobWrapper>(blob_);
+  }
+
+  string get_blob() const noexcept {
+    return blob_;
+  }
+
+  ~BlobWrapper() noexcept final {
+    if (deep_destroy_required_) {
+      DeepDestroyFromCacheVisitor{}.process(blob_);
+    }
+  }
+
+private:
+  string blob_;
+  const bool deep_destroy_required_{false};
+};
+
 bool instance_cache_store(const string &key, const InstanceWrapperBase &instance_wrapper, int64_t ttl);
 const InstanceWrapperBase *instance_cache_fetch_wrapper(const string &key, bool even_if_expired);
 
@@ -304,6 +355,7 @@ struct InstanceCacheStats : private vk::not_copyable {
   std::atomic<uint64_t> elements_storing_delayed_due_mutex{0};
 
   std::atomic<uint64_t> elements_fetched{0};
+  std::atomic<uint64_t> elements_fetched_from_request_cache{0};
   std::atomic<uint64_t> elements_missed{0};
   std::atomic<uint64_t> elements_missed_earlier{0};
 
@@ -326,9 +378,28 @@ InstanceCacheSwapStatus instance_cache_try_swap_memory();
 const InstanceCacheStats &instance_cache_get_stats();
 // these function should be called from master
 const memory_resource::MemoryStats &instance_cache_get_memory_stats();
+// these function should be called from master;
+// aggregates the allocator lock and all shard storage locks of the active buffer
+inter_process_mutex_stats instance_cache_get_mutex_stats();
 // these function should be called from master
 void instance_cache_purge_expired_elements();
 
+// the binary-upgrade handoff between master generations, see server/php-master.cpp;
+// the active buffer is backed by a memfd which the old master sends to the new one
+// together with the mapping address and a layout hash; the new master adopts the region
+// only when everything matches, otherwise it starts with a cold cache
+struct InstanceCacheSharedMemoryHandle {
+  int fd{-1}; // -1 when the kernel has no memfd support
+  size_t pool_size{0};
+  void *base{nullptr};
+};
+// these function should be called from master
+InstanceCacheSharedMemoryHandle instance_cache_get_shared_memory_handle();
+// these function should be called from master
+uint64_t instance_cache_shared_memory_layout_hash();
+// these function should be called from master, strictly before the workers are forked
+bool instance_cache_adopt_inherited_shared_memory(int fd, size_t pool_size, void *base);
+
 void instance_cache_release_all_resources_acquired_by_this_proc();
 
 template<typename ClassInstanceType>
@@ -346,8 +417,11 @@ ClassInstanceType f$instance_cache_fetch(const string &class_name, const string
   static_assert(is_class_instance<ClassInstanceType>::value, "class_instance<> type expected");
   if (const auto *base_wrapper = ic_impl_::instance_cache_fetch_wrapper(key, even_if_expired)) {
     // do not use first parameter (class name) for verifying type,
-    // because different classes from separated libs may have same names
-    if (auto wrapper = dynamic_cast<const ic_impl_::InstanceWrapper<ClassInstanceType> *>(base_wrapper)) {
+    // because different classes from separated libs may have same names;
+    // InstanceWrapper is final, so an exact typeid match is enough and is cheaper
+    // than a dynamic_cast on this 50k+/sec path
+    if (likely(typeid(*base_wrapper) == typeid(ic_impl_::InstanceWrapper<ClassInstanceType>))) {
+      auto wrapper = static_cast<const ic_impl_::InstanceWrapper<ClassInstanceType> *>(base_wrapper);
       auto result = wrapper->get_instance();
       php_assert(!result.is_null());
       return result;
@@ -361,3 +435,8 @@ ClassInstanceType f$instance_cache_fetch(const string &class_name, const string
 
 bool f$instance_cache_update_ttl(const string &key, int64_t ttl = 0);
 bool f$instance_cache_delete(const string &key);
+
+// blob flavour of store/fetch: caches one string shared between all workers,
+// fetch returns a zero-copy view of the shared data (see ic_impl_::BlobWrapper)
+bool f$instance_cache_store_blob(const string &key, const string &blob, int64_t ttl = 0);
+Optional<string> f$instance_cache_fetch_blob(const string &key, bool even_if_expired = false);
@@ -5,6 +5,7 @@
 #include "runtime/inter-process-mutex.h"
 
 #include <cerrno>
+#include <chrono>
 #include <cstring>
 #include <linux/futex.h>
 #include <syscall.h>
@@ -13,6 +14,31 @@
 #include "runtime/php_assert.h"
 #include "server/php-engine-vars.h"
 
+namespace {
+
+// hold times are sampled on every 64th acquisition: one clock call per sample
+// keeps the cost invisible even on the allocator lock
+constexpr uint64_t HOLD_TIME_SAMPLE_PERIOD = 64;
+
+uint64_t monotonic_now_ns() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+size_t hold_time_bucket(uint64_t hold_ns) noexcept {
+  if (hold_ns < 10 * 1000) {
+    return 0;
+  }
+  if (hold_ns < 100 * 1000) {
+    return 1;
+  }
+  if (hold_ns < 1000 * 1000) {
+    return 2;
+  }
+  return 3;
+}
+
+} // namespace
+
 pid_t get_main_thread_id() noexcept {
   return pid;
 }
@@ -39,6 +65,14 @@ void handle_lock_error(pid_t *lock, const char *what) noexcept {
   }
 }
 
+void inter_process_mutex::on_acquired(bool contended) noexcept {
+  const uint64_t acquisitions = acquisitions_.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (contended) {
+    contended_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+  }
+  sampled_hold_started_at_ = acquisitions % HOLD_TIME_SAMPLE_PERIOD == 0 ? monotonic_now_ns() : 0;
+}
+
 void inter_process_mutex::lock() noexcept {
   dl::enter_critical_section();
   const pid_t tid = get_main_thread_id();
@@ -53,20 +87,27 @@ void inter_process_mutex::lock() noexcept {
         check_that_tid_and_cached_pid_same();
         tid_checked = true;
       }
+      futex_waits_.fetch_add(1, std::memory_order_relaxed);
       if (!futex(&lock_, FUTEX_LOCK_PI)) {
+        on_acquired(true);
         return;
       } else {
         handle_lock_error(&lock_, "lock");
       }
     } else if (counter % trylock_period == 0) {
       if (!futex(&lock_, FUTEX_TRYLOCK_PI)) {
+        on_acquired(true);
         return;
       } else {
         handle_lock_error(&lock_, "try lock");
       }
     }
-    __sync_synchronize();
+    // a pause in the spin window instead of a full barrier:
+    // the CAS above is already a full barrier and the pause frees the core
+    // for the hyperthread that may be the current owner
+    __builtin_ia32_pause();
   }
+  on_acquired(counter != 0);
 }
 
 bool inter_process_mutex::try_lock() noexcept {
@@ -76,6 +117,7 @@ bool inter_process_mutex::try_lock() noexcept {
   for (size_t attempts = 0; attempts != 2; ++attempts) {
     if (__sync_bool_compare_and_swap(&lock_, 0, tid) ||
         !futex(&lock_, FUTEX_TRYLOCK_PI)) {
+      on_acquired(attempts != 0);
       return true;
     }
     handle_lock_error(&lock_, "try lock");
@@ -85,6 +127,10 @@ bool inter_process_mutex::try_lock() noexcept {
 }
 
 void inter_process_mutex::unlock() noexcept {
+  if (sampled_hold_started_at_) {
+    sampled_hold_time_buckets_[hold_time_bucket(monotonic_now_ns() - sampled_hold_started_at_)].fetch_add(1, std::memory_order_relaxed);
+    sampled_hold_started_at_ = 0;
+  }
   const pid_t tid = get_main_thread_id();
   if (!__sync_bool_compare_and_swap(&lock_, tid, 0)) {
     if (futex(&lock_, FUTEX_UNLOCK_PI)) {
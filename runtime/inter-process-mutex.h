@@ -3,17 +3,52 @@
 // Distributed under the GPL v3 License, see LICENSE.notice.txt
 
 #pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <sys/types.h>
 
 #include "common/mixin/not_copyable.h"
 #include "common/cacheline.h"
 
+// contention counters of one lock; the hold time buckets are sampled
+// (every 64th acquisition), not exhaustive
+struct inter_process_mutex_stats {
+  uint64_t acquisitions{0};
+  uint64_t contended_acquisitions{0};
+  uint64_t futex_waits{0};
+  // <10us, <100us, <1ms, >=1ms
+  std::array<uint64_t, 4> sampled_hold_time_buckets{{0, 0, 0, 0}};
+};
+
 class inter_process_mutex : vk::not_copyable {
 public:
   void lock() noexcept;
   bool try_lock() noexcept;
   void unlock() noexcept;
 
+  // the lock lives in shared memory, so the counters aggregate all processes;
+  // reading them without taking the lock gives a slightly torn but usable picture
+  void accumulate_stats_to(inter_process_mutex_stats &stats) const noexcept {
+    stats.acquisitions += acquisitions_.load(std::memory_order_relaxed);
+    stats.contended_acquisitions += contended_acquisitions_.load(std::memory_order_relaxed);
+    stats.futex_waits += futex_waits_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i != stats.sampled_hold_time_buckets.size(); ++i) {
+      stats.sampled_hold_time_buckets[i] += sampled_hold_time_buckets_[i].load(std::memory_order_relaxed);
+    }
+  }
+
 private:
+  void on_acquired(bool contended) noexcept;
+
   alignas(KDB_CACHELINE_SIZE) pid_t lock_{0};
+
+  // the counters are kept off the futex cacheline so the stats traffic
+  // doesn't interfere with the lock word itself
+  alignas(KDB_CACHELINE_SIZE) std::atomic<uint64_t> acquisitions_{0};
+  std::atomic<uint64_t> contended_acquisitions_{0};
+  std::atomic<uint64_t> futex_waits_{0};
+  std::array<std::atomic<uint64_t>, 4> sampled_hold_time_buckets_{};
+  // written only by the current owner, so a plain field is enough
+  uint64_t sampled_hold_started_at_{0};
 };
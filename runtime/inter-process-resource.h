@@ -4,13 +4,11 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <bitset>
 #include <cstring>
 #include <sys/mman.h>
 
-#include "common/parallel/lock_accessible.h"
-
-#include "runtime/inter-process-mutex.h"
 #include "runtime/php_assert.h"
 #include "server/php-engine-vars.h"
 
@@ -21,49 +19,60 @@ public:
 
   InterProcessResourceControl() {
     for (auto &pids: acquired_pids_) {
-      pids.fill(0);
+      for (auto &stored_pid: pids) {
+        stored_pid.store(0, std::memory_order_relaxed);
+      }
     }
   }
 
+  // hazard-pointer style pin: publish the pid into the slot of the resource we are
+  // about to use, then make sure the master has not switched the active resource away
+  // in between; every slot has a single writer, so no lock is taken on the reader side
   uint32_t acquire_active_resource_id() noexcept {
-    const uint32_t resource_id = get_active_resource_id();
-    acquired_pids_[resource_id][get_user_index()] = pid;
-    return resource_id;
+    const size_t user_index = get_user_index();
+    for (;;) {
+      const uint32_t resource_id = active_resource_id_.load(std::memory_order_seq_cst);
+      acquired_pids_[resource_id][user_index].store(pid, std::memory_order_seq_cst);
+      if (likely(active_resource_id_.load(std::memory_order_seq_cst) == resource_id)) {
+        return resource_id;
+      }
+      acquired_pids_[resource_id][user_index].store(0, std::memory_order_seq_cst);
+    }
   }
 
   void release(uint32_t resource_id) noexcept {
     php_assert(resource_id < RESOURCE_AMOUNT);
-    pid_t &stored_pid = acquired_pids_[resource_id][get_user_index()];
-    php_assert(stored_pid == pid);
-    stored_pid = 0;
+    auto &stored_pid = acquired_pids_[resource_id][get_user_index()];
+    php_assert(stored_pid.load(std::memory_order_relaxed) == pid);
+    stored_pid.store(0, std::memory_order_release);
   }
 
   void force_release_all_resources() noexcept {
     const auto user_index = get_user_index();
     for (size_t resource_id = 0; resource_id != RESOURCE_AMOUNT; ++resource_id) {
-      acquired_pids_[resource_id][user_index] = 0;
+      acquired_pids_[resource_id][user_index].store(0, std::memory_order_release);
     }
   }
 
   uint32_t get_active_resource_id() const noexcept {
-    return active_resource_id_;
+    return active_resource_id_.load(std::memory_order_acquire);
   }
 
   uint32_t get_next_inactive_resource_id() const noexcept {
-    return (active_resource_id_ + 1) % RESOURCE_AMOUNT;
+    return (get_active_resource_id() + 1) % RESOURCE_AMOUNT;
   }
 
   bool is_resource_unused(uint32_t resource_id) noexcept {
     php_assert(resource_id < RESOURCE_AMOUNT);
-    constexpr static std::array<pid_t, MAX_WORKERS> zeros = {0};
     const int32_t total_server_workers = std::max(1, workers_n);
     const auto worker_pid_it = acquired_pids_[resource_id].begin();
-    return std::equal(worker_pid_it, worker_pid_it + total_server_workers, zeros.begin());
+    return std::all_of(worker_pid_it, worker_pid_it + total_server_workers,
+                       [](const std::atomic<pid_t> &stored_pid) { return stored_pid.load(std::memory_order_seq_cst) == 0; });
   }
 
   uint32_t switch_active_to_next() noexcept {
-    const uint32_t prev_active = active_resource_id_;
-    active_resource_id_ = get_next_inactive_resource_id();
+    const uint32_t prev_active = get_active_resource_id();
+    active_resource_id_.store((prev_active + 1) % RESOURCE_AMOUNT, std::memory_order_seq_cst);
     return prev_active;
   }
 
@@ -73,8 +82,8 @@ private:
     return static_cast<size_t>(logname_id);
   }
 
-  uint32_t active_resource_id_{0};
-  std::array<std::array<pid_t, MAX_WORKERS>, RESOURCE_AMOUNT> acquired_pids_;
+  std::atomic<uint32_t> active_resource_id_{0};
+  std::array<std::array<std::atomic<pid_t>, MAX_WORKERS>, RESOURCE_AMOUNT> acquired_pids_;
 };
 
 template<typename T, size_t RESOURCE_AMOUNT>
@@ -100,7 +109,7 @@ public:
 
   T *acquire_current_resource() noexcept {
     php_assert(control_block_);
-    const uint32_t resource_id = (*control_block_)->acquire_active_resource_id();
+    const uint32_t resource_id = control_block_->acquire_active_resource_id();
     return &switchable_resource_[resource_id];
   }
 
@@ -110,30 +119,29 @@ public:
                                  [data](const T &res) { return &res == data; });
     php_assert(it != switchable_resource_.end());
     const auto resource_id = static_cast<uint32_t>(it - switchable_resource_.begin());
-    (*control_block_)->release(resource_id);
+    control_block_->release(resource_id);
   }
 
   void force_release_all_resources() noexcept {
-    (*control_block_)->force_release_all_resources();
+    control_block_->force_release_all_resources();
   }
 
   // this function should be called only from master
   T &get_current_resource() noexcept {
     php_assert(is_initial_process());
     php_assert(control_block_);
-    return switchable_resource_[(*control_block_)->get_active_resource_id()];
+    return switchable_resource_[control_block_->get_active_resource_id()];
   }
 
   // this function should be called only from master
   bool is_next_resource_unused(uint32_t *inactive_resource_id_out = nullptr) noexcept {
     php_assert(is_initial_process());
     php_assert(control_block_);
-    auto locked_block = control_block_->acquire_lock();
-    const uint32_t inactive_resource_id = locked_block->get_next_inactive_resource_id();
+    const uint32_t inactive_resource_id = control_block_->get_next_inactive_resource_id();
     if (inactive_resource_id_out) {
       *inactive_resource_id_out = inactive_resource_id;
     }
-    return locked_block->is_resource_unused(inactive_resource_id);
+    return control_block_->is_resource_unused(inactive_resource_id);
   }
 
   // this function should be called only from master
@@ -143,7 +151,7 @@ public:
     uint32_t inactive_resource_id = 0;
     if (is_next_resource_unused(&inactive_resource_id)) {
       switchable_resource_[inactive_resource_id].reset(std::forward<Args>(args)...);
-      const uint32_t prev_active = (*control_block_)->switch_active_to_next();
+      const uint32_t prev_active = control_block_->switch_active_to_next();
       // previous become dirty
       dirty_inactive_resources_.set(prev_active);
       // new become not dirty
@@ -162,12 +170,12 @@ public:
 
     // resources are cleared strictly in the order they were marked as unused: starting with the oldest, etc.
     // if the oldest can't be cleared, the cleanup is stopped
-    const uint32_t current_resource_id = (*control_block_)->get_active_resource_id();
+    const uint32_t current_resource_id = control_block_->get_active_resource_id();
     for (uint32_t resource_id = (current_resource_id + 1) % RESOURCE_AMOUNT;
          resource_id != current_resource_id && dirty_inactive_resources_.any();
          resource_id = (resource_id + 1) % RESOURCE_AMOUNT) {
       if (dirty_inactive_resources_.test(resource_id)) {
-        if ((*control_block_)->is_resource_unused(resource_id)) {
+        if (control_block_->is_resource_unused(resource_id)) {
           switchable_resource_[resource_id].clear();
           dirty_inactive_resources_.reset(resource_id);
         } else {
@@ -184,7 +192,7 @@ public:
   void destroy() noexcept {
     php_assert(control_block_);
     php_assert(is_initial_process());
-    control_block_->~lock_accessible();
+    control_block_->~InterProcessResourceControl();
     munmap(control_block_, sizeof(*control_block_));
     control_block_ = nullptr;
 
@@ -203,5 +211,5 @@ private:
   std::bitset<RESOURCE_AMOUNT> dirty_inactive_resources_;
   const pid_t initiate_process_pid_{0};
   std::array<T, RESOURCE_AMOUNT> switchable_resource_;
-  vk::lock_accessible<InterProcessResourceControl<RESOURCE_AMOUNT>, inter_process_mutex> *control_block_{nullptr};
+  InterProcessResourceControl<RESOURCE_AMOUNT> *control_block_{nullptr};
 };
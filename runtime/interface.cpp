@@ -28,6 +28,8 @@
 #include "runtime/kphp-backtrace.h"
 #include "runtime/math_functions.h"
 #include "runtime/memcache.h"
+#include "runtime/memory_resource/memory_attribution.h"
+#include "runtime/misc.h"
 #include "runtime/mysql.h"
 #include "runtime/net_events.h"
 #include "runtime/on_kphp_warning_callback.h"
@@ -41,7 +43,6 @@
 #include "runtime/typed_rpc.h"
 #include "runtime/udp.h"
 #include "runtime/url.h"
-#include "runtime/zlib.h"
 #include "server/php-engine-vars.h"
 #include "server/php-queries.h"
 #include "server/php-query-data.h"
@@ -408,13 +409,22 @@ static inline const char *http_get_error_msg_text(int *code) {
   return "Extension Code";
 }
 
+// the engine compresses the body after the script has finished and appends
+// Content-Encoding and Content-Length to the header block itself
+static constexpr int CONTENT_LENGTH_SET_BY_ENGINE = -2;
+
 static const string_buffer *get_headers(int content_length) {//can't use static_SB, returns pointer to static_SB_spare
   string date = f$gmdate(HTTP_DATE);
   static_SB_spare.clean() << "Date: " << date;
   header(static_SB_spare.c_str(), (int)static_SB_spare.size());
 
-  if (!is_head_query) {
-    static_SB_spare.clean() << "Content-Length: " << content_length;
+  if (!is_head_query && content_length != CONTENT_LENGTH_SET_BY_ENGINE) {
+    if (content_length >= 0) {
+      static_SB_spare.clean() << "Content-Length: " << content_length;
+    } else {
+      // the response is streamed with flush(), its full length is unknown in advance
+      static_SB_spare.clean() << "Transfer-Encoding: chunked";
+    }
     header(static_SB_spare.c_str(), (int)static_SB_spare.size());
   }
 
@@ -444,6 +454,26 @@ char shutdown_function_storage[MAX_SHUTDOWN_FUNCTIONS * sizeof(shutdown_function
 shutdown_function_type *shutdown_functions = reinterpret_cast<shutdown_function_type *>(shutdown_function_storage);
 static bool finished;
 static bool flushed;
+static bool body_streamed;
+
+void f$flush() {
+  // stream everything printed so far to the http client as a chunked-encoding frame,
+  // the script keeps running; no-op for non-http queries, for HEAD queries
+  // and while a user-level output buffer is open
+  if (query_type != QUERY_TYPE_HTTP || flushed || is_head_query || ob_cur_buffer != 0) {
+    return;
+  }
+  const string_buffer *headers_sb = nullptr;
+  if (!body_streamed) {
+    body_streamed = true;
+    // compression works on the whole response, it can't be combined with incremental flushing
+    http_need_gzip = 0;
+    headers_sb = get_headers(-1);
+  }
+  http_send_chunk(headers_sb ? headers_sb->buffer() : nullptr, headers_sb ? headers_sb->size() : 0,
+                  coub->buffer(), coub->size(), 0);
+  coub->clean();
+}
 
 void f$fastcgi_finish_request(int64_t exit_code) {
   if (flushed) {
@@ -479,24 +509,26 @@ void f$fastcgi_finish_request(int64_t exit_code) {
       break;
     }
     case QUERY_TYPE_HTTP: {
-      const string_buffer *compressed;
+      if (body_streamed) {
+        // headers and earlier output are already on the wire, send the tail and the terminating chunk
+        http_send_chunk(nullptr, 0, oub[first_not_empty_buffer].buffer(), oub[first_not_empty_buffer].size(), 1);
+        http_set_result("", 0, "", 0, static_cast<int32_t>(exit_code), 0);
+        break;
+      }
+      // compression itself is deferred to the engine: it runs after the script
+      // has finished, so it burns neither script time nor script memory
+      int compression = 0;
       if (is_head_query) {
         oub[first_not_empty_buffer].clean();
-        compressed = &oub[first_not_empty_buffer];
-      } else {
-        if ((http_need_gzip & 5) == 5) {
-          header("Content-Encoding: gzip", 22, true);
-          compressed = zlib_encode(oub[first_not_empty_buffer].c_str(), oub[first_not_empty_buffer].size(), 6, ZLIB_ENCODE);
-        } else if ((http_need_gzip & 6) == 6) {
-          header("Content-Encoding: deflate", 25, true);
-          compressed = zlib_encode(oub[first_not_empty_buffer].c_str(), oub[first_not_empty_buffer].size(), 6, ZLIB_COMPRESS);
-        } else {
-          compressed = &oub[first_not_empty_buffer];
-        }
+      } else if ((http_need_gzip & 5) == 5) {
+        compression = 1; // gzip, see HTTP_COMPRESSION_* in net/net-http-server.h
+      } else if ((http_need_gzip & 6) == 6) {
+        compression = 2; // deflate
       }
+      const string_buffer *body = &oub[first_not_empty_buffer];
 
-      const string_buffer *headers = get_headers(compressed->size());
-      http_set_result(headers->buffer(), headers->size(), compressed->buffer(), compressed->size(), static_cast<int32_t>(exit_code));
+      const string_buffer *headers = get_headers(compression != 0 ? CONTENT_LENGTH_SET_BY_ENGINE : static_cast<int>(body->size()));
+      http_set_result(headers->buffer(), headers->size(), body->buffer(), body->size(), static_cast<int32_t>(exit_code), compression);
 
       break;
     }
@@ -656,6 +688,32 @@ void print(const string_buffer &sb) {
   print(sb.buffer(), sb.size());
 }
 
+bool f$json_encode_print(const mixed &v, int64_t options) {
+  bool has_unsupported_option = static_cast<bool>(options & ~JSON_AVAILABLE_OPTIONS);
+  if (has_unsupported_option) {
+    php_warning("Wrong parameter options = %ld in function json_encode_print", options);
+    return false;
+  }
+
+  if (run_once && ob_cur_buffer == 0) {
+    static_SB.clean();
+    if (!do_json_encode(static_SB, v, options, false)) {
+      return false;
+    }
+    print(static_SB);
+    return true;
+  }
+
+  // encode straight into the current output buffer, skipping the intermediate string;
+  // on failure roll the buffer back so no partial document leaks into the response
+  const auto saved_pos = coub->size();
+  if (!do_json_encode(*coub, v, options, false)) {
+    coub->set_pos(saved_pos);
+    return false;
+  }
+  return true;
+}
+
 void dbg_echo(const char *s, size_t s_len) {
   dl::CriticalSectionGuard critical_section;
   write(kstderr, s, s_len);
@@ -715,6 +773,18 @@ mixed v$_ENV     __attribute__ ((weak));
 mixed v$argc  __attribute__ ((weak));
 mixed v$argv  __attribute__ ((weak));
 
+// codegen defines v$<name>$is_used next to each superglobal array the script
+// really references (see SuperglobalUsedFlag); through these weak references a
+// missing symbol proves the whole script never touches the array, so
+// init_superglobals can skip materializing it
+extern bool v$_SERVER$is_used  __attribute__ ((weak));
+extern bool v$_GET$is_used     __attribute__ ((weak));
+extern bool v$_POST$is_used    __attribute__ ((weak));
+extern bool v$_FILES$is_used   __attribute__ ((weak));
+extern bool v$_COOKIE$is_used  __attribute__ ((weak));
+extern bool v$_REQUEST$is_used __attribute__ ((weak));
+extern bool v$_ENV$is_used     __attribute__ ((weak));
+
 static std::aligned_storage_t<sizeof(array<bool>), alignof(array<bool>)> uploaded_files_storage;
 static array<bool> *uploaded_files = reinterpret_cast<array<bool> *> (&uploaded_files_storage);
 static long long uploaded_files_last_query_num = -1;
@@ -1193,6 +1263,9 @@ static bool parse_multipart(const char *post, int post_len, const string &bounda
 static char arg_vars_storage[sizeof(array<string>)];
 static array<string> *arg_vars = nullptr;
 
+static char env_vars_storage[sizeof(array<mixed>)];
+static array<mixed> *env_vars = nullptr;
+
 Optional<array<mixed>> f$getopt(const string &options, array<string> longopts) {
   if (!arg_vars) {
     return false;
@@ -1312,23 +1385,37 @@ static void init_superglobals(const char *uri, int uri_len, const char *get, int
 
   reset_superglobals();
 
+  const bool request_used = &v$_REQUEST$is_used != nullptr;
+  const bool server_used = &v$_SERVER$is_used != nullptr;
+  const bool get_used = request_used || &v$_GET$is_used != nullptr;
+  const bool post_used = request_used || &v$_POST$is_used != nullptr;
+  const bool files_used = &v$_FILES$is_used != nullptr;
+  const bool cookie_used = request_used || &v$_COOKIE$is_used != nullptr;
+  const bool env_used = &v$_ENV$is_used != nullptr;
+
   string uri_str;
   if (uri_len) {
     uri_str.assign(uri, uri_len);
-    v$_SERVER.set_value(string("PHP_SELF", 8), uri_str);
-    v$_SERVER.set_value(string("SCRIPT_URL", 10), uri_str);
-    v$_SERVER.set_value(string("SCRIPT_NAME", 11), uri_str);
+    if (server_used) {
+      v$_SERVER.set_value(string("PHP_SELF", 8), uri_str);
+      v$_SERVER.set_value(string("SCRIPT_URL", 10), uri_str);
+      v$_SERVER.set_value(string("SCRIPT_NAME", 11), uri_str);
+    }
   }
 
   string get_str;
   if (get_len) {
     get_str.assign(get, get_len);
-    f$parse_str(get_str, v$_GET);
+    if (get_used) {
+      f$parse_str(get_str, v$_GET);
+    }
 
-    v$_SERVER.set_value(string("QUERY_STRING", 12), get_str);
+    if (server_used) {
+      v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::query_string), get_str);
+    }
   }
 
-  if (uri) {
+  if (uri != nullptr && server_used) {
     if (get_len) {
       v$_SERVER.set_value(string("REQUEST_URI", 11), (static_SB.clean() << uri_str << '?' << get_str).str());
     } else {
@@ -1376,17 +1463,33 @@ static void init_superglobals(const char *uri, int uri_len, const char *get, int
           http_need_gzip |= 2;
         }
       } else if (!strcmp(header_name.c_str(), "cookie")) {
-        array<string> cookie = explode(';', header_value);
-        for (int t = 0; t < (int)cookie.count(); t++) {
-          array<string> cur_cookie = explode('=', f$trim(cookie[t]), 2);
-          if ((int)cur_cookie.count() == 2) {
-            parse_str_set_value(v$_COOKIE, cur_cookie[0], f$urldecode(cur_cookie[1]));
+        if (cookie_used) {
+          array<string> cookie = explode(';', header_value);
+          for (int t = 0; t < (int)cookie.count(); t++) {
+            array<string> cur_cookie = explode('=', f$trim(cookie[t]), 2);
+            if ((int)cur_cookie.count() == 2) {
+              parse_str_set_value(v$_COOKIE, cur_cookie[0], f$urldecode(cur_cookie[1]));
+            }
           }
         }
       } else if (!strcmp(header_name.c_str(), "host")) {
-        v$_SERVER.set_value(string("SERVER_NAME", 11), header_value);
+        if (server_used) {
+          v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::server_name), header_value);
+        }
       } else if (!strcmp(header_name.c_str(), "authorization")) {
-        parse_http_authorization_header(header_value);
+        if (server_used) {
+          parse_http_authorization_header(header_value);
+        }
+      } else if (!strcmp(header_name.c_str(), "x-kphp-timeout-ms")) {
+        // the client's own deadline for this request; it can only tighten the
+        // engine-stamped one, outgoing query timeouts are clamped to it
+        const int64_t client_timeout_ms = header_value.to_int();
+        if (client_timeout_ms > 0) {
+          const double client_deadline = get_precise_now() + client_timeout_ms * 0.001;
+          if (get_request_deadline_time() <= 0 || client_deadline < get_request_deadline_time()) {
+            set_request_deadline_time(client_deadline);
+          }
+        }
       }
 
       if (!strcmp(header_name.c_str(), "content-type")) {
@@ -1394,7 +1497,7 @@ static void init_superglobals(const char *uri, int uri_len, const char *get, int
         content_type_lower = f$strtolower(header_value);
       } else if (!strcmp(header_name.c_str(), "content-length")) {
         //must be equal to post_len, ignored
-      } else {
+      } else if (server_used) {
         string key(header_name.size() + 5, false);
         bool good_name = true;
         for (int i = 0; i < (int)header_name.size(); i++) {
@@ -1423,15 +1526,15 @@ static void init_superglobals(const char *uri, int uri_len, const char *get, int
     }
   }
 
-  string HTTP_X_REAL_SCHEME("HTTP_X_REAL_SCHEME", 18);
-  string HTTP_X_REAL_HOST("HTTP_X_REAL_HOST", 16);
-  string HTTP_X_REAL_REQUEST("HTTP_X_REAL_REQUEST", 19);
-  if (v$_SERVER.isset(HTTP_X_REAL_SCHEME) && v$_SERVER.isset(HTTP_X_REAL_HOST) && v$_SERVER.isset(HTTP_X_REAL_REQUEST)) {
+  string HTTP_X_REAL_SCHEME = string_cache::cached_literal(string_cache::literal::http_x_real_scheme);
+  string HTTP_X_REAL_HOST = string_cache::cached_literal(string_cache::literal::http_x_real_host);
+  string HTTP_X_REAL_REQUEST = string_cache::cached_literal(string_cache::literal::http_x_real_request);
+  if (server_used && v$_SERVER.isset(HTTP_X_REAL_SCHEME) && v$_SERVER.isset(HTTP_X_REAL_HOST) && v$_SERVER.isset(HTTP_X_REAL_REQUEST)) {
     string script_uri(v$_SERVER.get_value(HTTP_X_REAL_SCHEME).to_string());
     script_uri.append("://", 3);
     script_uri.append(v$_SERVER.get_value(HTTP_X_REAL_HOST).to_string());
     script_uri.append(v$_SERVER.get_value(HTTP_X_REAL_REQUEST).to_string());
-    v$_SERVER.set_value(string("SCRIPT_URI", 10), script_uri);
+    v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::script_uri), script_uri);
   }
 
   if (post_len > 0) {
@@ -1443,7 +1546,9 @@ static void init_superglobals(const char *uri, int uri_len, const char *get, int
         raw_post_data.assign(post, post_len);
         dl::leave_critical_section();
 
-        f$parse_str(raw_post_data, v$_POST);
+        if (post_used) {
+          f$parse_str(raw_post_data, v$_POST);
+        }
       }
     } else if (strstr(content_type_lower.c_str(), "multipart/form-data")) {
       const char *p = strstr(content_type_lower.c_str(), "boundary");
@@ -1459,7 +1564,9 @@ static void init_superglobals(const char *uri, int uri_len, const char *get, int
             end_p--;
           }
 //          fprintf (stderr, "!%s!\n", p);
-          is_parsed |= parse_multipart(post, post_len, string(p, static_cast<string::size_type>(end_p - p)));
+          if (post_used || files_used) {
+            is_parsed |= parse_multipart(post, post_len, string(p, static_cast<string::size_type>(end_p - p)));
+          }
         }
       }
     } else {
@@ -1479,50 +1586,51 @@ static void init_superglobals(const char *uri, int uri_len, const char *get, int
       }
     }
 
-    v$_SERVER.set_value(string("CONTENT_TYPE", 12), content_type);
+    if (server_used) {
+      v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::content_type), content_type);
+    }
   }
 
   double cur_time = microtime();
-  v$_SERVER.set_value(string("GATEWAY_INTERFACE", 17), string("CGI/1.1", 7));
-  if (remote_ip) {
-    v$_SERVER.set_value(string("REMOTE_ADDR", 11), f$long2ip(remote_ip));
-  }
-  if (remote_port) {
-    v$_SERVER.set_value(string("REMOTE_PORT", 11), remote_port);
-  }
-  if (rpc_request_id) {
-    v$_SERVER.set_value(string("RPC_REQUEST_ID", 14), f$strval(Long(rpc_request_id)));
-    v$_SERVER.set_value(string("RPC_REMOTE_IP", 13), rpc_remote_ip);
-    v$_SERVER.set_value(string("RPC_REMOTE_PORT", 15), rpc_remote_port);
-    v$_SERVER.set_value(string("RPC_REMOTE_PID", 14), rpc_remote_pid);
-    v$_SERVER.set_value(string("RPC_REMOTE_UTIME", 16), rpc_remote_utime);
-  }
-  is_head_query = false;
-  if (request_method_len) {
-    v$_SERVER.set_value(string("REQUEST_METHOD", 14), string(request_method, request_method_len));
-    if (request_method_len == 4 && !strncmp(request_method, "HEAD", request_method_len)) {
-      is_head_query = true;
-    }
-  }
-  v$_SERVER.set_value(string("REQUEST_TIME", 12), int(cur_time));
-  v$_SERVER.set_value(string("REQUEST_TIME_FLOAT", 18), cur_time);
-  v$_SERVER.set_value(string("SERVER_PORT", 11), string("80", 2));
-  v$_SERVER.set_value(string("SERVER_PROTOCOL", 15), string("HTTP/1.1", 8));
-  v$_SERVER.set_value(string("SERVER_SIGNATURE", 16), (static_SB.clean() << "Apache/2.2.9 (Debian) PHP/5.2.6-1<<lenny10 with Suhosin-Patch Server at "
-                                                                         << v$_SERVER[string("SERVER_NAME", 11)] << " Port 80").str());
-  v$_SERVER.set_value(string("SERVER_SOFTWARE", 15), string("Apache/2.2.9 (Debian) PHP/5.2.6-1+lenny10 with Suhosin-Patch", 60));
-
-  if (environ != nullptr) {
-    for (int i = 0; environ[i] != nullptr; i++) {
-      const char *s = strchr(environ[i], '=');
-      php_assert (s != nullptr);
-      v$_ENV.set_value(string(environ[i], static_cast<string::size_type>(s - environ[i])), string(s + 1));
+  is_head_query = request_method_len == 4 && !strncmp(request_method, "HEAD", request_method_len);
+  if (server_used) {
+    v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::gateway_interface), string_cache::cached_literal(string_cache::literal::cgi_1_1));
+    if (remote_ip) {
+      v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::remote_addr), f$long2ip(remote_ip));
     }
+    if (remote_port) {
+      v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::remote_port), remote_port);
+    }
+    if (rpc_request_id) {
+      v$_SERVER.set_value(string("RPC_REQUEST_ID", 14), f$strval(Long(rpc_request_id)));
+      v$_SERVER.set_value(string("RPC_REMOTE_IP", 13), rpc_remote_ip);
+      v$_SERVER.set_value(string("RPC_REMOTE_PORT", 15), rpc_remote_port);
+      v$_SERVER.set_value(string("RPC_REMOTE_PID", 14), rpc_remote_pid);
+      v$_SERVER.set_value(string("RPC_REMOTE_UTIME", 16), rpc_remote_utime);
+    }
+    if (request_method_len) {
+      v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::request_method), string(request_method, request_method_len));
+    }
+    v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::request_time), int(cur_time));
+    v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::request_time_float), cur_time);
+    v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::server_port), string("80", 2));
+    v$_SERVER.set_value(string_cache::cached_literal(string_cache::literal::server_protocol), string_cache::cached_literal(string_cache::literal::http_1_1));
+    v$_SERVER.set_value(string("SERVER_SIGNATURE", 16), (static_SB.clean() << "Apache/2.2.9 (Debian) PHP/5.2.6-1<<lenny10 with Suhosin-Patch Server at "
+                                                                           << v$_SERVER[string_cache::cached_literal(string_cache::literal::server_name)] << " Port 80").str());
+    v$_SERVER.set_value(string("SERVER_SOFTWARE", 15), string("Apache/2.2.9 (Debian) PHP/5.2.6-1+lenny10 with Suhosin-Patch", 60));
+  }
+
+  if (env_used && env_vars != nullptr) {
+    // the environment cannot change mid-process, so $_ENV is a COW handle onto
+    // the template built once at worker start instead of a per-request rebuild
+    v$_ENV = *env_vars;
   }
 
-  v$_REQUEST.as_array("") += v$_GET.to_array();
-  v$_REQUEST.as_array("") += v$_POST.to_array();
-  v$_REQUEST.as_array("") += v$_COOKIE.to_array();
+  if (request_used) {
+    v$_REQUEST.as_array("") += v$_GET.to_array();
+    v$_REQUEST.as_array("") += v$_POST.to_array();
+    v$_REQUEST.as_array("") += v$_COOKIE.to_array();
+  }
 
   if (uri != nullptr) {
     if (keep_alive) {
@@ -1548,8 +1656,10 @@ static void init_superglobals(const char *uri, int uri_len, const char *get, int
     v$argv = *arg_vars;
   }
 
-  v$_SERVER.set_value(string("argv", 4), v$argv);
-  v$_SERVER.set_value(string("argc", 4), v$argc);
+  if (server_used) {
+    v$_SERVER.set_value(string("argv", 4), v$argv);
+    v$_SERVER.set_value(string("argc", 4), v$argc);
+  }
 
   v$d$PHP_SAPI = php_sapi_name();
 
@@ -2000,6 +2110,19 @@ static bool php_fclose(const Stream &stream) {
 }
 
 static void global_init_interface_lib() {
+  if (env_vars == nullptr && environ != nullptr) {
+    // built before the first request on the plain heap, so the array survives
+    // between requests and init_superglobals only copies a COW handle to it
+    new(env_vars_storage) array<mixed>();
+    env_vars = reinterpret_cast <array<mixed> *> (env_vars_storage);
+
+    for (int i = 0; environ[i] != nullptr; i++) {
+      const char *s = strchr(environ[i], '=');
+      php_assert (s != nullptr);
+      env_vars->set_value(string(environ[i], static_cast<string::size_type>(s - environ[i])), string(s + 1));
+    }
+  }
+
   static stream_functions php_stream_functions;
 
   php_stream_functions.name = string("php", 3);
@@ -2059,9 +2182,12 @@ static void init_runtime_libs() {
 
   init_string_buffer_lib(static_cast<int>(static_buffer_length_limit));
 
+  memory_resource::attribution::reset_current_context();
+
   shutdown_functions_count = 0;
   finished = false;
   flushed = false;
+  body_streamed = false;
 
   php_warning_level = std::max(2, php_warning_minimum_level);
   php_disable_warnings = 0;
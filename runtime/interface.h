@@ -45,6 +45,10 @@ void f$setrawcookie(const string &name, const string &value, int64_t expire = 0,
 
 void f$register_shutdown_function(const shutdown_function_type &f);
 
+// streams everything printed so far to the http client as a chunked-encoding frame,
+// the script keeps running; no-op while a user-level output buffer is open
+void f$flush();
+
 void f$fastcgi_finish_request(int64_t exit_code = 0);
 
 __attribute__((noreturn))
@@ -166,6 +170,10 @@ void init_runtime_environment(php_query_data *data, void *mem, size_t mem_size);
 
 void free_runtime_environment();
 
+// defined in runtime/net_events.cpp; redeclared here because the engine can't
+// include runtime/net_events.h (its event_timer clashes with net/net-events.h)
+void set_request_deadline_time(double deadline);
+
 /*
  *
  *     IMPLEMENTATION
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "common/algorithms/simd-reductions.h"
+
 #include "runtime/kphp_core.h"
 
 int64_t f$bindec(const string &number) noexcept;
@@ -41,6 +43,14 @@ inline T f$min(const array<T> &a);
 template<class T>
 inline T f$max(const array<T> &a);
 
+inline int64_t f$min(const array<int64_t> &a);
+
+inline int64_t f$max(const array<int64_t> &a);
+
+inline double f$min(const array<double> &a);
+
+inline double f$max(const array<double> &a);
+
 template<class T>
 inline T f$min(const T &arg1);
 
@@ -154,6 +164,80 @@ T f$max(const array<T> &a) {
   return res;
 }
 
+// when inference proves the element type, vector-mode arrays are reduced
+// over the flat entries instead of the iterator loop with generic compares
+inline int64_t f$min(const array<int64_t> &a) {
+  if (a.count() == 0) {
+    php_warning("Empty array specified to function min");
+    return 0;
+  }
+
+  if (a.is_vector()) {
+    const int64_t *p = a.get_const_vector_pointer();
+    const int64_t *end = p + a.count();
+    int64_t res = *p;
+    for (++p; p != end; ++p) {
+      res = *p < res ? *p : res;
+    }
+    return res;
+  }
+
+  return f$min<int64_t>(a);
+}
+
+inline int64_t f$max(const array<int64_t> &a) {
+  if (a.count() == 0) {
+    php_warning("Empty array specified to function max");
+    return 0;
+  }
+
+  if (a.is_vector()) {
+    const int64_t *p = a.get_const_vector_pointer();
+    const int64_t *end = p + a.count();
+    int64_t res = *p;
+    for (++p; p != end; ++p) {
+      res = *p > res ? *p : res;
+    }
+    return res;
+  }
+
+  return f$max<int64_t>(a);
+}
+
+inline double f$min(const array<double> &a) {
+  if (a.count() == 0) {
+    php_warning("Empty array specified to function min");
+    return 0;
+  }
+
+  if (a.is_vector()) {
+    const double *begin = a.get_const_vector_pointer();
+    double min_value = 0;
+    double max_value = 0;
+    vk::simd_double_min_max(begin, begin + a.count(), &min_value, &max_value);
+    return min_value;
+  }
+
+  return f$min<double>(a);
+}
+
+inline double f$max(const array<double> &a) {
+  if (a.count() == 0) {
+    php_warning("Empty array specified to function max");
+    return 0;
+  }
+
+  if (a.is_vector()) {
+    const double *begin = a.get_const_vector_pointer();
+    double min_value = 0;
+    double max_value = 0;
+    vk::simd_double_min_max(begin, begin + a.count(), &min_value, &max_value);
+    return max_value;
+  }
+
+  return f$max<double>(a);
+}
+
 template<class T>
 T f$min(const T &arg1) {
   return arg1;
@@ -583,6 +583,10 @@ mixed f$McMemcache$$get(const class_instance<C$McMemcache> &v$this, const mixed
       php_warning("There is no available server to run Memcache::get");
       return array<mixed>();
     }
+    if (key_var.empty()) {
+      // don't send a bare "get\r\n" for nothing
+      return array<mixed>();
+    }
 
     drivers_SB.clean();
     drivers_SB << "get";
@@ -0,0 +1,21 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/memory_resource/memory_attribution.h"
+
+namespace memory_resource {
+namespace attribution {
+
+AttributionState state;
+
+uint16_t register_context(const char *name) noexcept {
+  if (state.contexts_count == MAX_CONTEXTS) {
+    return 0;
+  }
+  state.context_names[state.contexts_count] = name;
+  return state.contexts_count++;
+}
+
+} // namespace attribution
+} // namespace memory_resource
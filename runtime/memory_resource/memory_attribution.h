@@ -0,0 +1,77 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "common/mixin/not_copyable.h"
+
+namespace memory_resource {
+
+// Allocation-side memory attribution: every script allocation is counted against a
+// compact context id which the generated code maintains (the compiler inserts an
+// attribution_guard at the top of functions marked hot by the hotness profile).
+// Only the allocation side is attributed — counters are monotonic, like
+// MemoryStats::total_memory_allocated — because attributing frees would require a
+// per-piece tag and change the allocator layout; diffing two snapshots of these
+// counters is what localizes a regression, and that needs no deallocation info.
+namespace attribution {
+
+constexpr uint16_t MAX_CONTEXTS = 256;
+
+struct ContextCounters {
+  uint64_t total_allocations{0};
+  uint64_t total_memory_allocated{0};
+};
+
+struct AttributionState {
+  uint16_t current_context{0};
+  uint16_t contexts_count{1}; // context 0 collects everything outside the attributed functions
+  std::array<ContextCounters, MAX_CONTEXTS> counters{};
+  std::array<const char *, MAX_CONTEXTS> context_names{{"(unattributed)"}};
+};
+
+extern AttributionState state;
+
+// called from unsynchronized_pool_resource::allocate; must stay trivially cheap
+inline void register_allocation(size_t size) noexcept {
+  ContextCounters &counters = state.counters[state.current_context];
+  ++counters.total_allocations;
+  counters.total_memory_allocated += size;
+}
+
+// a script error unwinds with a longjmp, so a guard that was alive at that moment
+// never restores its saved context; reset before every new script run
+inline void reset_current_context() noexcept {
+  state.current_context = 0;
+}
+
+// called once per attributed function from a static local initializer in the
+// generated code; the name must outlive the worker (a string literal does);
+// returns context 0 when the table is full, so extra functions simply fall
+// into the unattributed bucket instead of breaking anything
+uint16_t register_context(const char *name) noexcept;
+
+} // namespace attribution
+
+// RAII guard emitted by the compiler at the top of hot-listed functions
+class attribution_guard : vk::not_copyable {
+public:
+  explicit attribution_guard(uint16_t context) noexcept
+    : saved_context_(attribution::state.current_context) {
+    attribution::state.current_context = context;
+  }
+
+  ~attribution_guard() noexcept {
+    attribution::state.current_context = saved_context_;
+  }
+
+private:
+  const uint16_t saved_context_;
+};
+
+} // namespace memory_resource
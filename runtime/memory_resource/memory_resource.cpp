@@ -19,6 +19,29 @@ void write_stat(stats_t *stats, const char *prefix, const char *suffix, size_t v
 
 namespace memory_resource {
 
+void write_size_class_stats_to(stats_t *stats, const char *prefix, const SizeClassStatsArray &classes) noexcept {
+  char class_prefix[128]{0};
+  for (size_t i = 0; i < classes.size(); ++i) {
+    const auto &cls = classes[i];
+    // untouched classes are skipped to keep the stats cardinality down
+    if (cls.allocations == 0 && cls.frees == 0) {
+      continue;
+    }
+    int len = 0;
+    if (i < SMALL_SIZE_CLASSES_COUNT) {
+      len = snprintf(class_prefix, sizeof(class_prefix) - 1, "%s.size_class.%zu", prefix, get_size_class_upper_bound(i));
+    } else {
+      len = snprintf(class_prefix, sizeof(class_prefix) - 1, "%s.size_class.huge", prefix);
+    }
+    assert(len > 0 && sizeof(class_prefix) >= static_cast<size_t>(len + 1));
+    write_stat(stats, class_prefix, "allocations", cls.allocations);
+    write_stat(stats, class_prefix, "frees", cls.frees);
+    write_stat(stats, class_prefix, "current_pieces", cls.current_pieces);
+    write_stat(stats, class_prefix, "max_pieces", cls.max_pieces);
+    write_stat(stats, class_prefix, "fallback_allocations", cls.fallback_allocations);
+  }
+}
+
 void MemoryStats::write_stats_to(stats_t *stats, const char *prefix) const noexcept {
   write_stat(stats, prefix, "memory.limit", memory_limit);
   write_stat(stats, prefix, "memory.used", memory_used);
@@ -3,6 +3,7 @@
 // Distributed under the GPL v3 License, see LICENSE.notice.txt
 
 #pragma once
+#include <array>
 #include <cinttypes>
 #include <cstdarg>
 #include <cstdio>
@@ -52,4 +53,35 @@ public:
   void write_stats_to(stats_t *stats, const char *prefix) const noexcept;
 };
 
+// per-size-class allocator counters: power-of-two buckets over the small chunk
+// range (8 bytes .. 16KB) plus one bucket for huge pieces; a couple of increments
+// per allocation, cheap enough for always-on
+struct SizeClassStats {
+  uint64_t allocations{0};
+  uint64_t frees{0};
+  uint64_t current_pieces{0};
+  uint64_t max_pieces{0};
+  uint64_t fallback_allocations{0}; // small pieces the pool couldn't serve and routed to the fallback resource
+};
+
+constexpr size_t SMALL_SIZE_CLASSES_COUNT = 12; // 8, 16, 32, ... 16384 bytes
+constexpr size_t SIZE_CLASSES_COUNT = SMALL_SIZE_CLASSES_COUNT + 1; // + huge pieces
+
+using SizeClassStatsArray = std::array<SizeClassStats, SIZE_CLASSES_COUNT>;
+
+inline size_t get_size_class(size_t aligned_size) noexcept {
+  if (aligned_size >= size_t{16 * 1024}) {
+    return SMALL_SIZE_CLASSES_COUNT;
+  }
+  // aligned_size is always >= 8 here; 8 -> 0, 16 -> 1, ..., 16384 -> 11
+  const size_t bits = 64 - static_cast<size_t>(__builtin_clzll(aligned_size - 1));
+  return bits <= 3 ? 0 : bits - 3;
+}
+
+constexpr size_t get_size_class_upper_bound(size_t size_class) noexcept {
+  return size_t{8} << size_class;
+}
+
+void write_size_class_stats_to(stats_t *stats, const char *prefix, const SizeClassStatsArray &classes) noexcept;
+
 } // namespace memory_resource
@@ -18,6 +18,7 @@ void unsynchronized_pool_resource::init(void *buffer, size_t buffer_size) noexce
   huge_pieces_.hard_reset();
   fallback_resource_.init(nullptr, 0);
   free_chunks_.fill(details::memory_chunk_list{});
+  size_class_stats_ = {};
 }
 
 void unsynchronized_pool_resource::perform_defragmentation() noexcept {
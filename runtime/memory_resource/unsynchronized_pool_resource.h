@@ -7,6 +7,7 @@
 #include "runtime/memory_resource/details/memory_chunk_list.h"
 #include "runtime/memory_resource/details/memory_chunk_tree.h"
 #include "runtime/memory_resource/details/universal_reallocate.h"
+#include "runtime/memory_resource/memory_attribution.h"
 #include "runtime/memory_resource/monotonic_buffer_resource.h"
 #include "runtime/memory_resource/resource_allocator.h"
 #include "runtime/php_assert.h"
@@ -23,11 +24,13 @@ public:
 
   void *allocate(size_t size) noexcept {
     void *mem = nullptr;
+    bool from_fallback = false;
     const auto aligned_size = details::align_for_chunk(size);
     if (aligned_size < MAX_CHUNK_BLOCK_SIZE_) {
       mem = try_allocate_small_piece(aligned_size);
       if (!mem) {
         mem = allocate_small_piece_from_fallback_resource(aligned_size);
+        from_fallback = true;
       }
     } else {
       mem = allocate_huge_piece(aligned_size, true);
@@ -37,6 +40,10 @@ public:
     }
 
     register_allocation(mem, aligned_size);
+    if (mem != nullptr) {
+      attribution::register_allocation(aligned_size);
+      register_size_class_allocation(aligned_size, from_fallback);
+    }
     return mem;
   }
 
@@ -59,6 +66,11 @@ public:
     const auto aligned_size = details::align_for_chunk(size);
     put_memory_back(mem, aligned_size);
     register_deallocation(aligned_size);
+    register_size_class_free(aligned_size);
+  }
+
+  const SizeClassStatsArray &get_size_class_stats() const noexcept {
+    return size_class_stats_;
   }
 
   void perform_defragmentation() noexcept;
@@ -103,6 +115,20 @@ private:
   void *allocate_small_piece_from_fallback_resource(size_t aligned_size) noexcept;
   void *perform_defragmentation_and_allocate_huge_piece(size_t aligned_size) noexcept;
 
+  void register_size_class_allocation(size_t aligned_size, bool from_fallback) noexcept {
+    auto &size_class = size_class_stats_[get_size_class(aligned_size)];
+    ++size_class.allocations;
+    size_class.fallback_allocations += from_fallback;
+    ++size_class.current_pieces;
+    size_class.max_pieces = std::max(size_class.max_pieces, size_class.current_pieces);
+  }
+
+  void register_size_class_free(size_t aligned_size) noexcept {
+    auto &size_class = size_class_stats_[get_size_class(aligned_size)];
+    ++size_class.frees;
+    --size_class.current_pieces;
+  }
+
   void put_memory_back(void *mem, size_t size) noexcept {
     if (!monotonic_buffer_resource::put_memory_back(mem, size)) {
       if (size < MAX_CHUNK_BLOCK_SIZE_) {
@@ -118,6 +144,7 @@ private:
 
   details::memory_chunk_tree huge_pieces_;
   monotonic_buffer_resource fallback_resource_;
+  SizeClassStatsArray size_class_stats_{};
 
   static constexpr size_t MAX_CHUNK_BLOCK_SIZE_{16u * 1024u};
   std::array<details::memory_chunk_list, details::get_chunk_id(MAX_CHUNK_BLOCK_SIZE_)> free_chunks_;
@@ -4,6 +4,41 @@
 
 #include "runtime/memory_usage.h"
 
+#include "runtime/allocator.h"
+#include "runtime/memory_resource/memory_attribution.h"
+
+array<int64_t> f$get_memory_attribution_stats() {
+  const auto &state = memory_resource::attribution::state;
+  array<int64_t> result;
+  for (uint16_t i = 0; i < state.contexts_count; ++i) {
+    result.set_value(string{state.context_names[i]}, static_cast<int64_t>(state.counters[i].total_memory_allocated));
+  }
+  return result;
+}
+
+array<array<int64_t>> f$get_memory_size_class_stats() {
+  const auto &classes = dl::get_script_size_class_stats();
+  array<array<int64_t>> result;
+  for (size_t i = 0; i < classes.size(); ++i) {
+    const auto &size_class = classes[i];
+    if (size_class.allocations == 0 && size_class.frees == 0) {
+      continue;
+    }
+    array<int64_t> counters;
+    counters.set_value(string{"allocations", 11}, static_cast<int64_t>(size_class.allocations));
+    counters.set_value(string{"frees", 5}, static_cast<int64_t>(size_class.frees));
+    counters.set_value(string{"current_pieces", 14}, static_cast<int64_t>(size_class.current_pieces));
+    counters.set_value(string{"max_pieces", 10}, static_cast<int64_t>(size_class.max_pieces));
+    counters.set_value(string{"fallback_allocations", 20}, static_cast<int64_t>(size_class.fallback_allocations));
+    if (i < memory_resource::SMALL_SIZE_CLASSES_COUNT) {
+      result.set_value(string{static_cast<int64_t>(memory_resource::get_size_class_upper_bound(i))}, counters);
+    } else {
+      result.set_value(string{"huge", 4}, counters);
+    }
+  }
+  return result;
+}
+
 int64_t f$estimate_memory_usage(const string &value) {
   if (value.is_reference_counter(ExtraRefCnt::for_global_const) || value.is_reference_counter(ExtraRefCnt::for_instance_cache)) {
     return 0;
@@ -34,6 +34,17 @@ int64_t f$estimate_memory_usage(const class_instance<T> &value);
 template<typename Int = int64_t, typename = std::enable_if_t<std::is_same<int64_t, Int>{}>>
 array<int64_t> f$get_global_vars_memory_stats(Int limit = 0);
 
+// per-context allocation counters maintained by the allocator (see memory_attribution.h);
+// keys are function names from the hotness profile plus "(unattributed)", values are
+// total bytes allocated under that context since the worker started; unlike
+// estimate_memory_usage it never walks any structures, so it's fine to call in production
+array<int64_t> f$get_memory_attribution_stats();
+
+// per-size-class counters from the script allocator free lists, dumpable mid-request;
+// keys are size class upper bounds ("8", "16", ... "16384") plus "huge", values are
+// maps with allocations/frees/current_pieces/max_pieces/fallback_allocations
+array<array<int64_t>> f$get_memory_size_class_stats();
+
 template<typename T, typename>
 int64_t f$estimate_memory_usage(const T &) {
   return 0;
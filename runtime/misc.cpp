@@ -11,6 +11,10 @@
 #include <sys/time.h>
 #include <unistd.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "runtime/critical_section.h"
 #include "runtime/datetime.h"
 #include "runtime/exception.h"
@@ -760,84 +764,84 @@ mixed f$unserialize(const string &v) {
 }
 
 
-static void json_append_one_char(unsigned int c) {
-  static_SB.append_char('\\');
-  static_SB.append_char('u');
-  static_SB.append_char("0123456789abcdef"[c >> 12]);
-  static_SB.append_char("0123456789abcdef"[(c >> 8) & 15]);
-  static_SB.append_char("0123456789abcdef"[(c >> 4) & 15]);
-  static_SB.append_char("0123456789abcdef"[c & 15]);
+static void json_append_one_char(string_buffer &sb, unsigned int c) {
+  sb.append_char('\\');
+  sb.append_char('u');
+  sb.append_char("0123456789abcdef"[c >> 12]);
+  sb.append_char("0123456789abcdef"[(c >> 8) & 15]);
+  sb.append_char("0123456789abcdef"[(c >> 4) & 15]);
+  sb.append_char("0123456789abcdef"[c & 15]);
 }
 
-static bool json_append_char(unsigned int c) {
+static bool json_append_char(string_buffer &sb, unsigned int c) {
   if (c < 0x10000) {
     if (0xD7FF < c && c < 0xE000) {
       return false;
     }
-    json_append_one_char(c);
+    json_append_one_char(sb, c);
     return true;
   } else if (c <= 0x10ffff) {
     c -= 0x10000;
-    json_append_one_char(0xD800 | (c >> 10));
-    json_append_one_char(0xDC00 | (c & 0x3FF));
+    json_append_one_char(sb, 0xD800 | (c >> 10));
+    json_append_one_char(sb, 0xDC00 | (c & 0x3FF));
     return true;
   } else {
     return false;
   }
 }
 
-static bool do_json_encode_string_php(const char *s, int len, int64_t options) {
-  int begin_pos = static_SB.size();
+static bool do_json_encode_string_php(string_buffer &sb, const char *s, int len, int64_t options) {
+  int begin_pos = sb.size();
   if (options & JSON_UNESCAPED_UNICODE) {
-    static_SB.reserve(2 * len + 2);
+    sb.reserve(2 * len + 2);
   } else {
-    static_SB.reserve(6 * len + 2);
+    sb.reserve(6 * len + 2);
   }
-  static_SB.append_char('"');
+  sb.append_char('"');
 
-#define ERROR {static_SB.set_pos (begin_pos); static_SB.append ("null", 4); return false;}
+#define ERROR {sb.set_pos (begin_pos); sb.append ("null", 4); return false;}
 #define CHECK(x) if (!(x)) {php_warning ("Not a valid utf-8 character at pos %d in function json_encode", pos); ERROR}
-#define APPEND_CHAR(x) CHECK(json_append_char (x))
+#define APPEND_CHAR(x) CHECK(json_append_char (sb, x))
 
   int a, b, c, d;
   for (int pos = 0; pos < len; pos++) {
     switch (s[pos]) {
       case '"':
-        static_SB.append_char('\\');
-        static_SB.append_char('"');
+        sb.append_char('\\');
+        sb.append_char('"');
         break;
       case '\\':
-        static_SB.append_char('\\');
-        static_SB.append_char('\\');
+        sb.append_char('\\');
+        sb.append_char('\\');
         break;
       case '/':
-        static_SB.append_char('\\');
-        static_SB.append_char('/');
+        sb.append_char('\\');
+        sb.append_char('/');
         break;
       case '\b':
-        static_SB.append_char('\\');
-        static_SB.append_char('b');
+        sb.append_char('\\');
+        sb.append_char('b');
         break;
       case '\f':
-        static_SB.append_char('\\');
-        static_SB.append_char('f');
+        sb.append_char('\\');
+        sb.append_char('f');
         break;
       case '\n':
-        static_SB.append_char('\\');
-        static_SB.append_char('n');
+        sb.append_char('\\');
+        sb.append_char('n');
         break;
       case '\r':
-        static_SB.append_char('\\');
-        static_SB.append_char('r');
+        sb.append_char('\\');
+        sb.append_char('r');
         break;
       case '\t':
-        static_SB.append_char('\\');
-        static_SB.append_char('t');
+        sb.append_char('\\');
+        sb.append_char('t');
         break;
       case 0 ... 7:
       case 11:
       case 14 ... 31:
-        json_append_one_char(s[pos]);
+        json_append_one_char(sb, s[pos]);
         break;
       case -128 ... -1:
         a = s[pos];
@@ -848,8 +852,8 @@ static bool do_json_encode_string_php(const char *s, int len, int64_t options) {
         if ((a & 0x20) == 0) {
           CHECK((a & 0x1e) > 0);
           if (options & JSON_UNESCAPED_UNICODE) {
-            static_SB.append_char(static_cast<char>(a));
-            static_SB.append_char(static_cast<char>(b));
+            sb.append_char(static_cast<char>(a));
+            sb.append_char(static_cast<char>(b));
           } else {
             APPEND_CHAR(((a & 0x1f) << 6) | (b & 0x3f));
           }
@@ -861,9 +865,9 @@ static bool do_json_encode_string_php(const char *s, int len, int64_t options) {
         if ((a & 0x10) == 0) {
           CHECK(((a & 0x0f) | (b & 0x20)) > 0);
           if (options & JSON_UNESCAPED_UNICODE) {
-            static_SB.append_char(static_cast<char>(a));
-            static_SB.append_char(static_cast<char>(b));
-            static_SB.append_char(static_cast<char>(c));
+            sb.append_char(static_cast<char>(a));
+            sb.append_char(static_cast<char>(b));
+            sb.append_char(static_cast<char>(c));
           } else {
             APPEND_CHAR(((a & 0x0f) << 12) | ((b & 0x3f) << 6) | (c & 0x3f));
           }
@@ -875,10 +879,10 @@ static bool do_json_encode_string_php(const char *s, int len, int64_t options) {
         if ((a & 0x08) == 0) {
           CHECK(((a & 0x07) | (b & 0x30)) > 0);
           if (options & JSON_UNESCAPED_UNICODE) {
-            static_SB.append_char(static_cast<char>(a));
-            static_SB.append_char(static_cast<char>(b));
-            static_SB.append_char(static_cast<char>(c));
-            static_SB.append_char(static_cast<char>(d));
+            sb.append_char(static_cast<char>(a));
+            sb.append_char(static_cast<char>(b));
+            sb.append_char(static_cast<char>(c));
+            sb.append_char(static_cast<char>(d));
           } else {
             APPEND_CHAR(((a & 0x07) << 18) | ((b & 0x3f) << 12) | ((c & 0x3f) << 6) | (d & 0x3f));
           }
@@ -888,86 +892,86 @@ static bool do_json_encode_string_php(const char *s, int len, int64_t options) {
         CHECK(0);
         break;
       default:
-        static_SB.append_char(s[pos]);
+        sb.append_char(s[pos]);
         break;
     }
   }
 
-  static_SB.append_char('"');
+  sb.append_char('"');
   return true;
 #undef ERROR
 #undef CHECK
 #undef APPEND_CHAR
 }
 
-static bool do_json_encode_string_vkext(const char *s, int len) {
-  static_SB.reserve(2 * len + 2);
-  if (static_SB.string_buffer_error_flag == STRING_BUFFER_ERROR_FLAG_FAILED) {
+static bool do_json_encode_string_vkext(string_buffer &sb, const char *s, int len) {
+  sb.reserve(2 * len + 2);
+  if (sb.string_buffer_error_flag == STRING_BUFFER_ERROR_FLAG_FAILED) {
     return false;
   }
 
-  static_SB.append_char('"');
+  sb.append_char('"');
 
   for (int pos = 0; pos < len; pos++) {
     char c = s[pos];
     if (unlikely ((unsigned int)c < 32u)) {
       switch (c) {
         case '\b':
-          static_SB.append_char('\\');
-          static_SB.append_char('b');
+          sb.append_char('\\');
+          sb.append_char('b');
           break;
         case '\f':
-          static_SB.append_char('\\');
-          static_SB.append_char('f');
+          sb.append_char('\\');
+          sb.append_char('f');
           break;
         case '\n':
-          static_SB.append_char('\\');
-          static_SB.append_char('n');
+          sb.append_char('\\');
+          sb.append_char('n');
           break;
         case '\r':
-          static_SB.append_char('\\');
-          static_SB.append_char('r');
+          sb.append_char('\\');
+          sb.append_char('r');
           break;
         case '\t':
-          static_SB.append_char('\\');
-          static_SB.append_char('t');
+          sb.append_char('\\');
+          sb.append_char('t');
           break;
       }
     } else {
       if (c == '"' || c == '\\' || c == '/') {
-        static_SB.append_char('\\');
+        sb.append_char('\\');
       }
-      static_SB.append_char(c);
+      sb.append_char(c);
     }
   }
 
-  static_SB.append_char('"');
+  sb.append_char('"');
 
   return true;
 }
 
-bool do_json_encode(const mixed &v, int64_t options, bool simple_encode) {
+bool do_json_encode(string_buffer &sb, const mixed &v, int64_t options, bool simple_encode) {
   switch (v.get_type()) {
     case mixed::type::NUL:
-      static_SB.append("null", 4);
+      sb.append("null", 4);
       return true;
     case mixed::type::BOOLEAN:
       if (v.as_bool()) {
-        static_SB.append("true", 4);
+        sb.append("true", 4);
       } else {
-        static_SB.append("false", 5);
+        sb.append("false", 5);
       }
       return true;
     case mixed::type::INTEGER:
-      static_SB << v.as_int();
+      sb << v.as_int();
       return true;
     case mixed::type::FLOAT:
       if (is_ok_float(v.as_double())) {
-        static_SB << (simple_encode ? f$number_format(v.as_double(), 6, DOT, string()) : string(v.as_double()));
+        sb << (simple_encode ? f$number_format(v.as_double(), 6, DOT, string()) : string(v.as_double()));
       } else {
         php_warning("strange double %lf in function json_encode", v.as_double());
         if (options & JSON_PARTIAL_OUTPUT_ON_ERROR) {
-          static_SB.append("0", 1);
+          sb.append("0", 1);
         } else {
           return false;
         }
@@ -975,10 +979,10 @@ bool do_json_encode(const mixed &v, int64_t options, bool simple_encode) {
       return true;
     case mixed::type::STRING:
       if (simple_encode) {
-        return do_json_encode_string_vkext(v.as_string().c_str(), v.as_string().size());
+        return do_json_encode_string_vkext(sb, v.as_string().c_str(), v.as_string().size());
       }
 
-      return do_json_encode_string_php(v.as_string().c_str(), v.as_string().size(), options);
+      return do_json_encode_string_php(sb, v.as_string().c_str(), v.as_string().size(), options);
     case mixed::type::ARRAY: {
       bool is_vector = v.as_array().is_vector();
       const bool force_object = static_cast<bool>(JSON_FORCE_OBJECT & options);
@@ -1000,35 +1004,35 @@ bool do_json_encode(const mixed &v, int64_t options, bool simple_encode) {
       }
       is_vector &= !force_object;
 
-      static_SB << "{["[is_vector];
+      sb << "{["[is_vector];
 
       for (array<mixed>::const_iterator p = v.as_array().begin(); p != v.as_array().end(); ++p) {
         if (p != v.as_array().begin()) {
-          static_SB << ',';
+          sb << ',';
         }
 
         if (!is_vector) {
           const array<mixed>::key_type key = p.get_key();
           if (array<mixed>::is_int_key(key)) {
-            static_SB << '"' << key.to_int() << '"';
+            sb << '"' << key.to_int() << '"';
           } else {
-            if (!do_json_encode(key, options, simple_encode)) {
+            if (!do_json_encode(sb, key, options, simple_encode)) {
               if (!(options & JSON_PARTIAL_OUTPUT_ON_ERROR)) {
                 return false;
               }
             }
           }
-          static_SB << ':';
+          sb << ':';
         }
 
-        if (!do_json_encode(p.get_value(), options, simple_encode)) {
+        if (!do_json_encode(sb, p.get_value(), options, simple_encode)) {
           if (!(options & JSON_PARTIAL_OUTPUT_ON_ERROR)) {
             return false;
           }
         }
       }
 
-      static_SB << "}]"[is_vector];
+      sb << "}]"[is_vector];
       return true;
     }
     default:
@@ -1045,7 +1049,7 @@ Optional<string> f$json_encode(const mixed &v, int64_t options, bool simple_enco
 
   static_SB.clean();
 
-  if (!do_json_encode(v, options, simple_encode)) {
+  if (!do_json_encode(static_SB, v, options, simple_encode)) {
     return false;
   }
 
@@ -1055,7 +1059,7 @@ Optional<string> f$json_encode(const mixed &v, int64_t options, bool simple_enco
 string f$vk_json_encode_safe(const mixed &v, bool simple_encode) {
   static_SB.clean();
   string_buffer::string_buffer_error_flag = STRING_BUFFER_ERROR_FLAG_ON;
-  do_json_encode(v, 0, simple_encode);
+  do_json_encode(static_SB, v, 0, simple_encode);
   if (string_buffer::string_buffer_error_flag == STRING_BUFFER_ERROR_FLAG_FAILED) {
     static_SB.clean();
     string_buffer::string_buffer_error_flag = STRING_BUFFER_ERROR_FLAG_OFF;
@@ -1073,6 +1077,25 @@ static void json_skip_blanks(const char *s, int &i) {
   }
 }
 
+// returns a pointer to the first '"' or '\\' in [p, end), or end; string contents between the
+// interesting characters are skipped 16 bytes at a time
+static const char *json_find_quote_or_backslash(const char *p, const char *end) {
+#ifdef __SSE2__
+  for (; p + 16 <= end; p += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')),
+                                                    _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))));
+    if (mask) {
+      return p + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+  }
+#endif
+  while (p != end && *p != '"' && *p != '\\') {
+    p++;
+  }
+  return p;
+}
+
 static bool do_json_decode(const char *s, int s_len, int &i, mixed &v) {
   if (!v.is_null()) {
     v.destroy();
@@ -1109,14 +1132,21 @@ static bool do_json_decode(const char *s, int s_len, int &i, mixed &v) {
     case '"': {
       int j = i + 1;
       int slashes = 0;
-      while (j < s_len && s[j] != '"') {
-        if (s[j] == '\\') {
-          slashes++;
-          j++;
+      while (j < s_len) {
+        j = static_cast<int>(json_find_quote_or_backslash(s + j, s + s_len) - s);
+        if (j >= s_len || s[j] == '"') {
+          break;
         }
-        j++;
+        slashes++;
+        j += 2;
       }
       if (j < s_len) {
+        if (slashes == 0) {
+          // most strings have no escapes: take the bytes as is
+          new(&v) mixed(string(s + i + 1, static_cast<string::size_type>(j - i - 1)));
+          i = j + 1;
+          return true;
+        }
         int len = j - i - 1 - slashes;
 
         string value(len, false);
@@ -1235,7 +1265,7 @@ static bool do_json_decode(const char *s, int s_len, int &i, mixed &v) {
           if (!do_json_decode(s, s_len, i, value)) {
             return false;
           }
-          res.push_back(value);
+          res.push_back(std::move(value));
           json_skip_blanks(s, i);
         } while (s[i++] == ',');
 
@@ -1547,12 +1577,12 @@ void f$kphp_set_context_on_error(const array<mixed> &tags, const array<mixed> &e
   auto &context = KphpErrorContext::get();
   static_SB.clean();
 
-  if (do_json_encode(tags, 0, false)) {
+  if (do_json_encode(static_SB, tags, 0, false)) {
     context.set_tags(static_SB.c_str(), static_SB.size());
   }
   static_SB.clean();
 
-  if (do_json_encode(extra_info, 0, false)) {
+  if (do_json_encode(static_SB, extra_info, 0, false)) {
     context.set_extra_info(static_SB.c_str(), static_SB.size());
   }
   static_SB.clean();
@@ -48,8 +48,12 @@ constexpr int64_t JSON_FORCE_OBJECT = 16;
 constexpr int64_t JSON_PARTIAL_OUTPUT_ON_ERROR = 512;
 constexpr int64_t JSON_AVAILABLE_OPTIONS = JSON_UNESCAPED_UNICODE | JSON_FORCE_OBJECT | JSON_PARTIAL_OUTPUT_ON_ERROR;
 
+bool do_json_encode(string_buffer &sb, const mixed &v, int64_t options, bool simple_encode);
+
 Optional<string> f$json_encode(const mixed &v, int64_t options = 0, bool simple_encode = false);
 
+bool f$json_encode_print(const mixed &v, int64_t options = 0);
+
 string f$vk_json_encode_safe(const mixed &v, bool simple_encode = true);
 
 mixed f$json_decode(const string &v, bool assoc = false);
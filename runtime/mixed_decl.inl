@@ -224,6 +224,10 @@ private:
   static T &empty_value() noexcept;
 
   type type_{type::NUL};
+  // a single machine word: scalars live in place, STRING and ARRAY hold the buffer pointer of the
+  // corresponding refcounted class; there is deliberately no inline small-string storage here —
+  // as_string() hands out a string& whose copy-on-write header must precede the character data,
+  // and array<mixed> relocates its cells, which would invalidate in-place bytes
   uint64_t storage_{0};
 };
 
@@ -0,0 +1,308 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/msgpack-cursor.h"
+
+#include <cstring>
+
+#include "runtime/msgpack-serialization.h"
+
+namespace {
+
+uint64_t read_be(const unsigned char *p, uint32_t bytes) {
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < bytes; i++) {
+    value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+// end offset of the packed element starting at pos, 0 on malformed or
+// truncated data; containers are walked with an element budget instead of
+// recursion, their bodies are never decoded
+size_t skip_element(const unsigned char *data, size_t size, size_t pos) {
+  uint64_t todo = 1;
+  while (todo > 0) {
+    if (pos >= size) {
+      return 0;
+    }
+    todo--;
+    const unsigned char b = data[pos++];
+    if (b <= 0x7f || b >= 0xe0) {// fixint
+      continue;
+    }
+    if (b <= 0x8f) {// fixmap
+      todo += 2ull * (b & 0x0f);
+      continue;
+    }
+    if (b <= 0x9f) {// fixarray
+      todo += b & 0x0f;
+      continue;
+    }
+    if (b <= 0xbf) {// fixstr
+      pos += b & 0x1f;
+      continue;
+    }
+    switch (b) {
+      case 0xc0:// nil
+      case 0xc2:// false
+      case 0xc3:// true
+        break;
+      case 0xc4:// bin 8/16/32
+      case 0xc5:
+      case 0xc6: {
+        const uint32_t len_bytes = 1u << (b - 0xc4);
+        if (pos + len_bytes > size) {
+          return 0;
+        }
+        pos += len_bytes + read_be(data + pos, len_bytes);
+        break;
+      }
+      case 0xc7:// ext 8/16/32
+      case 0xc8:
+      case 0xc9: {
+        const uint32_t len_bytes = 1u << (b - 0xc7);
+        if (pos + len_bytes > size) {
+          return 0;
+        }
+        pos += len_bytes + 1 + read_be(data + pos, len_bytes);
+        break;
+      }
+      case 0xca:// float 32
+        pos += 4;
+        break;
+      case 0xcb:// float 64
+        pos += 8;
+        break;
+      case 0xcc:// uint 8/16/32/64
+      case 0xcd:
+      case 0xce:
+      case 0xcf:
+        pos += 1u << (b - 0xcc);
+        break;
+      case 0xd0:// int 8/16/32/64
+      case 0xd1:
+      case 0xd2:
+      case 0xd3:
+        pos += 1u << (b - 0xd0);
+        break;
+      case 0xd4:// fixext 1/2/4/8/16
+      case 0xd5:
+      case 0xd6:
+      case 0xd7:
+      case 0xd8:
+        pos += 1 + (1u << (b - 0xd4));
+        break;
+      case 0xd9:// str 8/16/32
+      case 0xda:
+      case 0xdb: {
+        const uint32_t len_bytes = 1u << (b - 0xd9);
+        if (pos + len_bytes > size) {
+          return 0;
+        }
+        pos += len_bytes + read_be(data + pos, len_bytes);
+        break;
+      }
+      case 0xdc:// array 16/32
+      case 0xdd: {
+        const uint32_t len_bytes = 2u << (b - 0xdc);
+        if (pos + len_bytes > size) {
+          return 0;
+        }
+        todo += read_be(data + pos, len_bytes);
+        pos += len_bytes;
+        break;
+      }
+      case 0xde:// map 16/32
+      case 0xdf: {
+        const uint32_t len_bytes = 2u << (b - 0xde);
+        if (pos + len_bytes > size) {
+          return 0;
+        }
+        todo += 2 * read_be(data + pos, len_bytes);
+        pos += len_bytes;
+        break;
+      }
+      default:// 0xc1 is never a valid format byte
+        return 0;
+    }
+  }
+  return pos <= size ? pos : 0;
+}
+
+// container header at pos: element count and the offset of the first child;
+// false if the element is not an array (want_map == false) or map
+bool read_container_header(const unsigned char *data, size_t pos, bool want_map, uint64_t *count, size_t *body) {
+  const unsigned char b = data[pos];
+  if (!want_map) {
+    if (b >= 0x90 && b <= 0x9f) {
+      *count = b & 0x0f;
+      *body = pos + 1;
+      return true;
+    }
+    if (b == 0xdc || b == 0xdd) {
+      const uint32_t len_bytes = 2u << (b - 0xdc);
+      *count = read_be(data + pos + 1, len_bytes);
+      *body = pos + 1 + len_bytes;
+      return true;
+    }
+    return false;
+  }
+  if (b >= 0x80 && b <= 0x8f) {
+    *count = b & 0x0f;
+    *body = pos + 1;
+    return true;
+  }
+  if (b == 0xde || b == 0xdf) {
+    const uint32_t len_bytes = 2u << (b - 0xde);
+    *count = read_be(data + pos + 1, len_bytes);
+    *body = pos + 1 + len_bytes;
+    return true;
+  }
+  return false;
+}
+
+// compares the packed key element at [pos, end) against a php key without
+// materializing it; non int/str packed keys never match
+bool key_matches(const unsigned char *data, size_t pos, size_t end, const mixed &key) {
+  const unsigned char b = data[pos];
+  if (key.is_string()) {
+    const string &s = key.as_string();
+    size_t len = 0;
+    size_t body = 0;
+    if (b >= 0xa0 && b <= 0xbf) {
+      len = b & 0x1f;
+      body = pos + 1;
+    } else if (b >= 0xd9 && b <= 0xdb) {
+      const uint32_t len_bytes = 1u << (b - 0xd9);
+      len = read_be(data + pos + 1, len_bytes);
+      body = pos + 1 + len_bytes;
+    } else {
+      return false;
+    }
+    return body + len == end && len == s.size() && memcmp(data + body, s.c_str(), len) == 0;
+  }
+  if (key.is_int()) {
+    const int64_t k = key.as_int();
+    if (b <= 0x7f) {
+      return k == b;
+    }
+    if (b >= 0xe0) {
+      return k == static_cast<int8_t>(b);
+    }
+    if (b >= 0xcc && b <= 0xcf) {
+      const uint64_t v = read_be(data + pos + 1, 1u << (b - 0xcc));
+      return k >= 0 && static_cast<uint64_t>(k) == v;
+    }
+    if (b >= 0xd0 && b <= 0xd3) {
+      const uint32_t bytes = 1u << (b - 0xd0);
+      uint64_t v = read_be(data + pos + 1, bytes);
+      if (bytes < 8 && (v & (1ull << (bytes * 8 - 1)))) {
+        v |= ~0ull << (bytes * 8);// sign extension
+      }
+      return k == static_cast<int64_t>(v);
+    }
+  }
+  return false;
+}
+
+class_instance<C$MsgPackCursor> make_cursor(const string &buffer, size_t offset, size_t size) {
+  auto cursor = make_instance<C$MsgPackCursor>();
+  cursor.get()->buffer = buffer;
+  cursor.get()->offset = static_cast<string::size_type>(offset);
+  cursor.get()->size = static_cast<string::size_type>(size);
+  return cursor;
+}
+
+} // namespace
+
+class_instance<C$MsgPackCursor> f$msgpack_cursor(const string &packed) {
+  if (packed.empty()) {
+    return {};
+  }
+  // one allocation-free validating walk up front, navigation trusts the bytes after it
+  const auto *data = reinterpret_cast<const unsigned char *>(packed.c_str());
+  if (skip_element(data, packed.size(), 0) != packed.size()) {
+    php_warning("msgpack_cursor: malformed or truncated msgpack data");
+    return {};
+  }
+  return make_cursor(packed, 0, packed.size());
+}
+
+class_instance<C$MsgPackCursor> f$msgpack_cursor_get(const class_instance<C$MsgPackCursor> &cursor, const mixed &key) {
+  if (cursor.is_null()) {
+    return {};
+  }
+  const auto *c = cursor.get();
+  const auto *data = reinterpret_cast<const unsigned char *>(c->buffer.c_str());
+  const size_t end = c->offset + c->size;
+
+  uint64_t count = 0;
+  size_t pos = 0;
+  if (read_container_header(data, c->offset, false, &count, &pos)) {
+    if (!key.is_int() || key.as_int() < 0 || static_cast<uint64_t>(key.as_int()) >= count) {
+      return {};
+    }
+    for (int64_t i = key.as_int(); i > 0; i--) {
+      pos = skip_element(data, end, pos);
+    }
+    const size_t elem_end = skip_element(data, end, pos);
+    return elem_end != 0 ? make_cursor(c->buffer, pos, elem_end - pos) : class_instance<C$MsgPackCursor>{};
+  }
+
+  if (read_container_header(data, c->offset, true, &count, &pos)) {
+    for (uint64_t i = 0; i < count; i++) {
+      const size_t key_end = skip_element(data, end, pos);
+      if (key_end == 0) {
+        return {};
+      }
+      const size_t value_end = skip_element(data, end, key_end);
+      if (value_end == 0) {
+        return {};
+      }
+      if (key_matches(data, pos, key_end, key)) {
+        return make_cursor(c->buffer, key_end, value_end - key_end);
+      }
+      pos = value_end;
+    }
+  }
+  return {};
+}
+
+mixed f$msgpack_cursor_value(const class_instance<C$MsgPackCursor> &cursor) {
+  if (cursor.is_null()) {
+    return {};
+  }
+  const auto *c = cursor.get();
+  if (c->offset == 0 && c->size == c->buffer.size()) {
+    return f$msgpack_deserialize(c->buffer);
+  }
+  // a subtree is a valid standalone packed element, only it gets decoded
+  return f$msgpack_deserialize(string(c->buffer.c_str() + c->offset, c->size));
+}
+
+string f$msgpack_cursor_raw(const class_instance<C$MsgPackCursor> &cursor) {
+  if (cursor.is_null()) {
+    return {};
+  }
+  const auto *c = cursor.get();
+  if (c->offset == 0 && c->size == c->buffer.size()) {
+    return c->buffer;
+  }
+  return {c->buffer.c_str() + c->offset, c->size};
+}
+
+Optional<int64_t> f$msgpack_cursor_count(const class_instance<C$MsgPackCursor> &cursor) {
+  if (cursor.is_null()) {
+    return false;
+  }
+  const auto *c = cursor.get();
+  const auto *data = reinterpret_cast<const unsigned char *>(c->buffer.c_str());
+  uint64_t count = 0;
+  size_t body = 0;
+  if (read_container_header(data, c->offset, false, &count, &body) || read_container_header(data, c->offset, true, &count, &body)) {
+    return static_cast<int64_t>(count);
+  }
+  return false;
+}
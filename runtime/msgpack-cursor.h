@@ -0,0 +1,31 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include "runtime/kphp_core.h"
+#include "runtime/memory_usage.h"
+#include "runtime/refcountable_php_classes.h"
+
+// A lazy view into a msgpack-packed buffer: navigation skips over elements
+// without materializing them, so a handler that only routes by an envelope
+// field never pays for decoding the payload blobs. The cursor holds a COW
+// handle onto the whole buffer plus the byte range of its subtree; raw bytes
+// of an untouched subtree can be forwarded as is, they are a valid packed
+// element on their own.
+struct C$MsgPackCursor final : public refcountable_php_classes<C$MsgPackCursor> {
+  string buffer;
+  string::size_type offset{0};
+  string::size_type size{0};
+
+  void accept(InstanceMemoryEstimateVisitor &visitor) {
+    visitor("", buffer);
+  }
+};
+
+class_instance<C$MsgPackCursor> f$msgpack_cursor(const string &packed);
+class_instance<C$MsgPackCursor> f$msgpack_cursor_get(const class_instance<C$MsgPackCursor> &cursor, const mixed &key);
+mixed f$msgpack_cursor_value(const class_instance<C$MsgPackCursor> &cursor);
+string f$msgpack_cursor_raw(const class_instance<C$MsgPackCursor> &cursor);
+Optional<int64_t> f$msgpack_cursor_count(const class_instance<C$MsgPackCursor> &cursor);
@@ -12,6 +12,7 @@
 #include "runtime/exception.h"
 #include "runtime/interface.h"
 #include "runtime/kphp_core.h"
+#include "runtime/shape.h"
 #include "runtime/string_functions.h"
 
 namespace msgpack {
@@ -120,6 +121,44 @@ struct pack<array<T>> {
   }
 };
 
+// shape<...>
+// std::tuple is packed element-wise by msgpack itself; shapes get the same treatment
+// here: emitted straight from the compile-time field list as a fixed map of
+// field-name-hash tag => value, no intermediate array is built on either side
+template<size_t ...Is, typename ...T>
+struct convert<shape<std::index_sequence<Is...>, T...>> {
+  const msgpack::object &operator()(const msgpack::object &obj, shape<std::index_sequence<Is...>, T...> &res) const {
+    if (obj.type != msgpack::type::MAP) {
+      throw msgpack::type_error();
+    }
+    for (size_t i = 0; i < obj.via.map.size; ++i) {
+      const auto tag = obj.via.map.ptr[i].key.as<uint64_t>();
+      const auto &elem = obj.via.map.ptr[i].val;
+      //unknown tags are skipped, same as unknown field tags in instance unpacking
+      std::initializer_list<int>{(convert_field<Is>(tag, elem, res), 0)...};
+    }
+    return obj;
+  }
+
+private:
+  template<size_t tag, typename ShapeT>
+  static void convert_field(uint64_t packed_tag, const msgpack::object &elem, ShapeT &res) {
+    if (packed_tag == tag) {
+      elem.convert(res.template get<tag>());
+    }
+  }
+};
+
+template<size_t ...Is, typename ...T>
+struct pack<shape<std::index_sequence<Is...>, T...>> {
+  template <typename Stream>
+  packer<Stream> &operator()(msgpack::packer<Stream> &packer, const shape<std::index_sequence<Is...>, T...> &s) const noexcept {
+    packer.pack_map(static_cast<uint32_t>(sizeof...(Is)));
+    std::initializer_list<int>{(packer.pack(static_cast<uint64_t>(Is)), packer.pack(s.template get<Is>()), 0)...};
+    return packer;
+  }
+};
+
 // mixed
  template<>
  struct convert<mixed> {
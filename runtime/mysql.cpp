@@ -225,6 +225,12 @@ static void mysql_query_callback(const char *result_, int result_len) {
 
 static class_instance<C$mysqli> DB_Proxy;
 
+// note on asynchrony: db_run_query() parks the whole script until the sql answer arrives,
+// so other forks can't be scheduled meanwhile (unlike rpc queries, which deliver answers
+// into per-slot net events that the resumable wait machinery consumes).
+// making this path fork-friendly needs the engine to route sql answers through net events
+// too and this parser to keep its state per query instead of the file-scope globals above;
+// until then, send rpc queries before the sql one — their answers are buffered during the wait
 static bool mysql_query(const class_instance<C$mysqli> &db, const string &query) {
   if (query.size() > (1 << 24) - 10) {
     return false;
@@ -4,10 +4,14 @@
 
 #include "runtime/net_events.h"
 
+#include <cstdint>
+
 #include "common/precise-time.h"
 
 #include "runtime/allocator.h"
+#include "runtime/files.h"
 #include "runtime/rpc.h"
+#include "runtime/udp.h"
 #include "server/php-queries.h"
 
 int timeout_convert_to_ms(double timeout) {
@@ -33,6 +37,32 @@ double get_precise_now() {
   return kphp_precise_now;
 }
 
+
+static double request_deadline_time;
+
+void set_request_deadline_time(double deadline) {
+  request_deadline_time = deadline;
+}
+
+double get_request_deadline_time() {
+  return request_deadline_time;
+}
+
+double get_request_deadline_budget() {
+  if (request_deadline_time <= 0) {
+    return MAX_TIMEOUT;
+  }
+  return request_deadline_time - get_precise_now();
+}
+
+double clamp_timeout_to_deadline(double timeout) {
+  const double budget = get_request_deadline_budget();
+  if (timeout <= budget) {
+    return timeout;
+  }
+  return budget > 0.001 ? budget : 0.001;
+}
+
 static bool process_net_event(net_event_t *e) {
   if (e == nullptr) {
     return false;
@@ -42,6 +72,8 @@ static bool process_net_event(net_event_t *e) {
     process_rpc_answer(e->slot_id, e->result, e->result_len);
   } else if (e->type == ne_rpc_error) {
     process_rpc_error(e->slot_id, e->error_code, e->error_message);
+  } else if (e->type == ne_file_io_answer) {
+    process_file_io_answer(e->slot_id, e->file_io_answer);
   } else {
     php_critical_error ("unsupported net event %d", e->type);
   }
@@ -59,7 +91,6 @@ static int process_net_events() {
 
 
 const int MAX_WAKEUP_CALLBACKS_EXP = 3;
-const int EVENT_TIMERS_HEAP_INDEX_MASK = ((1 << (31 - MAX_WAKEUP_CALLBACKS_EXP)) - 1);
 static void (*wakeup_callbacks[1 << MAX_WAKEUP_CALLBACKS_EXP ])(event_timer *timer);
 static int wakeup_callbacks_size;
 
@@ -71,38 +102,72 @@ int register_wakeup_callback(void (*wakeup)(event_timer *timer)) {
   return wakeup_callbacks_size++;
 }
 
-static event_timer **event_timers_heap;
-static int event_timers_heap_size;
-static int event_timers_max_heap_size;
+// hierarchical timing wheel: 256 one-millisecond slots near-term, then four levels
+// of 64 slots each 64x coarser; arming and cancelling a timer are O(1), which matters
+// because almost every rpc and resumable timeout is cancelled before it expires
+const int EVENT_TIMERS_WHEEL_L0_BITS = 8;
+const int EVENT_TIMERS_WHEEL_LEVEL_BITS = 6;
+const int EVENT_TIMERS_WHEEL_LEVELS = 5;
+const int EVENT_TIMERS_WHEEL_SLOTS = (1 << EVENT_TIMERS_WHEEL_L0_BITS) + (EVENT_TIMERS_WHEEL_LEVELS - 1) * (1 << EVENT_TIMERS_WHEEL_LEVEL_BITS);
 
-static inline int event_timer_heap_move_up(double wakeup_time, int i) {
-  while (i > 1) {
-    int j = (i >> 1);
-    if (event_timers_heap[j]->wakeup_time <= wakeup_time) {
-      break;
+static event_timer *event_timers_wheel;//EVENT_TIMERS_WHEEL_SLOTS sentinel list heads
+static int event_timers_count;
+static uint64_t event_timers_now_ms;
+
+static inline uint64_t event_timer_tick(double wakeup_time) {
+  return (uint64_t)(wakeup_time * 1e3);
+}
+
+static inline void event_timer_unlink(event_timer *et) {
+  et->wheel_prev->wheel_next = et->wheel_next;
+  et->wheel_next->wheel_prev = et->wheel_prev;
+}
+
+static inline void event_timer_link(event_timer *slot, event_timer *et) {
+  et->wheel_prev = slot->wheel_prev;
+  et->wheel_next = slot;
+  slot->wheel_prev->wheel_next = et;
+  slot->wheel_prev = et;
+}
+
+static event_timer *event_timers_wheel_slot(uint64_t tick) {
+  const uint64_t delta = tick - event_timers_now_ms;//caller guarantees tick > event_timers_now_ms
+  if (delta < (1ull << EVENT_TIMERS_WHEEL_L0_BITS)) {
+    return &event_timers_wheel[tick & ((1 << EVENT_TIMERS_WHEEL_L0_BITS) - 1)];
+  }
+  int shift = EVENT_TIMERS_WHEEL_L0_BITS;
+  int base = 1 << EVENT_TIMERS_WHEEL_L0_BITS;
+  for (int level = 1;; level++) {
+    if (level == EVENT_TIMERS_WHEEL_LEVELS - 1 || delta < (1ull << (shift + EVENT_TIMERS_WHEEL_LEVEL_BITS))) {
+      return &event_timers_wheel[base + ((tick >> shift) & ((1 << EVENT_TIMERS_WHEEL_LEVEL_BITS) - 1))];
     }
-    event_timers_heap[i] = event_timers_heap[j];
-    event_timers_heap[i]->heap_index ^= i ^ j;
-    i = j;
+    shift += EVENT_TIMERS_WHEEL_LEVEL_BITS;
+    base += 1 << EVENT_TIMERS_WHEEL_LEVEL_BITS;
   }
-  return i;
 }
 
-static inline int event_timer_heap_move_down(double wakeup_time, int i) {
-  int j = 2 * i;
-  while (j <= event_timers_heap_size) {
-    if (j < event_timers_heap_size && event_timers_heap[j]->wakeup_time > event_timers_heap[j + 1]->wakeup_time) {
-      j++;
-    }
-    if (wakeup_time <= event_timers_heap[j]->wakeup_time) {
-      break;
-    }
-    event_timers_heap[i] = event_timers_heap[j];
-    event_timers_heap[i]->heap_index ^= i ^ j;
-    i = j;
-    j <<= 1;
+static void event_timers_wheel_place(event_timer *et) {
+  uint64_t tick = event_timer_tick(et->wakeup_time);
+  if (tick <= event_timers_now_ms) {
+    tick = event_timers_now_ms + 1;//already due: fire on the next tick the wheel crosses
+  }
+  event_timer_link(event_timers_wheel_slot(tick), et);
+}
+
+// at a lower wheel wraparound, reinsert the timers of the current coarse slot:
+// they are now within range of a finer level (or due)
+static void event_timers_wheel_cascade(int level) {
+  const int shift = EVENT_TIMERS_WHEEL_L0_BITS + (level - 1) * EVENT_TIMERS_WHEEL_LEVEL_BITS;
+  const int base = (1 << EVENT_TIMERS_WHEEL_L0_BITS) + (level - 1) * (1 << EVENT_TIMERS_WHEEL_LEVEL_BITS);
+  event_timer *slot = &event_timers_wheel[base + ((event_timers_now_ms >> shift) & ((1 << EVENT_TIMERS_WHEEL_LEVEL_BITS) - 1))];
+
+  event_timer *et = slot->wheel_next;
+  slot->wheel_prev = slot->wheel_next = slot;
+  while (et != slot) {
+    event_timer *next = et->wheel_next;
+    event_timers_wheel_place(et);
+    et = next;
   }
-  return i;
 }
 
 event_timer *allocate_event_timer(double wakeup_time, int wakeup_callback_id, int wakeup_extra) {
@@ -110,53 +175,118 @@ event_timer *allocate_event_timer(double wakeup_time, int wakeup_callback_id, in
   php_assert (0 <= wakeup_callback_id && wakeup_callback_id < wakeup_callbacks_size);
   php_assert (get_precise_now() < wakeup_time);
 
+  et->wakeup_callback_id = wakeup_callback_id;
   et->wakeup_extra = wakeup_extra;
   et->wakeup_time = wakeup_time;
 
-  int i = ++event_timers_heap_size;
-  if (i == event_timers_max_heap_size) {
-    event_timers_heap = static_cast <event_timer **> (dl::reallocate(event_timers_heap, sizeof(event_timer *) * 2 * event_timers_max_heap_size, sizeof(event_timer *) * event_timers_max_heap_size));
-    event_timers_max_heap_size *= 2;
-    if (event_timers_max_heap_size > EVENT_TIMERS_HEAP_INDEX_MASK) {
-      php_critical_error ("maximum number of event timers exceeded");
-    }
+  if (event_timers_count == 0) {
+    //the wheel did not tick while empty, bring it up to date in O(1)
+    event_timers_now_ms = event_timer_tick(get_precise_now());
   }
-  i = event_timer_heap_move_up(et->wakeup_time, i);
-  et->heap_index = i | (wakeup_callback_id << (31 - MAX_WAKEUP_CALLBACKS_EXP));
-  event_timers_heap[i] = et;
+  event_timers_count++;
+  event_timers_wheel_place(et);
   return et;
 }
 
 void remove_event_timer(event_timer *et) {
-  int i = (et->heap_index & EVENT_TIMERS_HEAP_INDEX_MASK);
-  php_assert (i > 0 && i <= event_timers_heap_size && event_timers_heap[i] == et);
-  et->heap_index = 0;//TODO remove after testing
+  php_assert (event_timers_count > 0);
+  event_timer_unlink(et);
+  event_timers_count--;
   dl::deallocate(et, sizeof(event_timer));
-
-  et = event_timers_heap[event_timers_heap_size--];
-  if (i > event_timers_heap_size) {
-    return;
-  }
-
-  i = event_timer_heap_move_up(et->wakeup_time, i);
-  i = event_timer_heap_move_down(et->wakeup_time, i);
-  et->heap_index &= ~EVENT_TIMERS_HEAP_INDEX_MASK;
-  et->heap_index |= i;
-  event_timers_heap[i] = et;
 }
 
 int remove_expired_event_timers() {
   int expired_events = 0;
-  while (event_timers_heap_size > 0 && event_timers_heap[1]->wakeup_time <= get_precise_now()) {
-    event_timer *et = event_timers_heap[1];
-    wakeup_callbacks[et->heap_index >> (31 - MAX_WAKEUP_CALLBACKS_EXP)](et);
-    expired_events++;
+  const uint64_t now_ms = event_timer_tick(get_precise_now());
+  if (event_timers_count == 0) {
+    event_timers_now_ms = now_ms;
+    return 0;
+  }
+
+  while (event_timers_now_ms < now_ms) {
+    event_timers_now_ms++;
+    if ((event_timers_now_ms & ((1 << EVENT_TIMERS_WHEEL_L0_BITS) - 1)) == 0) {
+      int shift = EVENT_TIMERS_WHEEL_L0_BITS;
+      for (int level = 1; level < EVENT_TIMERS_WHEEL_LEVELS; level++) {
+        event_timers_wheel_cascade(level);
+        shift += EVENT_TIMERS_WHEEL_LEVEL_BITS;
+        if (event_timers_now_ms & ((1ull << shift) - 1)) {
+          break;
+        }
+      }
+    }
+
+    event_timer *slot = &event_timers_wheel[event_timers_now_ms & ((1 << EVENT_TIMERS_WHEEL_L0_BITS) - 1)];
+    while (slot->wheel_next != slot) {
+      event_timer *et = slot->wheel_next;
+      wakeup_callbacks[et->wakeup_callback_id](et);//the callback removes et
+      expired_events++;
+    }
+
+    if (event_timers_count == 0) {
+      event_timers_now_ms = now_ms;//nothing left to expire or cascade
+      break;
+    }
   }
   return expired_events;
 }
 
+// lower bound in ms on the next moment a timer can fire: exact for the ms level,
+// the next cascade boundary for coarser levels; may be early, never late
+static int event_timers_wakeup_bound_ms() {
+  const uint64_t now = event_timers_now_ms;
+  uint64_t bound = MAX_TIMEOUT_MS;
+
+  for (uint64_t d = 1; d < (1 << EVENT_TIMERS_WHEEL_L0_BITS) && d < bound; d++) {
+    const event_timer *slot = &event_timers_wheel[(now + d) & ((1 << EVENT_TIMERS_WHEEL_L0_BITS) - 1)];
+    if (slot->wheel_next != slot) {
+      bound = d;
+      break;
+    }
+  }
+
+  int shift = EVENT_TIMERS_WHEEL_L0_BITS;
+  int base = 1 << EVENT_TIMERS_WHEEL_L0_BITS;
+  for (int level = 1; level < EVENT_TIMERS_WHEEL_LEVELS; level++) {
+    const uint64_t cur = now >> shift;
+    for (uint64_t d = 1; d <= (1 << EVENT_TIMERS_WHEEL_LEVEL_BITS); d++) {
+      const event_timer *slot = &event_timers_wheel[base + ((cur + d) & ((1 << EVENT_TIMERS_WHEEL_LEVEL_BITS) - 1))];
+      if (slot->wheel_next != slot) {
+        const uint64_t cascade_at = (cur + d) << shift;
+        if (cascade_at - now < bound) {
+          bound = cascade_at - now;
+        }
+        break;
+      }
+    }
+    shift += EVENT_TIMERS_WHEEL_LEVEL_BITS;
+    base += 1 << EVENT_TIMERS_WHEEL_LEVEL_BITS;
+  }
+
+  return (int)(bound < MAX_TIMEOUT_MS ? bound : MAX_TIMEOUT_MS);
+}
+
+// a timer is guaranteed to expire once the wheel catches up to now_ms:
+// only the ms level is checked, so a true result is reliable and a false one conservative
+static bool event_timer_fires_by(uint64_t now_ms) {
+  uint64_t reach = now_ms - event_timers_now_ms;
+  if (reach >= (1 << EVENT_TIMERS_WHEEL_L0_BITS)) {
+    reach = (1 << EVENT_TIMERS_WHEEL_L0_BITS) - 1;//ms level slots only hold timers of the current revolution
+  }
+  for (uint64_t d = 1; d <= reach; d++) {
+    const event_timer *slot = &event_timers_wheel[(event_timers_now_ms + d) & ((1 << EVENT_TIMERS_WHEEL_L0_BITS) - 1)];
+    if (slot->wheel_next != slot) {
+      return true;
+    }
+  }
+  return false;
+}
+
 
 int wait_net(int timeout_ms) {
+  //the worker is about to block, queued datagrams must leave now
+  flush_pending_udp_messages();
+
   bool some_expires = false;//TODO remove assert
   double begin_time = get_precise_now();
   double expire_event_time = 0.0;
@@ -164,13 +294,17 @@ int wait_net(int timeout_ms) {
   int finished_events = process_net_events();
   if (finished_events) {
     timeout_ms = 0;
-  } else {
-    if (event_timers_heap_size > 0 && event_timers_heap[1]->wakeup_time <= get_precise_now() + timeout_ms * 0.001) {
-      if (timeout_ms > 0) {
-        timeout_ms = timeout_convert_to_ms(event_timers_heap[1]->wakeup_time - get_precise_now());
-      }
+  } else if (event_timers_count > 0) {
+    const uint64_t now_ms = event_timer_tick(get_precise_now());
+    const uint64_t bound_ms = event_timers_now_ms + event_timers_wakeup_bound_ms();
+    if (timeout_ms > 0 && bound_ms < now_ms + timeout_ms) {
+      timeout_ms = bound_ms > now_ms ? (int)(bound_ms - now_ms) : 1;
+    }
+    //the bound may legitimately wake us early (cascade boundary), so only a timer
+    //certain to fire within the wait window can demand finished events afterwards
+    if (event_timer_fires_by(now_ms + timeout_ms)) {
       some_expires = true;
-      expire_event_time = event_timers_heap[1]->wakeup_time;
+      expire_event_time = (now_ms + timeout_ms) * 0.001;
     }
   }
 
@@ -191,9 +325,12 @@ int wait_net(int timeout_ms) {
 }
 
 void init_net_events_lib() {
-  event_timers_heap_size = 0;
-  event_timers_max_heap_size = 1023;
-  event_timers_heap = static_cast <event_timer **> (dl::allocate(sizeof(event_timer *) * event_timers_max_heap_size));
+  event_timers_count = 0;
+  event_timers_wheel = static_cast <event_timer *> (dl::allocate(sizeof(event_timer) * EVENT_TIMERS_WHEEL_SLOTS));
+  for (int i = 0; i < EVENT_TIMERS_WHEEL_SLOTS; i++) {
+    event_timers_wheel[i].wheel_prev = event_timers_wheel[i].wheel_next = &event_timers_wheel[i];
+  }
 
   update_precise_now();
+  event_timers_now_ms = event_timer_tick(get_precise_now());
 }
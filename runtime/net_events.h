@@ -15,8 +15,26 @@ void update_precise_now();
 double get_precise_now();
 
 
+// Request-scoped deadline: the engine stamps every request with the absolute
+// moment (get_precise_now() clock) its client stops waiting, and outgoing
+// query timeouts are clamped to the remaining budget, so downstream queries
+// expire together with the request instead of running on after the client
+// gave up; 0 means no deadline (console mode, warmup)
+void set_request_deadline_time(double deadline);
+double get_request_deadline_time();
+
+// seconds left until the deadline, MAX_TIMEOUT when no deadline is set
+double get_request_deadline_budget();
+
+// min(timeout, remaining budget), at least 1ms so the query still gets a
+// valid timer and fails through the usual timeout path
+double clamp_timeout_to_deadline(double timeout);
+
+
 struct event_timer {
-  int heap_index;
+  event_timer *wheel_prev; // intrusive timing wheel slot list
+  event_timer *wheel_next;
+  int wakeup_callback_id;
   int wakeup_extra;
   double wakeup_time;
 };
@@ -81,6 +81,94 @@ string f$hash(const string &algo, const string &s, bool raw_output) {
   php_critical_error ("algo %s not supported in function hash", algo.c_str());
 }
 
+// batch counterpart of hash() for the signing paths that digest thousands of short
+// strings per request: the algorithm is dispatched once for the whole batch and the
+// results land in one preallocated array, keys preserved. OpenSSL already routes
+// SHA1/SHA256 to the fastest SIMD/SHA-NI implementation for the host cpu, so per-call
+// dispatch and allocation overhead, not digest throughput, is what the batch form removes
+array<string> f$hash_batch(const string &algo, const array<string> &strings, bool raw_output) {
+  unsigned char *(*one_shot_digest)(const unsigned char *, size_t, unsigned char *) = nullptr;
+  int hash_len = 0;
+  if (!strcmp(algo.c_str(), "sha1")) {
+    one_shot_digest = SHA1;
+    hash_len = 20;
+  } else if (!strcmp(algo.c_str(), "sha256")) {
+    one_shot_digest = SHA256;
+    hash_len = 32;
+  } else if (!strcmp(algo.c_str(), "md5")) {
+    one_shot_digest = MD5;
+    hash_len = 16;
+  } else {
+    php_critical_error ("algo %s not supported in function hash_batch", algo.c_str());
+  }
+
+  array<string> result(strings.size());
+  for (const auto &it : strings) {
+    const string &s = it.get_value();
+    string res;
+    if (raw_output) {
+      res.assign(hash_len, false);
+    } else {
+      res.assign(hash_len * 2, false);
+    }
+
+    one_shot_digest(reinterpret_cast <const unsigned char *> (s.c_str()), (unsigned long)s.size(), reinterpret_cast <unsigned char *> (res.buffer()));
+
+    if (!raw_output) {
+      for (int i = hash_len - 1; i >= 0; i--) {
+        res[2 * i + 1] = lhex_digits[res[i] & 15];
+        res[2 * i] = lhex_digits[(res[i] >> 4) & 15];
+      }
+    }
+    result.set_value(it.get_key(), res);
+  }
+  return result;
+}
+
+// one persistent HMAC context per worker, re-keyed only when the key or digest changes:
+// repeated signing with the same key (the typical pattern) skips the context allocation
+// and the key schedule, HMAC_Init_ex with a null key reuses the cached one
+static HMAC_CTX *acquire_hmac_ctx(const EVP_MD *evp_md, const string &key) {
+  php_assert (dl::in_critical_section > 0);
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+  static HMAC_CTX *ctx = nullptr;
+  if (ctx == nullptr && (ctx = HMAC_CTX_new()) == nullptr) {
+    return nullptr;
+  }
+#else
+  static HMAC_CTX ctx_storage;
+  static bool ctx_inited = false;
+  HMAC_CTX *ctx = &ctx_storage;
+  if (!ctx_inited) {
+    HMAC_CTX_init(ctx);
+    ctx_inited = true;
+  }
+#endif
+  static const EVP_MD *cached_md = nullptr;
+  static char *cached_key = nullptr;
+  static string::size_type cached_key_len = 0;
+
+  const bool same_key = cached_md == evp_md && cached_key != nullptr &&
+                        cached_key_len == key.size() && memcmp(cached_key, key.c_str(), key.size()) == 0;
+  if (same_key) {
+    return HMAC_Init_ex(ctx, nullptr, 0, evp_md, nullptr) == 1 ? ctx : nullptr;
+  }
+  if (HMAC_Init_ex(ctx, key.c_str(), (int)key.size(), evp_md, nullptr) != 1) {
+    cached_md = nullptr;
+    return nullptr;
+  }
+  free(cached_key);
+  cached_key = static_cast<char *>(malloc(key.size()));
+  if (cached_key != nullptr) {
+    memcpy(cached_key, key.c_str(), key.size());
+    cached_key_len = key.size();
+    cached_md = evp_md;
+  } else {
+    cached_md = nullptr;
+  }
+  return ctx;
+}
+
 string f$hash_hmac(const string &algo, const string &data, const string &key, bool raw_output) {
   const EVP_MD *evp_md = nullptr;
   string::size_type hash_len = 0;
@@ -100,11 +188,14 @@ string f$hash_hmac(const string &algo, const string &data, const string &key, bo
       res.assign(hash_len * 2, false);
     }
 
-    unsigned int md_len;
-    HMAC(evp_md, static_cast <const void *> (key.c_str()), (int)key.size(),
-         reinterpret_cast <const unsigned char *> (data.c_str()), (int)data.size(),
-         reinterpret_cast <unsigned char *> (res.buffer()), &md_len);
-    php_assert (md_len == hash_len);
+    unsigned int md_len = 0;
+    dl::enter_critical_section();//OK
+    HMAC_CTX *ctx = acquire_hmac_ctx(evp_md, key);
+    const bool ok = ctx != nullptr &&
+                    HMAC_Update(ctx, reinterpret_cast <const unsigned char *> (data.c_str()), data.size()) == 1 &&
+                    HMAC_Final(ctx, reinterpret_cast <unsigned char *> (res.buffer()), &md_len) == 1;
+    dl::leave_critical_section();
+    php_assert (ok && md_len == hash_len);
 
     if (!raw_output) {
       for (int i = hash_len - 1; i >= 0; i--) {
@@ -119,6 +210,53 @@ string f$hash_hmac(const string &algo, const string &data, const string &key, bo
   return string();
 }
 
+// batch counterpart of hash_hmac() for URL signing: the key schedule is set up once
+// in the cached per-worker context and every further string only pays for the digest
+array<string> f$hash_hmac_batch(const string &algo, const array<string> &data, const string &key, bool raw_output) {
+  const EVP_MD *evp_md = nullptr;
+  string::size_type hash_len = 0;
+  if (!strcmp(algo.c_str(), "sha1")) {
+    evp_md = EVP_sha1();
+    hash_len = 20;
+  } else if (!strcmp(algo.c_str(), "sha256")) {
+    evp_md = EVP_sha256();
+    hash_len = 32;
+  }
+  if (evp_md == nullptr) {
+    php_critical_error ("unsupported algo = \"%s\" in function hash_hmac_batch", algo.c_str());
+    return {};
+  }
+
+  array<string> result(data.size());
+  for (const auto &it : data) {
+    const string &s = it.get_value();
+    string res;
+    if (raw_output) {
+      res.assign(hash_len, false);
+    } else {
+      res.assign(hash_len * 2, false);
+    }
+
+    unsigned int md_len = 0;
+    dl::enter_critical_section();//OK
+    HMAC_CTX *ctx = acquire_hmac_ctx(evp_md, key);
+    const bool ok = ctx != nullptr &&
+                    HMAC_Update(ctx, reinterpret_cast <const unsigned char *> (s.c_str()), s.size()) == 1 &&
+                    HMAC_Final(ctx, reinterpret_cast <unsigned char *> (res.buffer()), &md_len) == 1;
+    dl::leave_critical_section();
+    php_assert (ok && md_len == hash_len);
+
+    if (!raw_output) {
+      for (int i = hash_len - 1; i >= 0; i--) {
+        res[2 * i + 1] = lhex_digits[res[i] & 15];
+        res[2 * i] = lhex_digits[(res[i] >> 4) & 15];
+      }
+    }
+    result.set_value(it.get_key(), res);
+  }
+  return result;
+}
+
 string f$sha1(const string &s, bool raw_output) {
   string res;
   if (raw_output) {
@@ -645,6 +783,36 @@ struct ssl_connection {
   SSL_CTX *ssl_ctx;
 };
 
+// worker-local cache of the most recent TLS session per host:port, kept on heap memory and
+// reused across requests: offering the ticket on reconnect skips the full handshake round-trips.
+// a false hit after a hash collision is harmless — the server just falls back to a full handshake
+struct cached_tls_session {
+  uint64_t key_hash;
+  SSL_SESSION *session;
+};
+static constexpr size_t TLS_SESSION_CACHE_SIZE = 256; // power of two
+static cached_tls_session tls_session_cache[TLS_SESSION_CACHE_SIZE];
+
+static uint64_t tls_session_key_hash(const string &host, int64_t port) {
+  return static_cast<uint64_t>(string_hash(host.c_str(), host.size())) * 0x10001u + static_cast<uint64_t>(port) + 1;
+}
+
+static SSL_SESSION *get_cached_tls_session(uint64_t key_hash) {
+  php_assert (dl::in_critical_section > 0);
+  const cached_tls_session &slot = tls_session_cache[key_hash & (TLS_SESSION_CACHE_SIZE - 1)];
+  return slot.key_hash == key_hash ? slot.session : nullptr;
+}
+
+static void store_cached_tls_session(uint64_t key_hash, SSL_SESSION *session) {
+  php_assert (dl::in_critical_section > 0);
+  cached_tls_session &slot = tls_session_cache[key_hash & (TLS_SESSION_CACHE_SIZE - 1)];
+  if (slot.session != nullptr) {
+    SSL_SESSION_free(slot.session);
+  }
+  slot.key_hash = key_hash;
+  slot.session = session;
+}
+
 static char ssl_connections_storage[sizeof(array<ssl_connection>)];
 static array<ssl_connection> *ssl_connections = reinterpret_cast <array<ssl_connection> *> (ssl_connections_storage);
 static long long ssl_connections_last_query_num = -1;
@@ -828,6 +996,11 @@ static Stream ssl_stream_socket_client(const string &url, int64_t &error_number,
   SSL_set_tlsext_host_name (ssl_handle, host.c_str());
 #endif
 
+  const uint64_t session_key_hash = tls_session_key_hash(host, port);
+  if (SSL_SESSION *cached_session = get_cached_tls_session(session_key_hash)) {
+    SSL_set_session(ssl_handle, cached_session);
+  }
+
   SSL_set_connect_state(ssl_handle); //TODO remove
 
   while (true) {
@@ -862,6 +1035,10 @@ static Stream ssl_stream_socket_client(const string &url, int64_t &error_number,
     }
   }
 
+  if (SSL_SESSION *established_session = SSL_get1_session(ssl_handle)) {
+    store_cached_tls_session(session_key_hash, established_session);
+  }
+
   php_assert (fcntl(sock, F_SETFL, 0) == 0);
   dl::leave_critical_section();
 
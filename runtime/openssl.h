@@ -27,8 +27,12 @@ bool f$hash_equals(const string &known_string, const string &user_string) noexce
 
 string f$hash(const string &algo, const string &s, bool raw_output = false);
 
+array<string> f$hash_batch(const string &algo, const array<string> &strings, bool raw_output = false);
+
 string f$hash_hmac(const string &algo, const string &data, const string &key, bool raw_output = false);
 
+array<string> f$hash_hmac_batch(const string &algo, const array<string> &data, const string &key, bool raw_output = false);
+
 string f$sha1(const string &s, bool raw_output = false);
 
 string f$md5(const string &s, bool raw_output = false);
@@ -88,6 +88,75 @@ static void print_demangled_adresses(void **buffer, int nptrs, int num_shift, bo
   }
 }
 
+// A warning storm is almost always one or two callsites firing in a loop, and the
+// expensive part of a warning is not the message but the backtrace symbolization
+// behind it. Callsites are identified by the address of the format string (a string
+// literal): within each period a callsite gets its first warnings in full, then
+// message-only with no backtrace, then nothing at all; what was dropped is reported
+// once the period rolls over, so storms degrade into a one-line counter instead of
+// taking the worker down with it.
+enum class warning_verbosity { full, message_only, drop };
+
+class WarningsCallsiteLimiter {
+public:
+  warning_verbosity on_warning(const char *format, int cur_time) noexcept {
+    if (cur_time >= period_start_ + period_) {
+      report_drops();
+      memset(slots_, 0, sizeof(slots_));
+      period_start_ = cur_time;
+    }
+
+    Slot *slot = find_slot(format);
+    if (slot == nullptr) {
+      // all probed slots are taken by other callsites; don't limit what we can't count
+      return warning_verbosity::full;
+    }
+    ++slot->count;
+    if (slot->count <= full_warnings_per_period_) {
+      return warning_verbosity::full;
+    }
+    return slot->count <= messages_per_period_ ? warning_verbosity::message_only : warning_verbosity::drop;
+  }
+
+private:
+  struct Slot {
+    const char *format;
+    int count;
+  };
+
+  Slot *find_slot(const char *format) noexcept {
+    auto hash = reinterpret_cast<uintptr_t>(format) * 0x9E3779B97F4A7C15ull;
+    for (size_t probe = 0; probe < max_probes_; ++probe) {
+      Slot &slot = slots_[(hash + probe) & (table_size_ - 1)];
+      if (slot.format == format) {
+        return &slot;
+      }
+      if (slot.format == nullptr) {
+        slot.format = format;
+        return &slot;
+      }
+    }
+    return nullptr;
+  }
+
+  void report_drops() noexcept {
+    for (const Slot &slot : slots_) {
+      if (slot.format != nullptr && slot.count > messages_per_period_) {
+        fprintf(stderr, "[time=%d] Dropped %d warnings \"%s\"\n", period_start_, slot.count - messages_per_period_, slot.format);
+      }
+    }
+  }
+
+  static constexpr size_t table_size_ = 256; // power of two
+  static constexpr size_t max_probes_ = 8;
+  static constexpr int full_warnings_per_period_ = 10;
+  static constexpr int messages_per_period_ = 100;
+  static constexpr int period_ = 300;
+
+  Slot slots_[table_size_];
+  int period_start_{0};
+};
+
 static void php_warning_impl(bool out_of_memory, int error_type, char const *message, va_list args) {
   if (php_warning_level == 0 || php_disable_warnings) {
     return;
@@ -103,6 +172,7 @@ static void php_warning_impl(bool out_of_memory, int error_type, char const *mes
   static int warnings_printed = 0;
   static int warnings_count_time = 0;
   static int skipped = 0;
+  static WarningsCallsiteLimiter callsite_limiter;
   int cur_time = (int)time(nullptr);
 
   if (cur_time >= warnings_count_time + warnings_time_period) {
@@ -122,6 +192,12 @@ static void php_warning_impl(bool out_of_memory, int error_type, char const *mes
     return;
   }
 
+  const warning_verbosity verbosity = callsite_limiter.on_warning(message, cur_time);
+  if (verbosity == warning_verbosity::drop) {
+    ++skipped;
+    return;
+  }
+
   const bool allocations_allowed = !out_of_memory && !dl::in_critical_section;
   dl::enter_critical_section();//OK
 
@@ -129,7 +205,7 @@ static void php_warning_impl(bool out_of_memory, int error_type, char const *mes
   vsnprintf(buf, BUF_SIZE, message, args);
   fprintf(stderr, "%s\n", buf);
 
-  bool need_stacktrace = php_warning_level >= 1;
+  bool need_stacktrace = php_warning_level >= 1 && verbosity == warning_verbosity::full;
   int nptrs = 0;
   void *buffer[64];
   if (need_stacktrace) {
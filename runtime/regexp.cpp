@@ -312,6 +312,7 @@ void regexp::init(const string &regexp_string, const char *function, const char
       subpattern_names = re->subpattern_names;
 
       pcre_regexp = re->pcre_regexp;
+      pcre_study_extra = re->pcre_study_extra;
       RE2_regexp = re->RE2_regexp;
 
       return;
@@ -332,6 +333,7 @@ void regexp::init(const string &regexp_string, const char *function, const char
     re->subpattern_names = subpattern_names;
 
     re->pcre_regexp = pcre_regexp;
+    re->pcre_study_extra = pcre_study_extra;
     re->RE2_regexp = RE2_regexp;
 
     regexp_cache->set_value(regexp_string, re);
@@ -493,6 +495,21 @@ void regexp::init(const char *regexp_string, int64_t regexp_len, const char *fun
       clean();
       return;
     }
+
+#ifdef PCRE_STUDY_JIT_COMPILE
+    if (use_heap_memory) {
+      // persistent regexps (compile-time constants) are matched for the worker's whole lifetime,
+      // so pay once for studying and JIT compilation; per-request regexps live on script memory
+      // and are recompiled anyway, JIT would only add to that cost
+      const char *study_error = nullptr;
+      pcre_study_extra = pcre_study(pcre_regexp, PCRE_STUDY_JIT_COMPILE, &study_error);
+      if (pcre_study_extra != nullptr) {
+        pcre_study_extra->flags |= PCRE_EXTRA_MATCH_LIMIT | PCRE_EXTRA_MATCH_LIMIT_RECURSION;
+        pcre_study_extra->match_limit = PCRE_BACKTRACK_LIMIT;
+        pcre_study_extra->match_limit_recursion = PCRE_RECURSION_LIMIT;
+      }
+    }
+#endif
   }
 
   //compile has finished
@@ -562,6 +579,13 @@ void regexp::clean() {
   is_utf8 = false;
   use_heap_memory = false;
 
+#ifdef PCRE_STUDY_JIT_COMPILE
+  if (pcre_study_extra != nullptr) {
+    pcre_free_study(pcre_study_extra);
+    pcre_study_extra = nullptr;
+  }
+#endif
+
   if (pcre_regexp != nullptr) {
     pcre_free(pcre_regexp);
     pcre_regexp = nullptr;
@@ -615,7 +639,7 @@ int64_t regexp::exec(const string &subject, int64_t offset, bool second_try) con
 
   int32_t options = second_try ? PCRE_NO_UTF8_CHECK | PCRE_NOTEMPTY_ATSTART : PCRE_NO_UTF8_CHECK;
   dl::enter_critical_section();//OK
-  int64_t count = pcre_exec(pcre_regexp, &extra, subject.c_str(), subject.size(),
+  int64_t count = pcre_exec(pcre_regexp, pcre_study_extra != nullptr ? pcre_study_extra : &extra, subject.c_str(), subject.size(),
                             static_cast<int32_t>(offset), options, submatch, 3 * subpatterns_count);
   dl::leave_critical_section();
 
@@ -50,6 +50,7 @@ private:
   string *subpattern_names{nullptr};
 
   pcre *pcre_regexp{nullptr};
+  pcre_extra *pcre_study_extra{nullptr};
   re2::RE2 *RE2_regexp{nullptr};
 
   char *regex_compilation_warning{nullptr};
@@ -4,9 +4,11 @@
 
 #include "runtime/resumable.h"
 
+#include <algorithm>
 #include <typeinfo>
 
 #include "common/kprintf.h"
+#include "common/precise-time.h"
 
 #include "runtime/net_events.h"
 
@@ -73,6 +75,14 @@ struct forked_resumable_info {
   int64_t son;
   const char *name;
   double running_time;
+  int64_t sched_priority;// > 0 - resumed before normal yielded forks, < 0 - after them, 0 - default
+  double sched_deadline;// get_precise_now() moment after which the fork jumps the yield queue, 0 - none
+  double sched_yield_budget;// sched_yield() suspends only after this many seconds of the current slice, 0 - always
+  double sched_slice_start;// get_interpolated_double_time() moment this fork was last switched in
+  double sched_wait_started;// get_precise_now() moment the fork was put into the yielded queue, 0 - not there
+  double sched_delay_total;
+  double sched_delay_max;
+  int64_t sched_yield_count;
 };
 
 struct started_resumable_info {
@@ -98,8 +108,14 @@ static uint32_t started_resumables_size;
 static int64_t first_free_started_resumable_id;
 
 
+// the ready-list of a queue is intrusive: finished forks are pushed LIFO onto
+// first_finished_function by finish_forked_resumable, chained through the
+// forked_resumable_info::queue_id field of the members (see its encoding above),
+// so wait_queue_next pops in O(1) no matter how many forks are still pending;
+// entries whose result was already fetched are dropped lazily by
+// wait_queue_skip_gotten, each one exactly once
 struct wait_queue {
-  int64_t first_finished_function;
+  int64_t first_finished_function;// -2 - none, x < 0 - (-id) of the top of the finished stack
   int32_t left_functions;
   int64_t resumable_id;//0 - default, x > 0 - id of wait_queue_next resumable, x < 0 - next free queue_id
 };
@@ -113,10 +129,17 @@ static int64_t *finished_resumables;
 static uint32_t finished_resumables_size;
 static uint32_t finished_resumables_count;
 
-static int64_t *yielded_resumables;
-static uint32_t yielded_resumables_l;
-static uint32_t yielded_resumables_r;
-static uint32_t yielded_resumables_size;
+// yielded resumables are kept in one FIFO ring per scheduling class: high-priority
+// forks and forks past their deadline go to ring 0, default ones to ring 1,
+// low-priority ones to ring 2; the scheduler always drains the lowest non-empty ring
+struct yielded_resumables_ring {
+  int64_t *ids;
+  uint32_t l;
+  uint32_t r;
+  uint32_t size;
+};
+
+static yielded_resumables_ring yielded_resumables[3];
 
 bool in_main_thread() {
   return runned_resumable_id == 0;
@@ -160,6 +183,14 @@ Storage *get_forked_storage(int64_t resumable_id) {
   return &get_forked_resumable_info(resumable_id)->output;
 }
 
+Storage *get_forked_storage_if_ready(int64_t resumable_id) {
+  if (!is_forked_resumable_id(resumable_id)) {
+    return nullptr;
+  }
+  forked_resumable_info *resumable = get_forked_resumable_info(resumable_id);
+  return resumable->queue_id < 0 && resumable->output.tag != 0 ? &resumable->output : nullptr;
+}
+
 bool check_started_storage(Storage *storage) {
   return ((void *)started_resumables <= (void *)storage && (void *)storage < (void *)(started_resumables + started_resumables_size));
 }
@@ -198,6 +229,14 @@ int64_t register_forked_resumable(Resumable *resumable) {
   res->queue_id = 0;
   res->son = 0;
   res->running_time = 0;
+  res->sched_priority = 0;
+  res->sched_deadline = 0;
+  res->sched_yield_budget = 0;
+  res->sched_slice_start = 0;
+  res->sched_wait_started = 0;
+  res->sched_delay_total = 0;
+  res->sched_delay_max = 0;
+  res->sched_yield_count = 0;
   res->name = resumable ? typeid(*resumable).name() : "(null)";
 
   return res_id;
@@ -213,7 +252,11 @@ static inline void update_current_resumable_id(int64_t new_id) {
       get_forked_resumable_info(old_running_fork)->running_time += get_precise_now();
     }
     if (new_running_fork) {
-      get_forked_resumable_info(new_running_fork)->running_time -= get_precise_now();
+      forked_resumable_info *fork = get_forked_resumable_info(new_running_fork);
+      fork->running_time -= get_precise_now();
+      if (fork->sched_yield_budget > 0) {
+        fork->sched_slice_start = get_interpolated_double_time();
+      }
     }
   }
   Resumable::update_output();
@@ -257,9 +300,56 @@ Optional<array<mixed>> f$get_fork_stat(int64_t fork_id) {
     running_time += get_precise_now();
   }
   result.set_value(string("work_time"), running_time);
+  result.set_value(string("yields"), info->sched_yield_count);
+  result.set_value(string("sched_delay_total"), info->sched_delay_total);
+  result.set_value(string("sched_delay_max"), info->sched_delay_max);
   return result;
 }
 
+static forked_resumable_info *get_fork_for_scheduling(int64_t fork_id, const char *function) {
+  if (!is_forked_resumable_id(fork_id)) {
+    php_warning("Wrong fork id %ld in function %s", fork_id, function);
+    return nullptr;
+  }
+  forked_resumable_info *info = get_forked_resumable_info(fork_id);
+  if (info->queue_id == -1 && info->output.tag == 0) {
+    return nullptr;// the result was already gotten, there is nothing left to schedule
+  }
+  return info;
+}
+
+bool f$set_fork_priority(int64_t fork_id, int64_t priority) {
+  forked_resumable_info *fork = get_fork_for_scheduling(fork_id, "set_fork_priority");
+  if (!fork) {
+    return false;
+  }
+  // takes effect at the next yield point: a fork already sitting in the yielded
+  // queue is not moved between rings
+  fork->sched_priority = priority;
+  return true;
+}
+
+bool f$set_fork_deadline(int64_t fork_id, double timeout) {
+  forked_resumable_info *fork = get_fork_for_scheduling(fork_id, "set_fork_deadline");
+  if (!fork) {
+    return false;
+  }
+  fork->sched_deadline = timeout > 0 ? timeout + get_precise_now() : 0;
+  return true;
+}
+
+bool f$set_fork_yield_budget(int64_t fork_id, int64_t budget) {
+  forked_resumable_info *fork = get_fork_for_scheduling(fork_id, "set_fork_yield_budget");
+  if (!fork) {
+    return false;
+  }
+  fork->sched_yield_budget = budget > 0 ? static_cast<double>(budget) * 1e-6 : 0;
+  if (fork->sched_yield_budget > 0 && fork_id == f$get_running_fork_id()) {
+    fork->sched_slice_start = get_interpolated_double_time();
+  }
+  return true;
+}
+
 int64_t register_started_resumable(Resumable *resumable) {
   int64_t res_id;
   bool is_new = false;
@@ -407,30 +497,73 @@ void unregister_started_resumable(int64_t resumable_id) {
 }
 
 
+static bool yielded_resumables_empty() {
+  return yielded_resumables[0].l == yielded_resumables[0].r &&
+         yielded_resumables[1].l == yielded_resumables[1].r &&
+         yielded_resumables[2].l == yielded_resumables[2].r;
+}
+
 static bool resumable_has_finished() {
-  return finished_resumables_count > 0 || yielded_resumables_l != yielded_resumables_r;
+  return finished_resumables_count > 0 || !yielded_resumables_empty();
 }
 
-static void yielded_resumables_push(int64_t id) {
-  yielded_resumables[yielded_resumables_r] = id;
-  yielded_resumables_r++;
-  if (yielded_resumables_r == yielded_resumables_size) {
-    yielded_resumables_r = 0;
+static uint32_t fork_sched_class(const forked_resumable_info *fork) {
+  if (fork->sched_deadline > 0 && fork->sched_deadline <= get_precise_now()) {
+    return 0;// past the deadline: jump the queue whatever the priority is
+  }
+  if (fork->sched_priority > 0) {
+    return 0;
   }
-  if (yielded_resumables_r == yielded_resumables_l) {
-    yielded_resumables = static_cast<int64_t *>(dl::reallocate(yielded_resumables, sizeof(int64_t) * 2 * yielded_resumables_size, sizeof(int64_t) * yielded_resumables_size));
-    memcpy(yielded_resumables + yielded_resumables_size, yielded_resumables, sizeof(int64_t) * yielded_resumables_r);
-    yielded_resumables_r += yielded_resumables_size;
-    yielded_resumables_size *= 2;
+  return fork->sched_priority < 0 ? 2 : 1;
+}
+
+static void yielded_resumables_push(int64_t id) {
+  uint32_t sched_class = 1;
+  const int64_t fork_id = get_started_resumable_info(id)->fork_id;
+  if (fork_id) {
+    forked_resumable_info *fork = get_forked_resumable_info(fork_id);
+    sched_class = fork_sched_class(fork);
+    fork->sched_yield_count++;
+    fork->sched_wait_started = get_precise_now();
+  }
+
+  yielded_resumables_ring *ring = &yielded_resumables[sched_class];
+  ring->ids[ring->r] = id;
+  ring->r++;
+  if (ring->r == ring->size) {
+    ring->r = 0;
+  }
+  if (ring->r == ring->l) {
+    ring->ids = static_cast<int64_t *>(dl::reallocate(ring->ids, sizeof(int64_t) * 2 * ring->size, sizeof(int64_t) * ring->size));
+    memcpy(ring->ids + ring->size, ring->ids, sizeof(int64_t) * ring->r);
+    ring->r += ring->size;
+    ring->size *= 2;
   }
 }
 
 static int64_t yielded_resumables_pop() {
-  php_assert (yielded_resumables_l != yielded_resumables_r);
-  int64_t result = yielded_resumables[yielded_resumables_l];
-  yielded_resumables_l++;
-  if (yielded_resumables_l == yielded_resumables_size) {
-    yielded_resumables_l = 0;
+  php_assert (!yielded_resumables_empty());
+  yielded_resumables_ring *ring = &yielded_resumables[0];
+  while (ring->l == ring->r) {
+    ring++;
+  }
+  int64_t result = ring->ids[ring->l];
+  ring->l++;
+  if (ring->l == ring->size) {
+    ring->l = 0;
+  }
+
+  const int64_t fork_id = get_started_resumable_info(result)->fork_id;
+  if (fork_id) {
+    forked_resumable_info *fork = get_forked_resumable_info(fork_id);
+    if (fork->sched_wait_started > 0) {
+      const double delay = get_precise_now() - fork->sched_wait_started;
+      if (delay > 0) {
+        fork->sched_delay_total += delay;
+        fork->sched_delay_max = std::max(fork->sched_delay_max, delay);
+      }
+      fork->sched_wait_started = 0;
+    }
   }
   return result;
 }
@@ -1188,6 +1321,18 @@ void f$sched_yield() {
     return;
   }
 
+  const int64_t fork_id = f$get_running_fork_id();
+  if (fork_id) {
+    forked_resumable_info *fork = get_forked_resumable_info(fork_id);
+    // with a budget set the yield point is almost free until the slice runs out:
+    // precise_now is not advanced by pure CPU work, so the check needs the
+    // cycleclock-interpolated clock
+    if (fork->sched_yield_budget > 0 && get_interpolated_double_time() - fork->sched_slice_start < fork->sched_yield_budget) {
+      resumable_finished = true;
+      return;
+    }
+  }
+
   resumable_finished = false;
 
   int64_t id = register_started_resumable(nullptr);
@@ -1238,9 +1383,11 @@ void init_resumable_lib() {
   finished_resumables_count = 0;
   finished_resumables = static_cast<int64_t *>(dl::allocate(sizeof(int64_t) * finished_resumables_size));
 
-  yielded_resumables_size = 170;
-  yielded_resumables_l = yielded_resumables_r = 0;
-  yielded_resumables = static_cast<int64_t *>(dl::allocate(sizeof(int64_t) * yielded_resumables_size));
+  for (auto &ring : yielded_resumables) {
+    ring.size = 170;
+    ring.l = ring.r = 0;
+    ring.ids = static_cast<int64_t *>(dl::allocate(sizeof(int64_t) * ring.size));
+  }
 
   wait_queues_size = 101;
   wait_queues = static_cast<wait_queue *>(dl::allocate(sizeof(wait_queue) * wait_queues_size));
@@ -114,6 +114,9 @@ Storage *get_started_storage(int64_t resumable_id);
 
 Storage *get_forked_storage(int64_t resumable_id);
 
+// returns the fork's output if it has already finished and the result wasn't claimed yet, nullptr otherwise
+Storage *get_forked_storage_if_ready(int64_t resumable_id);
+
 Resumable *get_forked_resumable(int64_t resumable_id);
 
 int32_t get_resumable_stack(void **buffer, int32_t limit);
@@ -140,6 +143,10 @@ void init_resumable_lib();
 int64_t f$get_running_fork_id();
 Optional<array<mixed>> f$get_fork_stat(int64_t fork_id);
 
+bool f$set_fork_priority(int64_t fork_id, int64_t priority);
+bool f$set_fork_deadline(int64_t fork_id, double timeout);
+bool f$set_fork_yield_budget(int64_t fork_id, int64_t budget);
+
 /*
  *
  *     IMPLEMENTATION
@@ -244,6 +251,14 @@ inline bool wait_result_resumable<void>::run() {
 
 template<typename T>
 T f$wait(int64_t resumable_id) {
+  // fast path for the common linear await chain: the fork has already finished,
+  // so consume its result in place instead of allocating a wait_result_resumable
+  // and driving it through the scheduler
+  if (Storage *output = get_forked_storage_if_ready(resumable_id)) {
+    last_wait_error = nullptr;
+    resumable_finished = true;
+    return output->load_as<T>();
+  }
   return start_resumable<T>(new wait_result_resumable<T>(resumable_id, -1));
 }
 
@@ -4,7 +4,10 @@
 
 #include "runtime/rpc.h"
 
+#include <cmath>
 #include <cstdarg>
+#include <cstdlib>
+#include <cstring>
 
 #include "common/rpc-error-codes.h"
 #include "common/tl/constants/common.h"
@@ -237,6 +240,10 @@ int32_t rpc_fetch_int() {
   return *rpc_data++;
 }
 
+int32_t rpc_remaining_ints() {
+  return rpc_data_len;
+}
+
 int64_t f$fetch_int() {
   return rpc_fetch_int();
 }
@@ -444,6 +451,129 @@ class_instance<C$RpcConnection> f$new_rpc_connection(const string &host_name, in
                                         timeout_convert_to_ms(connect_timeout), timeout_convert_to_ms(reconnect_timeout));
 }
 
+class_instance<C$RpcClusterConnection> f$new_rpc_cluster_connection(const array<string> &hosts, const array<int64_t> &weights, const mixed &default_actor_id,
+                                                                    double timeout, double connect_timeout, double reconnect_timeout) {
+  auto cluster = make_instance<C$RpcClusterConnection>();
+  cluster.get()->default_actor_id = store_parse_number<long long>(default_actor_id);
+  cluster.get()->timeout_ms = timeout_convert_to_ms(timeout);
+  cluster.get()->connect_timeout = timeout_convert_to_ms(connect_timeout);
+  cluster.get()->reconnect_timeout = timeout_convert_to_ms(reconnect_timeout);
+
+  int64_t host_index = 0;
+  for (const auto &it : hosts) {
+    const string &host_port = it.get_value();
+    const char *colon = static_cast<const char *>(memrchr(host_port.c_str(), ':', host_port.size()));
+    if (colon == nullptr) {
+      php_warning("Expected \"host:port\" in new_rpc_cluster_connection, got \"%s\"", host_port.c_str());
+      continue;
+    }
+    const string host_name(host_port.c_str(), static_cast<string::size_type>(colon - host_port.c_str()));
+    const auto port = static_cast<int32_t>(atoi(colon + 1));
+
+    int64_t weight = weights.isset(host_index) ? weights.get_value(host_index) : 1;
+    host_index++;
+    if (weight <= 0) {
+      php_warning("Wrong weight %ld for rpc cluster host \"%s\"", weight, host_port.c_str());
+      weight = 1;
+    }
+
+    // a failed connect leaves the slot without a connection: routing skips it and
+    // retries the connect when the rendezvous hash picks this host again
+    class_instance<C$RpcConnection> conn;
+    const int32_t host_num = rpc_connect_to(host_name.c_str(), port);
+    if (host_num >= 0) {
+      conn = make_instance<C$RpcConnection>(host_num, port, cluster.get()->timeout_ms, cluster.get()->default_actor_id,
+                                            cluster.get()->connect_timeout, cluster.get()->reconnect_timeout);
+    }
+    cluster.get()->hosts.push_back({std::move(conn), host_name, port, static_cast<int32_t>(weight)});
+  }
+
+  if (cluster.get()->hosts.empty()) {
+    php_warning("No valid hosts specified in new_rpc_cluster_connection");
+    return {};
+  }
+  return cluster;
+}
+
+// weighted rendezvous hashing: every worker ranks the hosts for a key identically,
+// and losing a host only remaps the keys that were routed to it
+static double cluster_host_score(const C$RpcClusterConnection::host &host, int64_t key_hash) {
+  uint64_t hash = static_cast<uint64_t>(key_hash) ^ static_cast<uint64_t>(host.host_name.hash()) ^ (static_cast<uint64_t>(host.port) << 32);
+  hash *= 0x9E3779B97F4A7C15ULL;
+  hash ^= hash >> 32;
+  // map to (0, 1]: +1 keeps the argument of log away from zero
+  const double uniform = static_cast<double>((hash >> 11) + 1) * (1.0 / 9007199254740992.0);
+  return -host.weight / std::log(uniform);
+}
+
+// the winner for a key among the hosts not yet excluded on this routing pass
+static int64_t choose_cluster_host(const array<C$RpcClusterConnection::host> &hosts, int64_t key_hash, const array<bool> &excluded) {
+  int64_t best = -1;
+  double best_score = 0;
+  for (int64_t i = 0; i < hosts.count(); i++) {
+    if (!excluded.empty() && excluded.get_value(i)) {
+      continue;
+    }
+    const double score = cluster_host_score(hosts.get_value(i), key_hash);
+    if (best == -1 || score > best_score) {
+      best = i;
+      best_score = score;
+    }
+  }
+  return best;
+}
+
+class_instance<C$RpcConnection> f$rpc_cluster_connection_for_key(const class_instance<C$RpcClusterConnection> &cluster, const string &shard_key) {
+  if (cluster.is_null()) {
+    php_warning("Rpc cluster connection is null in rpc_cluster_connection_for_key");
+    return {};
+  }
+
+  array<C$RpcClusterConnection::host> &hosts = cluster.get()->hosts;
+  const int64_t key_hash = shard_key.hash();
+  array<bool> excluded; // allocated only when the winner is down and failover starts
+
+  for (int64_t attempt = 0; attempt < hosts.count(); attempt++) {
+    const int64_t best = choose_cluster_host(hosts, key_hash, excluded);
+    if (best == -1) {
+      break;
+    }
+
+    C$RpcClusterConnection::host &winner = hosts[best];
+    if (!winner.conn.is_null()) {
+      return winner.conn;
+    }
+    const int32_t host_num = rpc_connect_to(winner.host_name.c_str(), winner.port);
+    if (host_num >= 0) {
+      winner.conn = make_instance<C$RpcConnection>(host_num, winner.port, cluster.get()->timeout_ms, cluster.get()->default_actor_id,
+                                                   cluster.get()->connect_timeout, cluster.get()->reconnect_timeout);
+      return winner.conn;
+    }
+
+    if (excluded.empty()) {
+      excluded = array<bool>(array_size(hosts.count(), 0, true));
+      excluded.fill_vector(hosts.count(), false);
+    }
+    excluded.set_value(best, true);
+  }
+
+  php_warning("All %ld hosts of the rpc cluster are unreachable for shard key \"%s\"", hosts.count(), shard_key.c_str());
+  return {};
+}
+
+array<int64_t> f$rpc_cluster_tl_query(const class_instance<C$RpcClusterConnection> &cluster, const string &shard_key, const array<mixed> &tl_objects,
+                                      double timeout, bool ignore_answer) {
+  const auto conn = f$rpc_cluster_connection_for_key(cluster, shard_key);
+  if (conn.is_null()) {
+    array<int64_t> result(tl_objects.size());
+    for (auto it = tl_objects.begin(); it != tl_objects.end(); ++it) {
+      result.set_value(it.get_key(), -1);
+    }
+    return result;
+  }
+  return f$rpc_tl_query(conn, tl_objects, timeout, ignore_answer);
+}
+
 static string_buffer data_buf;
 static const int data_buf_header_size = 2 * sizeof(long long) + 4 * sizeof(int);
 static const int data_buf_header_reserved_size = sizeof(long long) + sizeof(int);
@@ -803,6 +933,10 @@ public:
   }
 };
 
+// timeouts of the queries sent since the last flush; their slot ids are consecutive
+// (see the php_assert in rpc_send), so this stays a plain vector indexed from
+// rpc_need_timer_first_id, with 0 meaning the query does not need a timer
+static slot_id_t rpc_need_timer_first_id;
 static array<double> rpc_request_need_timer;
 
 static void process_rpc_timeout(int request_id) {
@@ -822,6 +956,8 @@ int64_t rpc_send(const class_instance<C$RpcConnection> &conn, double timeout, bo
   if (timeout <= 0 || timeout > MAX_TIMEOUT) {
     timeout = conn.get()->timeout_ms * 0.001;
   }
+  // a downstream query must not outlive its request
+  timeout = clamp_timeout_to_deadline(timeout);
 
   store_int(-1); // reserve for crc32
   php_assert (data_buf.size() % sizeof(int) == 0);
@@ -880,13 +1016,17 @@ int64_t rpc_send(const class_instance<C$RpcConnection> &conn, double timeout, bo
 
   cur->resumable_id = register_forked_resumable(new rpc_resumable(result, conn.get()->port, conn.get()->default_actor_id));
   cur->timer = nullptr;
+  if (rpc_request_need_timer.empty()) {
+    rpc_need_timer_first_id = result;
+  }
   if (ignore_answer) {
+    rpc_request_need_timer.push_back(0.0); // keep the vector aligned with the consecutive slot ids
     int64_t resumable_id = cur->resumable_id;
     process_rpc_timeout(result);
     get_forked_storage(resumable_id)->load<rpc_request>();
     return resumable_id;
   } else {
-    rpc_request_need_timer.set_value(result, timeout);
+    rpc_request_need_timer.push_back(timeout);
     return cur->resumable_id;
   }
 }
@@ -895,12 +1035,16 @@ void f$rpc_flush() {
   update_precise_now();
   wait_net(0);
   update_precise_now();
-  for (array<double>::iterator iter = rpc_request_need_timer.begin(); iter != rpc_request_need_timer.end(); ++iter) {
-    int32_t id = static_cast<int32_t>(iter.get_key().to_int());
-    rpc_request *cur = get_rpc_request(id);
-    if (cur->resumable_id > 0) {
-      php_assert (cur->timer == nullptr);
-      cur->timer = allocate_event_timer(iter.get_value() + get_precise_now(), timeout_wakeup_id, id);
+  const int64_t queries_sent = rpc_request_need_timer.count();
+  for (int64_t i = 0; i < queries_sent; i++) {
+    const double timeout = rpc_request_need_timer.get_value(i);
+    if (timeout > 0) {
+      slot_id_t id = rpc_need_timer_first_id + static_cast<slot_id_t>(i);
+      rpc_request *cur = get_rpc_request(id);
+      if (cur->resumable_id > 0) {
+        php_assert (cur->timer == nullptr);
+        cur->timer = allocate_event_timer(timeout + get_precise_now(), timeout_wakeup_id, id);
+      }
     }
   }
   rpc_request_need_timer.clear();
@@ -1227,7 +1371,8 @@ class_instance<RpcTlQuery> store_function(const mixed &tl_object) {
     return {};
   }
   string fun_name = tl_arr_get(tl_object, tl_str_underscore, 0).to_string();
-  if (!tl_storers_ht.has_key(fun_name)) {
+  const tl_storer_ptr *untyped_storer = tl_storers_ht.find_value(fun_name);
+  if (untyped_storer == nullptr) {
     CurrentProcessingQuery::get().raise_storing_error("Function \"%s\" not found in tl-scheme", fun_name.c_str());
     return {};
   }
@@ -1235,8 +1380,7 @@ class_instance<RpcTlQuery> store_function(const mixed &tl_object) {
   rpc_query.alloc();
   rpc_query.get()->tl_function_name = fun_name;
   CurrentProcessingQuery::get().set_current_tl_function(fun_name);
-  const auto &untyped_storer = tl_storers_ht.get_value(fun_name);
-  rpc_query.get()->result_fetcher = make_unique_on_script_memory<RpcRequestResultUntyped>(untyped_storer(tl_object));
+  rpc_query.get()->result_fetcher = make_unique_on_script_memory<RpcRequestResultUntyped>((*untyped_storer)(tl_object));
   CurrentProcessingQuery::get().reset();
   return rpc_query;
 }
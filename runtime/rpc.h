@@ -49,6 +49,8 @@ int32_t rpc_lookup_int();
 
 int32_t rpc_fetch_int();
 
+int32_t rpc_remaining_ints();
+
 int64_t f$fetch_int();
 
 int64_t f$fetch_lookup_int();
@@ -116,6 +118,47 @@ struct C$RpcConnection final : public refcountable_php_classes<C$RpcConnection>
 
 class_instance<C$RpcConnection> f$new_rpc_connection(const string &host_name, int64_t port, const mixed &default_actor_id = 0, double timeout = 0.3, double connect_timeout = 0.3, double reconnect_timeout = 17);
 
+// a cluster of rpc targets configured once: per-host pooled connections plus
+// rendezvous-hash shard routing, so userland does not reimplement it with arrays of connections
+struct C$RpcClusterConnection final : public refcountable_php_classes<C$RpcClusterConnection> {
+  class host {
+  public:
+    class_instance<C$RpcConnection> conn;
+    string host_name;
+    int32_t port{-1};
+    int32_t weight{1};
+
+    host() = default;
+    host(class_instance<C$RpcConnection> &&conn, const string &host_name, int32_t port, int32_t weight) :
+      conn(std::move(conn)),
+      host_name(host_name),
+      port(port),
+      weight(weight) {}
+  };
+
+  array<host> hosts{array_size{4, 0, true}};
+  long long default_actor_id{-1};
+  int32_t timeout_ms{-1};
+  int32_t connect_timeout{-1};
+  int32_t reconnect_timeout{-1};
+
+  void accept(InstanceMemoryEstimateVisitor &visitor) {
+    visitor("", hosts);
+  }
+
+  friend inline int64_t f$estimate_memory_usage(const C$RpcClusterConnection::host &h) {
+    return f$estimate_memory_usage(h.conn) + f$estimate_memory_usage(h.host_name);
+  }
+};
+
+class_instance<C$RpcClusterConnection> f$new_rpc_cluster_connection(const array<string> &hosts, const array<int64_t> &weights = {}, const mixed &default_actor_id = 0,
+                                                                    double timeout = 0.3, double connect_timeout = 0.3, double reconnect_timeout = 17);
+
+class_instance<C$RpcConnection> f$rpc_cluster_connection_for_key(const class_instance<C$RpcClusterConnection> &cluster, const string &shard_key);
+
+array<int64_t> f$rpc_cluster_tl_query(const class_instance<C$RpcClusterConnection> &cluster, const string &shard_key, const array<mixed> &tl_objects,
+                                      double timeout = -1.0, bool ignore_answer = false);
+
 void f$store_gzip_pack_threshold(int64_t pack_threshold_bytes);
 
 void f$store_start_gzip_pack();
@@ -216,6 +259,9 @@ int64_t f$rpc_tl_query_one(const class_instance<C$RpcConnection> &c, const mixed
 int64_t f$rpc_tl_pending_queries_count();
 bool f$rpc_mc_parse_raw_wildcard_with_flags_to_array(const string &raw_result, array<mixed> &result);
 
+// batched variant: all queries are serialized back to back and handed to the net layer
+// with a single flush at the end (intermediate flushes happen only on buffer overflow),
+// so a fan-out of N queries to one cluster does not pay N store/flush round-trips
 array<int64_t> f$rpc_tl_query(const class_instance<C$RpcConnection> &c, const array<mixed> &tl_objects, double timeout = -1.0, bool ignore_answer = false);
 
 array<mixed> f$rpc_tl_query_result_one(int64_t query_id);
@@ -0,0 +1,301 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+// microbenchmarks for the runtime primitives every script leans on: array<T>
+// insert/lookup in vector and map mode, string building, string_buffer growth
+// and the script allocator under a production-like allocation-size mix.
+// Every benchmark runs inside a real script memory environment, so the numbers
+// include exactly the allocator behavior generated code sees.
+//
+// Build with -DKPHP_BENCHMARKS=On, run e.g.:
+//   benchmark-runtime --benchmark_filter=BM_array --benchmark_counters_tabular=true
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "common/mixin/not_copyable.h"
+
+#include "runtime/allocator.h"
+#include "runtime/interface.h"
+#include "runtime/kphp_core.h"
+#include "runtime/storage.h"
+#include "runtime/tl/rpc_response.h"
+#include "server/php-engine-vars.h"
+
+namespace {
+
+std::array<uint8_t, 256 * 1024 * 1024> script_memory;
+
+// scoped script environment: benchmarks allocate through the real script
+// allocator and everything is discarded on teardown, like at script end
+struct ScriptEnvironment : vk::not_copyable {
+  ScriptEnvironment() {
+    init_runtime_environment(nullptr, script_memory.data(), script_memory.size());
+  }
+  ~ScriptEnvironment() {
+    free_runtime_environment();
+  }
+};
+
+void BM_array_vector_push_back(benchmark::State &state) {
+  ScriptEnvironment env;
+  const int64_t n = state.range(0);
+  for (auto _ : state) {
+    array<int64_t> a;
+    for (int64_t i = 0; i < n; ++i) {
+      a.push_back(i);
+    }
+    benchmark::DoNotOptimize(a.count());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_array_vector_push_back_reserved(benchmark::State &state) {
+  ScriptEnvironment env;
+  const int64_t n = state.range(0);
+  for (auto _ : state) {
+    array<int64_t> a;
+    a.reserve(n, 0, true);
+    for (int64_t i = 0; i < n; ++i) {
+      a.push_back(i);
+    }
+    benchmark::DoNotOptimize(a.count());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_array_int_key_set(benchmark::State &state) {
+  ScriptEnvironment env;
+  const int64_t n = state.range(0);
+  // sparse keys force map mode, the way ids index hash tables in scripts
+  for (auto _ : state) {
+    array<int64_t> a;
+    for (int64_t i = 0; i < n; ++i) {
+      a.set_value(i * 7 + 3, i);
+    }
+    benchmark::DoNotOptimize(a.count());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_array_int_key_lookup(benchmark::State &state) {
+  ScriptEnvironment env;
+  const int64_t n = state.range(0);
+  array<int64_t> a;
+  for (int64_t i = 0; i < n; ++i) {
+    a.set_value(i * 7 + 3, i);
+  }
+  int64_t sum = 0;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < n; ++i) {
+      sum += a.get_value(i * 7 + 3);
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_array_string_key_set(benchmark::State &state) {
+  ScriptEnvironment env;
+  const int64_t n = state.range(0);
+  {
+    std::vector<string> keys;
+    keys.reserve(n);
+    for (int64_t i = 0; i < n; ++i) {
+      char buffer[32];
+      const int len = snprintf(buffer, sizeof(buffer), "key_%" PRIi64, i);
+      keys.emplace_back(buffer, static_cast<string::size_type>(len));
+    }
+    for (auto _ : state) {
+      array<int64_t> a;
+      for (int64_t i = 0; i < n; ++i) {
+        a.set_value(keys[i], i);
+      }
+      benchmark::DoNotOptimize(a.count());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_array_string_key_lookup(benchmark::State &state) {
+  ScriptEnvironment env;
+  const int64_t n = state.range(0);
+  {
+    std::vector<string> keys;
+    keys.reserve(n);
+    array<int64_t> a;
+    for (int64_t i = 0; i < n; ++i) {
+      char buffer[32];
+      const int len = snprintf(buffer, sizeof(buffer), "key_%" PRIi64, i);
+      keys.emplace_back(buffer, static_cast<string::size_type>(len));
+      a.set_value(keys.back(), i);
+    }
+    int64_t sum = 0;
+    for (auto _ : state) {
+      for (int64_t i = 0; i < n; ++i) {
+        sum += a.get_value(keys[i]);
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_string_append(benchmark::State &state) {
+  ScriptEnvironment env;
+  const int64_t n = state.range(0);
+  for (auto _ : state) {
+    string s;
+    for (int64_t i = 0; i < n; ++i) {
+      s.append("fragment_", 9);
+      s.append(i);
+    }
+    benchmark::DoNotOptimize(s.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_string_buffer_append(benchmark::State &state) {
+  ScriptEnvironment env;
+  const int64_t n = state.range(0);
+  for (auto _ : state) {
+    static_SB.clean();
+    for (int64_t i = 0; i < n; ++i) {
+      static_SB.append("fragment_", 9);
+      static_SB << i;
+    }
+    benchmark::DoNotOptimize(static_SB.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_string_int_conversion(benchmark::State &state) {
+  ScriptEnvironment env;
+  int64_t value = 0;
+  for (auto _ : state) {
+    string s{value++};
+    benchmark::DoNotOptimize(s.size());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// allocation-size mix approximating production worker stats: dominated by small
+// objects (array buckets, short strings) with a thin tail of large buffers
+struct SizeBucket {
+  size_t min_size;
+  size_t max_size;
+  int share; // out of 100
+};
+
+constexpr SizeBucket size_mix[] = {
+  {8, 32, 46},
+  {33, 128, 30},
+  {129, 1024, 15},
+  {1025, 16384, 8},
+  {16385, 262144, 1},
+};
+
+size_t pick_size(std::mt19937 &gen) {
+  int choice = static_cast<int>(gen() % 100);
+  for (const auto &bucket : size_mix) {
+    if (choice < bucket.share) {
+      return bucket.min_size + gen() % (bucket.max_size - bucket.min_size + 1);
+    }
+    choice -= bucket.share;
+  }
+  return size_mix[0].min_size;
+}
+
+void BM_allocator_size_mix(benchmark::State &state) {
+  ScriptEnvironment env;
+  std::mt19937 gen{42};
+  // a ring of live allocations keeps a realistic live set, so frees hit the
+  // pool free lists instead of degenerating into pure linear allocation
+  const size_t live_slots = static_cast<size_t>(state.range(0));
+  std::vector<std::pair<void *, size_t>> slots(live_slots, {nullptr, 0});
+  uint64_t allocated_bytes = 0;
+  for (auto _ : state) {
+    auto &slot = slots[gen() % live_slots];
+    if (slot.first != nullptr) {
+      dl::deallocate(slot.first, slot.second);
+    }
+    slot.second = pick_size(gen);
+    slot.first = dl::allocate(slot.second);
+    allocated_bytes += slot.second;
+    benchmark::DoNotOptimize(slot.first);
+  }
+  for (auto &slot : slots) {
+    if (slot.first != nullptr) {
+      dl::deallocate(slot.first, slot.second);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["allocated_bytes"] = static_cast<double>(allocated_bytes);
+}
+
+} // namespace
+
+BENCHMARK(BM_array_vector_push_back)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_array_vector_push_back_reserved)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_array_int_key_set)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_array_int_key_lookup)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_array_string_key_set)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_array_string_key_lookup)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_string_append)->Arg(16)->Arg(256);
+BENCHMARK(BM_string_buffer_append)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_string_int_conversion);
+BENCHMARK(BM_allocator_size_mix)->ArgName("live_slots")->Arg(64)->Arg(1024)->Arg(16384);
+
+// linkage stubs: the full runtime expects these symbols from the generated code,
+// same set as in tests/cpp/runtime/_runtime-tests-env.cpp
+template<> int Storage::tagger<bool>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<int64_t>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<Optional<int64_t>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<void>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<thrown_exception>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<mixed>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<array<mixed>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<Optional<string>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<Optional<array<mixed>>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<array<array<mixed>>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<class_instance<C$VK$TL$RpcResponse>>::get_tag() noexcept { return 0; }
+template<> int Storage::tagger<array<class_instance<C$VK$TL$RpcResponse>>>::get_tag() noexcept { return 0; }
+template<> Storage::loader<mixed>::loader_fun Storage::loader<mixed>::get_function(int) noexcept { return nullptr; }
+
+void init_php_scripts() noexcept {
+  assert(0 && "this code shouldn't be executed and only for linkage");
+}
+void global_init_php_scripts() noexcept {
+  assert(0 && "this code shouldn't be executed and only for linkage");
+}
+const char *get_php_scripts_version() noexcept {
+  assert(0 && "this code shouldn't be executed and only for linkage");
+}
+
+char **get_runtime_options(int *) noexcept {
+  assert(0 && "this code shouldn't be executed and only for linkage");
+  return nullptr;
+}
+
+int main(int argc, char **argv) {
+  pid = getpid();
+  logname_id = 0;
+
+  php_disable_warnings = true;
+  php_warning_level = 0;
+
+  global_init_runtime_libs();
+  global_init_script_allocator();
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -3,6 +3,7 @@ prepend(KPHP_RUNTIME_MEMORY_RESOURCE_SOURCES memory_resource/
         details/memory_chunk_tree.cpp
         details/memory_ordered_chunk_list.cpp
         heap_resource.cpp
+        memory_attribution.cpp
         memory_resource.cpp
         monotonic_buffer_resource.cpp
         unsynchronized_pool_resource.cpp)
@@ -30,6 +31,7 @@ prepend(KPHP_RUNTIME_SOURCES ${BASE_DIR}/runtime/
         memcache.cpp
         memory_usage.cpp
         misc.cpp
+        msgpack-cursor.cpp
         msgpack-serialization.cpp
         mysql.cpp
         net_events.cpp
@@ -54,7 +56,8 @@ prepend(KPHP_RUNTIME_SOURCES ${BASE_DIR}/runtime/
         url.cpp
         vkext.cpp
         vkext_stats.cpp
-        zlib.cpp)
+        zlib.cpp
+        zstd.cpp)
 
 set_source_files_properties(
         ${BASE_DIR}/server/php-runner.cpp
@@ -193,5 +193,13 @@ X Storage::load_as() noexcept {
 
   int tag_save = tag;
   tag = 0;
+  // the stored type almost always is exactly the requested one (a fork of T waited
+  // as T); take the compile-time-selected trivial loader then — values up to
+  // sizeof(mixed) live inline in storage_, so this is a move out of the buffer —
+  // and leave the generated switch + function-pointer dispatch of get_function
+  // to the rare covariant case and the stored-exception case
+  if (likely(tag_save == tagger<X>::get_tag())) {
+    return load_implementation_helper<X, X>::load(storage_);
+  }
   return (loader<X>::get_function(tag_save))(storage_);
 }
@@ -200,12 +200,7 @@ string::string(int64_t i) {
     return;
   }
   if (i < 0 && i > -string_cache::cached_int_max()) {
-    const auto &cached_int_positive = string_cache::cached_int(-i);
-    p = create(cached_int_positive.size + 1, true);
-    p[0] = '-';
-    // copy with \0
-    std::memcpy(p + 1, cached_int_positive.ref_data(), cached_int_positive.size + 1);
-    inner()->size = cached_int_positive.size + 1;
+    p = string_cache::cached_negative_int(-i).ref_data();
     return;
   }
 
@@ -223,6 +218,29 @@ string::string(int64_t i) {
 }
 
 string::string(double f) {
+  // doubles holding integral values (prices in minor units, ids) are common and are
+  // printed exactly like ints, which the simd formatter does much faster than snprintf;
+  // %.14G keeps an integral value free of an exponent only while it fits in 14 digits
+  if (f != 0.0 && f == std::floor(f) && std::fabs(f) < 1e14) {
+    const auto i = static_cast<int64_t>(f);
+    p = create(STRLEN_INT64, true);
+    const char *end = simd_int64_to_string(i, p);
+    inner()->size = static_cast<size_type>(end - p);
+    p[inner()->size] = '\0';
+    return;
+  }
+
+  // values with one or two fractional digits (prices) are served from the cache
+  // like small ints: hundredths / 100.0 yields the exact double a php literal
+  // parses to, so the round-trip test recognizes them without any formatting
+  if (f > 0 && f < 100) {
+    const auto hundredths = static_cast<int64_t>(f * 100 + 0.5);
+    if (hundredths > 0 && hundredths < string_cache::cached_fixed_point_max() && static_cast<double>(hundredths) / 100.0 == f) {
+      p = string_cache::cached_fixed_point(hundredths).ref_data();
+      return;
+    }
+  }
+
   constexpr uint32_t MAX_LEN = 4096;
   char result[MAX_LEN + 2];
   result[0] = '\0';
@@ -432,11 +450,8 @@ string &string::append(int64_t i) {
     return append(cached_int.ref_data(), cached_int.size);
   }
   if (i < 0 && i > -string_cache::cached_int_max()) {
-    const auto &cached_int_positive = string_cache::cached_int(-i);
-    reserve_at_least(size() + cached_int_positive.size + 1);
-    p[inner()->size++] = '-';
-    append_unsafe(cached_int_positive.ref_data(), cached_int_positive.size);
-    return finish_append();
+    const auto &cached_int = string_cache::cached_negative_int(-i);
+    return append(cached_int.ref_data(), cached_int.size);
   }
 
   reserve_at_least(size() + STRLEN_INT64);
@@ -494,9 +509,8 @@ string &string::append_unsafe(int64_t i) {
     return append_unsafe(cached_int.ref_data(), cached_int.size);
   }
   if (i < 0 && i > -string_cache::cached_int_max()) {
-    const auto &cached_int_positive = string_cache::cached_int(-i);
-    p[inner()->size++] = '-';
-    return append_unsafe(cached_int_positive.ref_data(), cached_int_positive.size);
+    const auto &cached_int = string_cache::cached_negative_int(-i);
+    return append_unsafe(cached_int.ref_data(), cached_int.size);
   }
 
   const char *end = simd_int64_to_string(i, p + size());
@@ -843,6 +857,11 @@ int64_t string::hash() const {
 
 
 string string::substr(size_type pos, size_type n) const {
+  if (pos == 0 && n == size()) {
+    // whole-string slice: share the inner through copy-on-write instead of copying;
+    // substr-heavy parsers hit this case a lot when cutting already-trimmed pieces
+    return *this;
+  }
   return string(p + pos, n);
 }
 
@@ -874,6 +893,11 @@ string::size_type string::find_first_of(const string &s, size_type pos) const {
 }
 
 int64_t string::compare(const string &str) const {
+  if (p == str.p) {
+    // strings sharing one inner (copy-on-write copies, interned literal keys) are trivially equal;
+    // this skips the memcmp on the hottest map lookup path
+    return 0;
+  }
   const size_type my_size = size();
   const size_type str_size = str.size();
   const int res = memcmp(p, str.p, std::min(my_size, str_size));
@@ -962,6 +986,18 @@ inline string string::make_const_string_on_memory(const char *str, size_type len
   return result;
 }
 
+//wraps memory already laid out as [inner_sizeof() writable bytes][len bytes]['\0']
+//(e.g. an mmap'd file preceded by an anonymous page) without copying it;
+//the caller is responsible for the terminating '\0' at data[len];
+//the result behaves like a global const string and is never freed by the script allocator
+inline string string::make_const_string_on_mapped_memory(char *data, size_type len) {
+  auto *inner = new (data - inner_sizeof()) string_inner{len, len, ExtraRefCnt::for_global_const};
+  php_assert(inner->ref_data() == data);
+  string result;
+  result.p = inner->ref_data();
+  return result;
+}
+
 inline void string::destroy() {
   if (p) {
     inner()->dispose();
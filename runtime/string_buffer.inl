@@ -139,6 +139,8 @@ const char *string_buffer::c_str() {
 
 string string_buffer::str() const {
   php_assert (size() <= buffer_len);
+  // the copy here is mandatory: the buffer lives on heap memory and persists between script runs,
+  // while string data must be on script memory, so the allocation can't just be rebranded
   return string(buffer_begin, size());
 }
 
@@ -188,7 +190,7 @@ inline void init_string_buffer_lib(int max_length) {
 
 void string_buffer::copy_raw_data(const string_buffer &other) {
   clean();
-  append(other.str().c_str(), other.size());
+  append(other.buffer(), other.size());
 }
 
 bool operator==(const string_buffer &lhs, const string_buffer &rhs) {
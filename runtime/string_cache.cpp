@@ -8,6 +8,31 @@ constexpr auto string_cache::constexpr_make_large_ints() noexcept {
   return constexpr_make_ints(std::make_index_sequence<cached_int_max() / 10>{});
 }
 
+template<size_t... Ints>
+constexpr auto string_cache::constexpr_make_negative_ints(std::index_sequence<Ints...>) noexcept {
+  // the same 10-part split as constexpr_make_ints to keep the compilation time sane
+  return std::array<string_cache::string_8bytes, 10 * sizeof...(Ints)>{
+    {
+      constexpr_number_to_string<0 * sizeof...(Ints) + Ints>::create_negative()...,
+      constexpr_number_to_string<1 * sizeof...(Ints) + Ints>::create_negative()...,
+      constexpr_number_to_string<2 * sizeof...(Ints) + Ints>::create_negative()...,
+      constexpr_number_to_string<3 * sizeof...(Ints) + Ints>::create_negative()...,
+      constexpr_number_to_string<4 * sizeof...(Ints) + Ints>::create_negative()...,
+      constexpr_number_to_string<5 * sizeof...(Ints) + Ints>::create_negative()...,
+      constexpr_number_to_string<6 * sizeof...(Ints) + Ints>::create_negative()...,
+      constexpr_number_to_string<7 * sizeof...(Ints) + Ints>::create_negative()...,
+      constexpr_number_to_string<8 * sizeof...(Ints) + Ints>::create_negative()...,
+      constexpr_number_to_string<9 * sizeof...(Ints) + Ints>::create_negative()...
+    }};
+}
+
+const string::string_inner &string_cache::cached_negative_int(int64_t i) noexcept {
+  // the table starts with an unqueried "-0", so that it can be indexed by the absolute value directly
+  static constexpr auto negative_int_cache = constexpr_make_negative_ints(std::make_index_sequence<cached_int_max() / 10>{});
+  php_assert(0 < i && i < static_cast<int64_t>(negative_int_cache.size()));
+  return negative_int_cache[i].inner;
+}
+
 const string::string_inner &string_cache::cached_large_int(int64_t i) noexcept {
   static_assert(sizeof(string_8bytes) == sizeof(string::string_inner) + string_8bytes::TAIL_SIZE, "unexpected padding");
   // to avoid a big compilation time impact, we implement numbers generation from 100 (small_int_max) to 9999 (cached_int_max - 1) here
@@ -15,3 +40,76 @@ const string::string_inner &string_cache::cached_large_int(int64_t i) noexcept {
   php_assert(i < large_int_cache.size());
   return large_int_cache[i].inner;
 }
+
+constexpr string_cache::string_8bytes string_cache::constexpr_make_fixed_point(size_t hundredths) noexcept {
+  char buffer[string_8bytes::TAIL_SIZE]{};
+  size_t pos = 0;
+  const size_t int_part = hundredths / 100;
+  if (int_part >= 10) {
+    buffer[pos++] = static_cast<char>('0' + int_part / 10);
+  }
+  buffer[pos++] = static_cast<char>('0' + int_part % 10);
+  buffer[pos++] = '.';
+  const size_t frac = hundredths % 100;
+  buffer[pos++] = static_cast<char>('0' + frac / 10);
+  if (frac % 10) {
+    buffer[pos++] = static_cast<char>('0' + frac % 10);
+  }
+  return string_8bytes{buffer, pos};
+}
+
+template<size_t... Ints>
+constexpr auto string_cache::constexpr_make_fixed_points(std::index_sequence<Ints...>) noexcept {
+  // the same 10-part split as constexpr_make_ints to keep the compilation time sane
+  return std::array<string_cache::string_8bytes, 10 * sizeof...(Ints)>{
+    {
+      constexpr_make_fixed_point(0 * sizeof...(Ints) + Ints)...,
+      constexpr_make_fixed_point(1 * sizeof...(Ints) + Ints)...,
+      constexpr_make_fixed_point(2 * sizeof...(Ints) + Ints)...,
+      constexpr_make_fixed_point(3 * sizeof...(Ints) + Ints)...,
+      constexpr_make_fixed_point(4 * sizeof...(Ints) + Ints)...,
+      constexpr_make_fixed_point(5 * sizeof...(Ints) + Ints)...,
+      constexpr_make_fixed_point(6 * sizeof...(Ints) + Ints)...,
+      constexpr_make_fixed_point(7 * sizeof...(Ints) + Ints)...,
+      constexpr_make_fixed_point(8 * sizeof...(Ints) + Ints)...,
+      constexpr_make_fixed_point(9 * sizeof...(Ints) + Ints)...
+    }};
+}
+
+const string::string_inner &string_cache::cached_fixed_point(int64_t hundredths) noexcept {
+  // entries at multiples of 100 hold an unqueried "<n>.0": integral doubles take
+  // the int fast path in string(double) and never reach this table
+  static constexpr auto fixed_point_cache = constexpr_make_fixed_points(std::make_index_sequence<cached_fixed_point_max() / 10>{});
+  php_assert(0 < hundredths && hundredths < static_cast<int64_t>(fixed_point_cache.size()));
+  return fixed_point_cache[hundredths].inner;
+}
+
+string string_cache::cached_literal(literal id) noexcept {
+  // the order matches the literal enum
+  static constexpr std::array<string_28bytes, 20> literal_cache{
+    {
+      string_28bytes{"true"},
+      string_28bytes{"false"},
+      string_28bytes{"null"},
+      string_28bytes{"SERVER_NAME"},
+      string_28bytes{"SCRIPT_URI"},
+      string_28bytes{"CONTENT_TYPE"},
+      string_28bytes{"GATEWAY_INTERFACE"},
+      string_28bytes{"CGI/1.1"},
+      string_28bytes{"REMOTE_ADDR"},
+      string_28bytes{"REMOTE_PORT"},
+      string_28bytes{"REQUEST_METHOD"},
+      string_28bytes{"REQUEST_TIME"},
+      string_28bytes{"REQUEST_TIME_FLOAT"},
+      string_28bytes{"SERVER_PORT"},
+      string_28bytes{"SERVER_PROTOCOL"},
+      string_28bytes{"HTTP/1.1"},
+      string_28bytes{"QUERY_STRING"},
+      string_28bytes{"HTTP_X_REAL_SCHEME"},
+      string_28bytes{"HTTP_X_REAL_HOST"},
+      string_28bytes{"HTTP_X_REAL_REQUEST"}
+    }};
+  string result;
+  result.p = literal_cache[static_cast<size_t>(id)].inner.ref_data();
+  return result;
+}
@@ -5,6 +5,14 @@
 #pragma once
 #include <array>
 
+// Constexpr-interned strings shared by all workers through the read-only text segment:
+// every single-char string and the decimal representations of small ints are served from
+// here with ExtraRefCnt::for_global_const, so they are never copied or refcounted.
+// A wider process-shared interning table (hot confdata keys, observed literals) was
+// considered and rejected: string's inner layout has no spare bits for a table tag, so
+// interned equality would still go through the data pointers — which the existing
+// pointer-equality fast path in string::compare already exploits for every string that
+// shares an inner, including all constants from this cache and codegen literals.
 class string_cache {
 private:
   struct string_8bytes {
@@ -21,6 +29,20 @@ private:
       data{static_cast<char>('0' + Digits)..., '\0'} {
     }
 
+    template<size_t... Digits>
+    constexpr string_8bytes(char sign, std::index_sequence<Digits...>) :
+      inner{sizeof...(Digits) + 1, sizeof...(Digits) + 1, ExtraRefCnt::for_global_const},
+      data{sign, static_cast<char>('0' + Digits)..., '\0'} {
+    }
+
+    constexpr string_8bytes(const char *s, size_t size) :
+      inner{static_cast<string::size_type>(size), static_cast<string::size_type>(size), ExtraRefCnt::for_global_const},
+      data{} {
+      for (size_t i = 0; i != size; ++i) {
+        data[i] = s[i];
+      }
+    }
+
     constexpr string_8bytes() = default;
 
     string::string_inner inner{0, 0, ExtraRefCnt::for_global_const};
@@ -58,6 +80,12 @@ private:
              ? string_8bytes{std::index_sequence<Digits...>{}}
              : string_8bytes{std::index_sequence<0>{}};
     }
+
+    static constexpr string_8bytes create_negative() noexcept {
+      return sizeof...(Digits)
+             ? string_8bytes{'-', std::index_sequence<Digits...>{}}
+             : string_8bytes{'-', std::index_sequence<0>{}};
+    }
   };
 
   template<size_t... Ints>
@@ -84,9 +112,35 @@ private:
     return constexpr_make_ints(std::make_index_sequence<small_int_max() / 10>{});
   }
 
+  template<size_t... Ints>
+  static constexpr auto constexpr_make_negative_ints(std::index_sequence<Ints...>) noexcept;
+
   static constexpr auto constexpr_make_large_ints() noexcept;
   static const string::string_inner &cached_large_int(int64_t i) noexcept;
 
+  static constexpr string_8bytes constexpr_make_fixed_point(size_t hundredths) noexcept;
+
+  template<size_t... Ints>
+  static constexpr auto constexpr_make_fixed_points(std::index_sequence<Ints...>) noexcept;
+
+  // fixed strings big enough for the longest $_SERVER key; same layout trick as string_8bytes
+  struct string_28bytes {
+    static constexpr size_t TAIL_SIZE = 28u;
+
+    template<size_t N>
+    constexpr explicit string_28bytes(const char (&literal)[N]) :
+      inner{N - 1, N - 1, ExtraRefCnt::for_global_const},
+      data{} {
+      static_assert(N <= TAIL_SIZE, "literal is too long for the cache entry");
+      for (size_t i = 0; i != N; ++i) {
+        data[i] = literal[i];
+      }
+    }
+
+    string::string_inner inner{0, 0, ExtraRefCnt::for_global_const};
+    char data[TAIL_SIZE]{'\0'};
+  };
+
 public:
   static const string::string_inner &empty_string() noexcept {
     static constexpr string_8bytes empty_string;
@@ -106,5 +160,44 @@ public:
     return i < static_cast<int>(small_int_cache.size()) ? small_int_cache[i].inner : cached_large_int(i);
   }
 
+  // decimal representations of -1 .. -(cached_int_max() - 1); i is passed as the absolute value
+  static const string::string_inner &cached_negative_int(int64_t i) noexcept;
+
   static constexpr int64_t cached_int_max() noexcept { return 10000; }
+
+  // decimal strings of values with one or two fractional digits - prices, rates:
+  // "0.01" .. "99.99", indexed by the value in hundredths; trailing zeros are
+  // trimmed ("0.5", not "0.50"), matching what the %.14G fallback would print
+  static const string::string_inner &cached_fixed_point(int64_t hundredths) noexcept;
+
+  static constexpr int64_t cached_fixed_point_max() noexcept { return 10000; }
+
+  // fixed strings the runtime re-creates on every request - the $_SERVER keys
+  // filled in by query parsing and the json literals; the order matches the
+  // table in cached_literal
+  enum class literal : uint8_t {
+    json_true,
+    json_false,
+    json_null,
+    server_name,
+    script_uri,
+    content_type,
+    gateway_interface,
+    cgi_1_1,
+    remote_addr,
+    remote_port,
+    request_method,
+    request_time,
+    request_time_float,
+    server_port,
+    server_protocol,
+    http_1_1,
+    query_string,
+    http_x_real_scheme,
+    http_x_real_host,
+    http_x_real_request,
+  };
+
+  // returns a string sharing the cached rodata inner: no allocation, no refcounting
+  static string cached_literal(literal id) noexcept;
 };
@@ -7,6 +7,8 @@
 #include <clocale>
 #include <endian.h>
 
+#include "common/algorithms/simd-ascii-case.h"
+#include "common/algorithms/simd-escape-scan.h"
 #include "common/unicode/unicode-utils.h"
 
 #include "runtime/integer_types.h"
@@ -98,10 +100,18 @@ string f$addcslashes(const string &str, const string &what) {
 }
 
 string f$addslashes(const string &str) {
-  int len = str.size();
+  const string::size_type len = str.size();
 
   static_SB.clean().reserve(2 * len);
-  for (int i = 0; i < len; i++) {
+  string::size_type i = 0;
+  while (i < len) {
+    // bulk-copy the span that needs no escaping, fall into the switch per dirty byte only
+    const size_t clean = vk::simd_slashes_clean_span(str.c_str() + i, len - i);
+    static_SB.append(str.c_str() + i, clean);
+    i += static_cast<string::size_type>(clean);
+    if (i == len) {
+      break;
+    }
     switch (str[i]) {
       case '\0':
         static_SB.append_char('\\');
@@ -115,6 +125,7 @@ string f$addslashes(const string &str) {
       default:
         static_SB.append_char(str[i]);
     }
+    i++;
   }
   return static_SB.str();
 }
@@ -466,7 +477,16 @@ string f$htmlspecialchars(const string &str, int64_t flags) {
   const string::size_type len = str.size();
   static_SB.clean().reserve(6 * len);
 
-  for (string::size_type i = 0; i < len; i++) {
+  string::size_type i = 0;
+  while (i < len) {
+    // bulk-copy the span free of any potentially escaped char; the flag-dependent
+    // cases below still decide whether a found quote really gets replaced
+    const size_t clean = vk::simd_html_clean_span(str.c_str() + i, len - i);
+    static_SB.append(str.c_str() + i, clean);
+    i += static_cast<string::size_type>(clean);
+    if (i == len) {
+      break;
+    }
     switch (str[i]) {
       case '&':
         static_SB.append_char('&');
@@ -514,6 +534,7 @@ string f$htmlspecialchars(const string &str, int64_t flags) {
       default:
         static_SB.append_char(str[i]);
     }
+    i++;
   }
 
   return static_SB.str();
@@ -689,6 +710,49 @@ string f$number_format(double number, int64_t decimals, const string &dec_point,
   frac = round(frac * mul + 1e-9);
 
   int64_t old_decimals = decimals;
+
+  // price-style calls (moderate magnitude, few decimals) take an integer fast path:
+  // the digits come from integer divisions instead of the digit-at-a-time double loops
+  if (number < 1e15 && decimals <= 15 &&
+      static_cast<int64_t>(dec_point.size()) + static_cast<int64_t>(thousands_sep.size()) * 5 < PHP_BUF_LEN - 64) {
+    auto int_part = static_cast<uint64_t>(number);
+    auto frac_part = static_cast<uint64_t>(frac);
+    const auto scale = static_cast<uint64_t>(mul);
+    if (frac_part >= scale) {
+      // rounding of the fraction carried over into the integer part
+      frac_part -= scale;
+      int_part++;
+    }
+
+    for (int64_t i = 0; i < decimals; i++) {
+      *--result_begin = static_cast<char>('0' + frac_part % 10);
+      frac_part /= 10;
+    }
+    if (decimals > 0) {
+      for (string::size_type i = dec_point.size(); i > 0;) {
+        *--result_begin = dec_point[--i];
+      }
+    }
+
+    int64_t digits = 0;
+    do {
+      if (digits && digits % 3 == 0) {
+        for (string::size_type i = thousands_sep.size(); i > 0;) {
+          *--result_begin = thousands_sep[--i];
+        }
+      }
+      digits++;
+
+      *--result_begin = static_cast<char>('0' + int_part % 10);
+      int_part /= 10;
+    } while (int_part > 0);
+
+    if (negative) {
+      *--result_begin = '-';
+    }
+    return string(result_begin, static_cast<string::size_type>(php_buf + PHP_BUF_LEN - result_begin));
+  }
+
   while (result_begin > php_buf && decimals--) {
     double x = floor(frac * 0.1 + 0.05);
     auto y = static_cast<int32_t>(frac - x * 10 + 0.05);
@@ -1219,7 +1283,10 @@ string f$stripslashes(const string &str) {
 
 int64_t f$strcasecmp(const string &lhs, const string &rhs) {
   int n = min(lhs.size(), rhs.size()) + 1;
-  for (int i = 0; i < n; i++) {
+  // skip the pure-ascii case-insensitively equal prefix without lowering copies;
+  // the loop below takes over at the first non-ascii or differing position
+  int i = static_cast<int>(vk::simd_ascii_case_equal_prefix(lhs.c_str(), rhs.c_str(), min(lhs.size(), rhs.size())));
+  for (; i < n; i++) {
     if (tolower(lhs[i]) != tolower(rhs[i])) {
       return tolower(lhs[i]) - tolower(rhs[i]);
     }
@@ -1251,8 +1318,8 @@ Optional<int64_t> f$stripos(const string &haystack, const string &needle, int64_
   return s - haystack.c_str();
 }
 
-static bool php_tag_find(const string &tag, const string &allow) {
-  if (tag.empty() || allow.empty()) {
+static bool php_tag_find(const char *tag, const string &allow) {
+  if (*tag == '\0' || allow.empty()) {
     return false;
   }
 
@@ -1358,8 +1425,8 @@ string f$strip_tags(const string &str, const string &allow) {
             lc = '>';
             in_q = state = 0;
             static_SB_spare << '>';
-            if (php_tag_find(static_SB_spare.str(), allow_low)) {
-              static_SB << static_SB_spare.c_str();
+            if (php_tag_find(static_SB_spare.c_str(), allow_low)) {
+              static_SB.append(static_SB_spare.buffer(), static_SB_spare.size());
             }
             static_SB_spare.clean();
             break;
@@ -1744,11 +1811,27 @@ Optional<int64_t> f$strrpos(const string &haystack, const string &needle, int64_
     return false;
   }
 
-  const char *s = static_cast <const char *> (memmem(haystack.c_str() + offset, haystack.size() - offset, needle.c_str(), needle.size())), *t;
-  if (s == nullptr || s >= end) {
+  const char *haystack_end = haystack.c_str() + haystack.size();
+  if (needle.size() == 1) {
+    const char *start = haystack.c_str() + offset;
+    const char *s = static_cast <const char *> (memrchr(start, needle[0], static_cast<size_t>(end - start)));
+    if (s == nullptr) {
+      return false;
+    }
+    return s - haystack.c_str();
+  }
+
+  //a match must start before end, so there is no point scanning the haystack any further
+  const char *scan_end = end - 1 + needle.size();
+  if (scan_end > haystack_end) {
+    scan_end = haystack_end;
+  }
+
+  const char *s = static_cast <const char *> (memmem(haystack.c_str() + offset, scan_end - (haystack.c_str() + offset), needle.c_str(), needle.size())), *t;
+  if (s == nullptr) {
     return false;
   }
-  while ((t = static_cast <const char *> (memmem(s + 1, haystack.c_str() + haystack.size() - s - 1, needle.c_str(), needle.size()))) != nullptr && t < end) {
+  while ((t = static_cast <const char *> (memmem(s + 1, scan_end - s - 1, needle.c_str(), needle.size()))) != nullptr) {
     s = t;
   }
   return s - haystack.c_str();
@@ -1813,22 +1896,47 @@ Optional<string> f$strstr(const string &haystack, const string &needle, bool bef
 }
 
 string f$strtolower(const string &str) {
-  int n = str.size();
+  const string::size_type n = str.size();
+
+  // headers and paths lowercased on every request usually are lowercase already: when no
+  // byte can change (no A-Z, no locale-dependent non-ascii), share the string untouched
+  if (!vk::simd_ascii_needs_case_mapping(str.c_str(), n, 'A', 'Z')) {
+    return str;
+  }
 
   string res(n, false);
-  for (int i = 0; i < n; i++) {
-    res[i] = (char)tolower(str[i]);
+  const char *src = str.c_str();
+  char *dst = res.buffer();
+  string::size_type i = 0;
+  while (i < n) {
+    i += static_cast<string::size_type>(vk::simd_ascii_flip_case_span(src + i, dst + i, n - i, 'A', 'Z'));
+    // non-ascii bytes map through the locale table (cp1251 in production)
+    while (i < n && static_cast<signed char>(src[i]) < 0) {
+      dst[i] = (char)tolower(src[i]);
+      i++;
+    }
   }
 
   return res;
 }
 
 string f$strtoupper(const string &str) {
-  int n = str.size();
+  const string::size_type n = str.size();
+
+  if (!vk::simd_ascii_needs_case_mapping(str.c_str(), n, 'a', 'z')) {
+    return str;
+  }
 
   string res(n, false);
-  for (int i = 0; i < n; i++) {
-    res[i] = (char)toupper(str[i]);
+  const char *src = str.c_str();
+  char *dst = res.buffer();
+  string::size_type i = 0;
+  while (i < n) {
+    i += static_cast<string::size_type>(vk::simd_ascii_flip_case_span(src + i, dst + i, n - i, 'a', 'z'));
+    while (i < n && static_cast<signed char>(src[i]) < 0) {
+      dst[i] = (char)toupper(src[i]);
+      i++;
+    }
   }
 
   return res;
@@ -1956,11 +2064,18 @@ void str_replace_inplace(const string &search, const string &replace, string &su
     return;
   }
 
+  //probe before detaching the buffer: when nothing matches (the usual case) we don't pay for a copy-on-write clone
+  const char *first_pos = static_cast <const char *> (memmem(subject.c_str(), subject.size(), search.c_str(), search.size()));
+  if (first_pos == nullptr) {
+    return;
+  }
+  const auto first_offset = static_cast<string::size_type>(first_pos - subject.c_str());
+
   subject.make_not_shared();
 
   int count = 0;
-  const char *piece = subject.c_str(), *piece_end = subject.c_str() + subject.size();
-  char *output = subject.buffer();
+  const char *piece = subject.c_str() + first_offset, *piece_end = subject.c_str() + subject.size();
+  char *output = subject.buffer() + first_offset;
   bool length_no_change = search.size() == replace.size();
   while (true) {
     const char *pos = static_cast <const char *> (memmem(piece, piece_end - piece, search.c_str(), search.size()));
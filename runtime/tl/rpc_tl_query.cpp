@@ -5,23 +5,66 @@
 #include "runtime/tl/rpc_tl_query.h"
 
 #include <cstdarg>
+#include <cstring>
 
+#include "runtime/allocator.h"
 #include "runtime/exception.h"
 #include "runtime/tl/rpc_request.h"
 
 void RpcPendingQueries::save(const class_instance<RpcTlQuery> &query) {
-  php_assert(!queries_.has_key(query.get()->query_id));
-  queries_.set_value(query.get()->query_id, query);
+  const int64_t query_id = query.get()->query_id;
+  if (dl::query_num != last_query_num_) {
+    last_query_num_ = dl::query_num;
+    queries_size_ = 170;
+    queries_ = static_cast<class_instance<RpcTlQuery> *>(dl::allocate0(sizeof(queries_[0]) * queries_size_));
+    first_query_id_ = query_id;
+    next_query_id_ = query_id;
+    count_ = 0;
+  }
+  php_assert(query_id >= next_query_id_ && query_id >= first_query_id_);
+  if (count_ == 0) {
+    first_query_id_ = query_id; // skip over a fully drained window in O(1)
+  }
+  while (query_id - first_query_id_ >= queries_size_) {
+    int64_t skip = 0;
+    while (skip < queries_size_ && queries_[skip].is_null()) {
+      skip++;
+    }
+    if (skip > queries_size_ / 2) {
+      // a zeroed class_instance is a valid null one, so the window slides with raw moves
+      memmove(queries_, queries_ + skip, sizeof(queries_[0]) * (queries_size_ - skip));
+      memset(reinterpret_cast<void *>(queries_ + (queries_size_ - skip)), 0, sizeof(queries_[0]) * skip);
+      first_query_id_ += skip;
+    } else {
+      queries_ = static_cast<class_instance<RpcTlQuery> *>(dl::reallocate(queries_, sizeof(queries_[0]) * 2 * queries_size_, sizeof(queries_[0]) * queries_size_));
+      memset(reinterpret_cast<void *>(queries_ + queries_size_), 0, sizeof(queries_[0]) * queries_size_);
+      queries_size_ *= 2;
+    }
+  }
+  queries_[query_id - first_query_id_] = query;
+  next_query_id_ = query_id + 1;
+  count_++;
 }
 
 class_instance<RpcTlQuery> RpcPendingQueries::withdraw(int64_t query_id) {
-  auto query = queries_.get_value(query_id);
-  queries_.unset(query_id);
+  if (dl::query_num != last_query_num_ || query_id < first_query_id_ || query_id >= next_query_id_) {
+    return {};
+  }
+  class_instance<RpcTlQuery> query = std::move(queries_[query_id - first_query_id_]);
+  if (!query.is_null()) {
+    count_--;
+  }
   return query;
 }
 
 void RpcPendingQueries::hard_reset() {
-  hard_reset_var(queries_);
+  // the window lives in script memory which is dropped wholesale, just forget it
+  queries_ = nullptr;
+  queries_size_ = 0;
+  first_query_id_ = 0;
+  next_query_id_ = 0;
+  count_ = 0;
+  last_query_num_ = -1;
 }
 
 void CurrentProcessingQuery::reset() {
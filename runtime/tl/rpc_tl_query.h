@@ -26,12 +26,19 @@ public:
     return queries;
   }
 
-  int64_t count() const { return queries_.count(); }
+  int64_t count() const { return count_; }
 
 private:
   RpcPendingQueries() = default;
 
-  array<class_instance<RpcTlQuery>> queries_;
+  // flat sliding window over query ids (forked resumable ids grow monotonically),
+  // so save and withdraw are one indexed load each instead of hash maintenance
+  class_instance<RpcTlQuery> *queries_{nullptr};
+  int64_t queries_size_{0};
+  int64_t first_query_id_{0}; // id of queries_[0]
+  int64_t next_query_id_{0};  // one past the largest saved id
+  int64_t count_{0};
+  long long last_query_num_{-1};
 };
 
 class CurrentProcessingQuery {
@@ -76,6 +76,14 @@ inline void fetch_magic_if_not_bare(unsigned int inner_magic, const char *error_
   }
 }
 
+// every element of a vector occupies at least one 4-byte word on the wire (two with a non-bare
+// magic), so the bytes left in the answer bound the element count; reserving min(n, bound) gives
+// big genuine vectors a single exact-size allocation instead of geometric growth and protects
+// against a huge bogus size prefix
+inline int64_t max_vector_elems_left_in_answer(unsigned int inner_magic) {
+  return rpc_remaining_ints() / (inner_magic ? 2 : 1);
+}
+
 template<class T>
 inline void fetch_raw_vector_T(array<T> &out __attribute__ ((unused)), int64_t n_elems __attribute__ ((unused))) {
   php_assert(0 && "never called in runtime");
@@ -350,7 +358,7 @@ struct t_Vector {
       CurrentProcessingQuery::get().raise_fetching_error("Vector size is negative");
       return array<mixed>();
     }
-    array<mixed> result(array_size(std::min(n, 10000), 0, true));
+    array<mixed> result(array_size(std::min(int64_t{n}, max_vector_elems_left_in_answer(inner_magic)), 0, true));
     for (int i = 0; i < n; ++i) {
       fetch_magic_if_not_bare(inner_magic, "Incorrect magic of inner type of type Vector");
       const mixed &cur_elem = elem_state.fetch();
@@ -389,7 +397,7 @@ struct t_Vector {
       CurrentProcessingQuery::get().raise_fetching_error("Vector size is negative");
       return;
     }
-    out.reserve(n, 0, true);
+    out.reserve(std::min(int64_t{n}, max_vector_elems_left_in_answer(inner_magic)), 0, true);
 
     if (std::is_same<T, t_Double>{} && inner_magic == 0) {
       fetch_raw_vector_T<typename T::PhpType>(out, n);
@@ -39,6 +39,7 @@ int64_t f$typed_rpc_tl_query_one(const class_instance<C$RpcConnection> &connecti
   return typed_rpc_tl_query_impl(connection, R{query_function}, timeout, false, false, bytes_sent, true);
 }
 
+// batched variant: like f$rpc_tl_query, serializes the whole batch with one flush at the end
 template<typename F, typename R = KphpRpcRequest>
 array<int64_t> f$typed_rpc_tl_query(const class_instance<C$RpcConnection> &connection,
                                     const array<class_instance<F>> &query_functions,
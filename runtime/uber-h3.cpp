@@ -114,6 +114,21 @@ int64_t f$UberH3$$geoToH3(double latitude, double longitude, int64_t resolution)
   return geoToH3(&geo_cord, checked_resolution);
 }
 
+array<int64_t> f$UberH3$$geoToH3Batch(const array<std::tuple<double, double>> &points, int64_t resolution) noexcept {
+  const int32_t checked_resolution = check_resolution_param(resolution);
+  if (unlikely(checked_resolution != resolution)) {
+    return {};
+  }
+  // one preallocated vector out, one library call per point: the parameter check,
+  // the result allocation and the runtime boundary are paid once per batch
+  array<int64_t> result{array_size{points.count(), 0, true}};
+  for (const auto &point : points) {
+    const auto geo_coord = deg2coord(point.get_value());
+    result.emplace_back(static_cast<int64_t>(geoToH3(&geo_coord, checked_resolution)));
+  }
+  return result;
+}
+
 std::tuple<double, double> f$UberH3$$h3ToGeo(int64_t h3_index) noexcept {
   GeoCoord geo_coord{};
   h3ToGeo(h3_index, &geo_coord);
@@ -191,6 +206,28 @@ Optional<array<int64_t>> f$UberH3$$kRing(int64_t h3_index_origin, int64_t k) noe
   return std::move(neighbor_indexes);
 }
 
+Optional<array<int64_t>> f$UberH3$$kRingBatch(const array<int64_t> &h3_index_origins, int64_t k) noexcept {
+  const int32_t checked_k = check_k_param(k);
+  if (unlikely(checked_k != k)) {
+    return false;
+  }
+
+  // flat vector out, maxKringSize(k) slots per origin in input order (the same
+  // layout hexRanges uses); unused slots of a truncated ring stay zero
+  const int32_t neighbors_count = maxKringSize(checked_k);
+  auto neighbor_indexes = make_zeros_vector<int64_t>(neighbors_count * h3_index_origins.count());
+  if (!neighbor_indexes.empty()) {
+    // kRing() uses malloc; one replacement covers the whole batch
+    auto malloc_replacer = make_malloc_replacement_with_script_allocator();
+    int64_t offset = 0;
+    for (const auto &origin : h3_index_origins) {
+      kRing(static_cast<H3Index>(origin.get_value()), checked_k, reinterpret_cast<H3Index *>(&neighbor_indexes[offset]));
+      offset += neighbors_count;
+    }
+  }
+  return std::move(neighbor_indexes);
+}
+
 int64_t f$UberH3$$maxKringSize(int64_t k) noexcept {
   const int32_t checked_k = check_k_param(k);
   return checked_k != k ? 0 : maxKringSize(checked_k);
@@ -431,3 +468,39 @@ Optional<array<int64_t>> f$UberH3$$polyfill(const array<std::tuple<double, doubl
 
   return std::move(result_array);
 }
+
+Optional<array<array<int64_t>>> f$UberH3$$polyfillBatch(const array<array<std::tuple<double, double>>> &polygon_boundaries,
+                                                        int64_t resolution) noexcept {
+  const int32_t checked_resolution = check_resolution_param(resolution);
+  if (unlikely(checked_resolution != resolution)) {
+    return false;
+  }
+
+  array<array<int64_t>> result{array_size{polygon_boundaries.count(), 0, true}};
+  // polyfill() uses malloc; one replacement covers the whole batch; holes are not
+  // supported here — a zone with holes should go through the per-polygon polyfill
+  auto malloc_replacer = make_malloc_replacement_with_script_allocator();
+  for (const auto &boundary_it : polygon_boundaries) {
+    GeoPolygonOwner polygon_owner{boundary_it.get_value(), {}};
+    const int32_t max_size = maxPolyfillSize(&polygon_owner.getPolygon(), checked_resolution);
+    if (unlikely(max_size < 0)) {
+      return false;
+    }
+    auto hexagon_indexes = make_zeros_vector<int64_t>(max_size);
+    if (!hexagon_indexes.empty()) {
+      polyfill(&polygon_owner.getPolygon(), checked_resolution, reinterpret_cast<H3Index *>(&hexagon_indexes[0]));
+    }
+    int64_t indexes_count = 0;
+    for (const auto &element : hexagon_indexes) {
+      indexes_count += element.get_value() ? 1 : 0;
+    }
+    array<int64_t> polygon_result{array_size{indexes_count, 0, true}};
+    for (const auto &element : hexagon_indexes) {
+      if (auto h3_index = element.get_value()) {
+        polygon_result.emplace_back(h3_index);
+      }
+    }
+    result.emplace_back(std::move(polygon_result));
+  }
+  return std::move(result);
+}
@@ -7,6 +7,7 @@
 #include "runtime/kphp_core.h"
 
 int64_t f$UberH3$$geoToH3(double latitude, double longitude, int64_t resolution) noexcept;
+array<int64_t> f$UberH3$$geoToH3Batch(const array<std::tuple<double, double>> &points, int64_t resolution) noexcept;
 std::tuple<double, double> f$UberH3$$h3ToGeo(int64_t h3_index) noexcept;
 array<std::tuple<double, double>> f$UberH3$$h3ToGeoBoundary(int64_t h3_index) noexcept;
 
@@ -21,6 +22,7 @@ array<int64_t> f$UberH3$$h3GetFaces(int64_t h3_index) noexcept;
 int64_t f$UberH3$$maxFaceCount(int64_t h3_index) noexcept;
 
 Optional<array<int64_t>> f$UberH3$$kRing(int64_t h3_index_origin, int64_t k) noexcept;
+Optional<array<int64_t>> f$UberH3$$kRingBatch(const array<int64_t> &h3_index_origins, int64_t k) noexcept;
 int64_t f$UberH3$$maxKringSize(int64_t k) noexcept;
 Optional<array<std::tuple<int64_t, int64_t>>> f$UberH3$$kRingDistances(int64_t h3_index_origin, int64_t k) noexcept;
 Optional<array<int64_t>> f$UberH3$$hexRange(int64_t h3_index_origin, int64_t k) noexcept;
@@ -44,4 +46,6 @@ int64_t f$UberH3$$maxPolyfillSize(const array<std::tuple<double, double>> &polyg
                                   int64_t resolution) noexcept;
 Optional<array<int64_t>> f$UberH3$$polyfill(const array<std::tuple<double, double>> &polygon_boundary,
                                             const array<array<std::tuple<double, double>>> &holes,
-                                            int64_t resolution) noexcept;
\ No newline at end of file
+                                            int64_t resolution) noexcept;
+Optional<array<array<int64_t>>> f$UberH3$$polyfillBatch(const array<array<std::tuple<double, double>>> &polygon_boundaries,
+                                                        int64_t resolution) noexcept;
\ No newline at end of file
@@ -155,24 +155,99 @@ static int udp_get_fd(const Stream &stream) {
   return opened_udp_sockets->get_value(stream_key);
 }
 
+//small datagrams are not sent one syscall at a time: they are queued in a per-worker
+//buffer and leave in sendmmsg(2) batches when the buffer fills up, on fflush,
+//before the worker blocks in wait_net and at request end
+static const int UDP_BATCH_MAX_MESSAGES = 64;
+static const size_t UDP_BATCH_MAX_DATAGRAM_SIZE = 1472;//a typical MTU-sized payload, bigger datagrams are sent at once
+
+struct pending_udp_message {
+  int sock_fd;
+  size_t size;
+  char data[UDP_BATCH_MAX_DATAGRAM_SIZE];
+};
+
+static pending_udp_message pending_udp_messages[UDP_BATCH_MAX_MESSAGES];
+static int pending_udp_messages_count;
+
+bool flush_pending_udp_messages() {
+  if (pending_udp_messages_count == 0) {
+    return true;
+  }
+
+  bool ok = true;
+  dl::enter_critical_section();//OK
+  int i = 0;
+  while (i < pending_udp_messages_count) {
+    //datagrams leave in queueing order, consecutive ones to the same socket share one sendmmsg call
+    mmsghdr messages[UDP_BATCH_MAX_MESSAGES];
+    iovec iovecs[UDP_BATCH_MAX_MESSAGES];
+    int run_len = 0;
+    while (i + run_len < pending_udp_messages_count && pending_udp_messages[i + run_len].sock_fd == pending_udp_messages[i].sock_fd) {
+      pending_udp_message &message = pending_udp_messages[i + run_len];
+      iovecs[run_len].iov_base = message.data;
+      iovecs[run_len].iov_len = message.size;
+      memset(&messages[run_len], 0, sizeof(mmsghdr));
+      messages[run_len].msg_hdr.msg_iov = &iovecs[run_len];
+      messages[run_len].msg_hdr.msg_iovlen = 1;
+      run_len++;
+    }
+
+    int sent = 0;
+    while (sent < run_len) {
+      int res = sendmmsg(pending_udp_messages[i].sock_fd, messages + sent, run_len - sent, 0);
+      if (res < 0) {
+        ok = false;
+        break;
+      }
+      sent += res;
+    }
+    i += run_len;
+  }
+  pending_udp_messages_count = 0;
+  dl::leave_critical_section();
+
+  if (!ok) {
+    php_warning("An error occurred while sending UPD-package");
+  }
+  return ok;
+}
+
 static Optional<int64_t> udp_fwrite(const Stream &stream, const string &data) {
   int sock_fd = udp_get_fd(stream);
   if (sock_fd == -1) {
     return false;
   }
-  const void *data_ptr = static_cast <const void *> (data.c_str());
   size_t data_len = data.size();
   if (data_len == 0) {
     return 0;
   }
-  dl::enter_critical_section(); // OK
-  ssize_t res = send(sock_fd, data_ptr, data_len, 0);
-  dl::leave_critical_section();
-  if (res == -1) {
-    php_warning("An error occurred while sending UPD-package");
-    return false;
+
+  if (data_len > UDP_BATCH_MAX_DATAGRAM_SIZE) {
+    //the queue is flushed first to keep the datagram order
+    flush_pending_udp_messages();
+    dl::enter_critical_section(); // OK
+    ssize_t res = send(sock_fd, data.c_str(), data_len, 0);
+    dl::leave_critical_section();
+    if (res == -1) {
+      php_warning("An error occurred while sending UPD-package");
+      return false;
+    }
+    return res;
+  }
+
+  if (pending_udp_messages_count == UDP_BATCH_MAX_MESSAGES) {
+    flush_pending_udp_messages();
   }
-  return res;
+  pending_udp_message &message = pending_udp_messages[pending_udp_messages_count++];
+  message.sock_fd = sock_fd;
+  message.size = data_len;
+  memcpy(message.data, data.c_str(), data_len);
+  return static_cast<int64_t>(data_len);
+}
+
+static bool udp_fflush(const Stream &stream __attribute__((unused))) {
+  return flush_pending_udp_messages();
 }
 
 static bool udp_fclose(const Stream &stream) {
@@ -182,6 +257,9 @@ static bool udp_fclose(const Stream &stream) {
     return false;
   }
 
+  //queued datagrams must not outlive their socket
+  flush_pending_udp_messages();
+
   dl::enter_critical_section();
   int result = close(opened_udp_sockets->get_value(stream_key));
   opened_udp_sockets->unset(stream_key);
@@ -201,7 +279,7 @@ void global_init_udp_lib() {
   udp_stream_functions.fgetc = nullptr;
   udp_stream_functions.fgets = nullptr;
   udp_stream_functions.fpassthru = nullptr;
-  udp_stream_functions.fflush = nullptr;
+  udp_stream_functions.fflush = udp_fflush;
   udp_stream_functions.feof = nullptr;
   udp_stream_functions.fclose = udp_fclose;
 
@@ -217,6 +295,8 @@ void global_init_udp_lib() {
 }
 
 void free_udp_lib() {
+  flush_pending_udp_messages();
+
   dl::enter_critical_section();//OK
   if (dl::query_num == opened_udp_sockets_last_query_num) {
     const array<int> *const_opened_udp_sockets = opened_udp_sockets;
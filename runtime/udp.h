@@ -9,3 +9,7 @@
 void global_init_udp_lib();
 
 void free_udp_lib();
+
+// sends all datagrams queued by udp fwrite in one sendmmsg(2) batch;
+// called when the buffer fills up, on fflush, before the worker blocks in wait_net and at request end
+bool flush_pending_udp_messages();
@@ -4,6 +4,8 @@
 
 #include "runtime/url.h"
 
+#include "common/algorithms/simd-escape-scan.h"
+
 #include "runtime/array_functions.h"
 #include "runtime/regexp.h"
 
@@ -513,17 +515,25 @@ string f$urldecode(const string &s) {
 }
 
 string f$urlencode(const string &s) {
-  static_SB.clean().reserve(3 * s.size());
-  for (int i = 0; i < (int)s.size(); i++) {
-    if (good_url_symbols[(unsigned char)s[i]] == '1') {
-      static_SB.append_char(s[i]);
-    } else if (s[i] == ' ') {
+  const string::size_type len = s.size();
+  static_SB.clean().reserve(3 * len);
+  string::size_type i = 0;
+  while (i < len) {
+    // bulk-copy the url-safe span (same set as good_url_symbols), escape per dirty byte
+    const size_t clean = vk::simd_url_clean_span(s.c_str() + i, len - i);
+    static_SB.append(s.c_str() + i, clean);
+    i += static_cast<string::size_type>(clean);
+    if (i == len) {
+      break;
+    }
+    if (s[i] == ' ') {
       static_SB.append_char('+');
     } else {
       static_SB.append_char('%');
       static_SB.append_char(uhex_digits[(s[i] >> 4) & 15]);
       static_SB.append_char(uhex_digits[s[i] & 15]);
     }
+    i++;
   }
   return static_SB.str();
 }
@@ -7,6 +7,7 @@
 #include <sys/time.h>
 
 #include "common/string-processing.h"
+#include "common/unicode/utf8-simd.h"
 #include "flex/vk-flex-data.h"
 
 #include "runtime/misc.h"
@@ -254,6 +255,13 @@ int utf8_to_win(const char *s, int len, int64_t max_len, bool exit_on_error) {
       }
       write_buff_char((char)c);
       st = 0;
+      //the rest of an ASCII run is copied in bulk
+      int run = (int)utf8_ascii_prefix(s + i + 1, len - i - 1);
+      if (max_len && run > max_len - cur_buff_len) {
+        run = max_len > cur_buff_len ? (int)(max_len - cur_buff_len) : 0;
+      }
+      write_buff(s + i + 1, run);
+      i += run;
     } else if ((c & 0xc0) == 0x80) {
       if (!st) {
         if (exit_on_error) {
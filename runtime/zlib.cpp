@@ -9,44 +9,48 @@
 #include "runtime/critical_section.h"
 #include "runtime/string_functions.h"
 
-static voidpf zlib_alloc(voidpf opaque, uInt items, uInt size) {
-  int *buf_pos = (int *)opaque;
-  php_assert (items != 0 && (PHP_BUF_LEN - *buf_pos) / items >= size);
-
-  int pos = *buf_pos;
-  *buf_pos += items * size;
-  php_assert (*buf_pos <= PHP_BUF_LEN);
-  return php_buf + pos;
-}
-
-static void zlib_free(voidpf opaque __attribute__((unused)), voidpf address __attribute__((unused))) {
+// one persistent deflate state per wrapper kind, allocated on heap memory at first use and
+// reused by every request of this worker: deflateInit2 sets up several hundred KB of state,
+// which used to dominate the cost of compressing small responses
+static z_stream *get_deflate_stream(int32_t encoding) {
+  static z_stream streams[3];
+  static bool inited[3];
+
+  const int idx = encoding == ZLIB_RAW ? 0 : (encoding == ZLIB_COMPRESS ? 1 : 2);
+  if (!inited[idx]) {
+    streams[idx].zalloc = Z_NULL;
+    streams[idx].zfree = Z_NULL;
+    streams[idx].opaque = Z_NULL;
+    if (deflateInit2(&streams[idx], Z_DEFAULT_COMPRESSION, Z_DEFLATED, encoding, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+      return nullptr;
+    }
+    inited[idx] = true;
+  }
+  return &streams[idx];
 }
 
 const string_buffer *zlib_encode(const char *s, int32_t s_len, int32_t level, int32_t encoding) {
-  int buf_pos = 0;
-  z_stream strm;
-  strm.zalloc = zlib_alloc;
-  strm.zfree = zlib_free;
-  strm.opaque = &buf_pos;
-
   unsigned int res_len = (unsigned int)compressBound(s_len) + 30;
   static_SB.clean().reserve(res_len);
 
   dl::enter_critical_section();//OK
-  int ret = deflateInit2 (&strm, level, Z_DEFLATED, encoding, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+  z_stream *strm = get_deflate_stream(encoding);
+  int ret = strm != nullptr ? deflateReset(strm) : Z_MEM_ERROR;
+  if (ret == Z_OK) {
+    ret = deflateParams(strm, level, Z_DEFAULT_STRATEGY);
+  }
   if (ret == Z_OK) {
-    strm.avail_in = (unsigned int)s_len;
-    strm.next_in = reinterpret_cast <Bytef *> (const_cast <char *> (s));
-    strm.avail_out = res_len;
-    strm.next_out = reinterpret_cast <Bytef *> (static_SB.buffer());
+    strm->avail_in = (unsigned int)s_len;
+    strm->next_in = reinterpret_cast <Bytef *> (const_cast <char *> (s));
+    strm->avail_out = res_len;
+    strm->next_out = reinterpret_cast <Bytef *> (static_SB.buffer());
 
-    ret = deflate(&strm, Z_FINISH);
-    deflateEnd(&strm);
+    ret = deflate(strm, Z_FINISH);
 
     if (ret == Z_STREAM_END) {
       dl::leave_critical_section();
 
-      static_SB.set_pos(static_cast<int64_t>(strm.total_out));
+      static_SB.set_pos(static_cast<int64_t>(strm->total_out));
       return &static_SB;
     }
   }
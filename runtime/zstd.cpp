@@ -0,0 +1,145 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/zstd.h"
+
+#include <zstd.h>
+
+#include "common/php-functions.h"
+
+#include "runtime/critical_section.h"
+#include "runtime/string_functions.h"
+
+namespace {
+
+constexpr int DEFAULT_COMPRESSION_LEVEL = 3;
+
+// contexts live on heap memory and are reused by every request of this worker:
+// creating one is considerably more expensive than compressing a small response with it
+ZSTD_CCtx *cctx = nullptr;
+ZSTD_DCtx *dctx = nullptr;
+
+// a digested form of the last seen dictionary is cached per worker: digesting costs about
+// as much as compressing the dictionary itself, while callers pass the same preset
+// dictionary (a constant string, COW-shared with the master) on every call
+ZSTD_CDict *cached_cdict = nullptr;
+int64_t cached_cdict_hash = 0;
+ZSTD_DDict *cached_ddict = nullptr;
+int64_t cached_ddict_hash = 0;
+
+// must be called under the critical section
+const ZSTD_CDict *get_cdict(const string &dict) {
+  const int64_t hash = string_hash(dict.c_str(), dict.size());
+  if (cached_cdict == nullptr || cached_cdict_hash != hash) {
+    ZSTD_freeCDict(cached_cdict);
+    cached_cdict = ZSTD_createCDict(dict.c_str(), dict.size(), DEFAULT_COMPRESSION_LEVEL);
+    cached_cdict_hash = hash;
+  }
+  return cached_cdict;
+}
+
+// must be called under the critical section
+const ZSTD_DDict *get_ddict(const string &dict) {
+  const int64_t hash = string_hash(dict.c_str(), dict.size());
+  if (cached_ddict == nullptr || cached_ddict_hash != hash) {
+    ZSTD_freeDDict(cached_ddict);
+    cached_ddict = ZSTD_createDDict(dict.c_str(), dict.size());
+    cached_ddict_hash = hash;
+  }
+  return cached_ddict;
+}
+
+Optional<string> zstd_compress_impl(const string &data, int64_t level, const string *dict) {
+  const size_t bound = ZSTD_compressBound(data.size());
+  static_SB.clean().reserve(static_cast<string::size_type>(bound));
+
+  dl::enter_critical_section();//OK
+  if (cctx == nullptr) {
+    cctx = ZSTD_createCCtx();
+  }
+  const ZSTD_CDict *cdict = cctx != nullptr && dict != nullptr ? get_cdict(*dict) : nullptr;
+  size_t res = 0;
+  bool allocation_failed = cctx == nullptr || (dict != nullptr && cdict == nullptr);
+  if (!allocation_failed) {
+    res = dict != nullptr
+          ? ZSTD_compress_usingCDict(cctx, static_SB.buffer(), bound, data.c_str(), data.size(), cdict)
+          : ZSTD_compressCCtx(cctx, static_SB.buffer(), bound, data.c_str(), data.size(), static_cast<int>(level));
+  }
+  dl::leave_critical_section();
+
+  if (allocation_failed) {
+    php_warning("zstd compression error: can't allocate the compression context");
+    static_SB.clean();
+    return false;
+  }
+  if (ZSTD_isError(res)) {
+    php_warning("zstd compression error: %s", ZSTD_getErrorName(res));
+    static_SB.clean();
+    return false;
+  }
+  static_SB.set_pos(static_cast<int64_t>(res));
+  return static_SB.str();
+}
+
+Optional<string> zstd_uncompress_impl(const string &data, const string *dict) {
+  const unsigned long long content_size = ZSTD_getFrameContentSize(data.c_str(), data.size());
+  if (content_size == ZSTD_CONTENTSIZE_ERROR) {
+    php_warning("zstd_uncompress: the given data is not a zstd frame");
+    return false;
+  }
+  if (content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size > string::max_size()) {
+    php_warning("zstd_uncompress: can't decode frame with content size %llu", content_size);
+    return false;
+  }
+  static_SB.clean().reserve(static_cast<string::size_type>(content_size));
+
+  dl::enter_critical_section();//OK
+  if (dctx == nullptr) {
+    dctx = ZSTD_createDCtx();
+  }
+  const ZSTD_DDict *ddict = dctx != nullptr && dict != nullptr ? get_ddict(*dict) : nullptr;
+  size_t res = 0;
+  bool allocation_failed = dctx == nullptr || (dict != nullptr && ddict == nullptr);
+  if (!allocation_failed) {
+    res = dict != nullptr
+          ? ZSTD_decompress_usingDDict(dctx, static_SB.buffer(), content_size, data.c_str(), data.size(), ddict)
+          : ZSTD_decompressDCtx(dctx, static_SB.buffer(), content_size, data.c_str(), data.size());
+  }
+  dl::leave_critical_section();
+
+  if (allocation_failed) {
+    php_warning("zstd decompression error: can't allocate the decompression context");
+    static_SB.clean();
+    return false;
+  }
+  if (ZSTD_isError(res)) {
+    php_warning("zstd decompression error: %s", ZSTD_getErrorName(res));
+    static_SB.clean();
+    return false;
+  }
+  static_SB.set_pos(static_cast<int64_t>(res));
+  return static_SB.str();
+}
+
+} // namespace
+
+Optional<string> f$zstd_compress(const string &data, int64_t level) {
+  if (level < ZSTD_minCLevel() || level > ZSTD_maxCLevel()) {
+    php_warning("zstd_compress: compression level (%" PRIi64 ") must be within %d..%d range", level, ZSTD_minCLevel(), ZSTD_maxCLevel());
+    return false;
+  }
+  return zstd_compress_impl(data, level, nullptr);
+}
+
+Optional<string> f$zstd_uncompress(const string &data) {
+  return zstd_uncompress_impl(data, nullptr);
+}
+
+Optional<string> f$zstd_compress_dict(const string &data, const string &dict) {
+  return zstd_compress_impl(data, DEFAULT_COMPRESSION_LEVEL, &dict);
+}
+
+Optional<string> f$zstd_uncompress_dict(const string &data, const string &dict) {
+  return zstd_uncompress_impl(data, &dict);
+}
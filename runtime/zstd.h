@@ -0,0 +1,15 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include "runtime/kphp_core.h"
+
+Optional<string> f$zstd_compress(const string &data, int64_t level = 3);
+
+Optional<string> f$zstd_uncompress(const string &data);
+
+Optional<string> f$zstd_compress_dict(const string &data, const string &dict);
+
+Optional<string> f$zstd_uncompress_dict(const string &data, const string &dict);
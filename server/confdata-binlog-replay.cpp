@@ -4,6 +4,7 @@
 
 #include "server/confdata-binlog-replay.h"
 
+#include <array>
 #include <bitset>
 #include <chrono>
 #include <cinttypes>
@@ -16,6 +17,7 @@
 #include "common/server/init-binlog.h"
 #include "common/server/init-snapshot.h"
 #include "common/wrappers/string_view.h"
+#include "common/kfs/kfs-snapshot.h"
 #include "common/kfs/kfs.h"
 
 #include "runtime/allocator.h"
@@ -41,6 +43,7 @@ public:
   }
 
   using vk::binlog::replayer::replay;
+  using vk::binlog::replayer::replay_batch;
 
   size_t try_reserve_for_snapshot(vk::string_view key, size_t search_from,
                                   vk::string_view &prev_key, array_size &counter) noexcept {
@@ -83,16 +86,33 @@ public:
 
     const int nrecords = header.nrecords;
     vkprintf(2, "%d records readed\n", nrecords);
-    auto index_offset = std::make_unique<int64_t[]>(nrecords + 1);
-    assert (index_offset);
 
-    kfs_read_file_assert (Snapshot, index_offset.get(), sizeof(index_offset[0]) * (nrecords + 1));
+    // parse the snapshot right out of a private mapping when possible:
+    // the offset table is patched copy-on-write during the blacklist pass and
+    // the multi-gigabyte entry data is never copied into heap buffers
+    long long snapshot_size = 0;
+    char *snapshot_data = static_cast<char *>(kfs_snapshot_mmap(Snapshot, &snapshot_size));
+    std::unique_ptr<int64_t[]> index_offset_storage;
+    std::unique_ptr<char[]> index_binary_data_storage;
+    int64_t *index_offset = nullptr;
+    const char *index_binary_data = nullptr;
+    if (snapshot_data) {
+      assert (sizeof(index_header) + sizeof(int64_t) * (nrecords + 1) <= static_cast<uint64_t>(snapshot_size));
+      index_offset = reinterpret_cast<int64_t *>(snapshot_data + sizeof(index_header));
+      index_binary_data = reinterpret_cast<const char *>(index_offset + nrecords + 1);
+      assert (index_offset[nrecords] <= snapshot_size - static_cast<int64_t>(sizeof(index_header) + sizeof(int64_t) * (nrecords + 1)));
+    } else {
+      index_offset_storage = std::make_unique<int64_t[]>(nrecords + 1);
+      assert (index_offset_storage);
+      kfs_read_file_assert (Snapshot, index_offset_storage.get(), sizeof(index_offset_storage[0]) * (nrecords + 1));
+      index_offset = index_offset_storage.get();
+      index_binary_data_storage = std::make_unique<char[]>(index_offset[nrecords]);
+      assert (index_binary_data_storage);
+      kfs_read_file_assert (Snapshot, index_binary_data_storage.get(), index_offset[nrecords]);
+      index_binary_data = index_binary_data_storage.get();
+    }
     vkprintf(1, "index_offset[%d]=%" PRId64 "\n", nrecords, index_offset[nrecords]);
 
-    auto index_binary_data = std::make_unique<char[]>(index_offset[nrecords]);
-    assert (index_binary_data);
-    kfs_read_file_assert (Snapshot, index_binary_data.get(), index_offset[nrecords]);
-
     using entry_type = lev_confdata_store_wrapper<index_entry, pmct_set>;
 
     vk::string_view last_one_dot_key;
@@ -123,6 +143,7 @@ public:
     }
     blacklist_enabled_ = true;
     size_hints_.clear();
+    kfs_snapshot_munmap(snapshot_data, snapshot_size);
     return 0;
   }
 
@@ -197,6 +218,14 @@ public:
     return confdata_has_any_updates_;
   }
 
+  // slots of the first keys modified since the last published sample;
+  // taken by the caller right after the new sample became visible to the workers
+  std::bitset<ConfdataEpochTable::SLOTS_AMOUNT> take_modified_epoch_slots() noexcept {
+    auto result = modified_epoch_slots_;
+    modified_epoch_slots_.reset();
+    return result;
+  }
+
   void delete_expired_elements() noexcept {
     assert(expiration_trace_.size() == element_delays_.size());
 
@@ -348,6 +377,11 @@ private:
     }
   }
 
+  void mark_processing_first_key_modified() noexcept {
+    const string &first_key = processing_key_.get_first_key();
+    modified_epoch_slots_.set(ConfdataEpochTable::get_slot(vk::string_view{first_key.c_str(), first_key.size()}));
+  }
+
   OperationStatus delete_processing_element() noexcept {
     auto first_key_it = updating_confdata_storage_->find(processing_key_.get_first_key());
     if (first_key_it == updating_confdata_storage_->end()) {
@@ -360,6 +394,7 @@ private:
       put_confdata_element_value_into_garbage(first_key_it->second);
       put_confdata_var_into_garbage(first_key_it->first, ConfdataGarbageDestroyWay::shallow_first);
       updating_confdata_storage_->erase(first_key_it);
+      mark_processing_first_key_modified();
       return OperationStatus::full_update;
     }
 
@@ -389,6 +424,7 @@ private:
       put_confdata_var_into_garbage(first_key_it->first, ConfdataGarbageDestroyWay::shallow_first);
       updating_confdata_storage_->erase(first_key_it);
     }
+    mark_processing_first_key_modified();
     return OperationStatus::full_update;
   }
 
@@ -430,6 +466,7 @@ private:
         // put the previous value to garbage and overwrite it with a new value
         put_confdata_element_value_into_garbage(first_key_it->second);
         first_key_it->second = get_processing_value(E);
+        mark_processing_first_key_modified();
         return OperationStatus::full_update;
       }
       return OperationStatus::ttl_update_only;
@@ -452,6 +489,7 @@ private:
       array_for_second_key.set_value(processing_key_.make_second_key_copy(), get_processing_value(E));
       // array insertion will detach the array RC
       assert(array_for_second_key.get_reference_counter() == 1);
+      mark_processing_first_key_modified();
       return OperationStatus::full_update;
     }
     if (is_new_value(E, *prev_value)) {
@@ -465,6 +503,7 @@ private:
       // put the previous value to garbage and overwrite it with a new value
       put_confdata_element_value_into_garbage(second_key_it.get_value());
       second_key_it.get_value() = get_processing_value(E);
+      mark_processing_first_key_modified();
       return OperationStatus::full_update;
     }
     return OperationStatus::ttl_update_only;
@@ -621,8 +660,24 @@ private:
            : array<mixed>{};
   }
 
-  bool is_key_blacklisted(vk::string_view key) const noexcept {
-    return blacklist_enabled_ && key_blacklist_.is_blacklisted(key);
+  bool is_key_blacklisted(vk::string_view key) noexcept {
+    if (!blacklist_enabled_) {
+      return false;
+    }
+    // keys repeat heavily during binlog catch-up and the blacklist is an RE2
+    // match, so verdicts are memoized in a small direct-mapped cache
+    if (key.empty()) {
+      return key_blacklist_.is_blacklisted(key);
+    }
+    const auto hash = std::hash<vk::string_view>{}(key);
+    auto &cached = blacklist_cache_[hash % blacklist_cache_.size()];
+    if (vk::string_view{cached.key.data(), cached.key.size()} == key) {
+      return cached.verdict;
+    }
+    const bool verdict = key_blacklist_.is_blacklisted(key);
+    cached.key.assign(key.data(), key.size());
+    cached.verdict = verdict;
+    return verdict;
   }
 
   // TODO: 'now' is used by engines, can we use it in the same way?
@@ -635,6 +690,7 @@ private:
   size_t garbage_size_{0};
   mixed last_element_in_garbage_;
   bool confdata_has_any_updates_{false};
+  std::bitset<ConfdataEpochTable::SLOTS_AMOUNT> modified_epoch_slots_;
   std::unordered_map<vk::string_view, array_size> size_hints_;
   ConfdataStats::EventCounters event_counters_;
 
@@ -644,6 +700,12 @@ private:
   std::unordered_map<vk::string_view, int> element_delays_;
   std::multimap<int, std::string> expiration_trace_;
 
+  struct BlacklistCacheEntry {
+    std::string key;
+    bool verdict{false};
+  };
+  std::array<BlacklistCacheEntry, 8192> blacklist_cache_;
+
   bool blacklist_enabled_{true};
   const ConfdataKeyBlacklist &key_blacklist_;
   const ConfdataPredefinedWildcards &predefined_wildcards_;
@@ -695,7 +757,9 @@ void init_confdata_binlog_reader() noexcept {
     return ConfdataBinlogReplayer::get().load_index();
   };
   settings.replay_logevent = [](const lev_generic *E, int size) {
-    return ConfdataBinlogReplayer::get().replay(E, size);
+    // the binlog buffer passes the whole remaining window here,
+    // so runs of store events are replayed in one tight loop
+    return ConfdataBinlogReplayer::get().replay_batch(E, size);
   };
   settings.on_lev_start = [](const lev_start *E) {
     log_split_min = E->split_min;
@@ -738,6 +802,7 @@ void init_confdata_binlog_reader() noexcept {
   confdata_stats.initial_loading_time += confdata_stats.last_update_time_point.time_since_epoch();
 
   confdata_manager.get_current().reset(std::move(loaded_confdata.new_confdata));
+  confdata_manager.get_epoch_table().on_sample_published(confdata_binlog_replayer.take_modified_epoch_slots());
 
   vkprintf(1, "confdata loaded\n");
   confdata_allocator_rollback.disable();
@@ -771,6 +836,8 @@ void confdata_binlog_update_cron() noexcept {
       previous_confdata_sample.save_garbage(std::move(updated_confdata.previous_confdata_garbage));
       const bool switched = confdata_manager.try_switch_to_next_sample(std::move(updated_confdata.new_confdata));
       assert(switched);
+      // epochs move strictly after the switch, see ConfdataEpochTable::on_sample_published
+      confdata_manager.get_epoch_table().on_sample_published(confdata_binlog_replayer.take_modified_epoch_slots());
     } else {
       ++confdata_stats.ignored_updates;
     }
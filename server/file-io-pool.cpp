@@ -0,0 +1,252 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/file-io-pool.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/kprintf.h"
+#include "common/parallel/sharded-counter.h"
+#include "common/stats/provider.h"
+#include "net/net-events.h"
+
+int file_io_pool_size;
+
+// bumped from pool threads without registration, gathered in the stats provider
+PARALLEL_SHARDED_COUNTER(file_io_jobs_performed);
+PARALLEL_SHARDED_COUNTER(file_io_jobs_failed);
+PARALLEL_SHARDED_COUNTER(file_io_bytes_read);
+
+static pthread_mutex_t file_io_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t file_io_cond = PTHREAD_COND_INITIALIZER;
+static file_io_job *file_io_submit_head;
+static file_io_job *file_io_submit_tail;
+static file_io_job *file_io_done_head;
+static int file_io_wakeup_fd[2] = {-1, -1};
+static bool file_io_pool_running;
+
+file_io_job *file_io_job_create(const char *filename) {
+  auto *job = static_cast<file_io_job *>(calloc(1, sizeof(file_io_job)));
+  if (job == nullptr) {
+    return nullptr;
+  }
+  job->filename = strdup(filename);
+  if (job->filename == nullptr) {
+    free(job);
+    return nullptr;
+  }
+  job->data_len = -1;
+  return job;
+}
+
+void file_io_job_free(file_io_job *job) {
+  free(job->filename);
+  free(job->data);
+  free(job);
+}
+
+static void file_io_job_perform_impl(file_io_job *job) {
+  // pool thread territory: only libc malloc and syscalls here, the script
+  // allocator and php_warning are off limits
+  const int fd = open(job->filename, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    job->error_code = errno;
+    return;
+  }
+
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) < 0) {
+    job->error_code = errno;
+    close(fd);
+    return;
+  }
+  if (!S_ISREG(stat_buf.st_mode)) {
+    job->error_code = EINVAL;
+    close(fd);
+    return;
+  }
+
+  size_t capacity = stat_buf.st_size > 0 ? (size_t)stat_buf.st_size : 16384;
+  char *buf = static_cast<char *>(malloc(capacity));
+  if (buf == nullptr) {
+    job->error_code = ENOMEM;
+    close(fd);
+    return;
+  }
+
+  size_t size = 0;
+  for (;;) {
+    if (size == capacity) {
+      char *new_buf = static_cast<char *>(realloc(buf, capacity * 2));
+      if (new_buf == nullptr) {
+        job->error_code = ENOMEM;
+        free(buf);
+        close(fd);
+        return;
+      }
+      buf = new_buf;
+      capacity *= 2;
+    }
+    const ssize_t r = read(fd, buf + size, capacity - size);
+    if (r < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      job->error_code = errno;
+      free(buf);
+      close(fd);
+      return;
+    }
+    if (r == 0) {
+      break;
+    }
+    size += (size_t)r;
+  }
+  close(fd);
+
+  job->data = buf;
+  job->data_len = (long long)size;
+}
+
+void file_io_job_perform(file_io_job *job) {
+  file_io_job_perform_impl(job);
+  PARALLEL_SHARDED_COUNTER_INC(file_io_jobs_performed);
+  if (job->data_len < 0) {
+    PARALLEL_SHARDED_COUNTER_INC(file_io_jobs_failed);
+  } else {
+    PARALLEL_SHARDED_COUNTER_ADD(file_io_bytes_read, (uint64_t)job->data_len);
+  }
+}
+
+STATS_PROVIDER(file_io_pool, 2000) {
+  if (file_io_pool_size > 0) {
+    add_histogram_stat_long(stats, "file_io.jobs_performed", PARALLEL_SHARDED_COUNTER_READ(file_io_jobs_performed));
+    add_histogram_stat_long(stats, "file_io.jobs_failed", PARALLEL_SHARDED_COUNTER_READ(file_io_jobs_failed));
+    add_histogram_stat_long(stats, "file_io.bytes_read", PARALLEL_SHARDED_COUNTER_READ(file_io_bytes_read));
+  }
+}
+
+static void *file_io_pool_thread(void *arg __attribute__((unused))) {
+  sigset_t mask;
+  sigfillset(&mask);
+  pthread_sigmask(SIG_SETMASK, &mask, nullptr);
+
+  pthread_mutex_lock(&file_io_lock);
+  for (;;) {
+    while (file_io_submit_head == nullptr) {
+      pthread_cond_wait(&file_io_cond, &file_io_lock);
+    }
+    file_io_job *job = file_io_submit_head;
+    file_io_submit_head = job->next;
+    if (file_io_submit_head == nullptr) {
+      file_io_submit_tail = nullptr;
+    }
+    pthread_mutex_unlock(&file_io_lock);
+
+    job->next = nullptr;
+    file_io_job_perform(job);
+
+    pthread_mutex_lock(&file_io_lock);
+    job->next = file_io_done_head;
+    file_io_done_head = job;
+    pthread_mutex_unlock(&file_io_lock);
+
+    // a full pipe means a wakeup is already pending, losing the byte is fine
+    ssize_t written = write(file_io_wakeup_fd[1], "x", 1);
+    (void)written;
+
+    pthread_mutex_lock(&file_io_lock);
+  }
+  return nullptr;
+}
+
+static int file_io_wakeup_gateway(int fd, void *data __attribute__((unused)), event_t *ev __attribute__((unused))) {
+  char buf[512];
+  while (read(fd, buf, sizeof(buf)) > 0) {
+  }
+
+  pthread_mutex_lock(&file_io_lock);
+  file_io_job *job = file_io_done_head;
+  file_io_done_head = nullptr;
+  pthread_mutex_unlock(&file_io_lock);
+
+  while (job != nullptr) {
+    file_io_job *next = job->next;
+    job->next = nullptr;
+    if (create_file_io_answer_event(job->slot_id, job) <= 0) {
+      // the script that asked for this file is already gone
+      file_io_job_free(job);
+    }
+    job = next;
+  }
+  return EVA_CONTINUE;
+}
+
+static bool file_io_pool_start() {
+  if (file_io_pool_running) {
+    return true;
+  }
+  if (file_io_pool_size <= 0) {
+    return false;
+  }
+
+  if (pipe2(file_io_wakeup_fd, O_NONBLOCK | O_CLOEXEC) < 0) {
+    kprintf("file-io-pool: cannot create wakeup pipe: %m\n");
+    return false;
+  }
+  epoll_sethandler(file_io_wakeup_fd[0], 0, file_io_wakeup_gateway, nullptr);
+  if (epoll_insert(file_io_wakeup_fd[0], EVT_READ | EVT_LEVEL) < 0) {
+    kprintf("file-io-pool: cannot add wakeup pipe to epoll\n");
+    close(file_io_wakeup_fd[0]);
+    close(file_io_wakeup_fd[1]);
+    file_io_wakeup_fd[0] = file_io_wakeup_fd[1] = -1;
+    return false;
+  }
+
+  int started = 0;
+  for (int i = 0; i < file_io_pool_size; i++) {
+    pthread_t thread;
+    if (pthread_create(&thread, nullptr, file_io_pool_thread, nullptr) != 0) {
+      kprintf("file-io-pool: cannot start thread %d of %d: %m\n", i + 1, file_io_pool_size);
+      break;
+    }
+    pthread_detach(thread);
+    started++;
+  }
+  if (started == 0) {
+    epoll_remove(file_io_wakeup_fd[0]);
+    close(file_io_wakeup_fd[0]);
+    close(file_io_wakeup_fd[1]);
+    file_io_wakeup_fd[0] = file_io_wakeup_fd[1] = -1;
+    return false;
+  }
+
+  file_io_pool_running = true;
+  return true;
+}
+
+bool file_io_pool_submit(file_io_job *job) {
+  if (!file_io_pool_start()) {
+    return false;
+  }
+
+  pthread_mutex_lock(&file_io_lock);
+  job->next = nullptr;
+  if (file_io_submit_tail == nullptr) {
+    file_io_submit_head = job;
+  } else {
+    file_io_submit_tail->next = job;
+  }
+  file_io_submit_tail = job;
+  pthread_cond_signal(&file_io_cond);
+  pthread_mutex_unlock(&file_io_lock);
+  return true;
+}
@@ -0,0 +1,44 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+
+#include "server/php-queries.h"
+
+// A small per-worker pool of detached threads doing blocking file reads, so a
+// slow disk (an NFS hiccup) parks one fork instead of freezing the whole
+// worker. A job is submitted from the script context, performed on a pool
+// thread into plain malloc'd memory, and comes back as a ne_file_io_answer net
+// event: a pool thread pushes the finished job onto a completion list and pokes
+// a pipe whose read end sits in the worker's epoll, the pipe handler turns the
+// completions into net events in the engine context, and the script processes
+// them through the usual wait_net machinery like an rpc answer.
+
+struct file_io_job {
+  file_io_job *next;
+  slot_id_t slot_id;
+  int64_t resumable_id;
+  char *filename;// malloc'd, owned by the job
+  char *data;// malloc'd by the pool thread, owned by the job
+  long long data_len;// -1 until performed successfully
+  int error_code;// errno of the failed operation
+};
+
+// pool threads per worker, set by --file-io-threads; 0 (default) disables
+// offloading and file reads stay synchronous
+extern int file_io_pool_size;
+
+file_io_job *file_io_job_create(const char *filename);
+void file_io_job_free(file_io_job *job);
+
+// the blocking part: reads the whole file into job->data; runs on a pool
+// thread, and inline as the synchronous fallback when the pool is disabled
+void file_io_job_perform(file_io_job *job);
+
+// hands the job over to the pool, starting it lazily on first use (i.e. in the
+// worker, after the master has forked); returns false when the pool is
+// disabled or cannot be started, leaving the job untouched
+bool file_io_pool_submit(file_io_job *job);
@@ -0,0 +1,115 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/hugepage-text.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+
+#include "common/kprintf.h"
+
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+size_t align_up(size_t value, size_t alignment) noexcept {
+  return (value + alignment - 1) & -alignment;
+}
+
+size_t align_down(size_t value, size_t alignment) noexcept {
+  return value & -alignment;
+}
+
+// the executable r-xp mapping containing the given address, from /proc/self/maps
+bool find_text_mapping(const void *inside, size_t *begin, size_t *end) {
+  FILE *maps = fopen("/proc/self/maps", "r");
+  if (maps == nullptr) {
+    return false;
+  }
+  const size_t needle = reinterpret_cast<size_t>(inside);
+  bool found = false;
+  char line[512];
+  while (fgets(line, sizeof(line), maps)) {
+    size_t from = 0;
+    size_t to = 0;
+    char perms[8] = {0};
+    if (sscanf(line, "%zx-%zx %7s", &from, &to, perms) == 3
+        && strncmp(perms, "r-xp", 4) == 0 && from <= needle && needle < to) {
+      *begin = from;
+      *end = to;
+      found = true;
+      break;
+    }
+  }
+  fclose(maps);
+  return found;
+}
+
+} // namespace
+
+size_t remap_text_onto_hugepages(size_t max_bytes) {
+  size_t text_begin = 0;
+  size_t text_end = 0;
+  if (!find_text_mapping(reinterpret_cast<const void *>(&remap_text_onto_hugepages), &text_begin, &text_end)) {
+    kprintf("hugepage-text: can't locate own text mapping, skipped\n");
+    return 0;
+  }
+
+  // the remap loop below executes from this very mapping: everything from the
+  // hugepage containing this function onwards is left alone, so the running
+  // code is never pulled from under itself; generated hot code sits at the
+  // start of .text and is unaffected by this cap
+  const size_t self_cap = align_down(reinterpret_cast<size_t>(&remap_text_onto_hugepages), HUGE_PAGE_SIZE);
+  const size_t begin = align_up(text_begin, HUGE_PAGE_SIZE);
+  size_t end = align_down(text_end, HUGE_PAGE_SIZE);
+  end = std::min(end, self_cap);
+  if (end > begin + max_bytes) {
+    end = begin + align_down(max_bytes, HUGE_PAGE_SIZE);
+  }
+  if (end <= begin) {
+    kprintf("hugepage-text: less than one hugepage of remappable text, skipped\n");
+    return 0;
+  }
+  const size_t length = end - begin;
+
+  void *scratch = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (scratch == MAP_FAILED) {
+    kprintf("hugepage-text: can't allocate %zu scratch bytes, skipped\n", length);
+    return 0;
+  }
+  memcpy(scratch, reinterpret_cast<void *>(begin), length);
+
+  // MAP_FIXED replaces the file-backed text with anonymous hugetlb pages;
+  // from here until the copy back there must be no calls into the remapped
+  // range, memcpy and this loop live outside it
+  bool hugetlb = true;
+  void *remapped = mmap(reinterpret_cast<void *>(begin), length, PROT_READ | PROT_WRITE | PROT_EXEC,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+  if (remapped == MAP_FAILED) {
+    // no hugetlb pool configured: fall back to ordinary pages and ask for
+    // transparent hugepages, khugepaged collapses them shortly after
+    hugetlb = false;
+    remapped = mmap(reinterpret_cast<void *>(begin), length, PROT_READ | PROT_WRITE | PROT_EXEC,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_POPULATE, -1, 0);
+    if (remapped == MAP_FAILED) {
+      // the original mapping is still intact: MAP_FIXED never got applied
+      munmap(scratch, length);
+      kprintf("hugepage-text: remap failed, text left untouched\n");
+      return 0;
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(remapped, length, MADV_HUGEPAGE);
+#endif
+  }
+  memcpy(remapped, scratch, length);
+  mprotect(remapped, length, PROT_READ | PROT_EXEC);
+  munmap(scratch, length);
+
+  kprintf("hugepage-text: remapped %zu MB of text onto %s hugepages\n",
+          length / (1024 * 1024), hugetlb ? "hugetlb" : "transparent");
+  return length;
+}
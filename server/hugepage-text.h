@@ -0,0 +1,17 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstddef>
+
+// Self-remap of the binary's code onto 2MB hugepages. Generated code produces
+// hundreds of MB of .text and a 4KB iTLB entry covers almost none of it; one
+// hugepage entry covers 512x more. Hot generated functions are packed at the
+// start of .text (see __attribute__((hot)) emission in codegen), so remapping
+// the first N MB covers the hot portion first. Must run before the master
+// forks: the remapped pages are inherited and never written, every worker
+// shares the same physical hugepages.
+// Returns the number of bytes actually remapped, 0 when nothing was done.
+size_t remap_text_onto_hugepages(size_t max_bytes);
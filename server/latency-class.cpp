@@ -0,0 +1,44 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/latency-class.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "common/kprintf.h"
+
+static constexpr int MAX_LATENCY_CLASSES = 16;
+static latency_class_t latency_classes[MAX_LATENCY_CLASSES];
+static int latency_classes_n = 0;
+
+int register_latency_class(const char *description) {
+  if (latency_classes_n == MAX_LATENCY_CLASSES) {
+    kprintf("too many latency classes, at most %d are supported\n", MAX_LATENCY_CLASSES);
+    return -1;
+  }
+  latency_class_t &cls = latency_classes[latency_classes_n];
+  int deadline_ms = 0;
+  if (sscanf(description, "%31[^:]:%127[^:]:%d", cls.name, cls.uri_prefix, &deadline_ms) != 3 || deadline_ms < 0) {
+    kprintf("cannot parse latency class: expected <name>:<uri-prefix>:<queue-deadline-ms>, got '%s'\n", description);
+    return -1;
+  }
+  cls.uri_prefix_len = static_cast<int>(strlen(cls.uri_prefix));
+  cls.queue_deadline = deadline_ms * 0.001;
+  latency_classes_n++;
+  return 0;
+}
+
+const latency_class_t *classify_request_uri(const char *uri, int uri_len) {
+  const latency_class_t *best = nullptr;
+  for (int i = 0; i < latency_classes_n; i++) {
+    const latency_class_t &cls = latency_classes[i];
+    if (cls.uri_prefix_len <= uri_len && !memcmp(uri, cls.uri_prefix, cls.uri_prefix_len)) {
+      if (best == nullptr || cls.uri_prefix_len > best->uri_prefix_len) {
+        best = &cls;
+      }
+    }
+  }
+  return best;
+}
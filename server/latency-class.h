@@ -0,0 +1,25 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+// Named request latency classes: sub-10ms API calls shouldn't be started after
+// waiting behind a burst of slow report endpoints. A class is configured per
+// URI prefix with --latency-class <name>:<uri-prefix>:<queue-deadline-ms>;
+// a request whose queue wait already exceeds its class deadline is shed
+// instead of started - its caller has given up on a fast answer anyway,
+// and the freed slot goes to a request that can still meet its deadline.
+
+struct latency_class_t {
+  char name[32];
+  char uri_prefix[128];
+  int uri_prefix_len;
+  double queue_deadline; // in seconds; how long the request may wait for a free script slot
+};
+
+// parses "<name>:<uri-prefix>:<queue-deadline-ms>"; returns -1 on error
+int register_latency_class(const char *description);
+
+// the longest matching prefix wins; nullptr when no class is configured for this uri
+const latency_class_t *classify_request_uri(const char *uri, int uri_len);
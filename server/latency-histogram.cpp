@@ -0,0 +1,113 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/latency-histogram.h"
+
+#include <cassert>
+#include <cmath>
+#include <sys/mman.h>
+
+#include "common/dl-utils-lite.h"
+
+size_t LatencyHistogram::bucket_index(uint64_t microseconds) noexcept {
+  if (microseconds < SUB_BUCKETS) {
+    return microseconds;
+  }
+  const size_t msb = 63 - __builtin_clzll(microseconds);
+  const size_t range = msb - SUB_BUCKET_BITS + 1;
+  if (range >= RANGES) {
+    return BUCKETS - 1;
+  }
+  const size_t sub = (microseconds >> (range - 1)) & (SUB_BUCKETS - 1);
+  return range * SUB_BUCKETS + sub;
+}
+
+double LatencyHistogram::bucket_value(size_t index) noexcept {
+  const size_t range = index / SUB_BUCKETS;
+  const size_t sub = index % SUB_BUCKETS;
+  // the middle of the bucket, converted back to seconds
+  const double microseconds = range == 0 ? sub : (((SUB_BUCKETS + sub) << (range - 1)) + 0.5 * (1u << (range - 1)));
+  return microseconds * 1e-6;
+}
+
+void LatencyHistogram::record(double seconds) noexcept {
+  const uint64_t microseconds = seconds > 0 ? static_cast<uint64_t>(std::round(seconds * 1e6)) : 0;
+  buckets_[bucket_index(microseconds)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() noexcept {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::add_from(const LatencyHistogram &other) noexcept {
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    buckets_[i].fetch_add(other.buckets_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::sub_from(const LatencyHistogram &other) noexcept {
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    buckets_[i].fetch_sub(other.buckets_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+}
+
+int64_t LatencyHistogram::total_count() const noexcept {
+  int64_t total = 0;
+  for (const auto &bucket : buckets_) {
+    total += bucket.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+double LatencyHistogram::get_percentile(double percentile) const noexcept {
+  const int64_t total = total_count();
+  if (total == 0) {
+    return 0;
+  }
+  const auto rank = static_cast<int64_t>(std::ceil(percentile / 100 * total));
+  int64_t seen = 0;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      return bucket_value(i);
+    }
+  }
+  return bucket_value(BUCKETS - 1);
+}
+
+static worker_latency_histograms_t *histogram_slabs;
+static int histogram_slabs_n;
+static worker_latency_histograms_t *my_slab;
+
+void init_worker_latency_histograms(int slots) {
+  const size_t mem_len = sizeof(worker_latency_histograms_t) * slots;
+  histogram_slabs = static_cast<worker_latency_histograms_t *>(
+    mmap(nullptr, mem_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  dl_passert (histogram_slabs != MAP_FAILED, "failed to mmap worker latency histograms");
+  histogram_slabs_n = slots;
+}
+
+void worker_latency_histograms_set_slot(int slot) {
+  assert (histogram_slabs != nullptr && 0 <= slot && slot < histogram_slabs_n);
+  my_slab = &histogram_slabs[slot];
+}
+
+void worker_latency_histograms_record(double working_time, double net_time, double script_time) noexcept {
+  if (my_slab == nullptr) {
+    return;
+  }
+  my_slab->working_time.record(working_time);
+  my_slab->net_time.record(net_time);
+  my_slab->script_time.record(script_time);
+}
+
+void worker_latency_histograms_collect(worker_latency_histograms_t *to) noexcept {
+  for (int i = 0; i < histogram_slabs_n; ++i) {
+    to->working_time.add_from(histogram_slabs[i].working_time);
+    to->net_time.add_from(histogram_slabs[i].net_time);
+    to->script_time.add_from(histogram_slabs[i].script_time);
+  }
+}
@@ -0,0 +1,61 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// HDR-style log-linear latency histogram: a sample in microseconds selects a
+// power-of-two range and the range is split into SUB_BUCKETS linear
+// sub-buckets, which bounds the relative error of any reported percentile by
+// 1/SUB_BUCKETS over 1us..~1000s. Recording is a single relaxed fetch_add,
+// so workers may update a histogram living in shared memory wait-free while
+// the master reads it; aggregation is a plain bucket-wise sum.
+class LatencyHistogram {
+public:
+  void record(double seconds) noexcept;
+
+  void reset() noexcept;
+  void add_from(const LatencyHistogram &other) noexcept;
+  void sub_from(const LatencyHistogram &other) noexcept;
+
+  int64_t total_count() const noexcept;
+  // percentile is in [0, 100], e.g. 99.9; returns seconds, 0 if the histogram is empty
+  double get_percentile(double percentile) const noexcept;
+
+private:
+  static constexpr size_t SUB_BUCKET_BITS{4};
+  static constexpr size_t SUB_BUCKETS{1u << SUB_BUCKET_BITS};
+  // range 0 is the exact linear part [0, SUB_BUCKETS); range r >= 1 covers
+  // microseconds in [2^(r + SUB_BUCKET_BITS - 1), 2^(r + SUB_BUCKET_BITS)),
+  // so 27 ranges reach ~1073 seconds; larger samples land in the last bucket
+  static constexpr size_t RANGES{27};
+  static constexpr size_t BUCKETS{RANGES * SUB_BUCKETS};
+
+  static size_t bucket_index(uint64_t microseconds) noexcept;
+  static double bucket_value(size_t index) noexcept;
+
+  std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+};
+
+// per-worker slabs of latency histograms living in MAP_SHARED memory:
+// the master maps them before the first fork, every worker inherits the
+// mapping and updates only its own slot, the master sums all slots on demand
+struct worker_latency_histograms_t {
+  LatencyHistogram working_time;
+  LatencyHistogram net_time;
+  LatencyHistogram script_time;
+};
+
+// master, before the first fork
+void init_worker_latency_histograms(int slots);
+// worker, right after fork: bind this process to its slab
+void worker_latency_histograms_set_slot(int slot);
+// worker: wait-free; does nothing until the slab is bound
+void worker_latency_histograms_record(double working_time, double net_time, double script_time) noexcept;
+// master: bucket-wise sum of all worker slabs into *to
+void worker_latency_histograms_collect(worker_latency_histograms_t *to) noexcept;
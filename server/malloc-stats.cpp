@@ -0,0 +1,33 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/malloc-stats.h"
+
+#include <cstdint>
+
+// jemalloc's control interface; weak, so the binary links fine with glibc
+// malloc and the pointer is simply null then
+extern "C" int mallctl(const char *name, void *oldp, size_t *oldlenp, void *newp, size_t newlen) __attribute__((weak));
+
+void write_malloc_allocator_stats_to(stats_t *stats) noexcept {
+  if (mallctl == nullptr) {
+    return;
+  }
+  // jemalloc caches its stats; bumping the epoch refreshes them
+  uint64_t epoch = 1;
+  size_t epoch_len = sizeof(epoch);
+  if (mallctl("epoch", &epoch, &epoch_len, &epoch, sizeof(epoch)) != 0) {
+    return;
+  }
+  const char *counters[] = {"stats.allocated", "stats.active", "stats.metadata", "stats.resident", "stats.mapped"};
+  const char *suffixes[] = {"memory.malloc.allocated", "memory.malloc.active", "memory.malloc.metadata",
+                            "memory.malloc.resident", "memory.malloc.mapped"};
+  for (size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); ++i) {
+    size_t value = 0;
+    size_t value_len = sizeof(value);
+    if (mallctl(counters[i], &value, &value_len, nullptr, 0) == 0) {
+      add_histogram_stat_long(stats, suffixes[i], static_cast<int64_t>(value));
+    }
+  }
+}
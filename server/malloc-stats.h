@@ -0,0 +1,14 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include "common/stats/provider.h"
+
+// Heap allocator introspection for binaries linked with a malloc replacement
+// (KPHP_ALLOCATOR=jemalloc): exports memory.malloc.* so allocator-level
+// fragmentation (resident vs allocated) is visible next to the RSS stats.
+// The runtime is built without any allocator headers - jemalloc's mallctl is
+// resolved as a weak symbol at link time, with glibc malloc this is a no-op.
+void write_malloc_allocator_stats_to(stats_t *stats) noexcept;
@@ -0,0 +1,120 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/numa-configuration.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "common/kprintf.h"
+
+namespace {
+
+constexpr int MAX_NUMA_NODES = 64;
+
+cpu_set_t node_cpus[MAX_NUMA_NODES];
+int numa_nodes_count = 0;
+bool numa_aware_enabled = false;
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+
+// parses a sysfs cpulist like "0-7,16-23" into a cpu_set_t
+bool parse_cpulist(const char *cpulist, cpu_set_t *cpus) {
+  CPU_ZERO(cpus);
+  const char *p = cpulist;
+  while (*p != '\0' && *p != '\n') {
+    char *p_end;
+    long first = strtol(p, &p_end, 10);
+    long last = first;
+    if (p_end == p) {
+      return false;
+    }
+    p = p_end;
+    if (*p == '-') {
+      last = strtol(p + 1, &p_end, 10);
+      if (p_end == p + 1) {
+        return false;
+      }
+      p = p_end;
+    }
+    for (long cpu = first; cpu <= last; cpu++) {
+      if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+      }
+      CPU_SET(cpu, cpus);
+    }
+    if (*p == ',') {
+      p++;
+    }
+  }
+  return CPU_COUNT(cpus) > 0;
+}
+
+int discover_numa_nodes() {
+  int nodes_found = 0;
+  for (int node = 0; node < MAX_NUMA_NODES; node++) {
+    char path[100];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE *f = fopen(path, "r");
+    if (f == nullptr) {
+      break;
+    }
+    char cpulist[4096];
+    const bool read_ok = fgets(cpulist, sizeof(cpulist), f) != nullptr;
+    fclose(f);
+    if (!read_ok || !parse_cpulist(cpulist, &node_cpus[nodes_found])) {
+      kprintf("failed to parse %s, NUMA aware workers disabled\n", path);
+      return 0;
+    }
+    nodes_found++;
+  }
+  return nodes_found;
+}
+
+} // namespace
+
+bool enable_numa_aware_workers() {
+  numa_nodes_count = discover_numa_nodes();
+  if (numa_nodes_count <= 1) {
+    kprintf("host has %d memory node(s), NUMA aware workers have no effect\n", numa_nodes_count);
+    return false;
+  }
+  numa_aware_enabled = true;
+  vkprintf(1, "NUMA aware workers enabled: %d nodes discovered\n", numa_nodes_count);
+  return true;
+}
+
+bool numa_aware_workers_enabled() {
+  return numa_aware_enabled;
+}
+
+void numa_bind_worker(int worker_index) {
+  if (!numa_aware_enabled) {
+    return;
+  }
+  const int node = worker_index % numa_nodes_count;
+
+  if (sched_setaffinity(0, sizeof(cpu_set_t), &node_cpus[node]) != 0) {
+    kprintf("failed to pin worker %d to numa node %d cpus: %m\n", worker_index, node);
+    return;
+  }
+
+  // the script arena and heap are mmap'ed in the worker after this point, so a preferred
+  // memory policy makes them node-local; MPOL_PREFERRED (unlike MPOL_BIND) falls back to
+  // remote nodes instead of failing allocations when the node runs out of free pages.
+  // shared regions (confdata, instance cache) are already faulted in by the master and
+  // are not affected; replicating them per node would need a publisher per node
+  unsigned long nodemask = 1UL << node;
+  if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, &nodemask, sizeof(nodemask) * 8) != 0) {
+    kprintf("failed to set preferred memory node %d for worker %d: %m\n", node, worker_index);
+    return;
+  }
+
+  vkprintf(1, "worker %d bound to numa node %d\n", worker_index, node);
+}
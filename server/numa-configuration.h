@@ -0,0 +1,16 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+// discovers the NUMA topology from sysfs and enables node-aware worker placement;
+// returns false if the host has no (or only one) memory node
+bool enable_numa_aware_workers();
+
+bool numa_aware_workers_enabled();
+
+// pins the calling worker to the cpus of its node (chosen round-robin by worker_index)
+// and prefers node-local memory for all its future allocations, including the script arena;
+// must be called in the worker process right after fork
+void numa_bind_worker(int worker_index);
@@ -0,0 +1,146 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/perf-counters.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "common/kprintf.h"
+
+namespace {
+
+constexpr size_t COUNTERS_COUNT = 4;
+
+struct counter_config_t {
+  uint32_t type;
+  uint64_t config;
+};
+
+// the order must match the accumulation in finish_request_perf_counters
+constexpr counter_config_t counter_configs[COUNTERS_COUNT] = {
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+  {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_ITLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+};
+
+// PERF_FORMAT_GROUP read layout
+struct group_read_t {
+  uint64_t nr;
+  uint64_t time_enabled;
+  uint64_t time_running;
+  uint64_t values[COUNTERS_COUNT];
+};
+
+bool perf_counters_enabled = false;
+bool open_attempted = false;
+int group_leader_fd = -1;
+
+int perf_event_open(perf_event_attr *attr, int group_fd) noexcept {
+  return static_cast<int>(syscall(__NR_perf_event_open, attr, 0 /* this thread */, -1 /* any cpu */, group_fd, 0));
+}
+
+void open_counter_group() noexcept {
+  open_attempted = true;
+  int fds[COUNTERS_COUNT];
+  for (size_t i = 0; i < COUNTERS_COUNT; ++i) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = counter_configs[i].type;
+    attr.config = counter_configs[i].config;
+    attr.disabled = i == 0;
+    // user space only: counting kernel time needs perf_event_paranoid <= 1,
+    // and the script code we are after runs in user space anyway
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    fds[i] = perf_event_open(&attr, i == 0 ? -1 : fds[0]);
+    if (fds[i] < 0) {
+      kprintf("can't open perf counter group (counter %zu): %m; request perf counters are disabled\n", i);
+      for (size_t j = 0; j < i; ++j) {
+        close(fds[j]);
+      }
+      return;
+    }
+  }
+  // sibling fds are owned by the group and only the leader is ioctl'd with
+  // PERF_IOC_FLAG_GROUP, but keeping them open is required for reading
+  group_leader_fd = fds[0];
+}
+
+} // namespace
+
+void PerfCounterSamples::add_from(const PerfCounterSamples &other) noexcept {
+  sampled_requests += other.sampled_requests;
+  cycles += other.cycles;
+  instructions += other.instructions;
+  llc_misses += other.llc_misses;
+  itlb_misses += other.itlb_misses;
+}
+
+void enable_request_perf_counters() {
+  perf_counters_enabled = true;
+}
+
+void start_request_perf_counters() noexcept {
+  if (!perf_counters_enabled) {
+    return;
+  }
+  if (!open_attempted) {
+    open_counter_group();
+  }
+  if (group_leader_fd < 0) {
+    return;
+  }
+  ioctl(group_leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group_leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void finish_request_perf_counters(PerfCounterSamples *into) noexcept {
+  if (group_leader_fd < 0) {
+    return;
+  }
+  ioctl(group_leader_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  group_read_t group_read;
+  if (read(group_leader_fd, &group_read, sizeof(group_read)) != sizeof(group_read) || group_read.nr != COUNTERS_COUNT) {
+    return;
+  }
+  // rescale for kernel multiplexing; time_running == 0 means the group never
+  // got a PMU slot during this request, better to drop the sample than skew
+  if (group_read.time_running == 0) {
+    return;
+  }
+  const double scale = static_cast<double>(group_read.time_enabled) / static_cast<double>(group_read.time_running);
+  into->sampled_requests++;
+  into->cycles += static_cast<uint64_t>(group_read.values[0] * scale);
+  into->instructions += static_cast<uint64_t>(group_read.values[1] * scale);
+  into->llc_misses += static_cast<uint64_t>(group_read.values[2] * scale);
+  into->itlb_misses += static_cast<uint64_t>(group_read.values[3] * scale);
+}
+
+void write_perf_counter_stats_to(stats_t *stats, const char *prefix, const PerfCounterSamples &samples) noexcept {
+  if (samples.sampled_requests == 0) {
+    return;
+  }
+  char buffer[256]{0};
+  const auto write_counter = [&](const char *suffix, uint64_t value) {
+    const int len = snprintf(buffer, sizeof(buffer) - 1, "%s.%s", prefix, suffix);
+    assert(len > 0 && sizeof(buffer) >= static_cast<size_t>(len + 1));
+    add_histogram_stat_long(stats, buffer, static_cast<int64_t>(value));
+  };
+  write_counter("sampled_requests", samples.sampled_requests);
+  write_counter("cycles", samples.cycles);
+  write_counter("instructions", samples.instructions);
+  write_counter("llc_misses", samples.llc_misses);
+  write_counter("itlb_misses", samples.itlb_misses);
+}
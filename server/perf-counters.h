@@ -0,0 +1,42 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/stats/provider.h"
+
+// Opt-in hardware performance counters per request: one perf_event group
+// (cycles, instructions, LLC misses, iTLB misses) is opened per worker and
+// read at script start/end, so regressions like icache blowup from a codegen
+// change show up in the regular stats instead of requiring a perf session on
+// a live host. The group is multiplexed by the kernel when the PMU is short
+// on slots; the deltas are rescaled by time_enabled/time_running, which makes
+// them estimates, not exact counts.
+
+// accumulated multiplex-scaled counter deltas; standard-layout,
+// it is memcpy'd worker -> master as a part of PhpWorkerStats
+struct PerfCounterSamples {
+  uint64_t sampled_requests{0};
+  uint64_t cycles{0};
+  uint64_t instructions{0};
+  uint64_t llc_misses{0};
+  uint64_t itlb_misses{0};
+
+  void add_from(const PerfCounterSamples &other) noexcept;
+};
+
+// remembers that --request-perf-counters was given; the counter group itself
+// is opened lazily in each worker on its first request
+void enable_request_perf_counters();
+
+// worker: resets and enables the group; does nothing when not enabled or
+// when perf_event_open is unavailable (kernel.perf_event_paranoid, VM without PMU)
+void start_request_perf_counters() noexcept;
+
+// worker: disables the group and accumulates the scaled deltas into *into
+void finish_request_perf_counters(PerfCounterSamples *into) noexcept;
+
+void write_perf_counter_stats_to(stats_t *stats, const char *prefix, const PerfCounterSamples &samples) noexcept;
@@ -47,6 +47,7 @@ extern double load_time;
 /** http **/
 extern int http_port;
 extern int http_sfd;
+extern int listen_reuseport;
 
 /** rpc **/
 extern long long rpc_failed, rpc_sent, rpc_received, rpc_received_news_subscr, rpc_received_news_redirect;
@@ -44,6 +44,7 @@
 #include "net/net-mysql-client.h"
 #include "net/net-sockaddr-storage.h"
 #include "net/net-socket.h"
+#include "net/net-trace.h"
 #include "net/net-tcp-connections.h"
 #include "net/net-tcp-rpc-client.h"
 #include "net/net-tcp-rpc-server.h"
@@ -51,7 +52,12 @@
 #include "runtime/interface.h"
 #include "runtime/profiler.h"
 #include "server/confdata-binlog-replay.h"
+#include "server/file-io-pool.h"
+#include "server/hugepage-text.h"
+#include "server/latency-class.h"
 #include "server/lease-config-parser.h"
+#include "server/numa-configuration.h"
+#include "server/perf-counters.h"
 #include "server/php-engine-vars.h"
 #include "server/php-lease.h"
 #include "server/php-master.h"
@@ -61,6 +67,10 @@
 #include "server/php-sql-connections.h"
 #include "server/php-worker-stats.h"
 #include "server/php-worker.h"
+#include "server/rpc-query-phases.h"
+#include "server/sampling-profiler.h"
+#include "server/worker-control-block.h"
+#include "server/worker-group.h"
 
 static void turn_sigterm_on();
 
@@ -312,6 +322,8 @@ php_worker *php_worker_create(php_worker_mode_t mode, connection *c, http_query_
 
   worker->req_id = req_id;
 
+  worker->latency_class = http_data != nullptr ? classify_request_uri(http_data->uri, http_data->uri_len) : nullptr;
+
   if (worker->conn->target) {
     worker->target_fd = static_cast<int>(worker->conn->target - Targets);
   } else {
@@ -338,9 +350,21 @@ int has_pending_scripts() {
   return php_worker_run_flag || pending_http_queue.first_query != (conn_query *)&pending_http_queue;
 }
 
+void php_worker_terminate(php_worker *worker, int flag, script_error_t terminate_reason, const char *error_message);
+
 /** trying to start query **/
 void php_worker_try_start(php_worker *worker) {
 
+  if (!worker->terminate_flag && worker->latency_class != nullptr && worker->latency_class->queue_deadline > 0
+      && precise_now - worker->init_time > worker->latency_class->queue_deadline) {
+    vkprintf (1, "shed php script [req_id = %016llx]: waited %.3lf over '%s' class deadline %.3lf\n",
+              worker->req_id, precise_now - worker->init_time, worker->latency_class->name, worker->latency_class->queue_deadline);
+    if (worker->mode == http_worker && worker->conn != nullptr) {
+      http_return(worker->conn, "SHED", 4);
+    }
+    php_worker_terminate(worker, 0, script_error_t::shed_queue_deadline, "queue wait exceeded latency class deadline");
+  }
+
   if (worker->terminate_flag) {
     worker->state = phpq_finish;
     return;
@@ -371,6 +395,54 @@ void php_worker_try_start(php_worker *worker) {
   worker->state = phpq_init_script;
 }
 
+//creating the script context is the expensive part of the first request after
+//a worker (re)start: the arena mmap gets faulted in and the ucontext stack set up;
+//doing it while the worker is idle keeps that cost off the request latency path
+void warmup_php_script() {
+  if (php_script == nullptr) {
+    php_script = php_script_create((size_t)max_memory, (size_t)(8 << 20));
+  }
+}
+
+//runs the developer-provided warmup function (KphpConfiguration
+//DEFAULT_RUNTIME_OPTIONS['--warmup-function'], registered as the "@warmup" script
+//in codegen) inside a normal script context, so compiled regexps and other
+//per-worker caches are populated before the worker starts serving traffic;
+//the event loop is not running yet, so the routine must not do outgoing queries
+void run_warmup_routine() {
+  script_t *warmup_script = get_script("@warmup");
+  if (warmup_script == nullptr) {
+    return;
+  }
+  get_utime_monotonic();
+  const double warmup_start = precise_now;
+  warmup_php_script();
+  // null query data is the console-mode shape: init_superglobals then builds an
+  // empty environment instead of expecting http or rpc query fields
+  php_script_init(php_script, warmup_script, nullptr);
+  php_script_set_timeout(DEFAULT_SCRIPT_TIMEOUT);
+  while (true) {
+    const run_state_t state = php_script_get_state(php_script);
+    if (state == run_state_t::ready) {
+      php_script_iterate(php_script);
+      continue;
+    }
+    if (state == run_state_t::query || state == run_state_t::query_running) {
+      vkprintf (-1, "warmup function attempted an outgoing query, terminating it\n");
+      php_script_terminate(php_script, "outgoing queries are not allowed in the warmup function", script_error_t::net_event_error);
+      continue;
+    }
+    break;
+  }
+  if (php_script_get_state(php_script) == run_state_t::error) {
+    vkprintf (-1, "warmup function failed: %s\n", php_script_get_error(php_script));
+  }
+  php_script_finish(php_script);
+  php_script_clear(php_script);
+  get_utime_monotonic();
+  vkprintf (1, "warmup function finished in %.3lf seconds\n", precise_now - warmup_start);
+}
+
 void php_worker_init_script(php_worker *worker) {
   double timeout = worker->finish_time - precise_now - 0.01;
   if (worker->terminate_flag || timeout < 0.2) {
@@ -392,6 +464,7 @@ void php_worker_init_script(php_worker *worker) {
 
   get_utime_monotonic();
   worker->start_time = precise_now;
+  trace_request_event(worker->conn, trace_event_type::script_start);
   vkprintf (1, "START php script [req_id = %016llx]\n", worker->req_id);
   assert (active_worker == nullptr);
   active_worker = worker;
@@ -402,11 +475,12 @@ void php_worker_init_script(php_worker *worker) {
 
   script_t *script = get_script("#0");
   dl_assert (script != nullptr, "failed to get script");
-  if (php_script == nullptr) {
-    php_script = php_script_create((size_t)max_memory, (size_t)(8 << 20));
-  }
+  warmup_php_script();
   php_script_init(php_script, script, worker->data);
   php_script_set_timeout(timeout);
+  // outgoing query timeouts are clamped to this; a header-derived deadline
+  // may tighten it further during superglobals initialization
+  set_request_deadline_time(worker->finish_time);
   worker->state = phpq_run;
 }
 
@@ -480,6 +554,7 @@ void php_worker_run_rpc_send_query(net_query_t *query) {
   connection *conn = get_target_connection(target, 0);
 
   if (conn != nullptr) {
+    rpc_query_phases_on_send(slot_id, inet_sockaddr_port(&target->endpoint));
     send_rpc_query(conn, TL_RPC_INVOKE_REQ, slot_id, (int *)query->request, query->request_size);
     conn->last_query_sent_time = precise_now;
   } else {
@@ -489,6 +564,9 @@ void php_worker_run_rpc_send_query(net_query_t *query) {
       return;
     }
 
+    // the actual write happens when the connection comes up; from the phase
+    // breakdown's point of view the query has left the script's queue here
+    rpc_query_phases_on_send(slot_id, inet_sockaddr_port(&target->endpoint));
     command_t *command = create_command_net_writer(query->request, query->request_size, &command_net_write_rpc_base, slot_id);
     double timeout = fix_timeout(query->timeout_ms * 0.001) + precise_now;
     create_delayed_send_query(target, command, timeout);
@@ -555,6 +633,77 @@ void php_worker_run_rpc_answer_query(php_worker *worker, php_query_rpc_answer *a
   php_script_query_answered(php_script);
 }
 
+// --client-write-buffer-limit: cap on bytes buffered in c->Out for a streaming
+// response; above it flush() pauses the script until the client drains the
+// connection instead of growing the buffer until the whole engine feels it
+long long client_write_buffer_limit;
+
+static void php_worker_wait_output_drain(php_worker *worker, connection *c) {
+  if (client_write_buffer_limit <= 0 || c->Out.total_bytes <= client_write_buffer_limit) {
+    return;
+  }
+
+  vkprintf (2, "flush: %d buffered bytes for fd %d are over the write buffer limit, waiting for the client\n", c->Out.total_bytes, c->fd);
+
+  // drain to half the limit, so a script producing faster than the client reads
+  // does not stop and restart on every flush
+  const long long drain_target = client_write_buffer_limit / 2;
+
+  pollfd poll_fds;
+  poll_fds.fd = c->fd;
+  poll_fds.events = POLLOUT;
+
+  while (c->Out.total_bytes > drain_target) {
+    const double left_time = worker->finish_time - get_utime_monotonic();
+    if (left_time < 0.01) {
+      // the script deadline sheds the worst offenders: the worker is terminated
+      // by its timeout and the buffered bytes go away with the connection
+      break;
+    }
+
+    const int r = poll(&poll_fds, 1, (int)(left_time * 1000 + 1));
+    if (r > 0) {
+      if (poll_fds.revents & (POLLERR | POLLHUP)) {
+        c->status = conn_error;
+        c->error = -1;
+        break;
+      }
+      c->flags &= ~C_NOWR;
+      flush_connection_output(c);
+      if (c->error) {
+        break;
+      }
+    } else if (r < 0 && errno != EINTR) {
+      break;
+    }
+  }
+}
+
+void php_worker_run_http_flush_query(php_worker *worker, php_query_http_flush_t *query) {
+  php_script_query_readed(php_script);
+  if (worker->mode == http_worker && worker->conn != nullptr && !worker->terminate_flag) {
+    connection *c = worker->conn;
+    if (query->headers_len > 0) {
+      write_out(&c->Out, query->headers, query->headers_len);
+    }
+    if (query->body_len > 0) {
+      char chunk_size[16];
+      int chunk_size_len = snprintf(chunk_size, sizeof(chunk_size), "%x\r\n", query->body_len);
+      write_out(&c->Out, chunk_size, chunk_size_len);
+      write_out(&c->Out, query->body, query->body_len);
+      write_out(&c->Out, "\r\n", 2);
+    }
+    if (query->is_last) {
+      write_out(&c->Out, "0\r\n\r\n", 5);
+    }
+    // hand the accumulated bytes to the writer right away, the script continues running;
+    // backpressure stays in c->Out — the event loop drains it while the worker computes
+    flush_connection_output(c);
+    php_worker_wait_output_drain(worker, c);
+  }
+  php_script_query_answered(php_script);
+}
+
 int php_worker_http_load_post_impl(php_worker *worker, char *buf, int min_len, int max_len) {
   assert (worker != nullptr);
 
@@ -756,6 +905,10 @@ void php_worker_run_query(php_worker *worker) {
       query_stats.desc = "HTTP_LOAD_POST";
       php_worker_http_load_post(worker, (php_query_http_load_post_t *)q_base);
       break;
+    case PHPQ_HTTP_FLUSH:
+      query_stats.desc = "HTTP_FLUSH";
+      php_worker_run_http_flush_query(worker, (php_query_http_flush_t *)q_base);
+      break;
     default:
       assert ("unknown php_query type" && 0);
   }
@@ -816,6 +969,24 @@ void php_worker_set_result(php_worker *worker, script_result *res) {
     if (worker->mode == http_worker) {
       if (res == nullptr) {
         http_return(worker->conn, "OK", 2);
+      } else if (res->compression != 0) {
+        // the headers deliberately lack Content-Length: drop the blank line,
+        // compress the body outside of script context and finish the header
+        // block here; on failure the body is sent as is
+        const char *compressed_body = nullptr;
+        int compressed_len = http_compress_response_body(res->body, res->body_len, res->compression, &compressed_body);
+        write_out(&worker->conn->Out, res->headers, res->headers_len - 2);
+        char tail_headers[64];
+        if (compressed_len >= 0) {
+          int tail_len = snprintf(tail_headers, sizeof(tail_headers), "Content-Encoding: %s\r\nContent-Length: %d\r\n\r\n",
+                                  res->compression == HTTP_COMPRESSION_GZIP ? "gzip" : "deflate", compressed_len);
+          write_out(&worker->conn->Out, tail_headers, tail_len);
+          write_out(&worker->conn->Out, compressed_body, compressed_len);
+        } else {
+          int tail_len = snprintf(tail_headers, sizeof(tail_headers), "Content-Length: %d\r\n\r\n", res->body_len);
+          write_out(&worker->conn->Out, tail_headers, tail_len);
+          write_out(&worker->conn->Out, res->body, res->body_len);
+        }
       } else {
         write_out(&worker->conn->Out, res->headers, res->headers_len);
         write_out(&worker->conn->Out, res->body, res->body_len);
@@ -927,6 +1098,7 @@ void php_worker_free_script(php_worker *worker) {
   int f = 0;
 
   get_utime_monotonic();
+  trace_request_event(worker->conn, trace_event_type::script_end);
   double worked = precise_now - worker->start_time;
   double waited = worker->start_time - worker->init_time;
 
@@ -957,11 +1129,23 @@ void php_worker_free_script(php_worker *worker) {
   php_script_clear(php_script);
 
   static int finished_queries = 0;
-  if ((++finished_queries) % queries_to_recreate_script == 0
-      || (!use_madvise_dontneed && php_script_memory_get_total_usage(php_script) > memory_used_to_recreate_script)) {
+  ++finished_queries;
+  if (use_madvise_dontneed) {
+    // the arena is trimmed in place between requests (see PHPScriptBase::clear),
+    // so periodic recreation buys nothing; restart the worker only when memory
+    // keeps growing monotonically - a leak that trimming can't give back
+    if (php_script_leak_like_growth_detected(php_script)) {
+      vkprintf(0, "leak-like memory growth detected, restarting worker gracefully\n");
+      turn_sigterm_on();
+    }
+  } else if (finished_queries % queries_to_recreate_script == 0
+             || php_script_memory_get_total_usage(php_script) > memory_used_to_recreate_script) {
     php_script_free(php_script);
     php_script = nullptr;
     finished_queries = 0;
+    //the replacement context is created right away, between requests,
+    //so the next query doesn't pay for the arena setup
+    warmup_php_script();
   }
 
   worker->state = phpq_finish;
@@ -1578,21 +1762,25 @@ int rpcx_execute(connection *c, int op, raw_message *raw) {
       double actual_script_timeout = custom_settings.has_timeout() ? normalize_script_timeout(custom_settings.php_timeout_ms / 1000.0) : script_timeout;
       set_connection_timeout(c, actual_script_timeout);
 
-      char buf[len + 1];
+      //the query bytes are fetched straight into the buffer rpc_query_data will own,
+      //without an intermediate stack copy
+      int *buf = static_cast<int *>(malloc(len));
       auto fetched_bytes = tl_fetch_data(buf, len);
       if (fetched_bytes == -1) {
+        free(buf);
         client_rpc_error(c, req_id, tl_fetch_error_code(), tl_fetch_error_string());
         return 0;
       }
       assert(fetched_bytes == len);
       auto D = TCP_RPC_DATA(c);
-      rpc_query_data *rpc_data = rpc_query_data_create(reinterpret_cast<int *>(buf), len / static_cast<int>(sizeof(int)),
+      rpc_query_data *rpc_data = rpc_query_data_create(buf, len / static_cast<int>(sizeof(int)),
                                                        req_id, D->remote_pid.ip, D->remote_pid.port,
                                                        D->remote_pid.pid, D->remote_pid.utime);
 
       php_worker *worker = php_worker_create(run_once ? once_worker : rpc_worker, c, nullptr, rpc_data,
                                              actual_script_timeout, req_id);
       D->extra = worker;
+      lease_on_task_arrival(worker->target_fd);
 
       c->status = conn_wait_net;
       rpcx_func_wakeup(c);
@@ -2030,6 +2218,7 @@ void write_full_stats_to_pipe() {
 sig_atomic_t pipe_fast_packet_id = 0;
 
 void write_immediate_stats_to_pipe() {
+  publish_worker_control_block(*get_imm_stats(), PhpWorkerStats::get_local().total_queries());
   if (master_pipe_fast_write != -1) {
 #define QSIZE (sizeof (php_immediate_stats_t) + 1 + sizeof (int) * 5 + 3) & -4
     int q[QSIZE] = {0};
@@ -2067,10 +2256,14 @@ void cron() {
   if (master_flag == -1 && getppid() == 1) {
     turn_sigterm_on();
   }
+  // so the master sees fresh worker state without signaling us
+  publish_worker_control_block(*get_imm_stats(), PhpWorkerStats::get_local().total_queries());
+  flush_sampling_profiler_stats();
+  flush_request_trace_events();
 }
 
 int try_get_http_fd() {
-  return server_socket(http_port, settings_addr, backlog, 0);
+  return server_socket(http_port, settings_addr, backlog, listen_reuseport ? SM_REUSEPORT : 0);
 }
 
 void open_json_log() {
@@ -2111,9 +2304,22 @@ void start_server() {
 
   init_netbuffers();
 
+  if (get_worker_groups_count() > 0) {
+    if (!master_flag || !listen_reuseport) {
+      vkprintf (-1, "--worker-group requires master mode with --listen-reuseport\n");
+      exit(1);
+    }
+    // the configured groups fully define the worker set; membership is derived
+    // from the logname id ranges, see server/worker-group.h
+    workers_n = get_total_group_workers();
+    vkprintf (1, "%d worker groups configured, %d workers in total\n", get_worker_groups_count(), workers_n);
+  }
+
   init_epoll();
   if (master_flag) {
-    start_master(http_port > 0 ? &http_sfd : nullptr, &try_get_http_fd, http_port);
+    // with --listen-reuseport the master does not own an http fd at all: every worker binds
+    // its own SO_REUSEPORT socket after the fork and the kernel shards accepts between them
+    start_master(http_port > 0 && !listen_reuseport ? &http_sfd : nullptr, &try_get_http_fd, http_port);
 
     if (logname_pattern != nullptr) {
       reopen_logs();
@@ -2124,8 +2330,8 @@ void start_server() {
   prev_time = 0;
 
   if (http_port > 0 && http_sfd < 0) {
-    dl_assert (!master_flag, "failed to get http_fd\n");
-    if (master_flag) {
+    dl_assert (!master_flag || listen_reuseport, "failed to get http_fd\n");
+    if (master_flag && !listen_reuseport) {
       vkprintf (-1, "try_get_http_fd after start_master\n");
       exit(1);
     }
@@ -2137,7 +2343,7 @@ void start_server() {
   }
 
   if (rpc_port > 0 && rpc_sfd < 0) {
-    rpc_sfd = server_socket(rpc_port, settings_addr, backlog, 0);
+    rpc_sfd = server_socket(rpc_port, settings_addr, backlog, listen_reuseport ? SM_REUSEPORT : 0);
     if (rpc_sfd < 0) {
       vkprintf (-1, "cannot open rpc server socket at port %d: %m\n", rpc_port);
       exit(1);
@@ -2205,6 +2411,11 @@ void start_server() {
 
   dl_allow_all_signals();
 
+  //the master never gets here: start_master returns only in forked workers,
+  //so the script context is warmed up before the first request arrives
+  warmup_php_script();
+  run_warmup_routine();
+
   vkprintf (1, "Server started\n");
   for (int i = 0; !(pending_signals & ~((1ll << SIGUSR1) | (1ll << SIGHUP))); i++) {
     if (verbosity > 0 && !(i & 255)) {
@@ -2288,6 +2499,10 @@ void init_all() {
     script_timeout = run_once ? 1e6 : DEFAULT_SCRIPT_TIMEOUT;
   }
 
+  // must happen before start_master() forks the workers: const_vars_init() inside
+  // global_init_php_scripts() materializes all class constants and static defaults on the master
+  // heap, so the workers map them copy-on-write and never touch the pages (refcounting skips
+  // data marked ExtraRefCnt::for_global_const), sharing one copy of the constant pool
   global_init_runtime_libs();
   global_init_php_scripts();
   global_init_script_allocator();
@@ -2347,6 +2562,8 @@ void init_logname(const char *src) {
 }
 
 /** main arguments parsing **/
+static int hugepage_text_limit_mb = 0;
+
 int main_args_handler(int i) {
   switch (i) {
     case 'D': {
@@ -2586,6 +2803,58 @@ int main_args_handler(int i) {
       kprintf("couldn't set net-dc-mask '%s'\n", optarg);
       return -1;
     }
+    case 2013: {
+      enable_numa_aware_workers();    // no-op on single node hosts, not an error
+      return 0;
+    }
+    case 2014: {
+      if (set_sampling_profiler_log_prefix(optarg)) {
+        return 0;
+      }
+      kprintf("couldn't set sampling-profiler-log-prefix '%s'\n", optarg);
+      return -1;
+    }
+    case 2015: {
+      listen_reuseport = 1;
+      return 0;
+    }
+    case 2016: {
+      return register_latency_class(optarg);
+    }
+    case 2017: {
+      return register_worker_group(optarg);
+    }
+    case 2018: {
+      enable_request_perf_counters();
+      return 0;
+    }
+    case 2019: {
+      return set_request_trace_config(optarg);
+    }
+    case 2020: {
+      hugepage_text_limit_mb = atoi(optarg);
+      if (hugepage_text_limit_mb <= 0) {
+        kprintf("--hugepage-text expects a positive MB limit\n");
+        return -1;
+      }
+      return 0;
+    }
+    case 2021: {
+      file_io_pool_size = atoi(optarg);
+      if (file_io_pool_size <= 0) {
+        kprintf("--file-io-threads expects a positive thread count\n");
+        return -1;
+      }
+      return 0;
+    }
+    case 2022: {
+      client_write_buffer_limit = parse_memory_limit_default(optarg, 'm');
+      if (client_write_buffer_limit <= 0) {
+        kprintf("--client-write-buffer-limit expects a positive size\n");
+        return -1;
+      }
+      return 0;
+    }
 
     default:
       return -1;
@@ -2639,7 +2908,8 @@ void parse_main_args(int argc, char *argv[]) {
   parse_option("fatal-warnings", no_argument, 'K', "script is killed, when warning happened");
   parse_option("worker-queries-to-reload", required_argument, 2000, "worker script is reloaded, when <queries> queries processed (default: 100)");
   parse_option("worker-memory-to-reload", required_argument, 2001, "worker script is reloaded, when <memory> queries processed");
-  parse_option("use-madvise-dontneed", no_argument, 2002, "Use madvise MADV_DONTNEED for script memory above limit");
+  parse_option("use-madvise-dontneed", no_argument, 2002,
+               "Use madvise MADV_DONTNEED for script memory above limit (without --worker-memory-to-reload the limit adapts to the per-request memory peaks)");
   parse_option("instance-cache-memory-limit", required_argument, 2003, "memory limit for instance_cache");
   parse_option("tasks-config", required_argument, 'S', "get lease worker settings from config file: mode and actor");
   parse_option("confdata-binlog", required_argument, 2004, "confdata binlog mask");
@@ -2651,6 +2921,23 @@ void parse_main_args(int argc, char *argv[]) {
   parse_option("profiler-log-prefix", required_argument, 2010, "set profier log path perfix");
   parse_option("mysql-db-name", required_argument, 2011, "database name of MySQL to connect");
   parse_option("net-dc-mask", required_argument, 2012, "a string formatted like '8=1.2.3.4/12' to detect a datacenter by ipv4");
+  parse_option("numa-aware-workers", no_argument, 2013, "pin each worker to a NUMA node (round-robin) and prefer node-local memory for its script arena");
+  parse_option("sampling-profiler-log-prefix", required_argument, 2014, "enable the SIGPROF sampling profiler in workers; per-function sample counts go to <prefix>.<pid>");
+  parse_option("latency-class", required_argument, 2016,
+               "named latency class '<name>:<uri-prefix>:<queue-deadline-ms>'; matching requests that waited longer than the deadline for a free script slot are shed instead of started (can be given several times)");
+  parse_option("listen-reuseport", no_argument, 2015, "each worker binds its own SO_REUSEPORT listening socket, the kernel shards accepts between workers instead of all of them polling one shared socket");
+  parse_option("worker-group", required_argument, 2017,
+               "dedicated worker group '<name>:<workers>:<port>[:<memory-limit-mb>]'; the group's workers bind their own port, so its traffic can't starve the other groups (can be given several times, requires master mode with --listen-reuseport)");
+  parse_option("request-perf-counters", no_argument, 2018,
+               "count hardware events (cycles, instructions, LLC and iTLB misses) per request via perf_event and export them with the worker stats; needs kernel.perf_event_paranoid <= 2");
+  parse_option("request-trace", required_argument, 2019,
+               "sampled request lifecycle tracing '<log-prefix>:<one-in-n>'; 1-in-n parsed queries get parse/script/byte-out transitions timestamped to <log-prefix>.<pid> as one JSON line per event");
+  parse_option("hugepage-text", required_argument, 2020,
+               "remap up to <mb> MB of the binary's code onto 2MB hugepages before workers fork (hot generated code is packed first); falls back to transparent hugepages when no hugetlb pool is configured");
+  parse_option("file-io-threads", required_argument, 2021,
+               "offload blocking file reads (file_get_contents_async) to <n> threads per worker, so a slow disk parks one fork instead of freezing the worker; 0 keeps file reads synchronous");
+  parse_option("client-write-buffer-limit", required_argument, 2022,
+               "cap on response bytes buffered per http connection when a script streams with flush(); above it flush() waits for the client to drain instead of buffering, the script deadline still applies; default unlimited");
   parse_engine_options_long(argc, argv, main_args_handler);
   parse_main_args_till_option(argc, argv);
 }
@@ -2734,6 +3021,12 @@ int run_main(int argc, char **argv, php_mode mode) {
 
   load_time = -dl_time();
 
+  if (hugepage_text_limit_mb > 0) {
+    // before init_default/init_all: the master hasn't forked yet, so every
+    // worker inherits and shares the same physical hugepages
+    remap_text_onto_hugepages(static_cast<size_t>(hugepage_text_limit_mb) * 1024 * 1024);
+  }
+
   init_default();
 
   init_all();
@@ -44,6 +44,19 @@ enum lease_state_t {
 static lease_state_t lease_state = lst_off;
 static int lease_ready_flag = 0; // waiting for something -> equal 0
 
+// pipelined leasing: the worker may announce readiness for up to lease_pipeline_depth
+// tasks on top of the one being processed, so the next task travels over the network
+// while the current one runs and short tasks don't pay a lease round trip each
+static int lease_pipeline_depth = 0;
+static int lease_ready_ahead = 0;   // READYs sent that no task has arrived for yet
+static int lease_tasks_holding = 0; // lease tasks received and not finished yet
+
+OPTION_PARSER(OPT_ENGINE_CUSTOM, "lease-pipeline-depth", required_argument,
+              "number of lease tasks to request ahead of the one being processed (default %d disables pipelining)", lease_pipeline_depth) {
+  lease_pipeline_depth = atoi(optarg);
+  return 0;
+}
+
 extern conn_target_t rpc_client_ct;
 
 int get_target_by_pid(int ip, int port, conn_target_t *ct);
@@ -79,6 +92,29 @@ void lease_on_worker_finish(php_worker *worker) {
     double worked = precise_now - worker->start_time;
     lease_stats_time += worked;
     lease_stats_cnt++;
+    if (lease_tasks_holding > 0) {
+      lease_tasks_holding--;
+    }
+    if (lease_pipeline_depth > 0 && lease_state == lst_on && has_pending_scripts()) {
+      // with another task already queued rpcx_at_query_end won't re-announce, do it here
+      lease_set_ready();
+      run_rpc_lease();
+    }
+  }
+}
+
+void lease_on_task_arrival(int target_fd) {
+  if (lease_state != lst_on || target_fd != rpc_lease_target) {
+    return;
+  }
+  if (lease_ready_ahead > 0) {
+    lease_ready_ahead--;
+  }
+  lease_tasks_holding++;
+  if (lease_pipeline_depth > 0) {
+    // request the next task right away, while this one is being processed
+    lease_set_ready();
+    run_rpc_lease();
   }
 }
 
@@ -232,10 +268,18 @@ static int lease_on() {
     return 0;
   }
   if (has_pending_scripts()) {
-    return 0;
+    // the worker is busy: a READY may leave only as a pipeline prefetch,
+    // each READY asks the tasks engine for one task
+    if (lease_ready_ahead + lease_tasks_holding > lease_pipeline_depth) {
+      return 0;
+    }
+  } else {
+    // an idle worker re-announces itself unconditionally, e.g. after a reconnect
+    lease_ready_ahead = 0;
   }
   // query the tasks engine to get new tasks
   if (rpct_ready(rpc_lease_target) >= 0) {
+    lease_ready_ahead++;
     lease_ready_flag = 0;
     return 1;
   }
@@ -262,6 +306,8 @@ static int lease_finish() {
   }
   rpct_stop_ready(rpc_lease_target);
   rpct_lease_stats(rpc_proxy_target);
+  lease_ready_ahead = 0;
+  lease_tasks_holding = 0;
   lease_change_state(lst_off);
   lease_ready_flag = 1;
   return 1;
@@ -340,6 +386,8 @@ int do_rpc_start_lease(process_id_t pid, double timeout) {
   lease_stats_cnt = 0;
   lease_stats_start_time = precise_now;
   lease_stats_time = 0;
+  lease_ready_ahead = 0;
+  lease_tasks_holding = 0;
 
   lease_change_state(lst_start);
   run_rpc_lease();
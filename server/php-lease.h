@@ -13,6 +13,7 @@
 #include "server/php-worker.h"
 
 void lease_on_worker_finish(php_worker *worker);
+void lease_on_task_arrival(int target_fd);
 void lease_set_ready();
 void lease_on_stop();
 void run_rpc_lease();
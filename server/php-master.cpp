@@ -48,10 +48,17 @@
 #include "runtime/confdata-global-manager.h"
 #include "runtime/instance_cache.h"
 #include "server/confdata-binlog-replay.h"
+#include "server/latency-histogram.h"
+#include "server/malloc-stats.h"
+#include "server/numa-configuration.h"
 #include "server/php-engine-vars.h"
 #include "server/php-engine.h"
 #include "server/php-worker-stats.h"
 #include "server/php-master-tl-handlers.h"
+#include "server/rpc-query-phases.h"
+#include "server/sampling-profiler.h"
+#include "server/worker-control-block.h"
+#include "server/worker-group.h"
 
 extern const char *engine_tag;
 
@@ -701,6 +708,12 @@ void start_master(int *new_http_fd, int (*new_try_get_http_fd)(), int new_http_f
   if (shared_data == nullptr) {
     shared_data = get_shared_data(shmem_name.c_str());
   }
+  // before the first fork, so every worker inherits the mapping
+  init_worker_latency_histograms(MAX_WORKERS);
+  init_worker_rpc_phase_histograms(MAX_WORKERS);
+  if (!init_workers_control_blocks()) {
+    vkprintf(0, "failed to init workers control blocks, falling back to pipe-only stats\n");
+  }
 
   int attempts_to_start = 2;
   int is_inited = 0;
@@ -947,6 +960,11 @@ int run_worker() {
       exit(123);
     }
 
+    // bind before any worker-local mmap, so the script arena gets node-local pages
+    numa_bind_worker(worker_logname_id);
+
+    start_sampling_profiler();
+
     // TODO should we just use net_reset_after_fork()?
 
     //Epoll_close should clear internal structures but shouldn't change epoll_fd.
@@ -994,6 +1012,18 @@ int run_worker() {
 
     signal_fd = -1;
     logname_id = worker_logname_id;
+    if (const worker_group_t *group = get_worker_group_of_logname(worker_logname_id)) {
+      // takes effect when the worker binds its own reuseport socket and creates
+      // the script context after returning from start_master()
+      if (group->http_port > 0) {
+        http_port = group->http_port;
+      }
+      if (group->max_memory > 0) {
+        max_memory = group->max_memory;
+      }
+    }
+    worker_latency_histograms_set_slot(worker_logname_id);
+    worker_rpc_phase_histograms_set_slot(worker_logname_id);
     if (logname_pattern) {
       char buf[100];
       snprintf(buf, 100, logname_pattern, worker_logname_id);
@@ -1101,7 +1131,25 @@ static const sockaddr_un *get_socket_addr() {
   return &unix_socket_addr;
 }
 
-static int send_fd_via_socket(int fd) {
+// every fd sent during the master-generation handoff is accompanied by this control
+// dgram, which tells the receiver what the fd is and how to use it; binaries predating
+// the tagged protocol send a single opaque byte instead, which means the http fd
+enum handoff_fd_kind {
+  HANDOFF_FD_HTTP = 1,
+  HANDOFF_FD_INSTANCE_CACHE_SHM = 2
+};
+
+struct handoff_fd_meta_t {
+  int32_t magic{0};
+  int32_t kind{0};
+  uint64_t layout_hash{0};
+  uint64_t pool_size{0};
+  uint64_t base_addr{0};
+};
+
+static constexpr int32_t HANDOFF_FD_META_MAGIC = 0x4b464431;
+
+static int send_fd_via_socket(int fd, const handoff_fd_meta_t *meta = nullptr) {
   int unix_socket_fd = socket(AF_LOCAL, SOCK_DGRAM, 0);
   dl_passert (fd >= 0, "failed to create socket");
 
@@ -1115,8 +1163,13 @@ static int send_fd_via_socket(int fd) {
   msg.msg_name = (sockaddr *)get_socket_addr();
   msg.msg_namelen = sizeof(*get_socket_addr());
 
-  vec.iov_base = (void *)str;
-  vec.iov_len = 1;
+  if (meta != nullptr) {
+    vec.iov_base = (void *)meta;
+    vec.iov_len = sizeof(*meta);
+  } else {
+    vec.iov_base = (void *)str;
+    vec.iov_len = 1;
+  }
   msg.msg_iov = &vec;
   msg.msg_iovlen = 1;
 
@@ -1155,18 +1208,18 @@ static int sock_dgram(const char *path) {
   return fd;
 }
 
-/* receive a file descriptor over file descriptor fd */
-static int receive_fd(int fd) {
+/* receive a file descriptor over file descriptor fd, together with its control dgram */
+static int receive_fd(int fd, handoff_fd_meta_t *meta) {
   msghdr msg;
   iovec iov;
-  char buf[1];
+  char buf[sizeof(handoff_fd_meta_t)];
   int rv;
   int connfd = -1;
   char ccmsg[CMSG_SPACE (sizeof(connfd))];
   cmsghdr *cmsg;
 
   iov.iov_base = buf;
-  iov.iov_len = 1;
+  iov.iov_len = sizeof(buf);
 
   msg.msg_name = 0;
   msg.msg_namelen = 0;
@@ -1189,9 +1242,74 @@ static int receive_fd(int fd) {
             cmsg->cmsg_type);
     return -1;
   }
+
+  *meta = handoff_fd_meta_t();
+  if (rv == static_cast<int>(sizeof(handoff_fd_meta_t)) && reinterpret_cast<handoff_fd_meta_t *>(buf)->magic == HANDOFF_FD_META_MAGIC) {
+    memcpy(meta, buf, sizeof(*meta));
+  } else {
+    // a single byte payload comes from a binary predating the tagged protocol: the http fd
+    meta->kind = HANDOFF_FD_HTTP;
+  }
   return *(int *)CMSG_DATA (cmsg);
 }
 
+// second half of the handoff: hand the memfd backing the active instance cache buffer
+// to the new master, so the upgraded binary starts serving with a warm cache
+static void send_instance_cache_shm_fd() {
+  const auto handle = instance_cache_get_shared_memory_handle();
+  if (handle.fd < 0) {
+    vkprintf(1, "instance cache is not memfd-backed, the new master will start with a cold cache\n");
+    return;
+  }
+  handoff_fd_meta_t meta;
+  meta.magic = HANDOFF_FD_META_MAGIC;
+  meta.kind = HANDOFF_FD_INSTANCE_CACHE_SHM;
+  meta.layout_hash = instance_cache_shared_memory_layout_hash();
+  meta.pool_size = handle.pool_size;
+  meta.base_addr = reinterpret_cast<uint64_t>(handle.base);
+  if (send_fd_via_socket(handle.fd, &meta)) {
+    vkprintf(1, "sent instance cache shm fd (pool size %llu)\n", static_cast<unsigned long long>(meta.pool_size));
+  }
+}
+
+// drains the handoff socket: adopts the instance cache region when it is compatible and
+// returns the http listen fd (or -1 when it has not arrived yet); the old master sends
+// both dgrams back-to-back, so after the http fd we poll briefly for the cache one
+static int receive_handoff_fds(int socket_fd) {
+  int received_http_fd = -1;
+  int empty_reads_left = 10;
+  for (;;) {
+    handoff_fd_meta_t meta;
+    const int received_fd = receive_fd(socket_fd, &meta);
+    if (received_fd == -1) {
+      if (received_http_fd == -1 || --empty_reads_left < 0) {
+        break;
+      }
+      usleep(50000);
+      continue;
+    }
+    if (meta.kind == HANDOFF_FD_HTTP) {
+      received_http_fd = received_fd;
+    } else if (meta.kind == HANDOFF_FD_INSTANCE_CACHE_SHM) {
+      if (meta.layout_hash != instance_cache_shared_memory_layout_hash()) {
+        vkprintf(1, "instance cache shm layout mismatch, starting with a cold cache\n");
+        close(received_fd);
+      } else if (instance_cache_adopt_inherited_shared_memory(received_fd, static_cast<size_t>(meta.pool_size),
+                                                              reinterpret_cast<void *>(meta.base_addr))) {
+        vkprintf(1, "adopted the instance cache of the previous master\n");
+      } else {
+        vkprintf(1, "can't adopt instance cache shm (pool size or base address mismatch), starting with a cold cache\n");
+        close(received_fd);
+      }
+      break;
+    } else {
+      vkprintf(1, "got handoff fd of unknown kind %d, ignoring\n", static_cast<int>(meta.kind));
+      close(received_fd);
+    }
+  }
+  return received_http_fd;
+}
+
 
 /*** Memcached interface for stats ***/
 int php_master_get(connection *c, const char *key, int key_len);
@@ -1652,6 +1770,135 @@ private:
   const double cooldown_period_{0};
 };
 
+static void write_latency_percentiles(stats_t *stats, const char *prefix, const LatencyHistogram &histogram) {
+  char key[256];
+  snprintf(key, sizeof(key), "%s.percentile_50", prefix);
+  add_histogram_stat_double(stats, key, histogram.get_percentile(50));
+  snprintf(key, sizeof(key), "%s.percentile_95", prefix);
+  add_histogram_stat_double(stats, key, histogram.get_percentile(95));
+  snprintf(key, sizeof(key), "%s.percentile_99", prefix);
+  add_histogram_stat_double(stats, key, histogram.get_percentile(99));
+  snprintf(key, sizeof(key), "%s.percentile_999", prefix);
+  add_histogram_stat_double(stats, key, histogram.get_percentile(99.9));
+}
+
+// exports script latency percentiles computed from the shared-memory worker
+// histograms; they are cumulative, so the reported window is the bucket-wise
+// difference between two snapshots taken WINDOW_SECONDS apart
+class LatencyPercentilesCalculator {
+public:
+  void update(double time_point) {
+    if (prev_time_ != 0 && time_point - prev_time_ < WINDOW_SECONDS) {
+      return;
+    }
+    prev_time_ = time_point;
+
+    window_.working_time.reset();
+    window_.net_time.reset();
+    window_.script_time.reset();
+    worker_latency_histograms_collect(&window_);
+
+    window_.working_time.sub_from(snapshot_.working_time);
+    window_.net_time.sub_from(snapshot_.net_time);
+    window_.script_time.sub_from(snapshot_.script_time);
+
+    snapshot_.working_time.add_from(window_.working_time);
+    snapshot_.net_time.add_from(window_.net_time);
+    snapshot_.script_time.add_from(window_.script_time);
+  }
+
+  void write_stats_to(stats_t *stats) const {
+    write_latency_percentiles(stats, "requests.working_time.hdr", window_.working_time);
+    write_latency_percentiles(stats, "requests.net_time.hdr", window_.net_time);
+    write_latency_percentiles(stats, "requests.script_time.hdr", window_.script_time);
+  }
+
+private:
+  // matches the one-minute sample expiry of the pipe-based percentiles
+  static constexpr double WINDOW_SECONDS{60};
+
+  double prev_time_{0};
+  worker_latency_histograms_t snapshot_;
+  worker_latency_histograms_t window_;
+};
+
+// the same cumulative-snapshot windowing applied to the outgoing RPC phase
+// histograms, per target port; ports only accumulate over the master's
+// lifetime, so the snapshot table is keyed once and never reshuffled
+class RpcPhasePercentilesCalculator {
+public:
+  void update(double time_point) {
+    if (prev_time_ != 0 && time_point - prev_time_ < WINDOW_SECONDS) {
+      return;
+    }
+    prev_time_ = time_point;
+
+    for (auto &cluster : window_.clusters) {
+      cluster.port.store(0, std::memory_order_relaxed);
+      cluster.queue_wait.reset();
+      cluster.net_roundtrip.reset();
+    }
+    worker_rpc_phase_histograms_collect(&window_);
+
+    for (auto &cluster : window_.clusters) {
+      const int port = cluster.port.load(std::memory_order_relaxed);
+      if (port == 0) {
+        continue;
+      }
+      rpc_phase_cluster_histograms_t *snapshot = snapshot_cluster(port);
+      if (snapshot == nullptr) {
+        continue;
+      }
+      cluster.queue_wait.sub_from(snapshot->queue_wait);
+      cluster.net_roundtrip.sub_from(snapshot->net_roundtrip);
+      snapshot->queue_wait.add_from(cluster.queue_wait);
+      snapshot->net_roundtrip.add_from(cluster.net_roundtrip);
+    }
+  }
+
+  void write_stats_to(stats_t *stats) const {
+    for (const auto &cluster : window_.clusters) {
+      const int port = cluster.port.load(std::memory_order_relaxed);
+      if (port == 0) {
+        continue;
+      }
+      write_cluster(stats, "queue_wait", port, cluster.queue_wait);
+      write_cluster(stats, "net_roundtrip", port, cluster.net_roundtrip);
+    }
+  }
+
+private:
+  static constexpr double WINDOW_SECONDS{60};
+
+  static void write_cluster(stats_t *stats, const char *phase, int port, const LatencyHistogram &histogram) {
+    char prefix[256];
+    if (port == RPC_PHASE_OTHER_PORT) {
+      snprintf(prefix, sizeof(prefix), "requests.outgoing_rpc.%s.port_other.hdr", phase);
+    } else {
+      snprintf(prefix, sizeof(prefix), "requests.outgoing_rpc.%s.port_%d.hdr", phase, port);
+    }
+    write_latency_percentiles(stats, prefix, histogram);
+  }
+
+  rpc_phase_cluster_histograms_t *snapshot_cluster(int port) {
+    for (auto &cluster : snapshot_.clusters) {
+      const int snapshot_port = cluster.port.load(std::memory_order_relaxed);
+      if (snapshot_port == port) {
+        return &cluster;
+      }
+      if (snapshot_port == 0) {
+        cluster.port.store(port, std::memory_order_relaxed);
+        return &cluster;
+      }
+    }
+    return nullptr;
+  }
+
+  double prev_time_{0};
+  worker_rpc_phase_histograms_t snapshot_;
+  worker_rpc_phase_histograms_t window_;
+};
+
 STATS_PROVIDER_TAGGED(kphp_stats, 100, STATS_TAG_KPHP_SERVER) {
   if (engine_tag) {
     add_histogram_stat_long(stats, "kphp_version", atoll(engine_tag));
@@ -1696,6 +1943,8 @@ STATS_PROVIDER_TAGGED(kphp_stats, 100, STATS_TAG_KPHP_SERVER) {
                           instance_cache_element_stats.elements_storing_delayed_due_mutex.load(std::memory_order_relaxed));
   add_histogram_stat_long(stats, "instance_cache.elements.fetched",
                           instance_cache_element_stats.elements_fetched.load(std::memory_order_relaxed));
+  add_histogram_stat_long(stats, "instance_cache.elements.fetched_from_request_cache",
+                          instance_cache_element_stats.elements_fetched_from_request_cache.load(std::memory_order_relaxed));
   add_histogram_stat_long(stats, "instance_cache.elements.missed",
                           instance_cache_element_stats.elements_missed.load(std::memory_order_relaxed));
   add_histogram_stat_long(stats, "instance_cache.elements.missed_earlier",
@@ -1713,6 +1962,15 @@ STATS_PROVIDER_TAGGED(kphp_stats, 100, STATS_TAG_KPHP_SERVER) {
   add_histogram_stat_long(stats, "instance_cache.elements.logically_expired_but_fetched",
                           instance_cache_element_stats.elements_logically_expired_but_fetched.load(std::memory_order_relaxed));
 
+  const auto instance_cache_mutex_stats = instance_cache_get_mutex_stats();
+  add_histogram_stat_long(stats, "instance_cache.mutex.acquisitions", instance_cache_mutex_stats.acquisitions);
+  add_histogram_stat_long(stats, "instance_cache.mutex.contended_acquisitions", instance_cache_mutex_stats.contended_acquisitions);
+  add_histogram_stat_long(stats, "instance_cache.mutex.futex_waits", instance_cache_mutex_stats.futex_waits);
+  add_histogram_stat_long(stats, "instance_cache.mutex.sampled_hold_time_lt10us", instance_cache_mutex_stats.sampled_hold_time_buckets[0]);
+  add_histogram_stat_long(stats, "instance_cache.mutex.sampled_hold_time_lt100us", instance_cache_mutex_stats.sampled_hold_time_buckets[1]);
+  add_histogram_stat_long(stats, "instance_cache.mutex.sampled_hold_time_lt1ms", instance_cache_mutex_stats.sampled_hold_time_buckets[2]);
+  add_histogram_stat_long(stats, "instance_cache.mutex.sampled_hold_time_ge1ms", instance_cache_mutex_stats.sampled_hold_time_buckets[3]);
+
   write_confdata_stats_to(stats);
   server_stats.worker_stats.recalc_master_percentiles();
   server_stats.worker_stats.to_stats(stats);
@@ -1722,6 +1980,14 @@ STATS_PROVIDER_TAGGED(kphp_stats, 100, STATS_TAG_KPHP_SERVER) {
   add_histogram_stat_double(stats, "requests.incoming_queries_per_second", qps_calculator.get_incoming_qps());
   add_histogram_stat_double(stats, "requests.outgoing_queries_per_second", qps_calculator.get_outgoing_qps());
 
+  static LatencyPercentilesCalculator latency_percentiles;
+  latency_percentiles.update(my_now);
+  latency_percentiles.write_stats_to(stats);
+
+  static RpcPhasePercentilesCalculator rpc_phase_percentiles;
+  rpc_phase_percentiles.update(my_now);
+  rpc_phase_percentiles.write_stats_to(stats);
+
   update_mem_stats();
   unsigned long long max_vms = 0;
   unsigned long long max_rss = 0;
@@ -1739,6 +2005,8 @@ STATS_PROVIDER_TAGGED(kphp_stats, 100, STATS_TAG_KPHP_SERVER) {
   add_histogram_stat_long(stats, "memory.vms_max", max_vms * 1024);
   add_histogram_stat_long(stats, "memory.rss_max", max_rss * 1024);
   add_histogram_stat_long(stats, "memory.shared_max", max_shared * 1024);
+
+  write_malloc_allocator_stats_to(stats);
 }
 
 int php_master_http_execute(struct connection *c, int op) {
@@ -1796,7 +2064,11 @@ void run_master_off_in_graceful_restart() {
 
   if (other->valid_flag && other->ask_http_fd_generation > me->generation) {
     vkprintf(1, "send http fd\n");
-    send_fd_via_socket(*http_fd);
+    handoff_fd_meta_t http_meta;
+    http_meta.magic = HANDOFF_FD_META_MAGIC;
+    http_meta.kind = HANDOFF_FD_HTTP;
+    send_fd_via_socket(*http_fd, &http_meta);
+    send_instance_cache_shm_fd();
     //TODO: process errors
     me->sent_http_fd_generation = static_cast<int>(generation);
     changed = 1;
@@ -1853,13 +2125,13 @@ void run_master_on() {
     } else {
       if (me->ask_http_fd_generation != 0 && other->sent_http_fd_generation > me->generation) {
         vkprintf(1, "read http fd\n");
-        *http_fd = receive_fd(socket_fd);
+        *http_fd = receive_handoff_fds(socket_fd);
         vkprintf(1, "http_fd = %d\n", *http_fd);
 
         if (*http_fd == -1) {
           vkprintf(1, "wait for a second...\n");
           sleep(1);
-          *http_fd = receive_fd(socket_fd);
+          *http_fd = receive_handoff_fds(socket_fd);
           vkprintf(1, "http_fd = %d\n", *http_fd);
         }
 
@@ -1969,8 +2241,18 @@ static void cron() {
   server_stats.worker_stats.copy_internal_from(dead_worker_stats);
   server_stats.worker_stats.reset_memory_and_percentiles_stats();
   int running_workers = 0;
+  bool all_control_blocks_read = true;
   for (int i = 0; i < me_workers_n; i++) {
     worker_info_t *w = workers[i];
+    if (!w->is_dying) {
+      php_immediate_stats_t istats;
+      uint64_t requests_handled = 0;
+      if (try_read_worker_control_block(w->logname_id, w->pid, &istats, &requests_handled)) {
+        worker_set_immediate_stats(w, &istats);
+      } else {
+        all_control_blocks_read = false;
+      }
+    }
     const bool get_pid_info_err = get_pid_info(w->pid, &w->my_info);
     w->valid_my_info = 1;
     if (!get_pid_info_err) {
@@ -1992,7 +2274,10 @@ static void cron() {
   CpuStatTimestamp cpu_timestamp{my_now, utime, stime, cpu_total};
   server_stats.update(cpu_timestamp);
 
-  create_stats_queries(nullptr, SPOLL_SEND_STATS | SPOLL_SEND_IMMEDIATE_STATS, -1);
+  if (!all_control_blocks_read) {
+    // some worker has not published its control block: ask through the pipe as before
+    create_stats_queries(nullptr, SPOLL_SEND_STATS | SPOLL_SEND_IMMEDIATE_STATS, -1);
+  }
   static double last_full_stats = -1;
   if (last_full_stats + FULL_STATS_PERIOD < my_now) {
     last_full_stats = my_now;
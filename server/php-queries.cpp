@@ -12,10 +12,12 @@
 #include "common/precise-time.h"
 
 #include "runtime/allocator.h"
+#include "server/file-io-pool.h"
 #include "server/php-engine-vars.h"
 #include "server/php-queries-stats.h"
 #include "server/php-runner.h"
 #include "server/php-script.h"
+#include "server/rpc-query-phases.h"
 
 #define MAX_NET_ERROR_LEN 128
 
@@ -829,6 +831,7 @@ int create_rpc_error_event(slot_id_t slot_id, int error_code, const char *error_
   }
   event->error_code = error_code;
   event->error_message = error_message; //in static memory
+  rpc_query_phases_on_complete(slot_id);
   if (res != nullptr) {
     *res = event;
   }
@@ -853,11 +856,22 @@ int create_rpc_answer_event(slot_id_t slot_id, int len, net_event_t **res) {
     event->result = nullptr;
   }
   event->result_len = len;
+  rpc_query_phases_on_complete(slot_id);
   assert (res != nullptr);
   *res = event;
   return 1;
 }
 
+int create_file_io_answer_event(slot_id_t slot_id, file_io_job *job) {
+  net_event_t *event;
+  int status = alloc_net_event(slot_id, ne_file_io_answer, &event);
+  if (status <= 0) {
+    return status;
+  }
+  event->file_io_answer = job;
+  return 1;
+}
+
 int net_events_empty() {
   return net_events.empty();
 }
@@ -931,6 +945,7 @@ slot_id_t rpc_send_query(int host_num, char *request, int request_size, int time
   }
 
   PhpQueriesStats::get_rpc_queries_stat().register_query(request_size);
+  rpc_query_phases_on_create(query->slot_id);
   query->host_num = host_num;
   query->request = request;
   query->request_size = request_size;
@@ -980,13 +995,27 @@ void script_error() {
   PHPScriptBase::error("script_error called", script_error_t::unclassified_error);
 }
 
-void http_set_result(const char *headers, int headers_len, const char *body, int body_len, int exit_code) {
+void http_send_chunk(const char *headers, int headers_len, const char *body, int body_len, int is_last) {
+  assert (PHPScriptBase::is_running);
+  php_query_http_flush_t q;
+  q.base.type = PHPQ_HTTP_FLUSH;
+  q.headers = headers;
+  q.headers_len = headers_len;
+  q.body = body;
+  q.body_len = body_len;
+  q.is_last = is_last;
+
+  PHPScriptBase::current_script->ask_query((void *)&q);
+}
+
+void http_set_result(const char *headers, int headers_len, const char *body, int body_len, int exit_code, int compression) {
   script_result res;
   res.exit_code = exit_code;
   res.headers = headers;
   res.headers_len = headers_len;
   res.body = body;
   res.body_len = body_len;
+  res.compression = compression;
 
   PHPScriptBase::current_script->set_script_result(&res);
 }
@@ -998,6 +1027,7 @@ void rpc_set_result(const char *body, int body_len, int exit_code) {
   res.headers_len = 0;
   res.body = body;
   res.body_len = body_len;
+  res.compression = 0;
 
   PHPScriptBase::current_script->set_script_result(&res);
 }
@@ -1054,6 +1084,13 @@ void php_queries_start() {
 void php_queries_finish() {
   qmem_clear();
   clear_slots();
+  //a file io completion the script never consumed (e.g. it timed out) still owns
+  //the job's malloc'd buffers; everything else queued here lives in qmem or static memory
+  while (net_event_t *event = net_events.pop()) {
+    if (event->type == ne_file_io_answer) {
+      file_io_job_free(event->file_io_answer);
+    }
+  }
   net_events.clear();
   net_queries.clear();
 }
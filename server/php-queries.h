@@ -10,9 +10,12 @@ using slot_id_t = int;
 
 enum net_event_type_t {
   ne_rpc_answer,
-  ne_rpc_error
+  ne_rpc_error,
+  ne_file_io_answer
 };
 
+struct file_io_job;
+
 struct net_event_t {
   net_event_type_t type;
   union {
@@ -29,6 +32,8 @@ struct net_event_t {
       int error_code;
       const char *error_message;
     };
+    //ne_file_io_answer; malloc'd, owned by the receiver
+    file_io_job *file_io_answer;
   };
 };
 
@@ -85,6 +90,7 @@ struct chain_t {
 #define PHPQ_NETQ 0x3d780000
 #define PHPQ_WAIT 0x728a0000
 #define PHPQ_HTTP_LOAD_POST 0x5ac20000
+#define PHPQ_HTTP_FLUSH 0x61f30000
 #define NETQ_PACKET 1234
 
 #define PNETF_IMMEDIATE 16
@@ -150,6 +156,17 @@ struct php_query_http_load_post_t {
   int max_len;
 };
 
+/** stream a part of the http response to the client while the script keeps running **/
+struct php_query_http_flush_t {
+  php_query_base_t base;
+
+  const char *headers; // sent as is before the first chunk, nullptr afterwards
+  int headers_len;
+  const char *body; // one chunked-encoding frame
+  int body_len;
+  int is_last; // also write the terminating zero-length chunk
+};
+
 
 /** net query **/
 struct data_reader_t {
@@ -331,8 +348,12 @@ void free_net_query(net_query_t *query);
 
 int create_rpc_error_event(slot_id_t slot_id, int error_code, const char *error_message, net_event_t **res);
 int create_rpc_answer_event(slot_id_t slot_id, int len, net_event_t **res);
+int create_file_io_answer_event(slot_id_t slot_id, file_io_job *job);
 int net_events_empty();
 
+slot_id_t create_slot();
+bool is_valid_slot(slot_id_t slot_id);
+
 void php_queries_start();
 void php_queries_finish();
 
@@ -350,7 +371,8 @@ int get_net_queries_count();
 int get_engine_uptime();
 const char *get_engine_version();
 int http_load_long_query(char *buf, int min_len, int max_len);
-void http_set_result(const char *headers, int headers_len, const char *body, int body_len, int exit_code);
+void http_send_chunk(const char *headers, int headers_len, const char *body, int body_len, int is_last);
+void http_set_result(const char *headers, int headers_len, const char *body, int body_len, int exit_code, int compression);
 void rpc_answer(const char *res, int res_len);
 void rpc_set_result(const char *body, int body_len, int exit_code);
 void script_error();
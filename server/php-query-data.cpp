@@ -71,7 +71,7 @@ void http_query_data_free(http_query_data *d) {
 rpc_query_data *rpc_query_data_create(int *data, int len, long long req_id, unsigned int ip, short port, short pid, int utime) {
   rpc_query_data *d = (rpc_query_data *)malloc(sizeof(rpc_query_data));
 
-  d->data = (int *)memdup(data, sizeof(int) * len);
+  d->data = data;
   d->len = len;
 
   d->req_id = req_id;
@@ -30,6 +30,7 @@ struct rpc_query_data {
   int utime;
 };
 
+//takes ownership of the malloc'd data buffer, rpc_query_data_free releases it
 rpc_query_data *rpc_query_data_create(int *data, int len, long long req_id, unsigned int ip, short port, short pid, int utime);
 void rpc_query_data_free(rpc_query_data *d);
 
@@ -4,8 +4,10 @@
 
 #include "server/php-runner.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
+#include <climits>
 #include <cstdlib>
 #include <cstring>
 #include <exception>
@@ -27,6 +29,8 @@
 #include "runtime/exception.h"
 #include "runtime/interface.h"
 #include "runtime/profiler.h"
+#include "server/latency-histogram.h"
+#include "server/perf-counters.h"
 #include "server/php-engine-vars.h"
 #include "server/php-worker-stats.h"
 
@@ -94,12 +98,32 @@ PHPScriptBase::PHPScriptBase(size_t mem_size, size_t stack_size) :
   res(nullptr) {
   //fprintf (stderr, "PHPScriptBase: constructor\n");
   stack_size = getpagesize() + (stack_size + getpagesize() - 1) / getpagesize() * getpagesize();
-  run_stack = (char *)valloc(stack_size);
+  // an anonymous mapping instead of valloc: pages are faulted in only as deep as the
+  // script actually recurses, and the cold part can be given back between requests
+  run_stack = static_cast<char *>(mmap(nullptr, stack_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0));
+  assert (run_stack != MAP_FAILED);
   assert (mprotect(run_stack, getpagesize(), PROT_NONE) == 0);
   protected_end = run_stack + getpagesize();
   run_stack_end = run_stack + stack_size;
 
-  run_mem = static_cast<char *>(mmap(nullptr, mem_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0));
+  // back the script arena with explicit 2MB hugepages when the size allows it:
+  // fewer TLB entries and no minor-fault storm after memory-limit-driven growth;
+  // MAP_POPULATE pre-faults the reserved hugepages once at worker start
+  constexpr size_t huge_page_size = 1ULL << 21;
+  if (mem_size % huge_page_size == 0) {
+    run_mem = static_cast<char *>(mmap(nullptr, mem_size, PROT_READ | PROT_WRITE,
+                                       MAP_ANONYMOUS | MAP_PRIVATE | MAP_HUGETLB | MAP_POPULATE, -1, 0));
+    if (run_mem == MAP_FAILED) {
+      run_mem = nullptr;
+    }
+  }
+  if (run_mem == nullptr) {
+    // no hugetlb pool configured: fall back to ordinary pages and ask for transparent hugepages
+    run_mem = static_cast<char *>(mmap(nullptr, mem_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0));
+#ifdef MADV_HUGEPAGE
+    our_madvise(run_mem, mem_size, MADV_HUGEPAGE);
+#endif
+  }
   //fprintf (stderr, "[%p -> %p] [%p -> %p]\n", run_stack, run_stack_end, run_mem, run_mem + mem_size);
 }
 
@@ -109,8 +133,7 @@ PHPScriptBase::~PHPScriptBase() {
     __sanitizer_finish_switch_fiber(nullptr, nullptr, nullptr);
   }
 #endif
-  mprotect(run_stack, getpagesize(), PROT_READ | PROT_WRITE);
-  free(run_stack);
+  munmap(run_stack, stack_size);
   munmap(run_mem, mem_size);
 }
 
@@ -144,6 +167,8 @@ void PHPScriptBase::init(script_t *script, php_query_data *data_to_set) {
   query_stats_id++;
   memset(&query_stats, 0, sizeof(query_stats));
 
+  start_request_perf_counters();
+
   PHPScriptBase::ml_flag = false;
 }
 
@@ -251,8 +276,13 @@ void PHPScriptBase::finish() {
   state = run_state_t::uncleared;
   error_type = script_error_t::no_error;
   update_net_time();
+  PerfCounterSamples perf_samples;
+  finish_request_perf_counters(&perf_samples);
+  PhpWorkerStats::get_local().add_request_perf_samples(perf_samples);
   PhpWorkerStats::get_local().add_stats(script_time, net_time, queries_cnt,
-                                        script_mem_stats.max_memory_used, script_mem_stats.max_real_memory_used, save_error_type);
+                                        script_mem_stats.max_memory_used, script_mem_stats.max_real_memory_used,
+                                        dl::get_script_size_class_stats(), save_error_type);
+  worker_latency_histograms_record(script_time + net_time, net_time, script_time);
   if (save_state == run_state_t::error) {
     assert (error_message != nullptr);
     kprintf("Critical error during script execution: %s\n", error_message);
@@ -297,10 +327,74 @@ void PHPScriptBase::clear() {
   free_runtime_environment();
   state = run_state_t::empty;
   if (use_madvise_dontneed) {
-    if (dl::get_script_memory_stats().real_memory_used > memory_used_to_recreate_script) {
-      const int advice = madvise_madv_free_supported() ? MADV_FREE : MADV_DONTNEED;
-      our_madvise(&run_mem[memory_used_to_recreate_script], mem_size - memory_used_to_recreate_script, advice);
+    if (memory_used_to_recreate_script != LLONG_MAX) {
+      if (dl::get_script_memory_stats().real_memory_used > memory_used_to_recreate_script) {
+        const int advice = madvise_madv_free_supported() ? MADV_FREE : MADV_DONTNEED;
+        our_madvise(&run_mem[memory_used_to_recreate_script], mem_size - memory_used_to_recreate_script, advice);
+      }
+    } else {
+      release_cold_script_memory();
     }
+    release_stack_memory();
+  }
+}
+
+// with --use-madvise-dontneed but no explicit --worker-memory-to-reload threshold the release
+// watermark is adaptive: a decaying maximum of the per-request memory peaks; pages above it were
+// dirtied by a rare heavy request only and are given back, so that one spike doesn't keep the
+// worker's rss inflated until the next script reload
+void PHPScriptBase::release_cold_script_memory() {
+  constexpr size_t page_size = 4096;
+  constexpr size_t min_release_size = 1 << 22; // don't bother the kernel for less than 4mb
+  const size_t last_peak = (dl::get_script_memory_stats().max_real_memory_used + page_size - 1) / page_size * page_size;
+  script_mem_dirty_end = std::max(script_mem_dirty_end, last_peak);
+  // follows the load profile up instantly and down slowly, by ~1/16 per request
+  script_mem_typical_peak = std::max(last_peak, script_mem_typical_peak - script_mem_typical_peak / 16);
+  const size_t watermark = (script_mem_typical_peak + page_size - 1) / page_size * page_size;
+  if (script_mem_dirty_end > watermark && script_mem_dirty_end - watermark >= min_release_size) {
+    const int advice = madvise_madv_free_supported() ? MADV_FREE : MADV_DONTNEED;
+    our_madvise(&run_mem[watermark], script_mem_dirty_end - watermark, advice);
+    script_mem_dirty_end = watermark;
+  }
+}
+
+// A worker whose memory keeps growing request after request is leaking outside
+// the script arena (heap allocations surviving clear(), growing dirty extent):
+// trimming can't give those pages back, the worker has to be restarted.
+// Growth must be observed over many consecutive requests and add up to a
+// noticeable amount before the restart cost is paid; memory that merely
+// plateaus after one heavy request never triggers it
+bool PHPScriptBase::leak_like_growth_detected() {
+  constexpr int growth_streak_limit = 64;
+  constexpr size_t growth_threshold = size_t{64} << 20;
+  const size_t used_now = dl::get_heap_memory_used() + script_mem_dirty_end;
+  if (leak_watch_last == 0) {
+    leak_watch_baseline = leak_watch_last = used_now;
+    return false;
+  }
+  if (used_now > leak_watch_last) {
+    ++leak_watch_growth_streak;
+  } else {
+    leak_watch_growth_streak = 0;
+    leak_watch_baseline = used_now;
+  }
+  leak_watch_last = used_now;
+  if (leak_watch_growth_streak >= growth_streak_limit && used_now - leak_watch_baseline >= growth_threshold) {
+    leak_watch_growth_streak = 0;
+    leak_watch_baseline = used_now;
+    return true;
+  }
+  return false;
+}
+
+// between requests no coroutine is suspended, so the whole ucontext stack above the
+// guard page is dead; MADV_FREE only clears the dirty bits, which makes reuse by the
+// next request free unless the kernel actually reclaimed the pages under pressure -
+// that's why the stack is released every request but only when MADV_FREE is there:
+// MADV_DONTNEED would force a zero-fill fault storm on every deep call chain
+void PHPScriptBase::release_stack_memory() {
+  if (madvise_madv_free_supported()) {
+    our_madvise(protected_end, run_stack_end - protected_end, MADV_FREE);
   }
 }
 
@@ -630,6 +724,10 @@ long long php_script_memory_get_total_usage(void *ptr) {
   return ((PHPScriptBase *)ptr)->memory_get_total_usage();
 }
 
+bool php_script_leak_like_growth_detected(void *ptr) {
+  return ((PHPScriptBase *)ptr)->leak_like_growth_detected();
+}
+
 void php_script_set_timeout(double t) {
   assert (t >= 0.1);
 
@@ -36,6 +36,7 @@ enum class script_error_t : uint8_t {
   rpc_connection_close,
   net_event_error,
   post_data_loading_error,
+  shed_queue_deadline,
   unclassified_error,
   errors_count
 };
@@ -90,6 +91,7 @@ void php_script_terminate(void *ptr, const char *error_message, script_error_t e
 void php_script_set_timeout(double t);
 const char *php_script_get_error(void *ptr);
 long long php_script_memory_get_total_usage(void *ptr);
+bool php_script_leak_like_growth_detected(void *ptr);
 
 /** script **/
 php_immediate_stats_t *get_immediate_stats();
@@ -155,6 +157,9 @@ public:
 
   void finish();
   void clear();
+  void release_cold_script_memory();
+  void release_stack_memory();
+  bool leak_like_growth_detected();
   void query_readed();
   void query_answered();
 
@@ -167,5 +172,15 @@ public:
   double get_script_time();
   int get_net_queries_count() const;
   long long memory_get_total_usage() const;
+
+private:
+  // adaptive inter-request memory release state, see release_cold_script_memory()
+  size_t script_mem_dirty_end{0};
+  size_t script_mem_typical_peak{0};
+
+  // leak detection state, see leak_like_growth_detected()
+  size_t leak_watch_baseline{0};
+  size_t leak_watch_last{0};
+  int leak_watch_growth_streak{0};
 };
 
@@ -23,5 +23,10 @@ struct script_result {
   const char *body;
   int body_len;
   int exit_code;
+  // HTTP_COMPRESSION_* value (see net/net-http-server.h) the client accepts,
+  // 0 = send the body as is; when set, the headers deliberately lack
+  // Content-Length and the engine compresses the body and completes the
+  // header block itself, outside of script time and script memory
+  int compression;
 };
 
@@ -59,7 +59,8 @@ void append_samples(const std::array<T, M> &from, std::array<T, N> &to, size_t o
 } // namespace
 
 void PhpWorkerStats::add_stats(double script_time, double net_time, long script_queries,
-                               long max_memory_used, long max_real_memory_used, script_error_t error) noexcept {
+                               long max_memory_used, long max_real_memory_used,
+                               const memory_resource::SizeClassStatsArray &size_class_stats, script_error_t error) noexcept {
   internal_.tot_queries_++;
   internal_.net_time_ += net_time;
   internal_.script_time_ += script_time;
@@ -68,6 +69,17 @@ void PhpWorkerStats::add_stats(double script_time, double net_time, long script_
   internal_.script_max_real_memory_used_ = std::max(internal_.script_max_real_memory_used_, max_real_memory_used);
   ++internal_.errors_[static_cast<size_t>(error)];
 
+  // the script allocator counters are reset on every request init,
+  // so the per request snapshot is simply accumulated here;
+  // current_pieces is a point-in-time value and is meaningless across requests
+  for (size_t i = 0; i < size_class_stats.size(); ++i) {
+    auto &total = internal_.size_class_stats_[i];
+    total.allocations += size_class_stats[i].allocations;
+    total.frees += size_class_stats[i].frees;
+    total.fallback_allocations += size_class_stats[i].fallback_allocations;
+    total.max_pieces = std::max(total.max_pieces, size_class_stats[i].max_pieces);
+  }
+
   const size_t sample = circular_percentiles_counter_++;
   circular_percentiles_counter_ %= PERCENTILE_SAMPLES;
   samples_tp_[sample] = std::chrono::steady_clock::now();
@@ -107,6 +119,10 @@ void PhpWorkerStats::recalc_master_percentiles() noexcept {
   internal_.script_real_memory_used_percentiles_ = calc_percentiles<17, 65, 99>(script_real_memory_used_samples_);
 }
 
+void PhpWorkerStats::add_request_perf_samples(const PerfCounterSamples &samples) noexcept {
+  internal_.perf_counters_.add_from(samples);
+}
+
 void PhpWorkerStats::add_from(const PhpWorkerStats &from) noexcept {
   internal_.tot_queries_ += from.internal_.tot_queries_;
   internal_.net_time_ += from.internal_.net_time_;
@@ -123,6 +139,16 @@ void PhpWorkerStats::add_from(const PhpWorkerStats &from) noexcept {
     internal_.errors_[i] += from.internal_.errors_[i];
   }
 
+  for (size_t i = 0; i < internal_.size_class_stats_.size(); ++i) {
+    auto &total = internal_.size_class_stats_[i];
+    total.allocations += from.internal_.size_class_stats_[i].allocations;
+    total.frees += from.internal_.size_class_stats_[i].frees;
+    total.fallback_allocations += from.internal_.size_class_stats_[i].fallback_allocations;
+    total.max_pieces = std::max(total.max_pieces, from.internal_.size_class_stats_[i].max_pieces);
+  }
+
+  internal_.perf_counters_.add_from(from.internal_.perf_counters_);
+
   const size_t offset = circular_percentiles_counter_;
   circular_percentiles_counter_ = (circular_percentiles_counter_ + PERCENTILES_COUNT) % PERCENTILE_SAMPLES;
 
@@ -182,12 +208,17 @@ void PhpWorkerStats::to_stats(stats_t *stats) const noexcept {
   write_error_stat_to(stats, "terminated_requests.rpc_connection_close", script_error_t::rpc_connection_close);
   write_error_stat_to(stats, "terminated_requests.net_event_error", script_error_t::net_event_error);
   write_error_stat_to(stats, "terminated_requests.post_data_loading_error", script_error_t::post_data_loading_error);
+  write_error_stat_to(stats, "terminated_requests.shed_queue_deadline", script_error_t::shed_queue_deadline);
   write_error_stat_to(stats, "terminated_requests.unclassified", script_error_t::memory_limit);
 
   add_histogram_stat_long(stats, "memory.script_usage.max", internal_.script_max_memory_used_);
   write_percentile(stats, "memory.script_usage", internal_.script_memory_used_percentiles_);
   add_histogram_stat_long(stats, "memory.script_real_usage.max", internal_.script_max_real_memory_used_);
   write_percentile(stats, "memory.script_real_usage", internal_.script_real_memory_used_percentiles_);
+
+  memory_resource::write_size_class_stats_to(stats, "memory.script", internal_.size_class_stats_);
+
+  write_perf_counter_stats_to(stats, "requests.perf", internal_.perf_counters_);
 }
 
 int PhpWorkerStats::write_into(char *buffer, int buffer_len) const noexcept {
@@ -207,6 +238,7 @@ int PhpWorkerStats::read_from(const char *buffer) noexcept {
 void PhpWorkerStats::reset_memory_and_percentiles_stats() noexcept {
   internal_.script_max_memory_used_ = 0;
   internal_.script_max_real_memory_used_ = 0;
+  internal_.size_class_stats_ = {};
 
   circular_percentiles_counter_ = 0;
   internal_.working_time_percentiles_ = {};
@@ -10,17 +10,22 @@
 
 #include "common/stats/provider.h"
 
+#include "runtime/memory_resource/memory_resource.h"
+#include "server/perf-counters.h"
 #include "server/php-runner.h"
 
 class PhpWorkerStats {
 public:
   void add_stats(double script_time, double net_time, long script_queries,
-                 long max_memory_used, long max_real_memory_used, script_error_t error) noexcept;
+                 long max_memory_used, long max_real_memory_used,
+                 const memory_resource::SizeClassStatsArray &size_class_stats, script_error_t error) noexcept;
 
   void update_idle_time(double tot_idle_time, int uptime, double average_idle_time, double average_idle_quotient) noexcept;
   void recalc_worker_percentiles() noexcept;
   void recalc_master_percentiles() noexcept;
 
+  void add_request_perf_samples(const PerfCounterSamples &samples) noexcept;
+
   void add_from(const PhpWorkerStats &from) noexcept;
   void copy_internal_from(const PhpWorkerStats &from) noexcept;
 
@@ -73,6 +78,9 @@ private:
     int64_t script_max_memory_used_{0};
     int64_t script_max_real_memory_used_{0};
 
+    memory_resource::SizeClassStatsArray size_class_stats_{};
+    PerfCounterSamples perf_counters_{};
+
     uint32_t accumulated_stats_{0};
     std::array<uint32_t, static_cast<size_t>(script_error_t::errors_count)> errors_{{0}};
 
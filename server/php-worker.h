@@ -7,6 +7,8 @@
 #include "server/php-query-data.h"
 #include "server/php-runner.h"
 
+struct latency_class_t;
+
 enum php_worker_mode_t {
   http_worker,
   rpc_worker,
@@ -45,5 +47,8 @@ struct php_worker {
 
   long long req_id;
   int target_fd;
+
+  // nullptr when no configured latency class matches the request uri
+  const latency_class_t *latency_class;
 };
 
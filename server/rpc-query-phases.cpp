@@ -0,0 +1,110 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/rpc-query-phases.h"
+
+#include <cassert>
+#include <sys/mman.h>
+
+#include "common/dl-utils-lite.h"
+#include "common/precise-time.h"
+
+// in-flight timestamps are worker-local: every phase of one query is observed
+// by the same process, only the final histograms are shared with the master.
+// The table is a direct-mapped cache indexed by the slot id; slot ids are
+// sequential within one request, so a collision needs that many queries in
+// flight at once and merely drops one sample from the stats
+struct inflight_rpc_query_t {
+  slot_id_t slot_id;
+  double t_create;
+  double t_send;
+  int target_port;
+};
+
+static constexpr int INFLIGHT_TABLE_SIZE = 16384; // power of two
+static inflight_rpc_query_t inflight_queries[INFLIGHT_TABLE_SIZE];
+
+static inflight_rpc_query_t *inflight_entry(slot_id_t slot_id) {
+  return &inflight_queries[slot_id & (INFLIGHT_TABLE_SIZE - 1)];
+}
+
+static worker_rpc_phase_histograms_t *phase_slabs;
+static int phase_slabs_n;
+static worker_rpc_phase_histograms_t *my_phase_slab;
+
+void init_worker_rpc_phase_histograms(int slots) {
+  const size_t mem_len = sizeof(worker_rpc_phase_histograms_t) * slots;
+  phase_slabs = static_cast<worker_rpc_phase_histograms_t *>(
+    mmap(nullptr, mem_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  dl_passert (phase_slabs != MAP_FAILED, "failed to mmap rpc phase histograms");
+  phase_slabs_n = slots;
+}
+
+void worker_rpc_phase_histograms_set_slot(int slot) {
+  assert (phase_slabs != nullptr && 0 <= slot && slot < phase_slabs_n);
+  my_phase_slab = &phase_slabs[slot];
+}
+
+// only the owning worker claims entries in its slab, so a plain first-fit
+// scan is race-free; the atomic port is for the concurrently reading master
+static rpc_phase_cluster_histograms_t *get_cluster(worker_rpc_phase_histograms_t *slab, int port) {
+  for (int i = 0; i < RPC_PHASE_CLUSTERS - 1; i++) {
+    const int entry_port = slab->clusters[i].port.load(std::memory_order_relaxed);
+    if (entry_port == port) {
+      return &slab->clusters[i];
+    }
+    if (entry_port == 0) {
+      slab->clusters[i].port.store(port, std::memory_order_relaxed);
+      return &slab->clusters[i];
+    }
+  }
+  auto &overflow = slab->clusters[RPC_PHASE_CLUSTERS - 1];
+  overflow.port.store(RPC_PHASE_OTHER_PORT, std::memory_order_relaxed);
+  return &overflow;
+}
+
+void rpc_query_phases_on_create(slot_id_t slot_id) noexcept {
+  inflight_rpc_query_t *entry = inflight_entry(slot_id);
+  entry->slot_id = slot_id;
+  entry->t_create = get_utime_monotonic();
+  entry->t_send = 0;
+  entry->target_port = 0;
+}
+
+void rpc_query_phases_on_send(slot_id_t slot_id, int target_port) noexcept {
+  inflight_rpc_query_t *entry = inflight_entry(slot_id);
+  if (entry->slot_id != slot_id) {
+    return;
+  }
+  entry->t_send = get_utime_monotonic();
+  entry->target_port = target_port;
+}
+
+void rpc_query_phases_on_complete(slot_id_t slot_id) noexcept {
+  inflight_rpc_query_t *entry = inflight_entry(slot_id);
+  if (entry->slot_id != slot_id) {
+    return;
+  }
+  entry->slot_id = 0;
+  if (entry->t_send == 0 || my_phase_slab == nullptr) {
+    return;
+  }
+  rpc_phase_cluster_histograms_t *cluster = get_cluster(my_phase_slab, entry->target_port);
+  cluster->queue_wait.record(entry->t_send - entry->t_create);
+  cluster->net_roundtrip.record(get_utime_monotonic() - entry->t_send);
+}
+
+void worker_rpc_phase_histograms_collect(worker_rpc_phase_histograms_t *to) noexcept {
+  for (int i = 0; i < phase_slabs_n; i++) {
+    for (auto &cluster : phase_slabs[i].clusters) {
+      const int port = cluster.port.load(std::memory_order_relaxed);
+      if (port == 0) {
+        continue;
+      }
+      rpc_phase_cluster_histograms_t *dst = get_cluster(to, port);
+      dst->queue_wait.add_from(cluster.queue_wait);
+      dst->net_roundtrip.add_from(cluster.net_roundtrip);
+    }
+  }
+}
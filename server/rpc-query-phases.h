@@ -0,0 +1,54 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <atomic>
+
+#include "server/latency-histogram.h"
+#include "server/php-queries.h"
+
+// Phase breakdown for outgoing RPC queries. The plain counters in
+// server/php-queries-stats.h say how many queries and bytes went out, but not
+// where the time was spent, so every query is timestamped at three points:
+// when the script creates it (rpc_send_query), when the reactor hands it to a
+// connection, and when its net event completes (answer, error or timeout).
+// The two deltas land in HDR histograms keyed by the target's port — targets
+// of one cluster share a port, so the port is the closest thing to a cluster
+// id this process has:
+//   queue_wait:    create -> reactor send, time the query sat in the script's
+//                  net queue waiting for the worker to reach the event loop;
+//   net_roundtrip: reactor send -> completion, wire plus remote server time.
+// Queries that fail before reaching a connection have no send timestamp and
+// are not recorded. The histograms live in per-worker MAP_SHARED slabs and
+// follow the latency-histogram.h conventions: the master maps them before the
+// first fork, each worker updates only its own slot, the master sums on demand.
+
+// one keyed entry per target port; the last entry is the shared overflow
+// bucket and is reported as "other"
+constexpr int RPC_PHASE_CLUSTERS = 16;
+constexpr int RPC_PHASE_OTHER_PORT = -1;
+
+struct rpc_phase_cluster_histograms_t {
+  std::atomic<int> port{0}; // 0 = unused entry, RPC_PHASE_OTHER_PORT = overflow
+  LatencyHistogram queue_wait;
+  LatencyHistogram net_roundtrip;
+};
+
+struct worker_rpc_phase_histograms_t {
+  rpc_phase_cluster_histograms_t clusters[RPC_PHASE_CLUSTERS];
+};
+
+// master, before the first fork
+void init_worker_rpc_phase_histograms(int slots);
+// worker, right after fork: bind this process to its slab
+void worker_rpc_phase_histograms_set_slot(int slot);
+
+// worker: capture the phase timestamps; all three tolerate unknown slot ids
+void rpc_query_phases_on_create(slot_id_t slot_id) noexcept;
+void rpc_query_phases_on_send(slot_id_t slot_id, int target_port) noexcept;
+void rpc_query_phases_on_complete(slot_id_t slot_id) noexcept;
+
+// master: per-port bucket-wise sum of all worker slabs into *to
+void worker_rpc_phase_histograms_collect(worker_rpc_phase_histograms_t *to) noexcept;
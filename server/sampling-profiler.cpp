@@ -0,0 +1,139 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/sampling-profiler.h"
+
+#include <cinttypes>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <dlfcn.h>
+#include <map>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "common/fast-backtrace.h"
+#include "common/kprintf.h"
+#include "common/precise-time.h"
+#include "common/server/signals.h"
+
+namespace {
+
+constexpr int SAMPLING_FREQUENCY_HZ = 99;
+constexpr int MAX_UNWIND_DEPTH = 32;
+constexpr int FLUSH_PERIOD_SEC = 10;
+
+char log_path_prefix[PATH_MAX]{'\0'};
+
+// open addressing pc -> hit count table, updated from the signal handler only;
+// the worker is single threaded, so plain increments are enough
+struct pc_hits {
+  void *pc;
+  uint64_t count;
+};
+constexpr uint32_t HITS_TABLE_SIZE = 1u << 16;
+pc_hits hits_table[HITS_TABLE_SIZE];
+uint64_t total_samples = 0;
+uint64_t dropped_samples = 0;
+
+void record_pc(void *pc) {
+  uint32_t slot = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pc) >> 4) & (HITS_TABLE_SIZE - 1);
+  for (uint32_t probes = 0; probes < HITS_TABLE_SIZE; ++probes) {
+    if (hits_table[slot].pc == pc) {
+      ++hits_table[slot].count;
+      return;
+    }
+    if (hits_table[slot].pc == nullptr) {
+      hits_table[slot].pc = pc;
+      hits_table[slot].count = 1;
+      return;
+    }
+    slot = (slot + 1) & (HITS_TABLE_SIZE - 1);
+  }
+  ++dropped_samples;
+}
+
+void sigprof_handler(int signum __attribute__((unused))) {
+  // only stack reads and writes into the static table here: no allocations, no locks
+  void *frames[MAX_UNWIND_DEPTH];
+  const int frames_count = fast_backtrace(frames, MAX_UNWIND_DEPTH);
+  // frame 0 is this handler, the rest get inclusive hits
+  for (int i = 1; i < frames_count; ++i) {
+    record_pc(frames[i]);
+  }
+  ++total_samples;
+}
+
+struct cstr_less {
+  bool operator()(const char *lhs, const char *rhs) const {
+    return strcmp(lhs, rhs) < 0;
+  }
+};
+
+} // namespace
+
+bool set_sampling_profiler_log_prefix(const char *prefix) {
+  const size_t prefix_len = strlen(prefix);
+  // reserve 32 bytes for the pid
+  if (!prefix_len || prefix_len + 32 > PATH_MAX) {
+    return false;
+  }
+  strcpy(log_path_prefix, prefix);
+  return true;
+}
+
+void start_sampling_profiler() {
+  if (!*log_path_prefix) {
+    return;
+  }
+  ksignal(SIGPROF, sigprof_handler);
+
+  itimerval timer;
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_usec = 1000000 / SAMPLING_FREQUENCY_HZ;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    kprintf("failed to start sampling profiler timer: %m\n");
+  }
+}
+
+void flush_sampling_profiler_stats() {
+  if (!*log_path_prefix || !total_samples) {
+    return;
+  }
+  static int last_flush_time = 0;
+  if (get_uptime() < last_flush_time + FLUSH_PERIOD_SEC) {
+    return;
+  }
+  last_flush_time = get_uptime();
+
+  // symbol names point into the static elf strtab, so they are stable between flushes
+  std::map<const char *, uint64_t, cstr_less> symbol_hits;
+  uint64_t unresolved_hits = 0;
+  for (const auto &hit : hits_table) {
+    if (!hit.pc) {
+      continue;
+    }
+    Dl_info info;
+    if (dladdr(hit.pc, &info) && info.dli_sname) {
+      symbol_hits[info.dli_sname] += hit.count;
+    } else {
+      unresolved_hits += hit.count;
+    }
+  }
+
+  char log_path[PATH_MAX];
+  snprintf(log_path, sizeof(log_path), "%s.%d", log_path_prefix, static_cast<int>(getpid()));
+  FILE *log = fopen(log_path, "w");
+  if (!log) {
+    kprintf("failed to open sampling profiler log '%s': %m\n", log_path);
+    return;
+  }
+  fprintf(log, "#total_samples %" PRIu64 "\n#dropped_samples %" PRIu64 "\n#unresolved_hits %" PRIu64 "\n",
+          total_samples, dropped_samples, unresolved_hits);
+  for (const auto &symbol : symbol_hits) {
+    fprintf(log, "%" PRIu64 " %s\n", symbol.second, symbol.first);
+  }
+  fclose(log);
+}
@@ -0,0 +1,20 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+// SIGPROF-based sampling profiler: unlike the tracing profiler from runtime/profiler.h it needs
+// no @kphp-profile recompilation and is cheap enough to keep always-on in production.
+// A timer signal unwinds the native stack with fast_backtrace() and accumulates pc hit counts;
+// between requests the counts are resolved to symbols (generated php functions are ordinary
+// f$* elf symbols) and dumped to <prefix>.<pid>
+
+// remembers the log path prefix and thereby enables the profiler; returns false if it is too long
+bool set_sampling_profiler_log_prefix(const char *prefix);
+
+// installs the SIGPROF handler and starts the sampling timer; to be called in a worker after fork
+void start_sampling_profiler();
+
+// periodically rewrites the log with the accumulated per-symbol sample counts; cheap to call often
+void flush_sampling_profiler_stats();
@@ -1,8 +1,15 @@
 prepend(KPHP_SERVER_SOURCES ${BASE_DIR}/server/
         confdata-binlog-replay.cpp
         confdata-stats.cpp
+        file-io-pool.cpp
+        hugepage-text.cpp
+        latency-class.cpp
+        latency-histogram.cpp
         lease-config-parser.cpp
         lease-rpc-client.cpp
+        malloc-stats.cpp
+        numa-configuration.cpp
+        perf-counters.cpp
         php-engine-vars.cpp
         php-engine.cpp
         php-lease.cpp
@@ -14,6 +21,10 @@ prepend(KPHP_SERVER_SOURCES ${BASE_DIR}/server/
         php-runner.cpp
         php-script.cpp
         php-sql-connections.cpp
-        php-worker-stats.cpp)
+        php-worker-stats.cpp
+        rpc-query-phases.cpp
+        sampling-profiler.cpp
+        worker-control-block.cpp
+        worker-group.cpp)
 
 vk_add_library(kphp_server OBJECT ${KPHP_SERVER_SOURCES})
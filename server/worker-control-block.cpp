@@ -0,0 +1,83 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/worker-control-block.h"
+
+#include <atomic>
+#include <new>
+#include <sys/mman.h>
+
+#include "common/cacheline.h"
+#include "common/kprintf.h"
+
+namespace {
+
+struct alignas(KDB_CACHELINE_SIZE) worker_control_block_t {
+  // odd while the payload is being rewritten; 0 means never published
+  std::atomic<uint32_t> sequence{0};
+  pid_t worker_pid{0};
+  uint64_t requests_handled{0};
+  php_immediate_stats_t istats{};
+};
+
+worker_control_block_t *control_blocks = nullptr;
+
+} // namespace
+
+bool init_workers_control_blocks() noexcept {
+  const size_t mem_size = sizeof(worker_control_block_t) * MAX_WORKERS;
+  void *mem = mmap(nullptr, mem_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) {
+    kprintf("cannot mmap %zu bytes for workers control blocks: %m\n", mem_size);
+    return false;
+  }
+  control_blocks = new (mem) worker_control_block_t[MAX_WORKERS];
+  return true;
+}
+
+void publish_worker_control_block(const php_immediate_stats_t &istats, uint64_t requests_handled) noexcept {
+  if (control_blocks == nullptr || logname_id < 0 || logname_id >= MAX_WORKERS) {
+    return;
+  }
+  worker_control_block_t &block = control_blocks[logname_id];
+  // seqlock write; the worker is the only writer of its block
+  const uint32_t sequence = block.sequence.load(std::memory_order_relaxed);
+  block.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  block.worker_pid = pid;
+  block.requests_handled = requests_handled;
+  block.istats = istats;
+  block.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool try_read_worker_control_block(int logname_id, pid_t expected_pid, php_immediate_stats_t *istats, uint64_t *requests_handled) noexcept {
+  if (control_blocks == nullptr || logname_id < 0 || logname_id >= MAX_WORKERS) {
+    return false;
+  }
+  const worker_control_block_t &block = control_blocks[logname_id];
+  constexpr int max_attempts = 4;
+  for (int attempt = 0; attempt != max_attempts; ++attempt) {
+    const uint32_t sequence = block.sequence.load(std::memory_order_acquire);
+    if (sequence == 0) {
+      return false;
+    }
+    if (sequence & 1) {
+      continue;
+    }
+    const pid_t worker_pid = block.worker_pid;
+    const uint64_t block_requests_handled = block.requests_handled;
+    const php_immediate_stats_t block_istats = block.istats;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (block.sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;
+    }
+    if (worker_pid != expected_pid) {
+      return false;
+    }
+    *istats = block_istats;
+    *requests_handled = block_requests_handled;
+    return true;
+  }
+  return false;
+}
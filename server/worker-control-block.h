@@ -0,0 +1,26 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <sys/types.h>
+
+#include "server/php-engine-vars.h"
+
+// Per-worker control blocks in shared memory: each worker publishes its state
+// (liveness, current phase, handled requests) wait-free through a seqlock,
+// and the master scans the blocks in its cron loop instead of signaling every
+// worker and parsing pipe packets. Pipes are kept for full stats and wakeups.
+
+// master side, called once before forking the first worker
+bool init_workers_control_blocks() noexcept;
+
+// worker side: seqlock write into the own block, never blocks
+void publish_worker_control_block(const php_immediate_stats_t &istats, uint64_t requests_handled) noexcept;
+
+// master side: consistent snapshot of one worker's block;
+// returns false if the block was never published, belongs to a previous worker
+// of the same slot, or is being updated right now (the caller falls back to pipes)
+bool try_read_worker_control_block(int logname_id, pid_t expected_pid, php_immediate_stats_t *istats, uint64_t *requests_handled) noexcept;
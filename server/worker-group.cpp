@@ -0,0 +1,64 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/worker-group.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "common/kprintf.h"
+
+#include "server/php-engine-vars.h"
+
+static constexpr int MAX_WORKER_GROUPS = 16;
+static worker_group_t worker_groups[MAX_WORKER_GROUPS];
+static int worker_groups_n = 0;
+
+int register_worker_group(const char *description) {
+  if (worker_groups_n == MAX_WORKER_GROUPS) {
+    kprintf("too many worker groups, at most %d are supported\n", MAX_WORKER_GROUPS);
+    return -1;
+  }
+  worker_group_t &group = worker_groups[worker_groups_n];
+  int memory_limit_mb = 0;
+  const int parsed = sscanf(description, "%31[^:]:%d:%d:%d", group.name, &group.workers, &group.http_port, &memory_limit_mb);
+  if (parsed < 3 || group.workers <= 0 || group.http_port < 0 || memory_limit_mb < 0) {
+    kprintf("cannot parse worker group: expected <name>:<workers>:<port>[:<memory-limit-mb>], got '%s'\n", description);
+    return -1;
+  }
+  group.max_memory = static_cast<long long>(memory_limit_mb) << 20;
+  if (get_total_group_workers() + group.workers > MAX_WORKERS) {
+    kprintf("worker groups define more than %d workers in total\n", MAX_WORKERS);
+    return -1;
+  }
+  worker_groups_n++;
+  return 0;
+}
+
+int get_worker_groups_count() {
+  return worker_groups_n;
+}
+
+const worker_group_t *get_worker_group(int group_id) {
+  return group_id >= 0 && group_id < worker_groups_n ? &worker_groups[group_id] : nullptr;
+}
+
+int get_total_group_workers() {
+  int total = 0;
+  for (int i = 0; i < worker_groups_n; i++) {
+    total += worker_groups[i].workers;
+  }
+  return total;
+}
+
+const worker_group_t *get_worker_group_of_logname(int logname_id) {
+  int first_id = 0;
+  for (int i = 0; i < worker_groups_n; i++) {
+    if (logname_id < first_id + worker_groups[i].workers) {
+      return logname_id >= first_id ? &worker_groups[i] : nullptr;
+    }
+    first_id += worker_groups[i].workers;
+  }
+  return nullptr;
+}
@@ -0,0 +1,39 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+// Worker groups give QoS isolation inside one engine: admin RPC, public HTTP and
+// internal traffic can each get a dedicated set of workers with its own listen
+// port and script memory limit, while all groups share one compiled binary and
+// one master. A group is configured with
+// --worker-group <name>:<workers>:<port>[:<memory-limit-mb>] (repeatable) and
+// requires master mode with --listen-reuseport: each worker binds its group's
+// port after the fork, so the kernel distributes a port's connections only
+// between that group's workers and one overloaded service can't starve the rest.
+//
+// Group membership is derived from the worker's logname id: group 0 owns ids
+// [0, workers_0), group 1 the next range, and so on. Logname ids are recycled
+// one-to-one when workers die, so a replacement worker lands in the same group
+// and the master's usual deficit refill keeps every group at its configured size
+// without extra bookkeeping.
+
+struct worker_group_t {
+  char name[32];
+  int workers;          // how many workers this group runs
+  int http_port;        // the group's own listen port, 0 = the engine-wide port
+  long long max_memory; // per-script memory limit in bytes, 0 = the engine-wide limit
+};
+
+// parses "<name>:<workers>:<port>[:<memory-limit-mb>]"; returns -1 on error
+int register_worker_group(const char *description);
+
+int get_worker_groups_count();
+const worker_group_t *get_worker_group(int group_id);
+
+// sum of the configured group sizes; becomes the engine's workers_n
+int get_total_group_workers();
+
+// the group owning this logname id; nullptr when no groups are configured
+const worker_group_t *get_worker_group_of_logname(int logname_id);
@@ -13,3 +13,16 @@ TEST(phpdoc_test, parse_php_doc) {
   ASSERT_TRUE(parsing_result.front().value.empty());
   ASSERT_EQ(parsing_result.front().line_num, -1);
 }
+
+TEST(phpdoc_test, parse_php_doc_is_cached) {
+  const char *phpdoc =
+    "**\n"
+    " * @param int $x\n"
+    " *\n";
+  const auto &first = parse_php_doc(phpdoc);
+  const auto &second = parse_php_doc(phpdoc);
+  ASSERT_EQ(&first, &second);
+  ASSERT_EQ(first.size(), 1);
+  ASSERT_EQ(first.front().type, php_doc_tag::param);
+  ASSERT_EQ(first.front().value, "int $x");
+}
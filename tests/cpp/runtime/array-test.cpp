@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <functional>
+#include <vector>
+
 #include "runtime/kphp_core.h"
 
 TEST(array_test, find_no_mutate_in_empy_array) {
@@ -132,3 +136,64 @@ TEST(array_test, test_mutate_shared_map) {
   ASSERT_EQ(arr_copy.get_reference_counter(), 1);
   ASSERT_FALSE(arr_copy.is_equal_inner_pointer(arr));
 }
+
+TEST(array_test, sort_int64_radix_path) {
+  // above the radix threshold with negative keys to cover the sign-flipping top byte pass
+  std::vector<int64_t> expected(1000);
+  array<int64_t> arr;
+  for (int64_t i = 0; i < 1000; i++) {
+    const int64_t x = (i * 2654435761) % 1000 - 500;
+    expected[i] = x;
+    arr.push_back(x);
+  }
+  std::sort(expected.begin(), expected.end());
+
+  arr.sort(std::greater<int64_t>{}, true);
+
+  ASSERT_TRUE(arr.is_vector());
+  for (int64_t i = 0; i < 1000; i++) {
+    ASSERT_EQ(arr.get_value(i), expected[i]);
+  }
+}
+
+TEST(array_test, sort_small_range_insertion) {
+  auto arr = array<int64_t>::create(5, -1, 3, 3, 0, -7, 2);
+  arr.sort(std::greater<int64_t>{}, true);
+
+  const auto expected = array<int64_t>::create(-7, -1, 0, 2, 3, 3, 5);
+  ASSERT_TRUE(equals(arr, expected));
+}
+
+TEST(array_test, revert_dense_map_to_vector_on_begin) {
+  auto arr = array<int>::create(10, 20, 30, 40);
+  arr.set_value(string{"tmp"}, 50);
+  arr.unset(string{"tmp"});
+
+  // the string key degraded the layout to a map, but the int keys are still 0..3 in order
+  ASSERT_FALSE(arr.is_vector());
+
+  // mutable begin() owns a private copy anyway, so it may drop the map layout
+  ASSERT_EQ((*arr.begin()).get_value(), 10);
+  ASSERT_TRUE(arr.is_vector());
+  for (int64_t i = 0; i < 4; i++) {
+    ASSERT_EQ(arr.get_value(i), (i + 1) * 10);
+  }
+}
+
+TEST(array_test, no_revert_for_sparse_or_unordered_maps) {
+  auto sparse = array<int>::create(10, 20, 30);
+  sparse.set_value(string{"tmp"}, 0);
+  sparse.unset(string{"tmp"});
+  sparse.unset(int64_t{1});
+  *sparse.begin();
+  ASSERT_FALSE(sparse.is_vector());
+
+  auto unordered = array<int>::create(10, 20, 30);
+  unordered.set_value(string{"tmp"}, 0);
+  unordered.unset(string{"tmp"});
+  unordered.unset(int64_t{1});
+  unordered.set_value(int64_t{1}, 20);
+  // keys are dense again, but the insertion order is 0, 2, 1
+  *unordered.begin();
+  ASSERT_FALSE(unordered.is_vector());
+}
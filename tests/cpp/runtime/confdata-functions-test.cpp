@@ -121,6 +121,24 @@ TEST(confdata_functions_test, test_confdata_get_values_by_any_wildcard) {
   }));
 }
 
+TEST(confdata_functions_test, test_confdata_epochs) {
+  init_global_confdata_confdata();
+
+  auto &epoch_table = ConfdataGlobalManager::get().get_epoch_table();
+  const int64_t global_epoch = f$confdata_get_global_epoch();
+  const int64_t key_1_epoch = f$confdata_get_epoch(string{"_key_1"});
+
+  std::bitset<ConfdataEpochTable::SLOTS_AMOUNT> modified_slots;
+  modified_slots.set(ConfdataEpochTable::get_slot(vk::string_view{"_key_1"}));
+  epoch_table.on_sample_published(modified_slots);
+
+  ASSERT_EQ(f$confdata_get_global_epoch(), global_epoch + 1);
+  ASSERT_EQ(f$confdata_get_epoch(string{"_key_1"}), global_epoch + 1);
+  ASSERT_GT(f$confdata_get_epoch(string{"_key_1"}), key_1_epoch);
+  // keys of one section share an epoch slot
+  ASSERT_EQ(f$confdata_get_epoch(string{"_one dot.one_1"}), f$confdata_get_epoch(string{"_one dot.one_2"}));
+}
+
 TEST(confdata_functions_test, test_confdata_get_values_by_bad_wildcard) {
   init_global_confdata_confdata();
 
@@ -0,0 +1,95 @@
+<?php
+
+// canned handler corpus for the load harness: each uri exercises one workload
+// class seen in production — json-heavy request bodies, string page rendering
+// and instance-cache churn; the request mix is replayed by the python driver
+
+/** @kphp-immutable-class */
+class CachedProfile {
+  /** @var int */
+  public $id = 0;
+  /** @var string */
+  public $name = '';
+  /** @var int[] */
+  public $friend_ids = [];
+
+  public function __construct(int $id, string $name, array $friend_ids) {
+    $this->id = $id;
+    $this->name = $name;
+    $this->friend_ids = $friend_ids;
+  }
+}
+
+function make_payload(int $size): array {
+  $users = [];
+  for ($i = 0; $i < $size; ++$i) {
+    $users[] = [
+      'id' => $i,
+      'name' => "user_$i",
+      'flags' => ['active' => ($i % 3) !== 0, 'verified' => ($i % 7) === 0],
+      'scores' => [$i * 3, $i * 5 + 1, $i * 7 + 2],
+    ];
+  }
+  return ['users' => $users, 'total' => $size];
+}
+
+function handle_json(): void {
+  $rounds = max(1, (int)$_GET['rounds']);
+  $size = max(1, (int)$_GET['size']);
+  $payload = make_payload($size);
+  $encoded = '';
+  for ($i = 0; $i < $rounds; ++$i) {
+    $encoded = json_encode($payload);
+    $decoded = json_decode($encoded, true);
+    $payload['total'] = count($decoded['users']);
+  }
+  echo 'json_len=', strlen($encoded), ' total=', $payload['total'];
+}
+
+function handle_render(): void {
+  $items = max(1, (int)$_GET['items']);
+  $page = "<ul class=\"feed\">\n";
+  for ($i = 0; $i < $items; ++$i) {
+    $title = htmlspecialchars("Item #$i <$i>");
+    $page .= "  <li id=\"item-$i\" data-score=\"" . ($i * 13 % 97) . "\">$title</li>\n";
+  }
+  $page .= "</ul>\n";
+  echo 'render_len=', strlen($page);
+}
+
+function handle_cache(): void {
+  $ops = max(1, (int)$_GET['ops']);
+  $hits = 0;
+  $misses = 0;
+  for ($i = 0; $i < $ops; ++$i) {
+    $id = $i % 64;
+    $key = "load_harness_profile_$id";
+    $profile = instance_cache_fetch(CachedProfile::class, $key);
+    if ($profile === null) {
+      ++$misses;
+      $friend_ids = [];
+      for ($j = 0; $j < 32; ++$j) {
+        $friend_ids[] = $id * 1000 + $j;
+      }
+      $profile = new CachedProfile($id, "profile_$id", $friend_ids);
+      instance_cache_store($key, $profile, 60);
+    } else {
+      ++$hits;
+    }
+  }
+  echo "hits=$hits misses=$misses";
+}
+
+switch ($_SERVER['PHP_SELF']) {
+  case '/json':
+    handle_json();
+    break;
+  case '/render':
+    handle_render();
+    break;
+  case '/cache':
+    handle_cache();
+    break;
+  default:
+    echo 'pong';
+}
@@ -0,0 +1,100 @@
+import os
+import random
+import time
+from collections import defaultdict
+from multiprocessing.dummy import Pool as ThreadPool
+
+from python.lib.testcase import KphpServerAutoTestCase
+
+# request mix replayed against the canned handler corpus in php/index.php;
+# weights are out of 100 and roughly follow the production traffic split
+# between json-heavy endpoints, page rendering and cache-backed lookups
+REQUEST_MIX = [
+    ("/json?rounds=8&size=24", 40),
+    ("/render?items=120", 30),
+    ("/cache?ops=48", 30),
+]
+
+
+def _percentile(sorted_values, fraction):
+    index = min(len(sorted_values) - 1, int(len(sorted_values) * fraction))
+    return sorted_values[index]
+
+
+class TestLoadHarness(KphpServerAutoTestCase):
+    """
+    Synthetic end-to-end load harness: replays a weighted request mix against
+    a compiled engine and reports client-side latency percentiles per handler
+    plus server-side worker and memory stats from the master.
+
+    Knobs (environment variables):
+      KPHP_LOAD_HARNESS_REQUESTS    total requests to replay (default 400)
+      KPHP_LOAD_HARNESS_CONCURRENCY parallel client connections (default 8)
+    """
+
+    @classmethod
+    def extra_class_setup(cls):
+        cls.kphp_server.update_options({
+            "--workers-num": 4,
+        })
+
+    def _send_request(self, uri):
+        started_at = time.monotonic()
+        resp = self.kphp_server.http_get(uri)
+        elapsed = time.monotonic() - started_at
+        self.assertEqual(resp.status_code, 200)
+        return uri, elapsed
+
+    def test_replay_request_mix(self):
+        total_requests = int(os.environ.get("KPHP_LOAD_HARNESS_REQUESTS", "400"))
+        concurrency = int(os.environ.get("KPHP_LOAD_HARNESS_CONCURRENCY", "8"))
+
+        # fixed seed: identical request plans make before/after runs comparable
+        rng = random.Random(42)
+        uris = [uri for uri, _ in REQUEST_MIX]
+        weights = [weight for _, weight in REQUEST_MIX]
+        plan = rng.choices(uris, weights=weights, k=total_requests)
+
+        # one warmup request per handler, so compilation caches and the
+        # instance cache working set don't end up inside the measurement
+        for uri in uris:
+            self._send_request(uri)
+
+        initial_stats = self.kphp_server.get_stats(prefix="kphp_server.")
+        started_at = time.monotonic()
+        with ThreadPool(concurrency) as pool:
+            results = pool.map(self._send_request, plan)
+        wall_time = time.monotonic() - started_at
+
+        latencies_by_uri = defaultdict(list)
+        for uri, elapsed in results:
+            latencies_by_uri[uri].append(elapsed)
+
+        print("\n=== load harness report: {} requests, {} connections, {:.2f}s wall, {:.0f} rps ===".format(
+            total_requests, concurrency, wall_time, total_requests / wall_time))
+        for uri in uris:
+            latencies = sorted(latencies_by_uri[uri])
+            print("{:<28} n={:<6} p50={:.1f}ms p95={:.1f}ms p99={:.1f}ms max={:.1f}ms".format(
+                uri, len(latencies),
+                _percentile(latencies, 0.50) * 1000,
+                _percentile(latencies, 0.95) * 1000,
+                _percentile(latencies, 0.99) * 1000,
+                latencies[-1] * 1000))
+
+        server_stats = self.kphp_server.get_stats(prefix="kphp_server.")
+        for stat in ("workers_general_processes_total", "uptime"):
+            key = "kphp_server.{}".format(stat)
+            if key in server_stats:
+                print("{:<40} {}".format(stat, server_stats[key]))
+        for stat in ("memory_script_usage_percentile_95", "requests_script_time_percentile_95"):
+            key = "kphp_server.{}".format(stat)
+            if key in server_stats:
+                print("{:<40} {}".format(stat, server_stats[key]))
+
+        self.kphp_server.assert_stats(
+            initial_stats=initial_stats,
+            prefix="kphp_server.",
+            expected_added_stats={
+                "requests_total_incoming_queries": self.cmpGe(total_requests),
+            })
+        self.assertKphpNoTerminatedRequests()
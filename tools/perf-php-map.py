@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Joins the codegen sidecar php_functions.map with the linked binary, so perf
+profiles collapse to PHP function names without a KPHP developer at hand.
+
+Codegen emits php_functions.map (c++ name -> php function -> php file) next to
+the generated sources; addresses exist only after link, so this script adds
+them post-link from `nm` output.
+
+  resolve  - print "<start-address> <size> <php function>" per linked php
+             function, the format perf understands as a /tmp/perf-<pid>.map
+  collapse - rewrite collapsed stacks (stackcollapse-perf.pl output) or plain
+             `perf script` text on stdin, replacing f$ frames with php names
+
+Examples:
+  tools/perf-php-map.py resolve --map kphp_out/php_functions.map --binary server
+  perf script | stackcollapse-perf.pl | \\
+      tools/perf-php-map.py collapse --map kphp_out/php_functions.map | flamegraph.pl > out.svg
+"""
+import argparse
+import re
+import subprocess
+import sys
+
+
+def load_map(map_path):
+    php_by_cpp = {}
+    with open(map_path) as f:
+        for line in f:
+            if line.startswith("#") or not line.strip():
+                continue
+            parts = line.rstrip("\n").split("\t")
+            if len(parts) >= 2:
+                php_by_cpp[parts[0]] = parts[1]
+    return php_by_cpp
+
+
+def demangled_symbols(binary):
+    # -C demangles, so generated functions show up as 'f$name(args)';
+    # the part before '(' is exactly the c++ name codegen wrote to the map
+    out = subprocess.check_output(["nm", "-C", "-S", "--defined-only", binary], text=True)
+    for line in out.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) == 4 and parts[2].lower() == "t":
+            yield parts[0], parts[1], parts[3].split("(")[0]
+
+
+def cmd_resolve(args, php_by_cpp):
+    for address, size, cpp_name in demangled_symbols(args.binary):
+        php_name = php_by_cpp.get(cpp_name)
+        if php_name is not None:
+            print("{} {} {}".format(address, size, php_name))
+
+
+def cmd_collapse(args, php_by_cpp):
+    # matches a demangled frame name up to its argument list; non-f$ frames
+    # (runtime, libc) never hit the map and pass through unchanged
+    frame_re = re.compile(r"f\$[A-Za-z0-9_$]+")
+    for line in sys.stdin:
+        sys.stdout.write(frame_re.sub(lambda m: php_by_cpp.get(m.group(0), m.group(0)), line))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    resolve = sub.add_parser("resolve", help="print php function address ranges of a linked binary")
+    resolve.add_argument("--map", required=True, help="php_functions.map from the codegen dest dir")
+    resolve.add_argument("--binary", required=True, help="linked kphp binary")
+
+    collapse = sub.add_parser("collapse", help="rewrite f$ frames on stdin to php function names")
+    collapse.add_argument("--map", required=True, help="php_functions.map from the codegen dest dir")
+
+    args = parser.parse_args()
+    php_by_cpp = load_map(args.map)
+    if args.command == "resolve":
+        cmd_resolve(args, php_by_cpp)
+    else:
+        cmd_collapse(args, php_by_cpp)
+
+
+if __name__ == "__main__":
+    main()
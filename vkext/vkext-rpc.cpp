@@ -68,6 +68,11 @@ struct stats stats;
 
 double ping_timeout = PING_TIMEOUT;
 
+// sockets opened towards every rpc target by each php worker; with large fpm
+// pools the engine-side connection count is workers * this, so hosts fronted
+// by a local proxy should run with 1 (vkext.rpc_connections_per_target)
+static int rpc_connections_per_target = 3;
+
 static int use_unix;
 static const char *unix_socket_directory;
 
@@ -3277,7 +3282,7 @@ void php_new_rpc_connection(INTERNAL_FUNCTION_PARAMETERS) {  /* {{{ */
   int errnum;
 
   struct rpc_connection *c;
-  if (!(c = do_new_rpc_connection(host, port, 3, default_actor_id, default_query_timeout, connect_timeout, retry_timeout, &error_string, &errnum))) {
+  if (!(c = do_new_rpc_connection(host, port, rpc_connections_per_target, default_actor_id, default_query_timeout, connect_timeout, retry_timeout, &error_string, &errnum))) {
     php_error_docref(NULL TSRMLS_CC, E_WARNING, "Can't connect to %s:%d (ip %08x), %s (%d)", host_name, port, host, error_string ? error_string : "Unknown error", errnum);
     if (error_string) {
       efree (error_string);
@@ -3407,6 +3412,15 @@ void rpc_on_minit(int module_number) { /* {{{ */
     use_unix = atoi(VK_INI_STR("vkext.use_unix"));
   }
 
+  if (VK_INI_STR("vkext.rpc_connections_per_target")) {
+    rpc_connections_per_target = atoi(VK_INI_STR("vkext.rpc_connections_per_target"));
+    if (rpc_connections_per_target < 1) {
+      rpc_connections_per_target = 1;
+    } else if (rpc_connections_per_target > 16) {
+      rpc_connections_per_target = 16;
+    }
+  }
+
   unix_socket_directory = VK_INI_STR("vkext.unix_socket_directory");
   assert(unix_socket_directory && unix_socket_directory[0]);
 
@@ -118,6 +118,7 @@ PHP_INI_BEGIN ()
     PHP_INI_ENTRY ("vkext.ping_timeout", 0, PHP_INI_ALL, 0)
     PHP_INI_ENTRY ("vkext.use_unix", 0, PHP_INI_ALL, 0)
     PHP_INI_ENTRY ("vkext.unix_socket_directory", "/var/run/engine", PHP_INI_ALL, 0)
+    PHP_INI_ENTRY ("vkext.rpc_connections_per_target", 0, PHP_INI_ALL, 0)
 PHP_INI_END ()
 
 zend_module_entry vkext_module_entry = {